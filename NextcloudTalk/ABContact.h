@@ -29,7 +29,8 @@
 @property (nonatomic, copy) NSString *identifier;
 @property (nonatomic, copy) NSString *name;
 @property (nonatomic, strong) RLMArray<RLMString> *phoneNumbers;
-@property (nonatomic, assign) NSInteger lastUpdate;
+@property (nonatomic, copy) NSString *phoneNumbersDigest; // hash of the sorted phone numbers
+@property (nonatomic, assign) NSInteger lastUpdate; // last time the phone numbers changed
 
 + (instancetype)contactWithIdentifier:(NSString *)identifier name:(NSString *)name phoneNumbers:(NSArray *)phoneNumbers lastUpdate:(NSInteger)lastUpdate;
 + (void)updateContact:(ABContact *)managedContact withContact:(ABContact *)contact;
@@ -22,6 +22,8 @@
 
 #import "ABContact.h"
 
+#import "NCAddressBookDiff.h"
+
 @implementation ABContact
 
 + (instancetype)contactWithIdentifier:(NSString *)identifier name:(NSString *)name phoneNumbers:(NSArray *)phoneNumbers lastUpdate:(NSInteger)lastUpdate
@@ -30,14 +32,21 @@
     contact.identifier = identifier;
     contact.name = name;
     contact.phoneNumbers = (RLMArray<RLMString> *)phoneNumbers;
+    contact.phoneNumbersDigest = [NCAddressBookDiff digestForPhoneNumbers:phoneNumbers];
     contact.lastUpdate = lastUpdate;
     return contact;
 }
 
++ (NSArray *)indexedProperties
+{
+    return @[@"identifier", @"lastUpdate"];
+}
+
 + (void)updateContact:(ABContact *)managedContact withContact:(ABContact *)contact
 {
     managedContact.name = contact.name;
     managedContact.phoneNumbers = contact.phoneNumbers;
+    managedContact.phoneNumbersDigest = contact.phoneNumbersDigest;
     managedContact.lastUpdate = contact.lastUpdate;
 }
 
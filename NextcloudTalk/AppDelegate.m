@@ -36,12 +36,14 @@
 #import "NCAppBranding.h"
 #import "NCDatabaseManager.h"
 #import "NCKeyChainController.h"
+#import "NCLogger.h"
 #import "NCNavigationController.h"
 #import "NCNotificationController.h"
 #import "NCPushNotification.h"
 #import "NCPushNotificationsUtils.h"
 #import "NCRoomsManager.h"
 #import "NCSettingsController.h"
+#import "NCStartupPhases.h"
 #import "NCUserInterfaceController.h"
 #import "NCUtils.h"
 
@@ -61,23 +63,20 @@
 
 - (BOOL)application:(UIApplication *)application didFinishLaunchingWithOptions:(NSDictionary *)launchOptions
 {
-#if DEBUG
-    [AFNetworkActivityIndicatorManager sharedManager].enabled = YES;
-#endif
+    // Only what is needed to show the room list (and to handle launches for calls or notifications) is done here,
+    // everything else is deferred until the app finished launching
+    [NCStartupPhases beginPhase:NCStartupPhaseCriticalPath];
+
     [[AFNetworkReachabilityManager sharedManager] startMonitoring];
     
-    [[NCNotificationController sharedInstance] requestAuthorization];
+    // The notification center delegate needs to be set before the app finished launching
+    [NCNotificationController sharedInstance];
     
     [application registerForRemoteNotifications];
     
     pushRegistry = [[PKPushRegistry alloc] initWithQueue:dispatch_get_main_queue()];
     pushRegistry.delegate = self;
     pushRegistry.desiredPushTypes = [NSSet setWithObject:PKPushTypeVoIP];
-
-    [[WebRTCCommon shared] dispatch:^{
-        NSLog(@"Configure Audio Session");
-        [NCAudioController sharedInstance];
-    }];
     
     NSLog(@"Configure App Settings");
     [NCSettingsController sharedInstance];
@@ -85,6 +84,7 @@
     //Init rooms manager to start receiving NSNotificationCenter notifications
     [NCRoomsManager sharedInstance];
     
+    // Launch handlers need to be registered before the app finished launching
     [self registerBackgroundFetchTask];
 
     [NCUserInterfaceController sharedInstance].mainViewController = (NCSplitViewController *) self.window.rootViewController;
@@ -110,10 +110,37 @@
 
     // When we include VLCKit we need to manually call this because otherwise, device rotation might not work
     [[UIDevice currentDevice] beginGeneratingDeviceOrientationNotifications];
+
+    [NCStartupPhases endPhase:NCStartupPhaseCriticalPath];
+
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self finishDeferredLaunchTasks];
+    });
     
     return YES;
 }
 
+- (void)finishDeferredLaunchTasks
+{
+    [NCStartupPhases beginPhase:NCStartupPhaseDeferred];
+
+#if DEBUG
+    [AFNetworkActivityIndicatorManager sharedManager].enabled = YES;
+#endif
+
+    [[NCNotificationController sharedInstance] requestAuthorization];
+
+    // Calls started before this point create the audio controller on demand
+    [[WebRTCCommon shared] dispatch:^{
+        NSLog(@"Configure Audio Session");
+        [NCAudioController sharedInstance];
+    }];
+
+    [[NCSettingsController sharedInstance] createAccountsFile];
+
+    [NCStartupPhases endPhase:NCStartupPhaseDeferred];
+}
+
 - (BOOL)application:(UIApplication *)application continueUserActivity:(nonnull NSUserActivity *)userActivity restorationHandler:(nonnull void (^)(NSArray<id<UIUserActivityRestoring>> * _Nullable))restorationHandler
 {
     BOOL audioCallIntent = [userActivity.interaction.intent isKindOfClass:[INStartAudioCallIntent class]];
@@ -420,6 +447,9 @@
     BGTaskHelper *bgTask = [BGTaskHelper startBackgroundTaskWithName:@"NCBackgroundFetch" expirationHandler:^(BGTaskHelper *task) {
         [NCUtils log:@"ExpirationHandler called"];
 
+        // We are about to be suspended, make sure the log is written
+        [[NCLogger sharedInstance] flush];
+
         /*
         expired = YES;
         completionHandler(YES);
@@ -497,6 +527,7 @@
 
     dispatch_group_notify(backgroundRefreshGroup, dispatch_get_main_queue(), ^{
          [NCUtils log:@"CompletionHandler performBackgroundFetchWithCompletionHandler dispatch_group_notify"];
+         [[NCLogger sharedInstance] flush];
 
          if (!expired) {
              completionHandler(errorOccurred);
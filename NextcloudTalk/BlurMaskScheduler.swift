@@ -0,0 +1,159 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Decides for which frames of the background blur the person segmentation runs. Frames in between reuse the last mask,
+/// a new segmentation is requested every `segmentationInterval` frames or earlier when the luma of the frame changed noticeably.
+/// Also contains the mask smoothing and blur downscale math, none of it depends on Vision or Core Image.
+/// Not thread safe, needs to be used from the queue that processes the video frames.
+class BlurMaskScheduler {
+
+    // The blur is applied with half the width and height (a quarter of the pixels) and scaled up for the composite
+    public static let blurScale = 0.5
+
+    // Segment at least every Nth frame
+    public var segmentationInterval = 3
+    // Mean absolute luma difference (0...1) to the last segmented frame that triggers a segmentation before the interval elapsed
+    public var lumaDeltaThreshold = 0.04
+    // Weight of a new mask when it's blended into the previous mask
+    public var maskSmoothingFactor = 0.5
+
+    public private(set) var segmentedFrames = 0
+    public private(set) var skippedFrames = 0
+
+    private var framesSinceSegmentation = 0
+    private var segmentedLumaSignature: [UInt8]?
+    private var hasSegmentedFrame = false
+
+    // MARK: - Scheduling
+
+    /// Returns true if the frame with the given luma signature needs to be segmented.
+    /// Without luma signature (e.g. unsupported pixel format) only the interval is used.
+    public func shouldSegment(frameWithLumaSignature lumaSignature: [UInt8]?) -> Bool {
+        var segment = !hasSegmentedFrame || framesSinceSegmentation + 1 >= max(segmentationInterval, 1)
+
+        if !segment, let lumaSignature, let segmentedLumaSignature {
+            segment = BlurMaskScheduler.lumaDelta(lumaSignature, segmentedLumaSignature) >= lumaDeltaThreshold
+        }
+
+        if segment {
+            hasSegmentedFrame = true
+            framesSinceSegmentation = 0
+            segmentedLumaSignature = lumaSignature
+            segmentedFrames += 1
+        } else {
+            framesSinceSegmentation += 1
+            skippedFrames += 1
+        }
+
+        return segment
+    }
+
+    /// Forgets the last segmented frame, so the next frame is segmented
+    public func reset() {
+        hasSegmentedFrame = false
+        framesSinceSegmentation = 0
+        segmentedLumaSignature = nil
+    }
+
+    // MARK: - Luma
+
+    /// Average luma of each cell of a gridSize x gridSize grid over an 8 bit luma plane
+    public class func lumaSignature(of plane: UnsafeRawPointer, width: Int, height: Int, bytesPerRow: Int, gridSize: Int = 16) -> [UInt8] {
+        guard width >= gridSize, height >= gridSize, gridSize > 0 else { return [] }
+
+        // Only every 4th pixel of every 4th row is sampled, that's enough to notice movement or lighting changes
+        let sampleStep = 4
+        let pixels = plane.assumingMemoryBound(to: UInt8.self)
+        var signature = [UInt8](repeating: 0, count: gridSize * gridSize)
+
+        for cellY in 0..<gridSize {
+            let startY = cellY * height / gridSize
+            let endY = (cellY + 1) * height / gridSize
+
+            for cellX in 0..<gridSize {
+                let startX = cellX * width / gridSize
+                let endX = (cellX + 1) * width / gridSize
+                var sum = 0
+                var count = 0
+
+                for y in stride(from: startY, to: endY, by: sampleStep) {
+                    let row = pixels + y * bytesPerRow
+
+                    for x in stride(from: startX, to: endX, by: sampleStep) {
+                        sum += Int(row[x])
+                        count += 1
+                    }
+                }
+
+                signature[cellY * gridSize + cellX] = UInt8(sum / max(count, 1))
+            }
+        }
+
+        return signature
+    }
+
+    /// Mean absolute difference of two luma signatures, from 0 (same) to 1
+    public class func lumaDelta(_ signature: [UInt8], _ otherSignature: [UInt8]) -> Double {
+        guard signature.count == otherSignature.count, !signature.isEmpty else { return 1 }
+
+        var sum = 0
+
+        for index in 0..<signature.count {
+            sum += abs(Int(signature[index]) - Int(otherSignature[index]))
+        }
+
+        return Double(sum) / Double(signature.count * 255)
+    }
+
+    // MARK: - Mask and blur math
+
+    /// Blends a new 8 bit mask into the previous mask (in place), so the edges of the mask don't flicker between segmentations
+    public class func smoothMask(_ mask: UnsafeMutableRawPointer, bytesPerRow: Int,
+                                 towards newMask: UnsafeRawPointer, newMaskBytesPerRow: Int,
+                                 width: Int, height: Int, factor: Double) {
+
+        // Fixed point weights, 256 is the whole new mask
+        let newWeight = Int(max(0, min(1, factor)) * 256)
+        let oldWeight = 256 - newWeight
+
+        for y in 0..<height {
+            let row = (mask + y * bytesPerRow).assumingMemoryBound(to: UInt8.self)
+            let newRow = (newMask + y * newMaskBytesPerRow).assumingMemoryBound(to: UInt8.self)
+
+            for x in 0..<width {
+                let oldValue = Int(row[x])
+                let newValue = Int(newRow[x])
+                // Round towards the new value, otherwise a mask that stays the same never reaches it completely
+                let rounding = newValue > oldValue ? 255 : 0
+
+                row[x] = UInt8((newValue * newWeight + oldValue * oldWeight + rounding) >> 8)
+            }
+        }
+    }
+
+    /// Gaussian sigma to use on the downscaled image, to get the same blur as the given sigma on the full resolution image
+    public class func scaledBlurSigma(_ sigma: Double) -> Double {
+        return sigma * blurScale
+    }
+}
@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Ordered participants of the call grid with constant time lookups by peerId and peerIdentifier.
+/// Needs to be used from the main thread.
+@objcMembers class CallParticipantList: NSObject {
+
+    public private(set) var peers: [NCPeerConnection] = []
+
+    private var rowIndex = PeerRowIndex()
+
+    public var count: Int {
+        return peers.count
+    }
+
+    public func peer(atRow row: Int) -> NCPeerConnection {
+        return peers[row]
+    }
+
+    public func peer(forPeerId peerId: String) -> NCPeerConnection? {
+        guard let row = rowIndex.row(forPeerId: peerId) else { return nil }
+
+        return peers[row]
+    }
+
+    public func peer(forPeerIdentifier peerIdentifier: String) -> NCPeerConnection? {
+        guard let row = rowIndex.row(forPeerIdentifier: peerIdentifier) else { return nil }
+
+        return peers[row]
+    }
+
+    public func indexPath(forPeerId peerId: String) -> IndexPath? {
+        guard let row = rowIndex.row(forPeerId: peerId) else { return nil }
+
+        return IndexPath(row: row, section: 0)
+    }
+
+    public func indexPath(forPeerIdentifier peerIdentifier: String) -> IndexPath? {
+        guard let row = rowIndex.row(forPeerIdentifier: peerIdentifier) else { return nil }
+
+        return IndexPath(row: row, section: 0)
+    }
+
+    /// Returns the index path of the added peer, or nil if a peer with the same peerIdentifier is already contained
+    public func addPeer(_ peer: NCPeerConnection) -> IndexPath? {
+        guard let row = rowIndex.append(peerId: peer.peerId ?? "", peerIdentifier: peer.peerIdentifier ?? "") else { return nil }
+
+        peers.append(peer)
+
+        return IndexPath(row: row, section: 0)
+    }
+
+    /// Removes the given peers and returns the index paths they had before, every index path only once
+    public func removePeers(_ peersToRemove: [NCPeerConnection]) -> [IndexPath] {
+        let rows = rowIndex.rows(forPeerIdentifiers: peersToRemove.map { $0.peerIdentifier ?? "" })
+
+        rowIndex.remove(rows: rows)
+
+        for row in rows.reversed() {
+            peers.remove(at: row)
+        }
+
+        return rows.map { IndexPath(row: $0, section: 0) }
+    }
+
+    public func removeAll() {
+        peers.removeAll()
+        rowIndex.removeAll()
+    }
+}
@@ -83,7 +83,7 @@ CGFloat const kCallParticipantCellMinHeight = 128;
 
     _displayName = nil;
     _peerNameLabel.text = nil;
-    [_videoView removeFromSuperview];
+    [[self ownVideoView] removeFromSuperview];
     _videoView = nil;
     _showOriginalSize = NO;
     self.layer.borderWidth = 0.0f;
@@ -276,11 +276,11 @@ CGFloat const kCallParticipantCellMinHeight = 128;
 {
     _videoDisabled = videoDisabled;
     if (videoDisabled) {
-        [_videoView setHidden:YES];
+        [[self ownVideoView] setHidden:YES];
         [_peerAvatarImageView setHidden:NO];
     } else {
         [_peerAvatarImageView setHidden:YES];
-        [_videoView setHidden:NO];
+        [[self ownVideoView] setHidden:NO];
     }
 }
 
@@ -308,7 +308,7 @@ CGFloat const kCallParticipantCellMinHeight = 128;
             return;
         }
 
-        [self->_videoView removeFromSuperview];
+        [[self ownVideoView] removeFromSuperview];
         self->_videoView = nil;
         self->_videoView = videoView;
         [self->_peerVideoView addSubview:self->_videoView];
@@ -342,11 +342,21 @@ CGFloat const kCallParticipantCellMinHeight = 128;
         
         remoteVideoFrame.size.height *= scale;
         remoteVideoFrame.size.width *= scale;
-        _videoView.frame = remoteVideoFrame;
-        _videoView.center = CGPointMake(CGRectGetMidX(bounds), CGRectGetMidY(bounds));
+        [self ownVideoView].frame = remoteVideoFrame;
+        [self ownVideoView].center = CGPointMake(CGRectGetMidX(bounds), CGRectGetMidY(bounds));
     } else {
-        _videoView.frame = bounds;
+        [self ownVideoView].frame = bounds;
     }
 }
 
+- (UIView<RTCVideoRenderer> *)ownVideoView
+{
+    // Video views are reused for other participants, so the last video view might be shown in another cell by now
+    if (_videoView.superview != _peerVideoView) {
+        return nil;
+    }
+
+    return _videoView;
+}
+
 @end
@@ -0,0 +1,75 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Detects whether the local participant is speaking, based on the statistics of the local audio source.
+/// The WebRTC framework doesn't expose the captured PCM frames, but the audio source statistics contain the total energy
+/// and duration of the captured audio, so the RMS since the last report can be fed into the voice activity detector
+/// without running a second capture pipeline.
+/// Needs to be used from the WebRTC queue.
+@objcMembers class CallSpeakingMonitor: NSObject {
+
+    public var speakingChangedBlock: ((_ speaking: Bool) -> Void)?
+
+    private let detector = VoiceActivityDetector()
+    private var lastTotalAudioEnergy: Double?
+    private var lastTotalSamplesDuration: Double?
+
+    public var isSpeaking: Bool {
+        return detector.isSpeaking
+    }
+
+    public func process(statisticsReport report: RTCStatisticsReport) {
+        WebRTCCommon.shared.assertQueue()
+
+        let audioSource = report.statistics.values.first { statistics in
+            statistics.type == "media-source" && (statistics.values["kind"] as? String) == "audio"
+        }
+
+        guard let audioSource,
+              let totalAudioEnergy = (audioSource.values["totalAudioEnergy"] as? NSNumber)?.doubleValue,
+              let totalSamplesDuration = (audioSource.values["totalSamplesDuration"] as? NSNumber)?.doubleValue
+        else { return }
+
+        defer {
+            lastTotalAudioEnergy = totalAudioEnergy
+            lastTotalSamplesDuration = totalSamplesDuration
+        }
+
+        guard let lastTotalAudioEnergy, let lastTotalSamplesDuration, totalSamplesDuration > lastTotalSamplesDuration else { return }
+
+        // The energy is the sum of the squared audio levels multiplied with the duration of each sample
+        let duration = totalSamplesDuration - lastTotalSamplesDuration
+        let rms = (max(totalAudioEnergy - lastTotalAudioEnergy, 0) / duration).squareRoot()
+
+        if let transition = detector.process(rms: Float(rms), zeroCrossingRate: nil, duration: Float(duration)) {
+            speakingChangedBlock?(transition == .startedSpeaking)
+        }
+    }
+
+    public func reset() {
+        detector.reset()
+        lastTotalAudioEnergy = nil
+        lastTotalSamplesDuration = nil
+    }
+}
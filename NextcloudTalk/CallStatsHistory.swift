@@ -0,0 +1,225 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Rates of one RTP stream over the interval between two statistics reports
+struct CallStatsTrackSample: Codable {
+    let id: String
+    let kind: String
+    let direction: String
+    // Bits per second
+    let bitrate: Double?
+    // Packets per second
+    let packetRate: Double?
+    // Lost packets relative to the expected packets of the interval, inbound streams only
+    let packetLoss: Double?
+    // Milliseconds, inbound streams only
+    let jitter: Double?
+    let framesPerSecond: Double?
+}
+
+struct CallStatsSample: Codable {
+    // Seconds since 1970
+    let timestamp: Double
+    let tracks: [CallStatsTrackSample]
+}
+
+/// Keeps the last `capacity` elements, older elements are overwritten
+struct CallStatsRingBuffer<Element> {
+
+    let capacity: Int
+
+    private var storage: [Element] = []
+    private var nextIndex = 0
+
+    init(capacity: Int) {
+        self.capacity = max(capacity, 1)
+        storage.reserveCapacity(self.capacity)
+    }
+
+    var count: Int {
+        return storage.count
+    }
+
+    // Oldest element first
+    var elements: [Element] {
+        if storage.count < capacity {
+            return storage
+        }
+
+        return Array(storage[nextIndex...] + storage[..<nextIndex])
+    }
+
+    mutating func append(_ element: Element) {
+        if storage.count < capacity {
+            storage.append(element)
+        } else {
+            storage[nextIndex] = element
+        }
+
+        nextIndex = (nextIndex + 1) % capacity
+    }
+}
+
+/// Computes rates from the cumulative counters of consecutive statistics reports of one peer connection.
+/// Reports are plain dictionaries (statistics id -> values, including "type" and "timestamp" in milliseconds),
+/// so they can be created from WebRTC reports or from recorded JSON.
+class CallStatsRateCalculator {
+
+    private struct Counters {
+        let timestamp: Double
+        let bytes: Double
+        let packets: Double
+        let packetsLost: Double
+    }
+
+    private var previousCounters: [String: Counters] = [:]
+
+    func sample(from report: [String: [String: Any]], timestamp: Double) -> CallStatsSample {
+        var tracks: [CallStatsTrackSample] = []
+        var currentCounters: [String: Counters] = [:]
+
+        for (id, values) in report {
+            guard let type = values["type"] as? String, type == "inbound-rtp" || type == "outbound-rtp" else { continue }
+
+            let isInbound = type == "inbound-rtp"
+            let bytes = CallStatsRateCalculator.number(values[isInbound ? "bytesReceived" : "bytesSent"]) ?? 0
+            let packets = CallStatsRateCalculator.number(values[isInbound ? "packetsReceived" : "packetsSent"]) ?? 0
+            let packetsLost = CallStatsRateCalculator.number(values["packetsLost"]) ?? 0
+            let counters = Counters(timestamp: CallStatsRateCalculator.number(values["timestamp"]) ?? timestamp * 1000,
+                                    bytes: bytes, packets: packets, packetsLost: packetsLost)
+
+            currentCounters[id] = counters
+
+            var bitrate: Double?
+            var packetRate: Double?
+            var packetLoss: Double?
+
+            // Without previous counters no rates can be computed
+            if let previous = previousCounters[id], counters.timestamp > previous.timestamp {
+                // Counters that were reset (e.g. a renegotiation) would result in negative rates, they are clamped to 0
+                let interval = (counters.timestamp - previous.timestamp) / 1000
+                let bytesDelta = max(counters.bytes - previous.bytes, 0)
+                let packetsDelta = max(counters.packets - previous.packets, 0)
+
+                bitrate = bytesDelta * 8 / interval
+                packetRate = packetsDelta / interval
+
+                if isInbound {
+                    // Lost packets can also decrease when late packets arrive
+                    let lost = max(counters.packetsLost - previous.packetsLost, 0)
+                    let expected = lost + packetsDelta
+                    packetLoss = expected > 0 ? lost / expected : 0
+                }
+            }
+
+            let jitter = isInbound ? CallStatsRateCalculator.number(values["jitter"]).map { $0 * 1000 } : nil
+
+            tracks.append(CallStatsTrackSample(id: id,
+                                               kind: values["kind"] as? String ?? "",
+                                               direction: isInbound ? "inbound" : "outbound",
+                                               bitrate: bitrate,
+                                               packetRate: packetRate,
+                                               packetLoss: packetLoss,
+                                               jitter: jitter,
+                                               framesPerSecond: CallStatsRateCalculator.number(values["framesPerSecond"])))
+        }
+
+        // Streams that are not part of the report anymore are forgotten
+        previousCounters = currentCounters
+
+        return CallStatsSample(timestamp: timestamp, tracks: tracks.sorted { $0.id < $1.id })
+    }
+
+    class func number(_ value: Any?) -> Double? {
+        if let value = value as? NSNumber {
+            return value.doubleValue
+        } else if let value = value as? Double {
+            return value
+        } else if let value = value as? Int {
+            return Double(value)
+        }
+
+        return nil
+    }
+}
+
+/// Bounded history of call statistics samples per peer: at most `samplesPerPeer` samples for at most `maxPeers` peers,
+/// the peer that wasn't updated for the longest time is dropped first. Not thread safe.
+class CallStatsHistory {
+
+    private class PeerHistory {
+        let calculator = CallStatsRateCalculator()
+        var samples: CallStatsRingBuffer<CallStatsSample>
+        var lastUpdate: Double = 0
+
+        init(capacity: Int) {
+            samples = CallStatsRingBuffer(capacity: capacity)
+        }
+    }
+
+    let samplesPerPeer: Int
+    let maxPeers: Int
+
+    private var peers: [String: PeerHistory] = [:]
+
+    init(samplesPerPeer: Int, maxPeers: Int) {
+        self.samplesPerPeer = samplesPerPeer
+        self.maxPeers = max(maxPeers, 1)
+    }
+
+    var numberOfPeers: Int {
+        return peers.count
+    }
+
+    var numberOfSamples: Int {
+        return peers.values.reduce(0) { $0 + $1.samples.count }
+    }
+
+    func add(report: [String: [String: Any]], forPeer peerId: String, timestamp: Double) {
+        let peer = peers[peerId] ?? PeerHistory(capacity: samplesPerPeer)
+
+        peer.samples.append(peer.calculator.sample(from: report, timestamp: timestamp))
+        peer.lastUpdate = timestamp
+        peers[peerId] = peer
+
+        while peers.count > maxPeers, let oldestPeer = peers.min(by: { $0.value.lastUpdate < $1.value.lastUpdate }) {
+            peers.removeValue(forKey: oldestPeer.key)
+        }
+    }
+
+    func removeAll() {
+        peers.removeAll()
+    }
+
+    func snapshot() -> [String: [CallStatsSample]] {
+        return peers.mapValues { $0.samples.elements }
+    }
+
+    func jsonData() -> Data? {
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+
+        return try? encoder.encode(self.snapshot())
+    }
+}
@@ -0,0 +1,120 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Polls the statistics of all peer connections of the running call and keeps a bounded history per peer,
+/// which can be exported from the diagnostics. The history of the last call is kept until the next call starts.
+@objcMembers class CallStatsSampler: NSObject {
+
+    public static let shared = CallStatsSampler()
+
+    public var interval: TimeInterval = 5
+
+    // With the default interval one hour per peer
+    private let history = CallStatsHistory(samplesPerPeer: 720, maxPeers: 32)
+    private var timer: Timer?
+    private var peerConnectionsBlock: (() -> [String: NCPeerConnection])?
+
+    // MARK: - Sampling
+
+    /// Starts sampling, the block returns the peer connections by peer key and is called on the WebRTC queue
+    public func startSampling(peerConnectionsBlock: @escaping () -> [String: NCPeerConnection]) {
+        WebRTCCommon.shared.dispatch {
+            self.history.removeAll()
+            self.peerConnectionsBlock = peerConnectionsBlock
+        }
+
+        DispatchQueue.main.async {
+            self.timer?.invalidate()
+            self.timer = Timer.scheduledTimer(withTimeInterval: self.interval, repeats: true) { [weak self] _ in
+                self?.sample()
+            }
+        }
+    }
+
+    public func stopSampling() {
+        DispatchQueue.main.async {
+            self.timer?.invalidate()
+            self.timer = nil
+        }
+
+        WebRTCCommon.shared.dispatch {
+            self.peerConnectionsBlock = nil
+        }
+    }
+
+    private func sample() {
+        WebRTCCommon.shared.dispatch {
+            guard let peerConnections = self.peerConnectionsBlock?() else { return }
+
+            for (peerKey, peerConnectionWrapper) in peerConnections {
+                peerConnectionWrapper.peerConnection?.statistics { report in
+                    WebRTCCommon.shared.dispatch {
+                        // The call might have ended in the meantime
+                        guard self.peerConnectionsBlock != nil else { return }
+
+                        self.history.add(report: CallStatsSampler.plainReport(from: report), forPeer: peerKey, timestamp: report.timestamp_us / 1_000_000)
+                    }
+                }
+            }
+        }
+    }
+
+    class func plainReport(from report: RTCStatisticsReport) -> [String: [String: Any]] {
+        var plainReport: [String: [String: Any]] = [:]
+
+        for (id, statistics) in report.statistics {
+            var values: [String: Any] = statistics.values
+            values["type"] = statistics.type
+            values["timestamp"] = statistics.timestamp_us / 1000
+            plainReport[id] = values
+        }
+
+        return plainReport
+    }
+
+    // MARK: - Export
+
+    /// Number of peers and samples in the history, the completion block is called on the main queue
+    public func summary(completionBlock: @escaping (_ numberOfPeers: Int, _ numberOfSamples: Int) -> Void) {
+        WebRTCCommon.shared.dispatch {
+            let numberOfPeers = self.history.numberOfPeers
+            let numberOfSamples = self.history.numberOfSamples
+
+            DispatchQueue.main.async {
+                completionBlock(numberOfPeers, numberOfSamples)
+            }
+        }
+    }
+
+    /// History as JSON (peer key -> samples), the completion block is called on the main queue
+    public func exportJSON(completionBlock: @escaping (_ data: Data?) -> Void) {
+        WebRTCCommon.shared.dispatch {
+            let data = self.history.jsonData()
+
+            DispatchQueue.main.async {
+                completionBlock(data)
+            }
+        }
+    }
+}
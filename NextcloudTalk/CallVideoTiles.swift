@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+@objc protocol CallVideoTilesDelegate: AnyObject {
+    func callVideoTiles(_ videoTiles: CallVideoTiles, attachRenderer renderer: Int, toPeer peerIdentifier: String)
+    func callVideoTiles(_ videoTiles: CallVideoTiles, detachRenderer renderer: Int, fromPeer peerIdentifier: String)
+    func callVideoTiles(_ videoTiles: CallVideoTiles, discardRenderer renderer: Int)
+    func callVideoTiles(_ videoTiles: CallVideoTiles, setVideoPaused paused: Bool, ofPeer peerIdentifier: String)
+}
+
+/// Passes the actions of a VideoTileVisibilityController to its delegate. Needs to be used from the main thread.
+@objcMembers class CallVideoTiles: NSObject {
+
+    public weak var delegate: CallVideoTilesDelegate?
+
+    private let visibilityController = VideoTileVisibilityController()
+
+    public var pausesHiddenPeers: Bool {
+        get { return visibilityController.pausesHiddenPeers }
+        set { visibilityController.pausesHiddenPeers = newValue }
+    }
+
+    public func addVideoPeer(_ peerIdentifier: String) {
+        self.apply(visibilityController.addVideoPeer(peerIdentifier))
+    }
+
+    public func removeVideoPeer(_ peerIdentifier: String) {
+        self.apply(visibilityController.removeVideoPeer(peerIdentifier))
+    }
+
+    public func replaceVideoPeer(_ peerIdentifier: String) {
+        self.apply(visibilityController.replaceVideoPeer(peerIdentifier))
+    }
+
+    public func updateVisiblePeers(_ peerIdentifiers: Set<String>) {
+        self.apply(visibilityController.updateVisiblePeers(peerIdentifiers))
+    }
+
+    public func removeAll() {
+        self.apply(visibilityController.removeAll())
+    }
+
+    private func apply(_ actions: [VideoTileAction]) {
+        guard let delegate else { return }
+
+        for action in actions {
+            switch action {
+            case .attach(let peerIdentifier, let renderer):
+                delegate.callVideoTiles(self, attachRenderer: renderer, toPeer: peerIdentifier)
+            case .detach(let peerIdentifier, let renderer):
+                delegate.callVideoTiles(self, detachRenderer: renderer, fromPeer: peerIdentifier)
+            case .discard(let renderer):
+                delegate.callVideoTiles(self, discardRenderer: renderer)
+            case .pauseVideo(let peerIdentifier):
+                delegate.callVideoTiles(self, setVideoPaused: true, ofPeer: peerIdentifier)
+            case .resumeVideo(let peerIdentifier):
+                delegate.callVideoTiles(self, setVideoPaused: false, ofPeer: peerIdentifier)
+            }
+        }
+    }
+}
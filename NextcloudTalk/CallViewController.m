@@ -71,12 +71,17 @@ typedef void (^UpdateCallParticipantViewCellBlock)(CallParticipantViewCell *cell
 @implementation PendingCellUpdate
 @end
 
-@interface CallViewController () <NCCallControllerDelegate, UICollectionViewDelegate, UICollectionViewDelegateFlowLayout, UICollectionViewDataSource, RTCVideoViewDelegate, CallParticipantViewCellDelegate, UIGestureRecognizerDelegate, NCChatTitleViewDelegate>
+@interface CallViewController () <NCCallControllerDelegate, UICollectionViewDelegate, UICollectionViewDelegateFlowLayout, UICollectionViewDataSource, RTCVideoViewDelegate, CallParticipantViewCellDelegate, UIGestureRecognizerDelegate, NCChatTitleViewDelegate, CallVideoTilesDelegate>
 {
     CallState _callState;
-    NSMutableArray *_peersInCall;
+    CallParticipantList *_peersInCall;
     NSMutableArray *_screenPeersInCall;
     NSMutableDictionary *_videoRenderersDict; // peerIdentifier -> renderer
+    NSMutableDictionary *_videoRenderersPool; // renderer number -> renderer
+    NSMutableDictionary *_videoRendererTracks; // renderer number -> video track it was added to, only used on the WebRTC queue
+    NSMutableDictionary *_videoPeersDict; // peerIdentifier -> peer with video
+    NSMutableSet *_visiblePeerIdentifiers;
+    CallVideoTiles *_videoTiles;
     NSMutableDictionary *_screenRenderersDict; // peerId -> renderer
     NCCallController *_callController;
     NCChatViewController *_chatViewController;
@@ -147,12 +152,21 @@ typedef void (^UpdateCallParticipantViewCellBlock)(CallParticipantViewCell *cell
     
     self.modalPresentationStyle = UIModalPresentationFullScreen;
     
-    _room = room;
+    // Rooms returned by the rooms manager are shared snapshots, we need our own copy as we modify it
+    _room = [[NCRoom alloc] initWithValue:room];
     _displayName = displayName;
     _isAudioOnly = audioOnly;
-    _peersInCall = [[NSMutableArray alloc] init];
+    _peersInCall = [[CallParticipantList alloc] init];
     _screenPeersInCall = [[NSMutableArray alloc] init];
     _videoRenderersDict = [[NSMutableDictionary alloc] init];
+    _videoRenderersPool = [[NSMutableDictionary alloc] init];
+    _videoRendererTracks = [[NSMutableDictionary alloc] init];
+    _videoPeersDict = [[NSMutableDictionary alloc] init];
+    _visiblePeerIdentifiers = [[NSMutableSet alloc] init];
+    _videoTiles = [[CallVideoTiles alloc] init];
+    _videoTiles.delegate = self;
+    // Only has an effect with MCU, see NCCallController
+    _videoTiles.pausesHiddenPeers = YES;
     _screenRenderersDict = [[NSMutableDictionary alloc] init];
     _buttonFeedbackGenerator = [[UIImpactFeedbackGenerator alloc] initWithStyle:(UIImpactFeedbackStyleLight)];
     _pendingPeerInserts = [[NSMutableArray alloc] init];
@@ -1412,15 +1426,9 @@ typedef void (^UpdateCallParticipantViewCellBlock)(CallParticipantViewCell *cell
         [_localVideoView setHidden:YES];
 
         dispatch_async(dispatch_get_main_queue(), ^{
-            for (NCPeerConnection *peerConnection in self->_peersInCall) {
-                // Video renderers
-                RTCMTLVideoView *videoRenderer = [self->_videoRenderersDict objectForKey:peerConnection.peerIdentifier];
-                [self->_videoRenderersDict removeObjectForKey:peerConnection.peerIdentifier];
-
-                [[WebRTCCommon shared] dispatch:^{
-                    [[peerConnection.remoteStream.videoTracks firstObject] removeRenderer:videoRenderer];
-                }];
-            }
+            // Video renderers
+            [self->_videoTiles removeAll];
+            [self->_videoPeersDict removeAllObjects];
 
             for (NCPeerConnection *peerConnection in self->_screenPeersInCall) {
                 // Screen renderers
@@ -1845,7 +1853,7 @@ typedef void (^UpdateCallParticipantViewCellBlock)(CallParticipantViewCell *cell
 - (UICollectionViewCell *)collectionView:(UICollectionView *)collectionView cellForItemAtIndexPath:(NSIndexPath *)indexPath
 {
     CallParticipantViewCell *cell = (CallParticipantViewCell *)[collectionView dequeueReusableCellWithReuseIdentifier:kCallParticipantCellIdentifier forIndexPath:indexPath];
-    NCPeerConnection *peerConnection = [_peersInCall objectAtIndex:indexPath.row];
+    NCPeerConnection *peerConnection = [_peersInCall peerAtRow:indexPath.row];
     cell.peerIdentifier = peerConnection.peerIdentifier;
     cell.actionsDelegate = self;
         
@@ -1855,11 +1863,88 @@ typedef void (^UpdateCallParticipantViewCellBlock)(CallParticipantViewCell *cell
 -(void)collectionView:(UICollectionView *)collectionView willDisplayCell:(UICollectionViewCell *)cell forItemAtIndexPath:(NSIndexPath *)indexPath
 {
     CallParticipantViewCell *participantCell = (CallParticipantViewCell *)cell;
-    NCPeerConnection *peerConnection = [_peersInCall objectAtIndex:indexPath.row];
+    NCPeerConnection *peerConnection = [_peersInCall peerAtRow:indexPath.row];
+
+    // Attach a renderer before the cell is updated, so the cell shows it right away
+    if (peerConnection.peerIdentifier) {
+        [_visiblePeerIdentifiers addObject:peerConnection.peerIdentifier];
+        [_videoTiles updateVisiblePeers:_visiblePeerIdentifiers];
+    }
     
     [self updateParticipantCell:participantCell withPeerConnection:peerConnection];
 }
 
+- (void)collectionView:(UICollectionView *)collectionView didEndDisplayingCell:(UICollectionViewCell *)cell forItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    // The index path might already be outdated after a batch update, so we use the peer of the cell
+    CallParticipantViewCell *participantCell = (CallParticipantViewCell *)cell;
+
+    if (participantCell.peerIdentifier) {
+        [_visiblePeerIdentifiers removeObject:participantCell.peerIdentifier];
+        [_videoTiles updateVisiblePeers:_visiblePeerIdentifiers];
+    }
+}
+
+#pragma mark - CallVideoTilesDelegate
+
+- (void)callVideoTiles:(CallVideoTiles *)videoTiles attachRenderer:(NSInteger)renderer toPeer:(NSString *)peerIdentifier
+{
+    NCPeerConnection *peer = [_videoPeersDict objectForKey:peerIdentifier];
+    RTCMTLVideoView *renderView = [_videoRenderersPool objectForKey:@(renderer)];
+
+    if (!renderView) {
+        renderView = [[RTCMTLVideoView alloc] initWithFrame:CGRectZero];
+        renderView.delegate = self;
+        [_videoRenderersPool setObject:renderView forKey:@(renderer)];
+    }
+
+    [_videoRenderersDict setObject:renderView forKey:peerIdentifier];
+
+    [[WebRTCCommon shared] dispatch:^{
+        RTCVideoTrack *videoTrack = [peer.remoteStream.videoTracks firstObject];
+
+        if (videoTrack) {
+            [videoTrack addRenderer:renderView];
+            [self->_videoRendererTracks setObject:videoTrack forKey:@(renderer)];
+        }
+    }];
+
+    NSIndexPath *indexPath = [self indexPathForPeerIdentifier:peerIdentifier];
+    if (indexPath) {
+        CallParticipantViewCell *cell = (id)[self.collectionView cellForItemAtIndexPath:indexPath];
+        [cell setVideoView:renderView];
+    }
+}
+
+- (void)callVideoTiles:(CallVideoTiles *)videoTiles detachRenderer:(NSInteger)renderer fromPeer:(NSString *)peerIdentifier
+{
+    RTCMTLVideoView *renderView = [_videoRenderersDict objectForKey:peerIdentifier];
+    [_videoRenderersDict removeObjectForKey:peerIdentifier];
+
+    // The peer might already send a new stream, so the renderer is removed from the track it was added to
+    [[WebRTCCommon shared] dispatch:^{
+        RTCVideoTrack *videoTrack = [self->_videoRendererTracks objectForKey:@(renderer)];
+        [self->_videoRendererTracks removeObjectForKey:@(renderer)];
+
+        [videoTrack removeRenderer:renderView];
+    }];
+}
+
+- (void)callVideoTiles:(CallVideoTiles *)videoTiles discardRenderer:(NSInteger)renderer
+{
+    RTCMTLVideoView *renderView = [_videoRenderersPool objectForKey:@(renderer)];
+    [_videoRenderersPool removeObjectForKey:@(renderer)];
+    [renderView removeFromSuperview];
+}
+
+- (void)callVideoTiles:(CallVideoTiles *)videoTiles setVideoPaused:(BOOL)paused ofPeer:(NSString *)peerIdentifier
+{
+    NCPeerConnection *peer = [_videoPeersDict objectForKey:peerIdentifier];
+    if (peer) {
+        [_callController setVideoPaused:paused ofPeer:peer];
+    }
+}
+
 #pragma mark - Call Controller delegate
 
 - (void)callControllerDidJoinCall:(NCCallController *)callController
@@ -1937,16 +2022,12 @@ typedef void (^UpdateCallParticipantViewCellBlock)(CallParticipantViewCell *cell
     [[WebRTCCommon shared] assertQueue];
 
     dispatch_async(dispatch_get_main_queue(), ^{
-        RTCMTLVideoView *renderView = [[RTCMTLVideoView alloc] initWithFrame:CGRectZero];
-
-        [[WebRTCCommon shared] dispatch:^{
-            RTCVideoTrack *remoteVideoTrack = [remotePeer.remoteStream.videoTracks firstObject];
-            renderView.delegate = self;
-            [remoteVideoTrack addRenderer:renderView];
-        }];
-
         if ([remotePeer.roomType isEqualToString:kRoomTypeVideo]) {
-            [self->_videoRenderersDict setObject:renderView forKey:remotePeer.peerIdentifier];
+            // Renderers are only attached while the cell of the peer is visible
+            // A renderer attached to a previous stream of the peer needs to be attached again
+            [self->_videoPeersDict setObject:remotePeer forKey:remotePeer.peerIdentifier];
+            [self->_videoTiles replaceVideoPeer:remotePeer.peerIdentifier];
+
             NSIndexPath *indexPath = [self indexPathForPeerIdentifier:remotePeer.peerIdentifier];
 
             if (!indexPath) {
@@ -1959,11 +2040,19 @@ typedef void (^UpdateCallParticipantViewCellBlock)(CallParticipantViewCell *cell
                 BOOL isVideoDisabled = (self->_isAudioOnly || remotePeer.isRemoteVideoDisabled);
 
                 [self updatePeer:remotePeer block:^(CallParticipantViewCell *cell) {
-                    [cell setVideoView:renderView];
+                    [cell setVideoView:[self->_videoRenderersDict objectForKey:remotePeer.peerIdentifier]];
                     [cell setVideoDisabled:isVideoDisabled];
                 }];
             }
         } else if ([remotePeer.roomType isEqualToString:kRoomTypeScreen]) {
+            RTCMTLVideoView *renderView = [[RTCMTLVideoView alloc] initWithFrame:CGRectZero];
+
+            [[WebRTCCommon shared] dispatch:^{
+                RTCVideoTrack *remoteVideoTrack = [remotePeer.remoteStream.videoTracks firstObject];
+                renderView.delegate = self;
+                [remoteVideoTrack addRenderer:renderView];
+            }];
+
             [self->_screenRenderersDict setObject:renderView forKey:remotePeer.peerId];
             [self->_screenPeersInCall addObject:remotePeer];
             [self showScreenOfPeerId:remotePeer.peerId];
@@ -2027,6 +2116,11 @@ typedef void (^UpdateCallParticipantViewCellBlock)(CallParticipantViewCell *cell
 
 - (void)callController:(NCCallController *)callController didReceiveNick:(NSString *)nick fromPeer:(NCPeerConnection *)peer
 {
+    // The cell is colored by the display name, calculate the color before the cell is updated
+    if (nick.length > 0) {
+        [[ColorGenerator shared] warmUpWithUsernames:@[nick]];
+    }
+
     [self updatePeer:peer block:^(CallParticipantViewCell *cell) {
         [cell setDisplayName:nick];
     }];
@@ -2231,28 +2325,12 @@ typedef void (^UpdateCallParticipantViewCellBlock)(CallParticipantViewCell *cell
 
 - (NSIndexPath *)indexPathForPeerIdentifier:(NSString *)peerIdentifier
 {
-    NSIndexPath *indexPath = nil;
-    for (int i = 0; i < _peersInCall.count; i ++) {
-        NCPeerConnection *peer = [_peersInCall objectAtIndex:i];
-        if ([peer.peerIdentifier isEqualToString:peerIdentifier]) {
-            indexPath = [NSIndexPath indexPathForRow:i inSection:0];
-        }
-    }
-    
-    return indexPath;
+    return [_peersInCall indexPathForPeerIdentifier:peerIdentifier];
 }
 
 - (NSIndexPath *)indexPathForPeerId:(NSString *)peerId
 {
-    NSIndexPath *indexPath = nil;
-    for (int i = 0; i < _peersInCall.count; i ++) {
-        NCPeerConnection *peer = [_peersInCall objectAtIndex:i];
-        if ([peer.peerId isEqualToString:peerId]) {
-            indexPath = [NSIndexPath indexPathForRow:i inSection:0];
-        }
-    }
-
-    return indexPath;
+    return [_peersInCall indexPathForPeerId:peerId];
 }
 
 - (void)updatePeer:(NCPeerConnection *)peer block:(UpdateCallParticipantViewCellBlock)block
@@ -2275,10 +2353,9 @@ typedef void (^UpdateCallParticipantViewCellBlock)(CallParticipantViewCell *cell
 }
 
 - (NCPeerConnection *)peerConnectionForPeerIdentifier:(NSString *)peerIdentifier {
-    for (NCPeerConnection *peerConnection in self->_peersInCall) {
-        if ([peerConnection.peerIdentifier isEqualToString:peerIdentifier]) {
-            return peerConnection;
-        }
+    NCPeerConnection *peer = [self->_peersInCall peerForPeerIdentifier:peerIdentifier];
+    if (peer) {
+        return peer;
     }
 
     for (NCPeerConnection *peerConnection in self->_screenPeersInCall) {
@@ -2291,13 +2368,7 @@ typedef void (^UpdateCallParticipantViewCellBlock)(CallParticipantViewCell *cell
 }
 
 - (NCPeerConnection *)peerConnectionForPeerId:(NSString *)peerId {
-    for (NCPeerConnection *peerConnection in self->_peersInCall) {
-        if ([peerConnection.peerId isEqualToString:peerId]) {
-            return peerConnection;
-        }
-    }
-
-    return nil;
+    return [self->_peersInCall peerForPeerId:peerId];
 }
 
 - (NCPeerConnection *)screenPeerConnectionForPeerId:(NSString *)peerId {
@@ -2345,9 +2416,10 @@ typedef void (^UpdateCallParticipantViewCellBlock)(CallParticipantViewCell *cell
         if (self->_peersInCall.count == 0) {
             // Don't delay adding the first peer
 
-            [self->_peersInCall addObject:peer];
-            NSIndexPath *insertionIndexPath = [NSIndexPath indexPathForRow:0 inSection:0];
-            [self.collectionView insertItemsAtIndexPaths:@[insertionIndexPath]];
+            NSIndexPath *insertionIndexPath = [self->_peersInCall addPeer:peer];
+            if (insertionIndexPath) {
+                [self.collectionView insertItemsAtIndexPaths:@[insertionIndexPath]];
+            }
         } else {
             // Delay updating the collection view a bit to allow batch updating
 
@@ -2390,44 +2462,26 @@ typedef void (^UpdateCallParticipantViewCellBlock)(CallParticipantViewCell *cell
 
     [_collectionView performBatchUpdates:^{
         // Perform deletes before inserts according to apples docs
-        NSMutableArray *indexPathsToDelete = [[NSMutableArray alloc] init];
-
-        // Determine all indexPaths we want to delete and remove the renderers
+        // Remove the renderers of the deleted peers
         for (NCPeerConnection *peer in _pendingPeerDeletions) {
             // Video renderers
-            RTCMTLVideoView *videoRenderer = [self->_videoRenderersDict objectForKey:peer.peerIdentifier];
-            [self->_videoRenderersDict removeObjectForKey:peer.peerIdentifier];
-
-            [[WebRTCCommon shared] dispatch:^{
-                [[peer.remoteStream.videoTracks firstObject] removeRenderer:videoRenderer];
-            }];
+            [self->_videoTiles removeVideoPeer:peer.peerIdentifier];
+            [self->_videoPeersDict removeObjectForKey:peer.peerIdentifier];
 
             // Screen renderers
             [self removeScreensharingOfPeer:peer];
-
-            NSIndexPath *indexPath = [self indexPathForPeerIdentifier:peer.peerIdentifier];
-
-            // Make sure we remove every index path only once
-            if (indexPath && ![indexPathsToDelete containsObject:indexPath]) {
-                [indexPathsToDelete addObject:indexPath];
-            }
         }
 
-        // Deletes should be done in descending order
-        NSSortDescriptor *rowSortDescending = [[NSSortDescriptor alloc] initWithKey:@"row" ascending:NO];
-        NSArray *indexPathsToDeleteSorted = [indexPathsToDelete sortedArrayUsingDescriptors:@[rowSortDescending]];
-
-        for (NSIndexPath *indexPath in indexPathsToDeleteSorted) {
-            [self->_peersInCall removeObjectAtIndex:indexPath.row];
-            [_collectionView deleteItemsAtIndexPaths:@[indexPath]];
+        // Index paths of the deleted peers before the update, every index path only once
+        NSArray *indexPathsToDelete = [self->_peersInCall removePeers:_pendingPeerDeletions];
+        if (indexPathsToDelete.count > 0) {
+            [_collectionView deleteItemsAtIndexPaths:indexPathsToDelete];
         }
 
         // Add all new peers
         for (NCPeerConnection *peer in _pendingPeerInserts) {
-            NSIndexPath *indexPath = [self indexPathForPeerIdentifier:peer.peerIdentifier];
-            if (!indexPath) {
-                [self->_peersInCall addObject:peer];
-                NSIndexPath *insertionIndexPath = [NSIndexPath indexPathForRow:self->_peersInCall.count - 1 inSection:0];
+            NSIndexPath *insertionIndexPath = [self->_peersInCall addPeer:peer];
+            if (insertionIndexPath) {
                 [self.collectionView insertItemsAtIndexPaths:@[insertionIndexPath]];
             }
         }
@@ -0,0 +1,199 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+struct CaptureFormat: Equatable {
+    let width: Int32
+    let height: Int32
+    let fps: Double
+}
+
+/// Mirrors ProcessInfo.ThermalState, so the governor doesn't depend on the platform
+enum CaptureThermalState: Int {
+    case nominal
+    case fair
+    case serious
+    case critical
+}
+
+struct CaptureLoadObservation {
+    // Seconds, monotonic
+    let timestamp: TimeInterval
+    let thermalState: CaptureThermalState
+    // Captured frames that were not encoded, relative to the captured frames
+    let droppedFrameRatio: Double
+    let subscriberCount: Int
+}
+
+/// Steps the capture format up or down a ladder of formats, based on the thermal state, the frames dropped by the encoder
+/// and the number of subscribers. Formats are changed at most once per `minimumDwellTime`, and a higher format is only
+/// chosen again after the conditions allowed it for `upgradeDelay`, so the format doesn't oscillate.
+/// Doesn't depend on AVFoundation or the clock, observations need to be passed in with increasing timestamps.
+class CaptureFormatGovernor {
+
+    // Highest format first
+    let ladder: [CaptureFormat]
+
+    var minimumDwellTime: TimeInterval = 10
+    var upgradeDelay: TimeInterval = 30
+    var downgradeDropRatio = 0.2
+    var upgradeDropRatio = 0.05
+    // Every additional group of subscribers lowers the highest allowed format by one step
+    var subscribersPerStep = 4
+
+    private(set) var currentIndex = 0
+    private var lastChangeTimestamp: TimeInterval?
+    private var lastObservationTimestamp: TimeInterval?
+    private var upgradeAllowedSince: TimeInterval?
+
+    var currentFormat: CaptureFormat {
+        return ladder[currentIndex]
+    }
+
+    init(ladder: [CaptureFormat]) {
+        precondition(!ladder.isEmpty, "The ladder needs at least one format")
+        self.ladder = ladder
+    }
+
+    /// Returns the new format when the format should be changed, nil otherwise
+    func observe(_ observation: CaptureLoadObservation) -> CaptureFormat? {
+        if let lastObservationTimestamp, observation.timestamp < lastObservationTimestamp {
+            return nil
+        }
+
+        lastObservationTimestamp = observation.timestamp
+
+        let lowestIndex = ladder.count - 1
+        let highestAllowedIndex = min(max(self.thermalLimit(for: observation.thermalState), self.subscriberLimit(for: observation.subscriberCount)), lowestIndex)
+        var targetIndex = currentIndex
+
+        if currentIndex < highestAllowedIndex {
+            // Above the limit, go straight down to it
+            targetIndex = highestAllowedIndex
+            upgradeAllowedSince = nil
+        } else if observation.droppedFrameRatio >= downgradeDropRatio {
+            targetIndex = min(currentIndex + 1, lowestIndex)
+            upgradeAllowedSince = nil
+        } else if currentIndex > highestAllowedIndex, observation.droppedFrameRatio <= upgradeDropRatio, observation.thermalState == .nominal {
+            let allowedSince = upgradeAllowedSince ?? observation.timestamp
+            upgradeAllowedSince = allowedSince
+
+            if observation.timestamp - allowedSince >= upgradeDelay {
+                targetIndex = currentIndex - 1
+            }
+        } else {
+            upgradeAllowedSince = nil
+        }
+
+        guard targetIndex != currentIndex else { return nil }
+
+        if let lastChangeTimestamp, observation.timestamp - lastChangeTimestamp < minimumDwellTime {
+            return nil
+        }
+
+        currentIndex = targetIndex
+        lastChangeTimestamp = observation.timestamp
+        upgradeAllowedSince = nil
+
+        return ladder[currentIndex]
+    }
+
+    private func thermalLimit(for thermalState: CaptureThermalState) -> Int {
+        switch thermalState {
+        case .nominal, .fair:
+            return 0
+        case .serious:
+            return ladder.count / 2
+        case .critical:
+            return ladder.count - 1
+        }
+    }
+
+    private func subscriberLimit(for subscriberCount: Int) -> Int {
+        guard subscriberCount > 0 else { return 0 }
+
+        return (subscriberCount - 1) / max(subscribersPerStep, 1)
+    }
+
+    // MARK: - Ladder
+
+    private static let ladderDimensions: [(width: Int32, height: Int32)] = [(1280, 720), (960, 540), (640, 480), (480, 360), (320, 240)]
+
+    /// Ladder starting at the given format, followed by the smaller standard resolutions and the smallest one at a reduced frame rate
+    class func ladder(maxWidth: Int32, maxHeight: Int32, maxFps: Double, minFps: Double = 15) -> [CaptureFormat] {
+        var ladder = [CaptureFormat(width: maxWidth, height: maxHeight, fps: maxFps)]
+
+        for dimension in ladderDimensions where Int(dimension.width) * Int(dimension.height) < Int(maxWidth) * Int(maxHeight) {
+            ladder.append(CaptureFormat(width: dimension.width, height: dimension.height, fps: maxFps))
+        }
+
+        if let smallestFormat = ladder.last, minFps < maxFps {
+            ladder.append(CaptureFormat(width: smallestFormat.width, height: smallestFormat.height, fps: minFps))
+        }
+
+        return ladder
+    }
+}
+
+/// Computes the ratio of captured frames that were not encoded from consecutive statistics reports of the video sender.
+/// Reports are plain dictionaries (statistics id -> values, including "type"), see CallStatsRateCalculator.
+class EncoderFrameDropCounter {
+
+    private var previousCapturedFrames: Double?
+    private var previousEncodedFrames: Double?
+
+    func droppedFrameRatio(from report: [String: [String: Any]]) -> Double {
+        var capturedFrames = 0.0
+        var encodedFrames = 0.0
+
+        for values in report.values {
+            let type = values["type"] as? String
+
+            if type == "media-source", values["kind"] as? String == "video" {
+                capturedFrames += CallStatsRateCalculator.number(values["frames"]) ?? 0
+            } else if type == "outbound-rtp", values["kind"] as? String == "video" {
+                encodedFrames += CallStatsRateCalculator.number(values["framesEncoded"]) ?? 0
+            }
+        }
+
+        defer {
+            previousCapturedFrames = capturedFrames
+            previousEncodedFrames = encodedFrames
+        }
+
+        guard let previousCapturedFrames, let previousEncodedFrames else { return 0 }
+
+        let capturedDelta = capturedFrames - previousCapturedFrames
+        let encodedDelta = encodedFrames - previousEncodedFrames
+
+        // Counters were reset (e.g. renegotiation) or nothing was captured
+        guard capturedDelta > 0, encodedDelta >= 0 else { return 0 }
+
+        return min(max(1 - encodedDelta / capturedDelta, 0), 1)
+    }
+
+    func reset() {
+        previousCapturedFrames = nil
+        previousEncodedFrames = nil
+    }
+}
@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Eviction policy of the chat file cache. Files are evicted in least recently used order until the cache fits into
+/// its size limit again. Files that are in use (e.g. shown in a preview or played) hold a lease and are skipped. Thread safe.
+final class ChatFileCachePolicy {
+
+    struct Entry: Equatable {
+        let filePath: String
+        let size: Int64
+    }
+
+    private let lock = NSLock()
+    private var leaseCounts: [String: Int] = [:]
+
+    // MARK: - Leases
+
+    func acquireLease(forFileAtPath filePath: String) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        leaseCounts[filePath, default: 0] += 1
+    }
+
+    func releaseLease(forFileAtPath filePath: String) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard let leaseCount = leaseCounts[filePath] else { return }
+
+        if leaseCount > 1 {
+            leaseCounts[filePath] = leaseCount - 1
+        } else {
+            leaseCounts.removeValue(forKey: filePath)
+        }
+    }
+
+    func isInUse(fileAtPath filePath: String) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return leaseCounts[filePath] != nil
+    }
+
+    // MARK: - Eviction
+
+    /// Entries need to be sorted by their last access, least recently used first.
+    /// Returns the entries that need to be removed to get the disk usage down to the size limit.
+    func entriesToEvict(from entries: [Entry], diskUsage: Int64, sizeLimit: Int64) -> [Entry] {
+        var diskUsage = diskUsage
+        var entriesToEvict: [Entry] = []
+
+        for entry in entries {
+            if diskUsage <= sizeLimit {
+                break
+            }
+
+            if self.isInUse(fileAtPath: entry.filePath) {
+                continue
+            }
+
+            diskUsage -= entry.size
+            entriesToEvict.append(entry)
+        }
+
+        return entriesToEvict
+    }
+}
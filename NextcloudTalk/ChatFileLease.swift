@@ -0,0 +1,49 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Keeps a file of the chat file cache from being evicted for as long as the lease is alive
+@objcMembers class ChatFileLease: NSObject {
+
+    static let cachePolicy = ChatFileCachePolicy()
+
+    public let filePath: String
+
+    public init(filePath: String) {
+        self.filePath = filePath
+        super.init()
+
+        ChatFileLease.cachePolicy.acquireLease(forFileAtPath: filePath)
+    }
+
+    deinit {
+        ChatFileLease.cachePolicy.releaseLease(forFileAtPath: filePath)
+    }
+
+    /// File paths need to be sorted by their last access, least recently used first. Files with a lease are never returned.
+    public class func filePathsToEvict(_ filePaths: [String], withSizes sizes: [NSNumber], diskUsage: Int64, sizeLimit: Int64) -> [String] {
+        let entries = zip(filePaths, sizes).map { ChatFileCachePolicy.Entry(filePath: $0, size: $1.int64Value) }
+
+        return cachePolicy.entriesToEvict(from: entries, diskUsage: diskUsage, sizeLimit: sizeLimit).map { $0.filePath }
+    }
+}
@@ -0,0 +1,273 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+#if canImport(SQLite3)
+import SQLite3
+#else
+import CSQLite
+#endif
+
+struct IndexedChatMessage {
+    let internalId: String
+    let accountId: String
+    let token: String
+    let messageId: Int
+    var actorId = ""
+    var actorType = ""
+    var actorDisplayName = ""
+    var timestamp = 0
+    var expirationTimestamp = 0
+    // Nil when the message should not be found (anymore), e.g. deleted messages
+    var text: String?
+}
+
+struct ChatMessageSearchHit: Equatable {
+    let accountId: String
+    let token: String
+    let messageId: Int
+    let actorId: String
+    let actorType: String
+    let actorDisplayName: String
+    let timestamp: Int
+    let snippet: String
+}
+
+/// Full-text index over chat messages, backed by a SQLite FTS5 table.
+/// Text is tokenized by the unicode61 tokenizer, which folds case and diacritics.
+/// Not thread-safe, needs to be used from a single serial queue.
+final class ChatMessageFullTextIndex {
+
+    var logBlock: ((_ message: String) -> Void)?
+
+    // Nil for an in-memory database
+    private let databaseURL: URL?
+    private var database: OpaquePointer?
+    private var statements: [String: OpaquePointer] = [:]
+    private var isOpen = false
+
+    private let sqliteTransient = unsafeBitCast(-1, to: sqlite3_destructor_type.self)
+
+    init(databaseURL: URL?) {
+        self.databaseURL = databaseURL
+    }
+
+    deinit {
+        for statement in statements.values {
+            sqlite3_finalize(statement)
+        }
+
+        sqlite3_close(database)
+    }
+
+    // MARK: - Indexing
+
+    /// Adds, updates or removes (messages without text) the messages. Returns false if the messages could not be stored, nothing is stored in that case.
+    @discardableResult
+    func store(_ indexedMessages: [IndexedChatMessage]) -> Bool {
+        guard openIfNeeded() else { return false }
+
+        guard !indexedMessages.isEmpty else { return true }
+
+        guard execute("BEGIN TRANSACTION") else { return false }
+
+        var success = true
+
+        for message in indexedMessages where success {
+            guard let text = message.text else {
+                success = execute("DELETE FROM messages_fts WHERE rowid IN (SELECT id FROM messages WHERE internalId = ?)", bindings: [message.internalId]) &&
+                    execute("DELETE FROM messages WHERE internalId = ?", bindings: [message.internalId])
+                continue
+            }
+
+            success = execute("""
+                INSERT INTO messages (internalId, accountId, token, messageId, actorId, actorType, actorDisplayName, timestamp, expirationTimestamp)
+                VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
+                ON CONFLICT(internalId) DO UPDATE SET actorDisplayName = excluded.actorDisplayName, expirationTimestamp = excluded.expirationTimestamp
+                """, bindings: [message.internalId, message.accountId, message.token, message.messageId, message.actorId,
+                                message.actorType, message.actorDisplayName, message.timestamp, message.expirationTimestamp])
+
+            guard success else { continue }
+
+            var rowId: Int64?
+            success = execute("SELECT id FROM messages WHERE internalId = ?", bindings: [message.internalId]) { statement in
+                rowId = sqlite3_column_int64(statement, 0)
+            }
+
+            guard success, let rowId else { continue }
+
+            success = execute("DELETE FROM messages_fts WHERE rowid = ?", bindings: [rowId]) &&
+                execute("INSERT INTO messages_fts (rowid, text) VALUES (?, ?)", bindings: [rowId, text])
+        }
+
+        if success, execute("COMMIT") {
+            return true
+        }
+
+        execute("ROLLBACK")
+
+        return false
+    }
+
+    /// Pass a nil token to remove the messages of all rooms of the account
+    func removeMessages(forAccountId accountId: String, token: String?) {
+        guard openIfNeeded() else { return }
+
+        if let token {
+            execute("DELETE FROM messages_fts WHERE rowid IN (SELECT id FROM messages WHERE accountId = ? AND token = ?)", bindings: [accountId, token])
+            execute("DELETE FROM messages WHERE accountId = ? AND token = ?", bindings: [accountId, token])
+        } else {
+            execute("DELETE FROM messages_fts WHERE rowid IN (SELECT id FROM messages WHERE accountId = ?)", bindings: [accountId])
+            execute("DELETE FROM messages WHERE accountId = ?", bindings: [accountId])
+        }
+    }
+
+    // MARK: - Search
+
+    /// Searches the messages of all rooms of an account that are not expired at the given time, the best matches come first
+    func search(_ searchTerm: String, forAccountId accountId: String, limit: Int, now: Int) -> [ChatMessageSearchHit] {
+        guard let matchExpression = ChatMessageFullTextIndex.matchExpression(for: searchTerm), openIfNeeded() else { return [] }
+
+        var hits: [ChatMessageSearchHit] = []
+        let query = """
+            SELECT m.accountId, m.token, m.messageId, m.actorId, m.actorType, m.actorDisplayName, m.timestamp, snippet(messages_fts, 0, '', '', '…', 16)
+            FROM messages_fts JOIN messages m ON m.id = messages_fts.rowid
+            WHERE messages_fts MATCH ? AND m.accountId = ? AND (m.expirationTimestamp = 0 OR m.expirationTimestamp > ?)
+            ORDER BY bm25(messages_fts), m.timestamp DESC
+            LIMIT ?
+            """
+
+        execute(query, bindings: [matchExpression, accountId, now, limit]) { statement in
+            hits.append(ChatMessageSearchHit(accountId: self.string(statement, 0),
+                                             token: self.string(statement, 1),
+                                             messageId: Int(sqlite3_column_int64(statement, 2)),
+                                             actorId: self.string(statement, 3),
+                                             actorType: self.string(statement, 4),
+                                             actorDisplayName: self.string(statement, 5),
+                                             timestamp: Int(sqlite3_column_int64(statement, 6)),
+                                             snippet: self.string(statement, 7)))
+        }
+
+        return hits
+    }
+
+    /// Every word of the search term needs to match the beginning of a word in the message
+    class func matchExpression(for searchTerm: String) -> String? {
+        let words = searchTerm.components(separatedBy: CharacterSet.alphanumerics.inverted).filter { !$0.isEmpty }
+
+        guard !words.isEmpty else { return nil }
+
+        return words.map { "\"\($0)\"*" }.joined(separator: " ")
+    }
+
+    // MARK: - Database
+
+    private func openIfNeeded() -> Bool {
+        if isOpen {
+            return true
+        }
+
+        let path = databaseURL?.path ?? ":memory:"
+
+        guard sqlite3_open_v2(path, &database, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, nil) == SQLITE_OK else {
+            logBlock?("Could not open chat message search index")
+            sqlite3_close(database)
+            database = nil
+            return false
+        }
+
+        // The index can always be rebuilt from the stored messages
+        if var databaseURL {
+            var resourceValues = URLResourceValues()
+            resourceValues.isExcludedFromBackup = true
+            try? databaseURL.setResourceValues(resourceValues)
+        }
+
+        isOpen = true
+
+        execute("PRAGMA journal_mode = WAL")
+        execute("""
+            CREATE TABLE IF NOT EXISTS messages (id INTEGER PRIMARY KEY, internalId TEXT NOT NULL UNIQUE, accountId TEXT NOT NULL, token TEXT NOT NULL,
+            messageId INTEGER NOT NULL, actorId TEXT, actorType TEXT, actorDisplayName TEXT, timestamp INTEGER, expirationTimestamp INTEGER)
+            """)
+        execute("CREATE INDEX IF NOT EXISTS messages_account_token ON messages (accountId, token)")
+        execute("CREATE VIRTUAL TABLE IF NOT EXISTS messages_fts USING fts5(text, tokenize = 'unicode61 remove_diacritics 2')")
+
+        return true
+    }
+
+    @discardableResult
+    private func execute(_ sql: String, bindings: [Any] = [], rowHandler: ((OpaquePointer) -> Void)? = nil) -> Bool {
+        guard let database else { return false }
+
+        var statement = statements[sql]
+
+        if statement == nil {
+            guard sqlite3_prepare_v2(database, sql, -1, &statement, nil) == SQLITE_OK, statement != nil else {
+                logBlock?("ChatMessageSearchIndex: could not prepare statement: \(String(cString: sqlite3_errmsg(database)))")
+                return false
+            }
+
+            statements[sql] = statement
+        }
+
+        guard let statement else { return false }
+
+        defer {
+            sqlite3_reset(statement)
+            sqlite3_clear_bindings(statement)
+        }
+
+        for (index, value) in bindings.enumerated() {
+            let position = Int32(index + 1)
+
+            switch value {
+            case let value as Int:
+                sqlite3_bind_int64(statement, position, Int64(value))
+            case let value as Int64:
+                sqlite3_bind_int64(statement, position, value)
+            case let value as String:
+                sqlite3_bind_text(statement, position, value, -1, sqliteTransient)
+            default:
+                sqlite3_bind_null(statement, position)
+            }
+        }
+
+        while true {
+            let result = sqlite3_step(statement)
+
+            if result == SQLITE_ROW {
+                rowHandler?(statement)
+            } else if result == SQLITE_DONE {
+                return true
+            } else {
+                logBlock?("ChatMessageSearchIndex: could not execute statement: \(String(cString: sqlite3_errmsg(database)))")
+                return false
+            }
+        }
+    }
+
+    private func string(_ statement: OpaquePointer, _ column: Int32) -> String {
+        guard let text = sqlite3_column_text(statement, column) else { return "" }
+        return String(cString: text)
+    }
+}
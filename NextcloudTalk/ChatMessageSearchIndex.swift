@@ -0,0 +1,221 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+import Foundation
+
+@objcMembers class ChatMessageSearchResult: NSObject {
+
+    public let accountId: String
+    public let token: String
+    public let messageId: Int
+    public let actorId: String
+    public let actorType: String
+    public let actorDisplayName: String
+    public let timestamp: Int
+    public let snippet: String
+
+    init(hit: ChatMessageSearchHit) {
+        self.accountId = hit.accountId
+        self.token = hit.token
+        self.messageId = hit.messageId
+        self.actorId = hit.actorId
+        self.actorType = hit.actorType
+        self.actorDisplayName = hit.actorDisplayName
+        self.timestamp = hit.timestamp
+        self.snippet = hit.snippet
+    }
+}
+
+extension IndexedChatMessage {
+
+    init?(message: NCChatMessage) {
+        guard let internalId = message.internalId, let accountId = message.accountId, let token = message.token, !message.isTemporary else { return nil }
+
+        self.init(internalId: internalId,
+                  accountId: accountId,
+                  token: token,
+                  messageId: message.messageId,
+                  actorId: message.actorId ?? "",
+                  actorType: message.actorType ?? "",
+                  actorDisplayName: message.actorDisplayName ?? "",
+                  timestamp: message.timestamp,
+                  expirationTimestamp: message.expirationTimestamp)
+
+        if message.isSystemMessage() || message.isDeletedMessage() {
+            return
+        }
+
+        // Replace the parameter placeholders with their names, so e.g. mentions and file names can be found
+        var text = message.message ?? ""
+
+        for (key, value) in message.messageParameters() {
+            if let key = key as? String, let parameter = value as? [String: Any], let name = parameter["name"] as? String {
+                text = text.replacingOccurrences(of: "{\(key)}", with: name)
+            }
+        }
+
+        self.text = text.isEmpty ? nil : text
+    }
+}
+
+/// On-device full-text index over the stored chat messages, see ChatMessageFullTextIndex.
+/// All database access happens on a serial background queue.
+@objcMembers class ChatMessageSearchIndex: NSObject {
+
+    public static let shared = ChatMessageSearchIndex()
+
+    private let databaseVersion = 1
+    private let backfillBatchSize = 500
+    private let queue = DispatchQueue(label: "com.nextcloud.talk.chatMessageSearchIndex", qos: .utility)
+
+    // Only accessed on the queue
+    private let fullTextIndex: ChatMessageFullTextIndex
+    // Accounts with a backfill in progress, only accessed on the queue
+    private var backfillingAccountIds = Set<String>()
+
+    override init() {
+        var databaseURL = FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask).first
+
+        if let directoryURL = databaseURL {
+            try? FileManager.default.createDirectory(at: directoryURL, withIntermediateDirectories: true)
+            databaseURL = directoryURL.appendingPathComponent("ChatMessageSearchIndex.sqlite")
+        }
+
+        fullTextIndex = ChatMessageFullTextIndex(databaseURL: databaseURL)
+        fullTextIndex.logBlock = { message in
+            NCUtils.log(message)
+        }
+
+        super.init()
+    }
+
+    // MARK: - Public
+
+    /// Adds or updates the messages in the index, needs to be called on the thread the messages belong to
+    public func index(messages: [NCChatMessage]) {
+        let indexedMessages = messages.compactMap { IndexedChatMessage(message: $0) }
+
+        guard !indexedMessages.isEmpty else { return }
+
+        queue.async {
+            self.fullTextIndex.store(indexedMessages)
+        }
+    }
+
+    public func removeMessages(forAccountId accountId: String, token: String?) {
+        queue.async {
+            self.fullTextIndex.removeMessages(forAccountId: accountId, token: token)
+
+            if token == nil {
+                self.backfillingAccountIds.remove(accountId)
+                UserDefaults.standard.removeObject(forKey: self.backfillKey(forAccountId: accountId))
+            }
+        }
+    }
+
+    /// Searches the messages of all rooms of an account, the best matches come first. The completion block is called on the main thread.
+    public func search(_ searchTerm: String, forAccountId accountId: String, limit: Int, completionBlock: @escaping ([ChatMessageSearchResult]) -> Void) {
+        guard ChatMessageFullTextIndex.matchExpression(for: searchTerm) != nil else {
+            completionBlock([])
+            return
+        }
+
+        queue.async {
+            let hits = self.fullTextIndex.search(searchTerm, forAccountId: accountId, limit: limit, now: Int(Date().timeIntervalSince1970))
+            let results = hits.map { ChatMessageSearchResult(hit: $0) }
+
+            DispatchQueue.main.async {
+                completionBlock(results)
+            }
+        }
+    }
+
+    // MARK: - Backfill
+
+    private func backfillKey(forAccountId accountId: String) -> String {
+        return "ChatMessageSearchIndexBackfill-\(databaseVersion)-\(accountId)"
+    }
+
+    /// Indexes the messages that were stored before the index existed, once per account.
+    /// Every batch is a separate work item on the queue, so searches don't wait for the whole backfill.
+    public func backfillIfNeeded(forAccountId accountId: String) {
+        queue.async {
+            let key = self.backfillKey(forAccountId: accountId)
+
+            guard !UserDefaults.standard.bool(forKey: key), !self.backfillingAccountIds.contains(accountId) else { return }
+
+            self.backfillingAccountIds.insert(accountId)
+            self.backfillBatch(forAccountId: accountId, offset: 0)
+        }
+    }
+
+    private func backfillBatch(forAccountId accountId: String, offset: Int) {
+        var batch: [IndexedChatMessage] = []
+        var numberOfMessages = 0
+
+        autoreleasepool {
+            // Work items of a serial queue can run on different threads, but a realm can only be used on the thread it
+            // was opened on. A realm opened for this batch also sees the messages that were stored since the last batch.
+            let realm = RLMRealm.default()
+            realm.refresh()
+
+            // Sorted by the primary key, so the batches stay stable between work items
+            let managedMessages = NCChatMessage.objects(in: realm, with: NSPredicate(format: "accountId = %@ AND isTemporary = false", accountId))
+                .sortedResults(usingKeyPath: "internalId", ascending: true)
+
+            numberOfMessages = Int(managedMessages.count)
+
+            // Messages might have been removed since the last batch
+            let endIndex = min(offset + backfillBatchSize, numberOfMessages)
+
+            guard offset < endIndex else { return }
+
+            for index in offset..<endIndex {
+                if let message = managedMessages.object(at: UInt(index)) as? NCChatMessage, let indexedMessage = IndexedChatMessage(message: message) {
+                    batch.append(indexedMessage)
+                }
+            }
+        }
+
+        guard fullTextIndex.store(batch) else {
+            // Try again on the next backfill request
+            NCUtils.log("ChatMessageSearchIndex: backfill failed for account \(accountId)")
+            backfillingAccountIds.remove(accountId)
+            return
+        }
+
+        let nextOffset = offset + backfillBatchSize
+
+        if nextOffset < numberOfMessages {
+            queue.async {
+                // The account might have been removed in the meantime
+                guard self.backfillingAccountIds.contains(accountId) else { return }
+
+                self.backfillBatch(forAccountId: accountId, offset: nextOffset)
+            }
+
+            return
+        }
+
+        backfillingAccountIds.remove(accountId)
+        UserDefaults.standard.set(true, forKey: backfillKey(forAccountId: accountId))
+    }
+}
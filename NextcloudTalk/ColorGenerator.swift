@@ -23,7 +23,6 @@
 // and https://github.com/nextcloud/nextcloud-vue/blob/56b79afae93f4701a0cb933bfeb7b4a2fbd590fb/src/utils/GenColors.js
 
 import Foundation
-import CryptoKit
 
 @objcMembers class ColorGenerator: NSObject {
 
@@ -31,9 +30,12 @@ import CryptoKit
 
     private let steps = 6
     private let finalPalette: [UIColor]
+    private let paletteIndexes: UsernamePaletteIndexes
+    private let warmUpQueue = DispatchQueue(label: "com.nextcloud.Talk.colorGenerator", qos: .utility)
 
     private override init() {
         finalPalette = ColorGenerator.genColors(steps)
+        paletteIndexes = UsernamePaletteIndexes(paletteSize: finalPalette.count)
 
         super.init()
     }
@@ -96,18 +98,15 @@ import CryptoKit
     }
 
     public func usernameToColor(_ username: String) -> UIColor {
-        let hash = username.lowercased()
-        var hashInt = 0
+        return finalPalette[paletteIndexes.paletteIndex(for: username)]
+    }
 
-        if let usernameData = hash.data(using: .utf8) {
-            let md5Hash = Insecure.MD5.hash(data: usernameData)
-            let t = md5Hash.map { String(format: "%02hhx", $0) }.joined()
-            hashInt = t.map { Int(String($0), radix: 16)! % 16}.reduce(0, +)
+    /// Calculates the colors of the given usernames in the background, so they are cached when they are displayed
+    public func warmUp(usernames: [String]) {
+        warmUpQueue.async {
+            for username in usernames {
+                _ = self.paletteIndexes.paletteIndex(for: username)
+            }
         }
-
-        let maximum = steps * 3
-        hashInt = hashInt % maximum
-
-        return finalPalette[hashInt]
     }
 }
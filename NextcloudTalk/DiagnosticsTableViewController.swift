@@ -32,6 +32,7 @@ class DiagnosticsTableViewController: UITableViewController {
         case kDiagnosticsSectionServer
         case kDiagnosticsSectionTalk
         case kDiagnosticsSectionSignaling
+        case kDiagnosticsSectionCalls
         case kDiagnosticsSectionCount
     }
 
@@ -83,6 +84,12 @@ class DiagnosticsTableViewController: UITableViewController {
         case kSignalingSectionCount
     }
 
+    enum CallSections: Int {
+        case kCallSectionStatistics = 0
+        case kCallSectionExportStatistics
+        case kCallSectionCount
+    }
+
     var signalingSections: [Int] = []
 
     var account: TalkAccount
@@ -97,6 +104,8 @@ class DiagnosticsTableViewController: UITableViewController {
     var notificationSettings: UNNotificationSettings?
     var notificationSettingsIndicator = UIActivityIndicatorView(frame: .init(x: 0, y: 0, width: 24, height: 24))
 
+    var callStatsSummary: (numberOfPeers: Int, numberOfSamples: Int)?
+
     let allowedString = NSLocalizedString("Allowed", comment: "'{Microphone, Camera, ...} access is allowed'")
     let deniedString = NSLocalizedString("Denied", comment: "'{Microphone, Camera, ...} access is denied'")
     let notRequestedString = NSLocalizedString("Not requested", comment: "'{Microphone, Camera, ...} access was not requested'")
@@ -161,6 +170,7 @@ class DiagnosticsTableViewController: UITableViewController {
         DispatchQueue.main.async {
             self.checkServerReachability()
             self.checkNotificationAuthorizationStatus()
+            self.checkCallStatistics()
         }
     }
 
@@ -194,6 +204,13 @@ class DiagnosticsTableViewController: UITableViewController {
         })
     }
 
+    func checkCallStatistics() {
+        CallStatsSampler.shared.summary { numberOfPeers, numberOfSamples in
+            self.callStatsSummary = (numberOfPeers, numberOfSamples)
+            self.reloadRow(CallSections.kCallSectionStatistics.rawValue, in: DiagnosticsSections.kDiagnosticsSectionCalls.rawValue)
+        }
+    }
+
     // MARK: Table view data source
 
     override func numberOfSections(in tableView: UITableView) -> Int {
@@ -217,6 +234,9 @@ class DiagnosticsTableViewController: UITableViewController {
         case DiagnosticsSections.kDiagnosticsSectionSignaling.rawValue:
             return signalingSections.count
 
+        case DiagnosticsSections.kDiagnosticsSectionCalls.rawValue:
+            return CallSections.kCallSectionCount.rawValue
+
         default:
             return 1
         }
@@ -239,6 +259,9 @@ class DiagnosticsTableViewController: UITableViewController {
         case DiagnosticsSections.kDiagnosticsSectionSignaling.rawValue:
             return NSLocalizedString("Signaling", comment: "")
 
+        case DiagnosticsSections.kDiagnosticsSectionCalls.rawValue:
+            return NSLocalizedString("Calls", comment: "")
+
         default:
             return nil
         }
@@ -261,6 +284,9 @@ class DiagnosticsTableViewController: UITableViewController {
         case DiagnosticsSections.kDiagnosticsSectionSignaling.rawValue:
             return signalingCell(for: indexPath)
 
+        case DiagnosticsSections.kDiagnosticsSectionCalls.rawValue:
+            return callCell(for: indexPath)
+
         default:
             break
         }
@@ -278,6 +304,11 @@ class DiagnosticsTableViewController: UITableViewController {
                   indexPath.row == TalkSections.kTalkSectionVersion.rawValue {
 
             presentCapabilitiesDetails()
+
+        } else if indexPath.section == DiagnosticsSections.kDiagnosticsSectionCalls.rawValue,
+                  indexPath.row == CallSections.kCallSectionExportStatistics.rawValue {
+
+            exportCallStatistics(from: indexPath)
         }
 
         self.tableView.deselectRow(at: indexPath, animated: true)
@@ -668,6 +699,52 @@ class DiagnosticsTableViewController: UITableViewController {
         return cell
     }
 
+    func callCell(for indexPath: IndexPath) -> UITableViewCell {
+        if indexPath.row == CallSections.kCallSectionExportStatistics.rawValue {
+            let cell = tableView.dequeueReusableCell(withIdentifier: cellIdentifierOpenAppSettings, for: indexPath)
+
+            cell.textLabel?.text = NSLocalizedString("Export call statistics", comment: "")
+            cell.textLabel?.textAlignment = .center
+            cell.textLabel?.textColor = UIColor.systemBlue
+
+            return cell
+        }
+
+        let cell = tableView.dequeueReusableCell(withIdentifier: cellIdentifierSubtitle, for: indexPath)
+        cell.textLabel?.text = NSLocalizedString("Call statistics", comment: "Statistics (bitrate, packet loss, ...) of the last call")
+        cell.detailTextLabel?.text = "-"
+
+        if let callStatsSummary, callStatsSummary.numberOfSamples > 0 {
+            let participantsString = NSLocalizedString("Participants", comment: "")
+            let samplesString = NSLocalizedString("Samples", comment: "Number of collected call statistics samples")
+            cell.detailTextLabel?.text = "\(participantsString): \(callStatsSummary.numberOfPeers)\n\(samplesString): \(callStatsSummary.numberOfSamples)"
+        }
+
+        return cell
+    }
+
+    // MARK: Call statistics export
+
+    func exportCallStatistics(from indexPath: IndexPath) {
+        CallStatsSampler.shared.exportJSON { data in
+            guard let data else { return }
+
+            let fileURL = FileManager.default.temporaryDirectory.appendingPathComponent("call-statistics.json")
+
+            do {
+                try data.write(to: fileURL, options: .atomic)
+            } catch {
+                NCUtils.log("Could not write call statistics: \(error.localizedDescription)")
+                return
+            }
+
+            let activityViewController = UIActivityViewController(activityItems: [fileURL], applicationActivities: nil)
+            activityViewController.popoverPresentationController?.sourceView = self.tableView.cellForRow(at: indexPath)
+
+            self.present(activityViewController, animated: true)
+        }
+    }
+
     // MARK: Capabilities details
 
     func presentCapabilitiesDetails() {
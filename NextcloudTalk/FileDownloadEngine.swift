@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+import Foundation
+
+/// Downloads a file of an account with the SegmentedFileDownloader, see there for details.
+@objcMembers class FileDownloadEngine: NSObject {
+
+    public let account: TalkAccount
+    public var maxParallelSegments = 4
+    public var parallelDownloadThreshold: Int64 = 32 * 1024 * 1024
+    // Disable for files that are played while they are downloaded, so the partial file is filled from the start
+    public var allowsParallelSegments = true
+    // Downloaded first when the file is played while it's downloaded, see streamingTailLength(forFileName:fileSize:)
+    public var tailLength: Int64 = 0
+    public var maxRetries = 4
+
+    private let userAgent = "Mozilla/5.0 (iOS) Nextcloud-Talk v\(Bundle.main.infoDictionary?["CFBundleShortVersionString"] as? String ?? "")"
+    private var downloader: SegmentedFileDownloader?
+
+    public init(account: TalkAccount) {
+        self.account = account
+        super.init()
+    }
+
+    // MARK: - Public
+
+    /// The file the download is written to until it's complete, it has the final size from the beginning
+    public class func partialFilePath(forLocalPath localPath: String) -> String {
+        return SegmentedFileDownloader.partialFilePath(forLocalPath: localPath)
+    }
+
+    /// Only files in containers that can be played from the partial file should be streamed
+    public class func canStreamFile(withName fileName: String) -> Bool {
+        return SegmentedFileDownloader.streamingTailLength(forFileName: fileName, fileSize: 0) != nil
+    }
+
+    public class func streamingTailLength(forFileName fileName: String, fileSize: Int64) -> Int64 {
+        return SegmentedFileDownloader.streamingTailLength(forFileName: fileName, fileSize: fileSize) ?? 0
+    }
+
+    /// The progress block receives the downloaded fraction and the fraction of the partial file that can already be played
+    public func downloadFile(fromURL url: URL, toPath localPath: String, fileSize: Int64, etag: String,
+                             progressBlock: ((_ fractionCompleted: Double, _ playableFraction: Double) -> Void)?,
+                             completionBlock: @escaping (_ errorDescription: String?) -> Void) {
+
+        let configuration = URLSessionConfiguration.default
+        configuration.httpCookieStorage = HTTPCookieStorage.sharedCookieStorage(forGroupContainerIdentifier: account.accountId)
+        configuration.timeoutIntervalForRequest = 60
+
+        let requestHeaders = [
+            "Authorization": NCAPIController.sharedInstance().authHeader(for: account) ?? "",
+            "User-Agent": userAgent
+        ]
+
+        let downloader = SegmentedFileDownloader(configuration: configuration, requestHeaders: requestHeaders)
+        downloader.maxParallelSegments = maxParallelSegments
+        downloader.parallelDownloadThreshold = parallelDownloadThreshold
+        downloader.allowsParallelSegments = allowsParallelSegments
+        downloader.tailLength = tailLength
+        downloader.maxRetries = maxRetries
+
+        downloader.logBlock = { message in
+            NCUtils.log(message)
+        }
+
+        downloader.challengeBlock = { challenge in
+            if CCCertificate.sharedManager().checkTrustedChallenge(challenge), let serverTrust = challenge.protectionSpace.serverTrust {
+                return (.useCredential, URLCredential(trust: serverTrust))
+            }
+
+            return (.performDefaultHandling, nil)
+        }
+
+        self.downloader = downloader
+
+        downloader.downloadFile(fromURL: url, toPath: localPath, fileSize: fileSize, etag: etag, progressBlock: progressBlock, completionBlock: completionBlock)
+    }
+
+    public func cancel() {
+        downloader?.cancel()
+    }
+}
@@ -41,6 +41,7 @@
 @interface FileMessageTableViewCell ()
 {
     MDCActivityIndicator *_activityIndicator;
+    FilePreviewImageRequest *_previewRequest;
 }
 
 @end
@@ -174,7 +175,7 @@
     [self.avatarButton cancelCurrentRequest];
     [self.avatarButton setImage:nil forState:UIControlStateNormal];
     
-    [self.previewImageView cancelImageDownloadTask];
+    [self cancelPreviewRequest];
     self.previewImageView.layer.borderWidth = 0.0f;
     self.previewImageView.image = nil;
     self.playIconImageView.hidden = YES;
@@ -273,63 +274,75 @@
     BOOL isVideoFile = [NCUtils isVideoFileType:message.file.mimetype];
     BOOL isMediaFile = isVideoFile || [NCUtils isImageFileType:message.file.mimetype];
 
-    
-    NSInteger requestedHeight = 3 * kFileMessageCellFileMaxPreviewHeight;
+    CGFloat previewMaxHeight = isMediaFile ? kFileMessageCellMediaFilePreviewHeight : kFileMessageCellFileMaxPreviewHeight;
+    CGFloat previewMaxWidth = isMediaFile ? kFileMessageCellMediaFileMaxPreviewWidth : kFileMessageCellFileMaxPreviewWidth;
+    CGSize previewMaxSize = CGSizeMake(previewMaxWidth, previewMaxHeight);
+
+    [self cancelPreviewRequest];
+    [self.previewImageView setImage:filePreviewImage];
+
     __weak typeof(self) weakSelf = self;
 
-    [self.previewImageView setImageWithURLRequest:[[NCAPIController sharedInstance] createPreviewRequestForFile:message.file.parameterId withMaxHeight:requestedHeight usingAccount:account]
-                                     placeholderImage:filePreviewImage success:^(NSURLRequest * _Nonnull request, NSHTTPURLResponse * _Nullable response, UIImage * _Nonnull image) {
-
-                                       //TODO: How to adjust for dark mode?
-                                       weakSelf.previewImageView.layer.borderColor = [[UIColor secondarySystemFillColor] CGColor];
-                                       weakSelf.previewImageView.layer.borderWidth = 1.0f;
-
-                                       dispatch_async(dispatch_get_main_queue(), ^(void){
-                                           CGFloat width = image.size.width * image.scale;
-                                           CGFloat height = image.size.height * image.scale;
-
-                                           CGFloat previewMaxHeight = isMediaFile ? kFileMessageCellMediaFilePreviewHeight : kFileMessageCellFileMaxPreviewHeight;
-                                           CGFloat previewMaxWidth = isMediaFile ? kFileMessageCellMediaFileMaxPreviewWidth : kFileMessageCellFileMaxPreviewWidth;
-
-                                           if (height < kFileMessageCellMinimumHeight) {
-                                               CGFloat ratio = kFileMessageCellMinimumHeight / height;
-                                               width = width * ratio;
-                                               if (width > previewMaxWidth) {
-                                                   width = previewMaxWidth;
-                                               }
-                                               height = kFileMessageCellMinimumHeight;
-                                           } else {
-                                               if (height > previewMaxHeight) {
-                                                   CGFloat ratio = previewMaxHeight / height;
-                                                   width = width * ratio;
-                                                   height = previewMaxHeight;
-                                               }
-                                               if (width > previewMaxWidth) {
-                                                   CGFloat ratio = previewMaxWidth / width;
-                                                   width = previewMaxWidth;
-                                                   height = height * ratio;
-                                               }
-                                           }
-                                           weakSelf.vPreviewSize[3].constant = height;
-                                           weakSelf.hPreviewSize[3].constant = width;
-                                           weakSelf.vGroupedPreviewSize[1].constant = height;
-                                           weakSelf.hGroupedPreviewSize[1].constant = width;
-                                           if (isVideoFile) {
-                                               // only show the play icon if there is an image preview (not on top of the default video placeholder)
-                                               weakSelf.playIconImageView.hidden = NO;
-                                               // if the video preview is very narrow, make the play icon fit inside
-                                               weakSelf.playIconImageView.frame = CGRectMake(0, 0, MIN(MIN(height, width), kFileMessageCellVideoPlayIconSize), MIN(MIN(height, width), kFileMessageCellVideoPlayIconSize));
-                                               weakSelf.playIconImageView.center = CGPointMake(width / 2.0, height / 2.0);
-                                           }
-                                           [weakSelf.previewImageView setImage:image];
-                                           [weakSelf setNeedsLayout];
-                                           [weakSelf layoutIfNeeded];
-
-                                           if (weakSelf.delegate) {
-                                               [weakSelf.delegate cellHasDownloadedImagePreviewWithHeight:ceil(height) forMessage:message];
-                                           }
-                                       });
-    } failure:nil];
+    // Previews are requested and decoded at the exact pixel size we display them with
+    _previewRequest = [[FilePreviewImageManager shared] getPreviewForFileId:message.file.parameterId withMaxPointSize:previewMaxSize using:account completionBlock:^(UIImage * _Nullable image) {
+        if (!image) {
+            return;
+        }
+
+        //TODO: How to adjust for dark mode?
+        weakSelf.previewImageView.layer.borderColor = [[UIColor secondarySystemFillColor] CGColor];
+        weakSelf.previewImageView.layer.borderWidth = 1.0f;
+
+        CGFloat width = image.size.width * image.scale;
+        CGFloat height = image.size.height * image.scale;
+
+        if (height < kFileMessageCellMinimumHeight) {
+            CGFloat ratio = kFileMessageCellMinimumHeight / height;
+            width = width * ratio;
+            if (width > previewMaxWidth) {
+                width = previewMaxWidth;
+            }
+            height = kFileMessageCellMinimumHeight;
+        } else {
+            if (height > previewMaxHeight) {
+                CGFloat ratio = previewMaxHeight / height;
+                width = width * ratio;
+                height = previewMaxHeight;
+            }
+            if (width > previewMaxWidth) {
+                CGFloat ratio = previewMaxWidth / width;
+                width = previewMaxWidth;
+                height = height * ratio;
+            }
+        }
+        weakSelf.vPreviewSize[3].constant = height;
+        weakSelf.hPreviewSize[3].constant = width;
+        weakSelf.vGroupedPreviewSize[1].constant = height;
+        weakSelf.hGroupedPreviewSize[1].constant = width;
+        if (isVideoFile) {
+            // only show the play icon if there is an image preview (not on top of the default video placeholder)
+            weakSelf.playIconImageView.hidden = NO;
+            // if the video preview is very narrow, make the play icon fit inside
+            weakSelf.playIconImageView.frame = CGRectMake(0, 0, MIN(MIN(height, width), kFileMessageCellVideoPlayIconSize), MIN(MIN(height, width), kFileMessageCellVideoPlayIconSize));
+            weakSelf.playIconImageView.center = CGPointMake(width / 2.0, height / 2.0);
+        }
+        [weakSelf.previewImageView setImage:image];
+        [weakSelf setNeedsLayout];
+        [weakSelf layoutIfNeeded];
+
+        // Cached previews are returned synchronously while the cell is being configured, so don't update the table view right away
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (weakSelf.delegate) {
+                [weakSelf.delegate cellHasDownloadedImagePreviewWithHeight:ceil(height) forMessage:message];
+            }
+        });
+    }];
+}
+
+- (void)cancelPreviewRequest
+{
+    [_previewRequest cancel];
+    _previewRequest = nil;
 }
 
 - (void)setDeliveryState:(ChatMessageDeliveryState)state
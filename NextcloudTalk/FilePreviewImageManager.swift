@@ -0,0 +1,184 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+import UIKit
+
+@objcMembers class FilePreviewImageRequest: NSObject {
+
+    fileprivate let key: String
+    fileprivate let identifier = UUID()
+
+    fileprivate init(key: String) {
+        self.key = key
+    }
+
+    public func cancel() {
+        FilePreviewImageManager.shared.cancel(self)
+    }
+}
+
+@objcMembers class FilePreviewImageManager: NSObject {
+
+    public static let shared = FilePreviewImageManager()
+
+    private class InFlightRequest {
+        var task: URLSessionDataTask?
+        var completionBlocks: [UUID: (_ image: UIImage?) -> Void] = [:]
+    }
+
+    // Decoded previews are kept in memory at display size only, the encoded data is cached on disk by NCImageSessionManager
+    private let memoryCache = NSCache<NSString, UIImage>()
+    private let decodingQueue = DispatchQueue(label: "com.nextcloud.Talk.FilePreviewImageManager.decoding", qos: .userInitiated, attributes: .concurrent)
+    private let lockQueue = DispatchQueue(label: "com.nextcloud.Talk.FilePreviewImageManager.lock")
+    private var inFlightRequests: [String: InFlightRequest] = [:]
+
+    override init() {
+        super.init()
+
+        // Limit the memory cache to roughly 40 media previews at 3x scale
+        memoryCache.totalCostLimit = 40 * 690 * 690 * 4
+
+        NotificationCenter.default.addObserver(self, selector: #selector(didReceiveMemoryWarning), name: UIApplication.didReceiveMemoryWarningNotification, object: nil)
+    }
+
+    func didReceiveMemoryWarning() {
+        memoryCache.removeAllObjects()
+    }
+
+    // MARK: - Preview requests
+
+    public func pixelSize(forPoints points: CGFloat) -> Int {
+        return Int(ceil(points * UIScreen.main.scale))
+    }
+
+    public func cachedPreview(forFileId fileId: String, withMaxPointSize size: CGSize, using account: TalkAccount) -> UIImage? {
+        let key = self.cacheKey(forFileId: fileId, maxPointSize: size, using: account)
+        return memoryCache.object(forKey: key as NSString)
+    }
+
+    /// Requests the preview of a file at the pixel size needed to display it within the given size in points.
+    /// Concurrent requests for the same file and size share a single network request and decoding pass.
+    /// The completion block is always called on the main queue, unless the returned request is cancelled.
+    @discardableResult
+    public func getPreview(forFileId fileId: String, withMaxPointSize size: CGSize, using account: TalkAccount, completionBlock: @escaping (_ image: UIImage?) -> Void) -> FilePreviewImageRequest? {
+        // The server scales the preview by height (keeping the aspect ratio), the decoder bounds the longest side
+        let requestedHeight = self.pixelSize(forPoints: size.height)
+        let maxPixelSize = self.pixelSize(forPoints: max(size.width, size.height))
+        let key = self.cacheKey(forFileId: fileId, maxPointSize: size, using: account)
+        let scale = UIScreen.main.scale
+
+        if let image = memoryCache.object(forKey: key as NSString) {
+            completionBlock(image)
+            return nil
+        }
+
+        let previewRequest = FilePreviewImageRequest(key: key)
+
+        lockQueue.sync {
+            if let inFlightRequest = inFlightRequests[key] {
+                inFlightRequest.completionBlocks[previewRequest.identifier] = completionBlock
+                return
+            }
+
+            let inFlightRequest = InFlightRequest()
+            inFlightRequest.completionBlocks[previewRequest.identifier] = completionBlock
+            inFlightRequests[key] = inFlightRequest
+
+            let urlRequest = NCAPIController.sharedInstance().createPreviewRequest(forFile: fileId, withMaxHeight: requestedHeight, using: account)
+            let session = NCImageSessionManager.sharedInstance().session
+
+            let task = session.dataTask(with: urlRequest) { [weak self] data, response, _ in
+                guard let self else { return }
+
+                let statusCode = (response as? HTTPURLResponse)?.statusCode ?? 0
+
+                guard let data, statusCode >= 200, statusCode < 300 else {
+                    self.finish(inFlightRequest, withKey: key, image: nil)
+                    return
+                }
+
+                self.decodingQueue.async {
+                    let image = FilePreviewImageManager.downsampledImage(from: data, maxPixelSize: maxPixelSize, scale: scale)
+
+                    if let image, let cgImage = image.cgImage {
+                        self.memoryCache.setObject(image, forKey: key as NSString, cost: cgImage.bytesPerRow * cgImage.height)
+                    }
+
+                    self.finish(inFlightRequest, withKey: key, image: image)
+                }
+            }
+
+            inFlightRequest.task = task
+            task.resume()
+        }
+
+        return previewRequest
+    }
+
+    public func cancel(_ request: FilePreviewImageRequest) {
+        lockQueue.sync {
+            guard let inFlightRequest = inFlightRequests[request.key] else { return }
+
+            inFlightRequest.completionBlocks.removeValue(forKey: request.identifier)
+
+            // Only cancel the network request when no other cell is waiting for the same preview
+            if inFlightRequest.completionBlocks.isEmpty {
+                inFlightRequest.task?.cancel()
+                inFlightRequests.removeValue(forKey: request.key)
+            }
+        }
+    }
+
+    private func finish(_ inFlightRequest: InFlightRequest, withKey key: String, image: UIImage?) {
+        var completionBlocks: [(_ image: UIImage?) -> Void] = []
+
+        lockQueue.sync {
+            // A cancelled request might have been replaced by a new one for the same key in the meantime
+            guard inFlightRequests[key] === inFlightRequest else { return }
+
+            inFlightRequests.removeValue(forKey: key)
+            completionBlocks = Array(inFlightRequest.completionBlocks.values)
+        }
+
+        guard !completionBlocks.isEmpty else { return }
+
+        DispatchQueue.main.async {
+            for completionBlock in completionBlocks {
+                completionBlock(image)
+            }
+        }
+    }
+
+    private func cacheKey(forFileId fileId: String, maxPointSize size: CGSize, using account: TalkAccount) -> String {
+        return "\(account.accountId)-\(fileId)-\(self.pixelSize(forPoints: size.width))x\(self.pixelSize(forPoints: size.height))"
+    }
+
+    // MARK: - Decoding
+
+    /// Decodes image data directly into a bitmap no larger than maxPixelSize, without inflating the full image first
+    public class func downsampledImage(from data: Data, maxPixelSize: Int, scale: CGFloat) -> UIImage? {
+        guard let cgImage = PreviewImageDownsampler.downsampledImage(from: data, maxPixelSize: maxPixelSize) else {
+            return nil
+        }
+
+        return UIImage(cgImage: cgImage, scale: scale, orientation: .up)
+    }
+}
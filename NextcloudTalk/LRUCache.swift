@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Least recently used entries are evicted first. Not thread safe.
+struct LRUCache<Key: Hashable, Value> {
+
+    private class Node {
+        let key: Key
+        var value: Value
+        var previous: Node?
+        var next: Node?
+
+        init(key: Key, value: Value) {
+            self.key = key
+            self.value = value
+        }
+    }
+
+    let capacity: Int
+
+    private var nodes: [Key: Node] = [:]
+    // Most recently used
+    private var head: Node?
+    // Least recently used
+    private var tail: Node?
+
+    init(capacity: Int) {
+        self.capacity = max(capacity, 1)
+    }
+
+    var count: Int {
+        return nodes.count
+    }
+
+    func contains(key: Key) -> Bool {
+        return nodes[key] != nil
+    }
+
+    mutating func value(forKey key: Key) -> Value? {
+        guard let node = nodes[key] else { return nil }
+
+        self.moveToFront(node)
+
+        return node.value
+    }
+
+    /// Returns the entry that was evicted to make room for the new value
+    @discardableResult
+    mutating func setValue(_ value: Value, forKey key: Key) -> (key: Key, value: Value)? {
+        if let node = nodes[key] {
+            node.value = value
+            self.moveToFront(node)
+            return nil
+        }
+
+        var evictedEntry: (key: Key, value: Value)?
+
+        if nodes.count >= capacity {
+            evictedEntry = self.removeLeastRecentlyUsed()
+        }
+
+        let node = Node(key: key, value: value)
+        nodes[key] = node
+        self.insertAtFront(node)
+
+        return evictedEntry
+    }
+
+    @discardableResult
+    mutating func removeValue(forKey key: Key) -> Value? {
+        guard let node = nodes.removeValue(forKey: key) else { return nil }
+
+        self.unlink(node)
+
+        return node.value
+    }
+
+    mutating func removeLeastRecentlyUsed() -> (key: Key, value: Value)? {
+        guard let tail else { return nil }
+
+        self.unlink(tail)
+        nodes.removeValue(forKey: tail.key)
+
+        return (tail.key, tail.value)
+    }
+
+    mutating func removeAll() {
+        // Break the reference cycles between the nodes
+        var node = head
+
+        while let current = node {
+            node = current.next
+            current.previous = nil
+            current.next = nil
+        }
+
+        nodes.removeAll()
+        head = nil
+        tail = nil
+    }
+
+    private mutating func moveToFront(_ node: Node) {
+        guard head !== node else { return }
+
+        self.unlink(node)
+        self.insertAtFront(node)
+    }
+
+    private mutating func insertAtFront(_ node: Node) {
+        node.next = head
+        head?.previous = node
+        head = node
+
+        if tail == nil {
+            tail = node
+        }
+    }
+
+    private mutating func unlink(_ node: Node) {
+        node.previous?.next = node.next
+        node.next?.previous = node.previous
+
+        if head === node {
+            head = node.next
+        }
+
+        if tail === node {
+            tail = node.previous
+        }
+
+        node.previous = nil
+        node.next = nil
+    }
+}
@@ -0,0 +1,188 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Bounded cache for parsed attributed strings, keyed by the source string (text and attributes) and a theme key.
+/// Entries are evicted in least recently used order once the estimated size exceeds the byte budget.
+/// Entries of another theme key are dropped as soon as a new theme key is used. Thread safe.
+class MarkdownParseCache {
+
+    /// Returns a stable description of an attribute value, or nil if the value has no description the cache knows about
+    typealias AttributeValueSignature = (_ value: Any) -> String?
+
+    // Sources are created for every message again (e.g. with new dynamic colors), so their attributes can't be compared
+    // with isEqual. The key contains the text and the ranges, names and value signatures of the attribute runs instead.
+    private struct Key: Hashable {
+        let text: String
+        let attributes: String
+        let themeKey: String
+    }
+
+    private struct Entry {
+        let result: NSAttributedString
+        let cost: Int
+    }
+
+    // Rough size of an attribute run (font, color, paragraph style) in addition to the UTF-16 storage
+    private static let attributeRunCost = 128
+
+    let byteBudget: Int
+
+    private let attributeValueSignature: AttributeValueSignature?
+    private let lock = NSLock()
+    private var entries: LRUCache<Key, Entry>
+    private var themeKey: String?
+
+    public private(set) var totalCost = 0
+    public private(set) var hits = 0
+    public private(set) var misses = 0
+
+    /// Attribute values are described by the given block first, then strings, URLs and numbers by their value
+    /// and all other values only by their type
+    init(byteBudget: Int, maxEntries: Int = 2000, attributeValueSignature: AttributeValueSignature? = nil) {
+        self.byteBudget = byteBudget
+        self.entries = LRUCache(capacity: maxEntries)
+        self.attributeValueSignature = attributeValueSignature
+    }
+
+    var count: Int {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return entries.count
+    }
+
+    func result(for source: NSAttributedString, themeKey: String) -> NSAttributedString? {
+        let key = self.key(for: source, themeKey: themeKey)
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard themeKey == self.themeKey, let entry = entries.value(forKey: key) else {
+            misses += 1
+            return nil
+        }
+
+        hits += 1
+
+        return entry.result
+    }
+
+    func contains(_ source: NSAttributedString, themeKey: String) -> Bool {
+        let key = self.key(for: source, themeKey: themeKey)
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        // Doesn't count as a hit and doesn't change the eviction order
+        return themeKey == self.themeKey && entries.contains(key: key)
+    }
+
+    func store(_ result: NSAttributedString, for source: NSAttributedString, themeKey: String) {
+        let entry = Entry(result: result.copy() as? NSAttributedString ?? result, cost: MarkdownParseCache.cost(of: source, result: result))
+
+        // Entries that could never fit are not worth evicting everything else
+        guard entry.cost <= byteBudget else { return }
+
+        let key = self.key(for: source, themeKey: themeKey)
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        if themeKey != self.themeKey {
+            self.removeAllEntries()
+            self.themeKey = themeKey
+        }
+
+        if let replacedEntry = entries.removeValue(forKey: key) {
+            totalCost -= replacedEntry.cost
+        }
+
+        if let evictedEntry = entries.setValue(entry, forKey: key) {
+            totalCost -= evictedEntry.value.cost
+        }
+
+        totalCost += entry.cost
+
+        while totalCost > byteBudget, let evictedEntry = entries.removeLeastRecentlyUsed() {
+            totalCost -= evictedEntry.value.cost
+        }
+    }
+
+    func removeAll() {
+        lock.lock()
+        defer { lock.unlock() }
+
+        self.removeAllEntries()
+    }
+
+    private func removeAllEntries() {
+        entries.removeAll()
+        totalCost = 0
+    }
+
+    // MARK: - Keys
+
+    private func key(for source: NSAttributedString, themeKey: String) -> Key {
+        var attributeRuns: [String] = []
+
+        source.enumerateAttributes(in: NSRange(location: 0, length: source.length)) { attributes, range, _ in
+            let attributeSignatures = attributes.map { name, value in
+                "\(name.rawValue)=\(self.signature(of: value))"
+            }
+
+            attributeRuns.append("\(range.location),\(range.length):\(attributeSignatures.sorted().joined(separator: ";"))")
+        }
+
+        return Key(text: source.string, attributes: attributeRuns.joined(separator: "|"), themeKey: themeKey)
+    }
+
+    private func signature(of value: Any) -> String {
+        if let signature = attributeValueSignature?(value) {
+            return signature
+        }
+
+        switch value {
+        case let string as String:
+            return string
+        case let url as URL:
+            return url.absoluteString
+        case let number as NSNumber:
+            return number.stringValue
+        default:
+            return String(describing: type(of: value))
+        }
+    }
+
+    // MARK: - Cost
+
+    class func cost(of source: NSAttributedString, result: NSAttributedString) -> Int {
+        var attributeRuns = 0
+
+        result.enumerateAttributes(in: NSRange(location: 0, length: result.length)) { _, _, _ in
+            attributeRuns += 1
+        }
+
+        return (source.length + result.length) * MemoryLayout<unichar>.size + attributeRuns * attributeRunCost
+    }
+}
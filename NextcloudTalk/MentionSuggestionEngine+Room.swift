@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+extension MentionSuggestionEngine {
+
+    @objc public convenience init(room: NCRoom) {
+        let token = room.token ?? ""
+        let accountId = room.accountId ?? ""
+
+        self.init(roomKey: room.internalId ?? "", cache: MentionSuggestionEngine.sharedCache, fetchBlock: { term, completionBlock in
+            guard let account = NCDatabaseManager.sharedInstance().talkAccount(forAccountId: accountId) else { return nil }
+
+            let task = NCAPIController.sharedInstance().getMentionSuggestions(inRoom: token, for: term, for: account) { mentions, error in
+                completionBlock(mentions as? [MentionSuggestion], error)
+            }
+
+            return task.map { task in { task.cancel() } }
+        }, seedBlock: {
+            return MentionSuggestionEngine.storedParticipants(inRoom: token, forAccountId: accountId)
+        })
+    }
+
+    // Objective-C name of suggestions(for:completionBlock:), which is part of the package and can't be exposed there
+    @objc(suggestionsFor:completionBlock:)
+    public func requestSuggestions(for term: String, completionBlock: @escaping (_ suggestions: [[String: Any]]) -> Void) {
+        self.suggestions(for: term, completionBlock: completionBlock)
+    }
+
+    // MARK: - Local participants
+
+    /// Authors of the last stored messages of the room, except the current user, most recent first
+    private class func storedParticipants(inRoom token: String, forAccountId accountId: String) -> [MentionSuggestion] {
+        let account = NCDatabaseManager.sharedInstance().talkAccount(forAccountId: accountId)
+        let messages = NCChatMessage.objects(with: NSPredicate(format: "accountId = %@ AND token = %@ AND actorType = 'users'", accountId, token))
+            .sortedResults(usingKeyPath: "messageId", ascending: false)
+
+        var participants: [MentionSuggestion] = []
+        var actorIds = Set<String>()
+
+        for index in 0..<min(messages.count, 200) {
+            guard let message = messages.object(at: index) as? NCChatMessage,
+                  let actorId = message.actorId, actorId != account?.userId,
+                  actorIds.insert(actorId).inserted
+            else { continue }
+
+            participants.append(["id": actorId, "label": message.actorDisplayName ?? actorId, "source": "users"])
+        }
+
+        return participants
+    }
+}
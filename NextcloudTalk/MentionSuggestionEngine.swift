@@ -0,0 +1,238 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Mention suggestions as returned by the server ("id", "label", "source" and optionally "status")
+typealias MentionSuggestion = [String: Any]
+
+/// Mention suggestions per room and search term. The server returns at most `resultLimit` suggestions,
+/// so a result with less suggestions is complete and also answers longer search terms starting with the same term.
+/// Participants seen locally can be seeded, they are shown until the server answered. Not thread safe.
+class MentionSuggestionCache {
+
+    private struct Entry {
+        let timestamp: TimeInterval
+        let suggestions: [MentionSuggestion]
+    }
+
+    private class RoomEntry {
+        var entries: [String: Entry] = [:]
+        var seededSuggestions: [MentionSuggestion]?
+        var lastAccess: TimeInterval = 0
+    }
+
+    let resultLimit: Int
+    var maxAge: TimeInterval = 300
+    var maxRooms = 10
+    var maxTermsPerRoom = 50
+
+    private var rooms: [String: RoomEntry] = [:]
+
+    init(resultLimit: Int) {
+        self.resultLimit = resultLimit
+    }
+
+    func store(_ suggestions: [MentionSuggestion], forTerm term: String, inRoom roomKey: String, timestamp: TimeInterval) {
+        let room = self.room(forKey: roomKey, timestamp: timestamp)
+
+        room.entries[MentionSuggestionCache.normalized(term)] = Entry(timestamp: timestamp, suggestions: suggestions)
+
+        if room.entries.count > maxTermsPerRoom, let oldestTerm = room.entries.min(by: { $0.value.timestamp < $1.value.timestamp })?.key {
+            room.entries.removeValue(forKey: oldestTerm)
+        }
+    }
+
+    /// Suggestions for the term, either stored for the term itself or filtered from a complete result of a shorter term
+    func cachedSuggestions(forTerm term: String, inRoom roomKey: String, timestamp: TimeInterval) -> [MentionSuggestion]? {
+        guard let room = rooms[roomKey] else { return nil }
+
+        room.lastAccess = timestamp
+
+        let term = MentionSuggestionCache.normalized(term)
+        var prefix = term
+
+        while true {
+            if let entry = room.entries[prefix], timestamp - entry.timestamp < maxAge {
+                if prefix == term {
+                    return entry.suggestions
+                }
+
+                if entry.suggestions.count < resultLimit {
+                    return entry.suggestions.filter { MentionSuggestionCache.suggestion($0, matches: term) }
+                }
+            }
+
+            if prefix.isEmpty {
+                return nil
+            }
+
+            prefix.removeLast()
+        }
+    }
+
+    func hasSeededSuggestions(inRoom roomKey: String) -> Bool {
+        return rooms[roomKey]?.seededSuggestions != nil
+    }
+
+    func seed(_ suggestions: [MentionSuggestion], inRoom roomKey: String, timestamp: TimeInterval) {
+        self.room(forKey: roomKey, timestamp: timestamp).seededSuggestions = suggestions
+    }
+
+    func seededSuggestions(forTerm term: String, inRoom roomKey: String) -> [MentionSuggestion] {
+        let term = MentionSuggestionCache.normalized(term)
+        let suggestions = rooms[roomKey]?.seededSuggestions ?? []
+
+        return Array(suggestions.filter { MentionSuggestionCache.suggestion($0, matches: term) }.prefix(resultLimit))
+    }
+
+    func removeAll() {
+        rooms.removeAll()
+    }
+
+    private func room(forKey roomKey: String, timestamp: TimeInterval) -> RoomEntry {
+        if let room = rooms[roomKey] {
+            room.lastAccess = timestamp
+            return room
+        }
+
+        if rooms.count >= maxRooms, let oldestRoom = rooms.min(by: { $0.value.lastAccess < $1.value.lastAccess })?.key {
+            rooms.removeValue(forKey: oldestRoom)
+        }
+
+        let room = RoomEntry()
+        room.lastAccess = timestamp
+        rooms[roomKey] = room
+
+        return room
+    }
+
+    // MARK: - Matching
+
+    class func normalized(_ term: String) -> String {
+        return term.folding(options: [.caseInsensitive, .diacriticInsensitive, .widthInsensitive], locale: nil)
+    }
+
+    /// Same as the server: the term is contained in the id or the label
+    class func suggestion(_ suggestion: MentionSuggestion, matches normalizedTerm: String) -> Bool {
+        if normalizedTerm.isEmpty {
+            return true
+        }
+
+        for key in ["id", "label"] {
+            if let value = suggestion[key] as? String, normalized(value).contains(normalizedTerm) {
+                return true
+            }
+        }
+
+        return false
+    }
+}
+
+/// Provides the mention suggestions of a room while typing. Requests are debounced and a new search term cancels the
+/// running request, so results are always delivered for the last term only. Needs to be used from the main thread.
+/// The Objective-C interface and the suggestions of the stored messages of a room are in MentionSuggestionEngine+Room.
+class MentionSuggestionEngine: NSObject {
+
+    /// Returns a block that cancels the request
+    public typealias FetchBlock = (_ term: String, _ completionBlock: @escaping (_ suggestions: [MentionSuggestion]?, _ error: Error?) -> Void) -> (() -> Void)?
+
+    // Same limit as used in getMentionSuggestionsInRoom
+    static let resultLimit = 20
+    static let sharedCache = MentionSuggestionCache(resultLimit: resultLimit)
+
+    public var debounceInterval: TimeInterval = 0.2
+
+    private let roomKey: String
+    private let cache: MentionSuggestionCache
+    private let fetchBlock: FetchBlock
+    private let seedBlock: (() -> [MentionSuggestion])?
+
+    private var generation = 0
+    private var pendingRequest: DispatchWorkItem?
+    private var runningRequestCancelBlock: (() -> Void)?
+
+    init(roomKey: String, cache: MentionSuggestionCache, fetchBlock: @escaping FetchBlock, seedBlock: (() -> [MentionSuggestion])? = nil) {
+        self.roomKey = roomKey
+        self.cache = cache
+        self.fetchBlock = fetchBlock
+        self.seedBlock = seedBlock
+    }
+
+    // MARK: - Suggestions
+
+    /// Calls the completion block with the suggestions for the term, maybe more than once (e.g. with local suggestions
+    /// first and the suggestions from the server afterwards). Not called anymore once a newer term was requested.
+    public func suggestions(for term: String, completionBlock: @escaping (_ suggestions: [[String: Any]]) -> Void) {
+        self.cancel()
+
+        let timestamp = ProcessInfo.processInfo.systemUptime
+
+        if let cachedSuggestions = cache.cachedSuggestions(forTerm: term, inRoom: roomKey, timestamp: timestamp) {
+            completionBlock(cachedSuggestions)
+            return
+        }
+
+        if !cache.hasSeededSuggestions(inRoom: roomKey), let seedBlock {
+            cache.seed(seedBlock(), inRoom: roomKey, timestamp: timestamp)
+        }
+
+        let seededSuggestions = cache.seededSuggestions(forTerm: term, inRoom: roomKey)
+
+        if !seededSuggestions.isEmpty {
+            completionBlock(seededSuggestions)
+        }
+
+        let requestGeneration = generation
+        let request = DispatchWorkItem { [weak self] in
+            guard let self else { return }
+
+            self.pendingRequest = nil
+            self.runningRequestCancelBlock = self.fetchBlock(term) { [weak self] suggestions, _ in
+                DispatchQueue.main.async {
+                    // Responses of superseded or cancelled requests are discarded
+                    guard let self, self.generation == requestGeneration else { return }
+
+                    self.runningRequestCancelBlock = nil
+
+                    guard let suggestions else { return }
+
+                    self.cache.store(suggestions, forTerm: term, inRoom: self.roomKey, timestamp: ProcessInfo.processInfo.systemUptime)
+                    completionBlock(suggestions)
+                }
+            }
+        }
+
+        pendingRequest = request
+        DispatchQueue.main.asyncAfter(deadline: .now() + debounceInterval, execute: request)
+    }
+
+    public func cancel() {
+        generation += 1
+
+        pendingRequest?.cancel()
+        pendingRequest = nil
+
+        runningRequestCancelBlock?()
+        runningRequestCancelBlock = nil
+    }
+}
@@ -143,13 +143,12 @@ extern NSInteger const kReceivedChatMessagesLimit;
 
 @interface NCAPIController : NSObject
 
-@property (nonatomic, strong) NSMutableDictionary *apiSessionManagers;
-@property (nonatomic, strong) NSMutableDictionary *longPollingApiSessionManagers;
 @property (nonatomic, strong) AFImageDownloader *imageDownloader;
 @property (nonatomic, strong) AFImageDownloader *imageDownloaderNoCache;
 
 + (instancetype)sharedInstance;
 - (void)createAPISessionManagerForAccount:(TalkAccount *)account;
+- (void)removeAPISessionManagerForAccountId:(NSString *)accountId;
 - (void)setupNCCommunicationForAccount:(TalkAccount *)account;
 - (NSInteger)conversationAPIVersionForAccount:(TalkAccount *)account;
 - (NSInteger)callAPIVersionForAccount:(TalkAccount *)account;
@@ -159,6 +158,8 @@ extern NSInteger const kReceivedChatMessagesLimit;
 - (NSInteger)breakoutRoomsAPIVersionForAccount:(TalkAccount *)account;
 - (NSInteger)signalingAPIVersionForAccount:(TalkAccount *)account;
 - (NSString *)filesPathForAccount:(TalkAccount *)account;
+- (NSString *)uploadsPathForAccount:(TalkAccount *)account;
+- (NSString *)authHeaderForAccount:(TalkAccount *)account;
 - (SDWebImageDownloaderRequestModifier *)getRequestModifierForAccount:(TalkAccount *)account;
 
 // App Store
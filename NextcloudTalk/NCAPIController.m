@@ -49,9 +49,16 @@ NSString * const kNCSpreedAPIVersionBase    = @"/apps/spreed/api/v";
 
 NSInteger const kReceivedChatMessagesLimit = 100;
 
+// The server holds long-polling requests for up to 30s
+NSTimeInterval const kLongPollingTimeoutInterval = 60;
+
 @interface NCAPIController () <NSURLSessionTaskDelegate, NSURLSessionDelegate, NKCommonDelegate>
 
 @property (nonatomic, strong) NCAPISessionManager *defaultAPISessionManager;
+// Created when an account makes its first request, accessed only while synchronized on self
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NCAPISessionManager *> *apiSessionManagers;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSString *> *authHeaders;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, SDWebImageDownloaderRequestModifier *> *requestModifiers;
 
 @end
 
@@ -84,32 +91,56 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     configuration.HTTPCookieStorage = nil;
     _defaultAPISessionManager = [[NCAPISessionManager alloc] initWithSessionConfiguration:configuration];
     
+    // Session managers of the accounts are created on demand, so inactive accounts don't hold any connections
     _apiSessionManagers = [NSMutableDictionary new];
-    _longPollingApiSessionManagers = [NSMutableDictionary new];
-    
-    for (TalkAccount *account in [[NCDatabaseManager sharedInstance] allAccounts]) {
-        [self createAPISessionManagerForAccount:account];
-    }
+    _authHeaders = [NSMutableDictionary new];
+    _requestModifiers = [NSMutableDictionary new];
 }
 
 - (void)createAPISessionManagerForAccount:(TalkAccount *)account
 {
-    NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
-    NSHTTPCookieStorage *cookieStorage = [NSHTTPCookieStorage sharedCookieStorageForGroupContainerIdentifier:account.accountId];
-    configuration.HTTPCookieStorage = cookieStorage;
-    NCAPISessionManager *apiSessionManager = [[NCAPISessionManager alloc] initWithSessionConfiguration:configuration];
-    [apiSessionManager.requestSerializer setValue:[self authHeaderForAccount:account] forHTTPHeaderField:@"Authorization"];
+    // Drop the cached credentials, the token of the account might have changed
+    [self removeAPISessionManagerForAccountId:account.accountId];
+    [self apiSessionManagerForAccount:account];
+}
+
+- (void)removeAPISessionManagerForAccountId:(NSString *)accountId
+{
+    NCAPISessionManager *apiSessionManager;
+
+    @synchronized (self) {
+        apiSessionManager = [_apiSessionManagers objectForKey:accountId];
+        [_apiSessionManagers removeObjectForKey:accountId];
+        [_authHeaders removeObjectForKey:accountId];
+        [_requestModifiers removeObjectForKey:accountId];
+    }
+
+    // Running requests are finished, the session is released afterwards
+    [apiSessionManager invalidateSessionCancelingTasks:NO resetSession:NO];
+}
+
+- (NCAPISessionManager *)apiSessionManagerForAccount:(TalkAccount *)account
+{
+    @synchronized (self) {
+        NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+        if (apiSessionManager) {
+            return apiSessionManager;
+        }
+
+        // Long-polling requests use the same session (see kLongPollingTimeoutInterval),
+        // so they share the connection with all other requests of the account (multiplexed when the server supports HTTP/2)
+        NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+        NSHTTPCookieStorage *cookieStorage = [NSHTTPCookieStorage sharedCookieStorageForGroupContainerIdentifier:account.accountId];
+        configuration.HTTPCookieStorage = cookieStorage;
+        apiSessionManager = [[NCAPISessionManager alloc] initWithSessionConfiguration:configuration];
+        [apiSessionManager.requestSerializer setValue:[self authHeaderForAccount:account] forHTTPHeaderField:@"Authorization"];
 
-    // As we can run max. 30s in the background, the default timeout should be lower than 30 to avoid being killed by the OS
-    [apiSessionManager.requestSerializer setTimeoutInterval:25];
-    [_apiSessionManagers setObject:apiSessionManager forKey:account.accountId];
+        // As we can run max. 30s in the background, the default timeout should be lower than 30 to avoid being killed by the OS
+        [apiSessionManager.requestSerializer setTimeoutInterval:25];
+        [_apiSessionManagers setObject:apiSessionManager forKey:account.accountId];
 
-    configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
-    cookieStorage = [NSHTTPCookieStorage sharedCookieStorageForGroupContainerIdentifier:account.accountId];
-    configuration.HTTPCookieStorage = cookieStorage;
-    apiSessionManager = [[NCAPISessionManager alloc] initWithSessionConfiguration:configuration];
-    [apiSessionManager.requestSerializer setValue:[self authHeaderForAccount:account] forHTTPHeaderField:@"Authorization"];
-    [_longPollingApiSessionManagers setObject:apiSessionManager forKey:account.accountId];
+        return apiSessionManager;
+    }
 }
 
 - (void)setupNCCommunicationForAccount:(TalkAccount *)account
@@ -155,19 +186,45 @@ NSInteger const kReceivedChatMessagesLimit = 100;
 
 - (NSString *)authHeaderForAccount:(TalkAccount *)account
 {
-    NSString *userTokenString = [NSString stringWithFormat:@"%@:%@", account.user, [[NCKeyChainController sharedInstance] tokenForAccountId:account.accountId]];
-    NSData *data = [userTokenString dataUsingEncoding:NSUTF8StringEncoding];
-    NSString *base64Encoded = [data base64EncodedStringWithOptions:0];
-    
-    return [[NSString alloc]initWithFormat:@"Basic %@",base64Encoded];
+    @synchronized (self) {
+        NSString *authHeader = [_authHeaders objectForKey:account.accountId];
+        if (authHeader) {
+            return authHeader;
+        }
+
+        NSString *userToken = [[NCKeyChainController sharedInstance] tokenForAccountId:account.accountId];
+        NSString *userTokenString = [NSString stringWithFormat:@"%@:%@", account.user, userToken];
+        NSData *data = [userTokenString dataUsingEncoding:NSUTF8StringEncoding];
+        NSString *base64Encoded = [data base64EncodedStringWithOptions:0];
+        authHeader = [[NSString alloc]initWithFormat:@"Basic %@",base64Encoded];
+
+        // Don't cache the header until the token is stored
+        if (userToken) {
+            [_authHeaders setObject:authHeader forKey:account.accountId];
+        }
+
+        return authHeader;
+    }
 }
 
 - (SDWebImageDownloaderRequestModifier *)getRequestModifierForAccount:(TalkAccount *)account
 {
-    NSMutableDictionary *headerDictionary = [[NSMutableDictionary alloc] init];
-    [headerDictionary setObject:[self authHeaderForAccount:account] forKey:@"Authorization"];
+    @synchronized (self) {
+        SDWebImageDownloaderRequestModifier *requestModifier = [_requestModifiers objectForKey:account.accountId];
+        if (requestModifier) {
+            return requestModifier;
+        }
+
+        NSMutableDictionary *headerDictionary = [[NSMutableDictionary alloc] init];
+        [headerDictionary setObject:[self authHeaderForAccount:account] forKey:@"Authorization"];
+        requestModifier = [[SDWebImageDownloaderRequestModifier alloc] initWithHeaders:headerDictionary];
+
+        if ([_authHeaders objectForKey:account.accountId]) {
+            [_requestModifiers setObject:requestModifier forKey:account.accountId];
+        }
 
-    return [[SDWebImageDownloaderRequestModifier alloc] initWithHeaders:headerDictionary];
+        return requestModifier;
+    }
 }
 
 - (NSInteger)conversationAPIVersionForAccount:(TalkAccount *)account
@@ -226,6 +283,11 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     return [NSString stringWithFormat:@"%@/files/%@", kDavEndpoint, account.userId];
 }
 
+- (NSString *)uploadsPathForAccount:(TalkAccount *)account
+{
+    return [NSString stringWithFormat:@"%@/uploads/%@", kDavEndpoint, account.userId];
+}
+
 - (NSString *)getRequestURLForEndpoint:(NSString *)endpoint withAPIVersion:(NSInteger)apiVersion forAccount:(TalkAccount *)account
 {
     return [NSString stringWithFormat:@"%@%@%@%ld/%@", account.server, kNCOCSAPIVersion, kNCSpreedAPIVersionBase, (long)apiVersion, endpoint];
@@ -240,7 +302,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSDictionary *parameters = @{@"location" : location,
                                  @"search" : phoneNumbers};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *responseContacts = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -278,7 +340,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
                                  @"shareTypes" : shareTypes
                                  };
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSArray *responseContacts = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         NSMutableArray *users = [[NSMutableArray alloc] initWithCapacity:responseContacts.count];
@@ -320,7 +382,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     if (serverCapabilities.userStatus && modifiedSince == 0) {
         URLString = [URLString stringByAppendingString:@"?includeStatus=true"];
     }
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nonnull responseObject) {
         NSArray *responseRooms = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         NSHTTPURLResponse *response = ((NSHTTPURLResponse *)[task response]);
@@ -349,7 +411,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger conversationAPIVersion = [self conversationAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:nil progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *roomDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         NSHTTPURLResponse *response = ((NSHTTPURLResponse *)[task response]);
@@ -380,7 +442,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     if (searchTerm.length > 0) {
         parameters = @{@"searchTerm" : searchTerm};
     }
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nonnull responseObject) {
         NSArray *responseRooms = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         NSMutableArray *parsedRooms = [NSMutableArray new];
@@ -420,7 +482,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         [parameters setObject:roomName forKey:@"roomName"];
     }
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSString *token = [[[responseObject objectForKey:@"ocs"] objectForKey:@"data"] objectForKey:@"token"];
         if (block) {
@@ -445,7 +507,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"roomName" : newName};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager PUT:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -468,7 +530,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger conversationAPIVersion = [self conversationAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:nil progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -491,7 +553,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger conversationAPIVersion = [self conversationAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -514,7 +576,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger conversationAPIVersion = [self conversationAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -538,7 +600,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"password" : password};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager PUT:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil, nil);
@@ -572,7 +634,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger conversationAPIVersion = [self conversationAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:nil progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *dataDictionary = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         NSString *sessionId = [dataDictionary objectForKey:@"sessionId"];
@@ -602,7 +664,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger conversationAPIVersion = [self conversationAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -625,7 +687,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger conversationAPIVersion = [self conversationAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:nil progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -648,7 +710,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger conversationAPIVersion = [self conversationAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -672,7 +734,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"level" : @(level)};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -696,7 +758,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"level" : @(enabled)};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -720,7 +782,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"state" : @(state)};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager PUT:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -751,7 +813,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         [parameters setObject:@(timer) forKey:@"timer"];
     }
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager PUT:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -775,7 +837,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"state" : @(state)};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager PUT:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -799,7 +861,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"scope" : @(scope)};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager PUT:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -823,7 +885,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"seconds" : @(messageExpiration)};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -848,7 +910,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger breakoutRoomsAPIVersion = [self breakoutRoomsAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:breakoutRoomsAPIVersion forAccount:account];
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:nil progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -871,7 +933,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger breakoutRoomsAPIVersion = [self breakoutRoomsAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:breakoutRoomsAPIVersion forAccount:account];
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -899,7 +961,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     if (serverCapabilities.userStatus) {
         URLString = [URLString stringByAppendingString:@"?includeStatus=true"];
     }
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:nil progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSArray *responseParticipants = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         NSMutableArray *participants = [[NSMutableArray alloc] initWithCapacity:responseParticipants.count];
@@ -974,7 +1036,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         [parameters setObject:type forKey:@"source"];
     }
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -998,7 +1060,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"attendeeId" : @(attendeeId)};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -1022,7 +1084,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"participant" : user};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -1046,7 +1108,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"participant" : guest};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -1069,7 +1131,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger conversationAPIVersion = [self conversationAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:conversationAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(0, nil);
@@ -1096,7 +1158,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         parameters = @{@"attendeeId" : user};
     }
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -1123,7 +1185,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         parameters = @{@"attendeeId" : moderator};
     }
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -1150,7 +1212,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         parameters = @{@"attendeeId" : participant};
     }
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -1175,7 +1237,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger callAPIVersion = [self callAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:callAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:nil progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSArray *responsePeers = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         NSMutableArray *peers = [[NSMutableArray alloc] initWithArray:responsePeers];
@@ -1205,7 +1267,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         [parameters setObject:@(silently) forKey:@"silent"];
     }
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil, 0);
@@ -1233,7 +1295,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         [parameters setObject:@(1) forKey:@"all"];
     }
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -1260,7 +1322,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         parameters = @{@"attendeeId" : participant};
     }
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -1293,15 +1355,10 @@ NSInteger const kReceivedChatMessagesLimit = 100;
                                  @"includeLastKnown" : include ? @(1) : @(0),
                                  @"markNotificationsAsRead" : markNotificationsAsRead ? @(1) : @(0)};
     
-    NCAPISessionManager *apiSessionManager;
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
+    NSTimeInterval timeoutInterval = timeout ? kLongPollingTimeoutInterval : apiSessionManager.requestSerializer.timeoutInterval;
 
-    if (timeout) {
-        apiSessionManager = [_longPollingApiSessionManagers objectForKey:account.accountId];
-    } else {
-        apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
-    }
-
-    NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
+    NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters timeoutInterval:timeoutInterval success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSArray *responseMessages = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         // Get X-Chat-Last-Given and X-Chat-Last-Common-Read headers
         NSHTTPURLResponse *response = ((NSHTTPURLResponse *)[task response]);
@@ -1349,12 +1406,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         [parameters setObject:@(silently) forKey:@"silent"];
     }
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
-    // Workaround: When sendChatMessage is called from Share Extension session managers are not initialized.
-    if (!apiSessionManager) {
-        [self initSessionManagers];
-        apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
-    }
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
 
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
@@ -1383,7 +1435,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
                                  @"includeStatus" : @(serverCapabilities.userStatus)
     };
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSArray *mentions = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         NSMutableArray *suggestions = [[NSMutableArray alloc] initWithArray:mentions];;
@@ -1407,7 +1459,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *endpoint = [NSString stringWithFormat:@"chat/%@/%ld", encodedToken, (long)messageId];
     NSInteger chatAPIVersion = [self chatAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:chatAPIVersion forAccount:account];
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *messageDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -1431,7 +1483,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *endpoint = [NSString stringWithFormat:@"chat/%@", encodedToken];
     NSInteger chatAPIVersion = [self chatAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:chatAPIVersion forAccount:account];
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *messageDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -1455,7 +1507,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *endpoint = [NSString stringWithFormat:@"chat/%@/share", encodedToken];
     NSInteger chatAPIVersion = [self chatAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:chatAPIVersion forAccount:account];
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:richObject progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -1478,7 +1530,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger chatAPIVersion = [self chatAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:chatAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"lastReadMessage" : @(lastReadMessage)};
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -1500,7 +1552,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *endpoint = [NSString stringWithFormat:@"chat/%@/read", encodedToken];
     NSInteger chatAPIVersion = [self chatAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:chatAPIVersion forAccount:account];
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -1527,7 +1579,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         [parameters setObject:@(limit) forKey:@"limit"];
     }
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *responseSharedItems = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         // Create dictionary [String: [NCChatMessage]]
@@ -1573,7 +1625,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         [parameters setObject:@(limit) forKey:@"limit"];
     }
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         id responseData = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         // Create array [NCChatMessage]
@@ -1619,7 +1671,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     if (from.length > 0) {
         [parameters setValue:from forKey:@"fromLanguage"];
     }
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *translationDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -1647,7 +1699,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger reactionsAPIVersion = [self reactionsAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:reactionsAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"reaction" : reaction};
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *reactionsDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -1672,7 +1724,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger reactionsAPIVersion = [self reactionsAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:reactionsAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"reaction" : reaction};
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *reactionsDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -1700,7 +1752,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     if (reaction) {
         parameters = @{@"reaction" : reaction};
     }
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *reactionsDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -1731,7 +1783,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
                                  @"resultMode" : @(resultMode),
                                  @"maxVotes" : @(maxVotes)
     };
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *pollDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         NCPoll *poll = [NCPoll initWithPollDictionary:pollDict];
@@ -1757,7 +1809,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger pollsAPIVersion = [self pollsAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:pollsAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:nil progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *pollDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         NCPoll *poll = [NCPoll initWithPollDictionary:pollDict];
@@ -1784,7 +1836,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:pollsAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"optionIds" : options};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *pollDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         NCPoll *poll = [NCPoll initWithPollDictionary:pollDict];
@@ -1810,7 +1862,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger pollsAPIVersion = [self pollsAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:pollsAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *pollDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         NCPoll *poll = [NCPoll initWithPollDictionary:pollDict];
@@ -1839,7 +1891,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:signalingAPIVersion forAccount:account];
     NSDictionary *parameters = @{@"messages" : messages};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -1862,7 +1914,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger signalingAPIVersion = [self signalingAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:signalingAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString
                                              parameters:nil progress:nil
                                                 success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
@@ -1887,7 +1939,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger signalingAPIVersion = [self signalingAPIVersionForAccount:account];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:signalingAPIVersion forAccount:account];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:nil progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *responseDict = responseObject;
         if (block) {
@@ -1919,7 +1971,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSDictionary *parameters = @{@"key" : @"read_status_privacy",
                                  @"value" : @(enabled)};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -1941,7 +1993,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSDictionary *parameters = @{@"key" : @"typing_privacy",
                                  @"value" : @(enabled)};
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -2009,12 +2061,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         }
     }
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
-    // Workaround: When shareFileOrFolderForAccount is called from Share Extension session managers are not initialized.
-    if (!apiSessionManager) {
-        [self initSessionManagers];
-        apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
-    }
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -2317,7 +2364,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         return nil;
     }
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:nil constructingBodyWithBlock:^(id<AFMultipartFormData> formData) {
         [formData appendPartWithFileData:imageData name:@"file" fileName:@"avatar.jpg" mimeType:@"image/jpeg"];
     } progress:nil success:^(NSURLSessionDataTask *task, id responseObject) {
@@ -2351,7 +2398,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         [parameters setValue:color forKey:@"color"];
     }
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -2375,7 +2422,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSInteger avatarAPIVersion = 1;
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:avatarAPIVersion forAccount:account];
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -2399,7 +2446,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [NSString stringWithFormat:@"%@/ocs/v2.php/hovercard/v1/%@", account.server, encodedUser];
     NSDictionary *parameters = @{@"format" : @"json"};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *actions = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -2442,7 +2489,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [NSString stringWithFormat:@"%@/ocs/v2.php/cloud/user", account.server];
     NSDictionary *parameters = @{@"format" : @"json"};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *profile = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -2464,7 +2511,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [NSString stringWithFormat:@"%@/ocs/v2.php/cloud/user/fields", account.server];
     NSDictionary *parameters = @{@"format" : @"json"};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSArray *editableFields = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -2488,7 +2535,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
                                  @"key" : field,
                                  @"value" : value};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager PUT:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil, 0);
@@ -2510,7 +2557,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [NSString stringWithFormat:@"%@/ocs/v2.php/apps/spreed/temp-user-avatar", account.server];
     NSData *imageData= UIImageJPEGRepresentation(image, 0.7);
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:nil constructingBodyWithBlock:^(id<AFMultipartFormData> formData) {
         [formData appendPartWithFileData:imageData name:@"files[]" fileName:@"avatar.jpg" mimeType:@"image/jpeg"];
     } progress:nil success:^(NSURLSessionDataTask *task, id responseObject) {
@@ -2532,7 +2579,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
 {
     NSString *URLString = [NSString stringWithFormat:@"%@/ocs/v2.php/apps/spreed/temp-user-avatar", account.server];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil, 0);
@@ -2644,7 +2691,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
 {
     NSString *URLString = [NSString stringWithFormat:@"%@/ocs/v2.php/apps/user_status/api/v1/user_status", account.server];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:nil progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *userStatus = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -2666,7 +2713,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [NSString stringWithFormat:@"%@/ocs/v2.php/apps/user_status/api/v1/user_status/status", account.server];
     NSDictionary *parameters = @{@"statusType" : status};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager PUT:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -2733,7 +2780,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [NSString stringWithFormat:@"%@/ocs/v1.php/cloud/capabilities", account.server];
     NSDictionary *parameters = @{@"format" : @"json"};
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *capabilities = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -2756,12 +2803,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
 {
     NSString *URLString = [NSString stringWithFormat:@"%@/ocs/v2.php/apps/notifications/api/v2/notifications/%ld", account.server, (long)notificationId];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
-    // Workaround: Just in case session managers are not initialized when called from NotificationService extension.
-    if (!apiSessionManager) {
-        [self initSessionManagers];
-        apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
-    }
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:nil progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *notification = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -2788,7 +2830,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         [request addValue:lastETag forHTTPHeaderField:@"If-None-Match"];
     }
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager dataTaskWithRequest:request completionHandler:^(NSURLResponse * _Nonnull response, id  _Nullable responseObject, NSError * _Nullable error) {
         if (!error) {
             NSArray *notifications = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
@@ -2823,7 +2865,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         }
     };
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
 
     if (action.actionType == NCNotificationActionTypeKNotificationActionTypeGet) {
         [apiSessionManager GET:action.actionLink parameters:nil progress:nil success:success failure:failure];
@@ -2854,7 +2896,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         @"ids" : notificationIds,
     };
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSArray *responseArray = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -2884,7 +2926,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
                                  @"proxyServer" : pushNotificationServer
                                  };
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *responseDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
         if (block) {
@@ -2905,7 +2947,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
 {
     NSString *URLString = [NSString stringWithFormat:@"%@/ocs/v2.php/apps/notifications/api/v2/push", account.server];
     
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -2971,7 +3013,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *URLString = [NSString stringWithFormat:@"%@/ocs/v2.php/references/resolve", account.server];
     NSDictionary *parameters = @{@"reference" : url};
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         NSDictionary *responseReferences = [[[responseObject objectForKey:@"ocs"] objectForKey:@"data"] objectForKey:@"references"];
         if (block) {
@@ -3012,7 +3054,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         @"status" : @(1)
     };
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -3034,7 +3076,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *endpoint = [NSString stringWithFormat:@"recording/%@", encodedToken];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:1 forAccount:account];
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -3060,7 +3102,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         @"timestamp" : timestamp
     };
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:parameters success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -3087,7 +3129,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         @"fileId" : fileId
     };
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -3117,7 +3159,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
         @"timestamp" : timestamp
     };
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager POST:URLString parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             block(nil);
@@ -3141,7 +3183,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *endpoint = [NSString stringWithFormat:@"chat/%@/%ld/reminder", encodedToken, (long)message.messageId];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:chatAPIVersion forAccount:account];
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager DELETE:URLString parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             NSDictionary *responseDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
@@ -3166,7 +3208,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
     NSString *endpoint = [NSString stringWithFormat:@"chat/%@/%ld/reminder", encodedToken, (long)message.messageId];
     NSString *URLString = [self getRequestURLForEndpoint:endpoint withAPIVersion:chatAPIVersion forAccount:account];
 
-    NCAPISessionManager *apiSessionManager = [_apiSessionManagers objectForKey:account.accountId];
+    NCAPISessionManager *apiSessionManager = [self apiSessionManagerForAccount:account];
     NSURLSessionDataTask *task = [apiSessionManager GET:URLString parameters:nil progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
         if (block) {
             NSDictionary *responseDict = [[responseObject objectForKey:@"ocs"] objectForKey:@"data"];
@@ -3224,6 +3266,7 @@ NSInteger const kReceivedChatMessagesLimit = 100;
 {
     if (statusCode == 401) {
         // App token has been revoked
+        [self removeAPISessionManagerForAccountId:account.accountId];
         NSDictionary *userInfo = [NSDictionary dictionaryWithObject:account.accountId forKey:@"accountId"];
         [[NSNotificationCenter defaultCenter] postNotificationName:NCTokenRevokedResponseReceivedNotification
                                                             object:self
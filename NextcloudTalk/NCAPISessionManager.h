@@ -27,4 +27,7 @@
 
 @property (nonatomic, strong) NSString *userAgent;
 
+// Same as GET:parameters:progress:success:failure:, but with a timeout that only applies to this request
+- (NSURLSessionDataTask *)GET:(NSString *)URLString parameters:(id)parameters timeoutInterval:(NSTimeInterval)timeoutInterval success:(void (^)(NSURLSessionDataTask *task, id responseObject))success failure:(void (^)(NSURLSessionDataTask *task, NSError *error))failure;
+
 @end
@@ -0,0 +1,54 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Changes between the stored copy of the address book and the current address book, based on the digests of the phone numbers
+@interface NCAddressBookDiff : NSObject
+
+@property (nonatomic, strong, readonly) NSSet<NSString *> *addedIdentifiers;
+// Contacts whose phone numbers changed, contacts that were only renamed don't need to be searched again
+@property (nonatomic, strong, readonly) NSSet<NSString *> *changedIdentifiers;
+@property (nonatomic, strong, readonly) NSSet<NSString *> *removedIdentifiers;
+
+// Both dictionaries map contact identifiers to the digest of their phone numbers
+- (instancetype)initWithStoredDigests:(NSDictionary<NSString *, NSString *> *)storedDigests
+                       currentDigests:(NSDictionary<NSString *, NSString *> *)currentDigests;
+
+// The order of the phone numbers in the address book doesn't matter for the server search
++ (NSString *)digestForPhoneNumbers:(NSArray<NSString *> *)phoneNumbers;
+
+// Contacts changed after the returned timestamp need to be searched in the server, 0 means a full sync of all contacts
++ (NSInteger)searchTimestampForLastContactSync:(NSInteger)lastContactSync forceSync:(BOOL)forceSync;
+
+// Stored matches that need to be removed after a search: a full sync replaces all matches,
+// an incremental sync only replaces the matches of the searched contacts
++ (NSSet<NSString *> *)staleMatchesInStoredMatches:(NSArray<NSString *> *)storedMatchIdentifiers
+                                    currentMatches:(NSArray<NSString *> *)currentMatchIdentifiers
+                              searchedIdentifiers:(NSArray<NSString *> *)searchedIdentifiers
+                                          fullSync:(BOOL)fullSync;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,97 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import "NCAddressBookDiff.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+@implementation NCAddressBookDiff
+
+- (instancetype)initWithStoredDigests:(NSDictionary<NSString *, NSString *> *)storedDigests currentDigests:(NSDictionary<NSString *, NSString *> *)currentDigests
+{
+    self = [super init];
+    if (self) {
+        NSMutableSet *addedIdentifiers = [NSMutableSet new];
+        NSMutableSet *changedIdentifiers = [NSMutableSet new];
+        NSMutableSet *removedIdentifiers = [NSMutableSet new];
+
+        [currentDigests enumerateKeysAndObjectsUsingBlock:^(NSString *identifier, NSString *digest, BOOL *stop) {
+            NSString *storedDigest = [storedDigests objectForKey:identifier];
+
+            if (!storedDigest) {
+                [addedIdentifiers addObject:identifier];
+            } else if (![storedDigest isEqualToString:digest]) {
+                [changedIdentifiers addObject:identifier];
+            }
+        }];
+
+        for (NSString *identifier in storedDigests) {
+            if (![currentDigests objectForKey:identifier]) {
+                [removedIdentifiers addObject:identifier];
+            }
+        }
+
+        _addedIdentifiers = addedIdentifiers;
+        _changedIdentifiers = changedIdentifiers;
+        _removedIdentifiers = removedIdentifiers;
+    }
+
+    return self;
+}
+
++ (NSString *)digestForPhoneNumbers:(NSArray<NSString *> *)phoneNumbers
+{
+    NSArray *sortedPhoneNumbers = [phoneNumbers sortedArrayUsingSelector:@selector(compare:)];
+    NSData *data = [[sortedPhoneNumbers componentsJoinedByString:@","] dataUsingEncoding:NSUTF8StringEncoding];
+    uint8_t digest[CC_SHA1_DIGEST_LENGTH];
+
+    // Same as [NCUtils sha1FromString:], so digests stored by older versions stay valid
+    CC_SHA1(data.bytes, (CC_LONG)data.length, digest);
+
+    NSMutableString *output = [NSMutableString stringWithCapacity:CC_SHA1_DIGEST_LENGTH * 2];
+    for (int i = 0; i < CC_SHA1_DIGEST_LENGTH; i++) {
+        [output appendFormat:@"%02x", digest[i]];
+    }
+
+    return output;
+}
+
++ (NSInteger)searchTimestampForLastContactSync:(NSInteger)lastContactSync forceSync:(BOOL)forceSync
+{
+    return forceSync ? 0 : MAX(lastContactSync, 0);
+}
+
++ (NSSet<NSString *> *)staleMatchesInStoredMatches:(NSArray<NSString *> *)storedMatchIdentifiers currentMatches:(NSArray<NSString *> *)currentMatchIdentifiers searchedIdentifiers:(NSArray<NSString *> *)searchedIdentifiers fullSync:(BOOL)fullSync
+{
+    NSMutableSet *staleMatches = [NSMutableSet setWithArray:storedMatchIdentifiers];
+
+    // Matches of contacts that were not searched are still valid
+    if (!fullSync) {
+        [staleMatches intersectSet:[NSSet setWithArray:searchedIdentifiers]];
+    }
+
+    [staleMatches minusSet:[NSSet setWithArray:currentMatchIdentifiers]];
+
+    return staleMatches;
+}
+
+@end
@@ -89,6 +89,7 @@ typedef void (^GetAudioEnabledStateCompletionBlock)(BOOL isEnabled);
 - (BOOL)isBackgroundBlurEnabled;
 - (void)enableBackgroundBlur:(BOOL)enable;
 - (void)stopCapturing;
+- (void)setVideoPaused:(BOOL)paused ofPeer:(NCPeerConnection *)peer;
 
 - (void)willSwitchToCall:(NSString *)token;
 
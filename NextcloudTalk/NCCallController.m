@@ -62,8 +62,9 @@ static NSString * const kNCVideoTrackKind = @"video";
 @property (nonatomic, assign) BOOL shouldRejoinCallUsingInternalSignaling;
 @property (nonatomic, assign) BOOL serverSupportsConversationPermissions;
 @property (nonatomic, assign) NSInteger joinCallAttempts;
-@property (nonatomic, strong) AVAudioRecorder *recorder;
+@property (nonatomic, strong) CallSpeakingMonitor *speakingMonitor;
 @property (nonatomic, strong) NSTimer *micAudioLevelTimer;
+@property (nonatomic, strong) NSTimer *captureLoadTimer;
 @property (nonatomic, assign) BOOL speaking;
 @property (nonatomic, assign) NSInteger userInCall;
 @property (nonatomic, assign) NSInteger userPermissions;
@@ -125,7 +126,7 @@ static NSString * const kNCVideoTrackKind = @"video";
             }
         }];
         
-        [self initRecorder];
+        [self initSpeakingMonitor];
     }
     
     return self;
@@ -168,6 +169,8 @@ static NSString * const kNCVideoTrackKind = @"video";
                 [self.delegate callControllerDidJoinCall:self];
                 [self getPeersForCall];
                 [self startMonitoringMicrophoneAudioLevel];
+                [self startSamplingCallStats];
+                [self startMonitoringCaptureLoad];
 
                 if ([self->_externalSignalingController isEnabled]) {
                     if ([self->_externalSignalingController hasMCU]) {
@@ -329,6 +332,8 @@ static NSString * const kNCVideoTrackKind = @"video";
     }];
     
     [self stopMonitoringMicrophoneAudioLevel];
+    [[CallStatsSampler shared] stopSampling];
+    [self stopMonitoringCaptureLoad];
     [_signalingController stopAllRequests];
     
     [_getPeersForCallTask cancel];
@@ -430,6 +435,7 @@ static NSString * const kNCVideoTrackKind = @"video";
 
         if (!enable) {
             self->_speaking = NO;
+            [self->_speakingMonitor reset];
             [self sendMessageToAllOfType:@"stoppedSpeaking" withPayload:nil];
         }
     }];
@@ -615,7 +621,8 @@ static NSString * const kNCVideoTrackKind = @"video";
 - (void)startMonitoringMicrophoneAudioLevel
 {
     dispatch_async(dispatch_get_main_queue(), ^{
-        self->_micAudioLevelTimer = [NSTimer scheduledTimerWithTimeInterval:1.0 target:self selector:@selector(checkMicAudioLevel) userInfo:nil repeats:YES];
+        // Audio source statistics are updated continuously, so speaking is detected within a few frames
+        self->_micAudioLevelTimer = [NSTimer scheduledTimerWithTimeInterval:0.1 target:self selector:@selector(checkMicAudioLevel) userInfo:nil repeats:YES];
     });
 }
 
@@ -624,50 +631,135 @@ static NSString * const kNCVideoTrackKind = @"video";
     dispatch_async(dispatch_get_main_queue(), ^{
         [self->_micAudioLevelTimer invalidate];
         self->_micAudioLevelTimer = nil;
-        [self->_recorder stop];
-        self->_recorder = nil;
     });
+
+    [[WebRTCCommon shared] dispatch:^{
+        [self->_speakingMonitor reset];
+    }];
 }
 
-- (void)initRecorder
+- (void)initSpeakingMonitor
 {
-    NSURL *url = [NSURL fileURLWithPath:@"/dev/null"];
-    
-    NSDictionary *settings = [NSDictionary dictionaryWithObjectsAndKeys:
-                              [NSNumber numberWithFloat: 44100.0],                 AVSampleRateKey,
-                              [NSNumber numberWithInt: kAudioFormatAppleLossless], AVFormatIDKey,
-                              [NSNumber numberWithInt: 0],                         AVNumberOfChannelsKey,
-                              [NSNumber numberWithInt: AVAudioQualityMax],         AVEncoderAudioQualityKey,
-                              nil];
-    
-    NSError *error;
-    
-    _recorder = [[AVAudioRecorder alloc] initWithURL:url settings:settings error:&error];
-    
-    if (_recorder) {
-        [_recorder prepareToRecord];
-        _recorder.meteringEnabled = YES;
-        [_recorder record];
-    } else {
-        NSLog(@"Failed initializing recorder.");
-    }
+    _speakingMonitor = [[CallSpeakingMonitor alloc] init];
+
+    __weak typeof(self) weakSelf = self;
+    _speakingMonitor.speakingChangedBlock = ^(BOOL speaking) {
+        __strong typeof(self) strongSelf = weakSelf;
+        if (!strongSelf || ![strongSelf isAudioEnabled] || strongSelf->_speaking == speaking) {
+            return;
+        }
+
+        strongSelf->_speaking = speaking;
+        [strongSelf sendMessageToAllOfType:speaking ? @"speaking" : @"stoppedSpeaking" withPayload:nil];
+    };
 }
 
 - (void)checkMicAudioLevel
 {
     [[WebRTCCommon shared] dispatch:^{
-        if ([self isAudioEnabled]) {
-            [self->_recorder updateMeters];
-            float averagePower = [self->_recorder averagePowerForChannel:0];
-
-            if (averagePower >= -50.0f && !self->_speaking) {
-                self->_speaking = YES;
-                [self sendMessageToAllOfType:@"speaking" withPayload:nil];
-            } else if (averagePower < -50.0f && self->_speaking) {
-                self->_speaking = NO;
-                [self sendMessageToAllOfType:@"stoppedSpeaking" withPayload:nil];
+        if (![self isAudioEnabled]) {
+            return;
+        }
+
+        NCPeerConnection *peerConnectionWrapper = [self peerConnectionSendingLocalTrackOfKind:kRTCMediaStreamTrackKindAudio];
+        RTCPeerConnection *peerConnection = peerConnectionWrapper.peerConnection;
+
+        for (RTCRtpSender *sender in peerConnection.senders) {
+            if (![sender.track.kind isEqualToString:kRTCMediaStreamTrackKindAudio]) {
+                continue;
+            }
+
+            [peerConnection statisticsForSender:sender completionHandler:^(RTCStatisticsReport * _Nonnull report) {
+                [[WebRTCCommon shared] dispatch:^{
+                    [self->_speakingMonitor processWithStatisticsReport:report];
+                }];
+            }];
+
+            break;
+        }
+    }];
+}
+
+- (NCPeerConnection *)peerConnectionSendingLocalTrackOfKind:(NSString *)kind
+{
+    // The local tracks are added to the publisher connection (MCU) or to every video peer connection,
+    // screensharing peer connections never have a local sender
+    if (_publisherPeerConnection) {
+        return _publisherPeerConnection;
+    }
+
+    for (NCPeerConnection *peerConnectionWrapper in [_connectionsDict allValues]) {
+        if (![peerConnectionWrapper.roomType isEqualToString:kRoomTypeVideo]) {
+            continue;
+        }
+
+        for (RTCRtpSender *sender in peerConnectionWrapper.peerConnection.senders) {
+            if ([sender.track.kind isEqualToString:kind]) {
+                return peerConnectionWrapper;
+            }
+        }
+    }
+
+    return nil;
+}
+
+#pragma mark - Call statistics
+
+- (void)startSamplingCallStats
+{
+    __weak typeof(self) weakSelf = self;
+    [[CallStatsSampler shared] startSamplingWithPeerConnectionsBlock:^NSDictionary<NSString *, NCPeerConnection *> *{
+        return [weakSelf.connectionsDict copy] ?: @{};
+    }];
+}
+
+#pragma mark - Capture load
+
+- (void)startMonitoringCaptureLoad
+{
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self->_captureLoadTimer invalidate];
+        self->_captureLoadTimer = [NSTimer scheduledTimerWithTimeInterval:5 target:self selector:@selector(checkCaptureLoad) userInfo:nil repeats:YES];
+    });
+}
+
+- (void)stopMonitoringCaptureLoad
+{
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self->_captureLoadTimer invalidate];
+        self->_captureLoadTimer = nil;
+    });
+}
+
+- (void)checkCaptureLoad
+{
+    [[WebRTCCommon shared] dispatch:^{
+        if (!self->_cameraController || ![self->_localVideoTrack isEnabled]) {
+            return;
+        }
+
+        // Every remote video peer adds an encoder (without MCU) or a decoder (with MCU) to the load
+        NSInteger subscriberCount = 0;
+        for (NCPeerConnection *peerConnectionWrapper in [self->_connectionsDict allValues]) {
+            if (!peerConnectionWrapper.isMCUPublisherPeer && [peerConnectionWrapper.roomType isEqualToString:kRoomTypeVideo]) {
+                subscriberCount += 1;
             }
         }
+
+        NCPeerConnection *peerConnectionWrapper = [self peerConnectionSendingLocalTrackOfKind:kRTCMediaStreamTrackKindVideo];
+        RTCPeerConnection *peerConnection = peerConnectionWrapper.peerConnection;
+
+        for (RTCRtpSender *sender in peerConnection.senders) {
+            if (![sender.track.kind isEqualToString:kRTCMediaStreamTrackKindVideo]) {
+                continue;
+            }
+
+            [peerConnection statisticsForSender:sender completionHandler:^(RTCStatisticsReport * _Nonnull report) {
+                [self->_cameraController updateCaptureLoadWithStatisticsReport:report subscriberCount:subscriberCount];
+            }];
+
+            break;
+        }
     }];
 }
 
@@ -919,6 +1011,18 @@ static NSString * const kNCVideoTrackKind = @"video";
     });
 }
 
+- (void)setVideoPaused:(BOOL)paused ofPeer:(NCPeerConnection *)peer
+{
+    [[WebRTCCommon shared] dispatch:^{
+        // Without MCU the video is sent directly by the peer, so it can't be paused
+        if (![self->_externalSignalingController hasMCU] || peer.isMCUPublisherPeer) {
+            return;
+        }
+
+        [self->_externalSignalingController selectStream:@{@"video": @(!paused)} forSessionId:peer.peerId andRoomType:peer.roomType];
+    }];
+}
+
 - (void)requestNewOffer:(NSTimer *)timer
 {
     [[WebRTCCommon shared] dispatch:^{
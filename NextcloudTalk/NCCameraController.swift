@@ -43,16 +43,26 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
 
     // AVFoundation
     private var session: AVCaptureSession?
+    // Session setup, camera switches and format changes, also protects the format governor
+    private let sessionQueue = DispatchQueue(label: "com.nextcloud.Talk.cameraSession", qos: .userInitiated)
 
     // WebRTC
     private var videoSource: RTCVideoSource
     private var videoCapturer: RTCVideoCapturer
     private let framerateLimit = 30.0
 
+    // Capture format, only used on the session queue
+    private var formatGovernor: CaptureFormatGovernor
+    private let frameDropCounter = EncoderFrameDropCounter()
+    private var lastDroppedFrameRatio = 0.0
+    private var lastSubscriberCount = 0
+
     // Vision
     private let requestHandler = VNSequenceRequestHandler()
-    private var facePoseRequest: VNDetectFaceRectanglesRequest!
     private var segmentationRequest: VNGeneratePersonSegmentationRequest!
+    private let maskScheduler = BlurMaskScheduler()
+    // Mask used for the composite, smoothed over the last segmentations
+    private var smoothedMask: CVPixelBuffer?
 
     // Metal
     private var metalDevice: MTLDevice!
@@ -79,6 +89,11 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
         self.videoSource = videoSource
         self.videoCapturer = videoCapturer
 
+        let settings = NCSettingsController.sharedInstance().videoSettingsModel
+        let targetWidth = settings?.currentVideoResolutionWidthFromStore() ?? 0
+        let targetHeight = settings?.currentVideoResolutionHeightFromStore() ?? 0
+        self.formatGovernor = CaptureFormatGovernor(ladder: CaptureFormatGovernor.ladder(maxWidth: targetWidth, maxHeight: targetHeight, maxFps: framerateLimit))
+
         super.init()
 
         initMetal()
@@ -86,6 +101,7 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
         initAVCaptureSession()
 
         NotificationCenter.default.addObserver(self, selector: #selector(deviceOrientationDidChangeNotification), name: UIDevice.orientationDidChangeNotification, object: nil)
+        NotificationCenter.default.addObserver(self, selector: #selector(thermalStateDidChangeNotification), name: ProcessInfo.thermalStateDidChangeNotification, object: nil)
         self.updateVideoRotationBasedOnDeviceOrientation()
     }
 
@@ -101,10 +117,6 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
     }
 
     func initVisionRequests() {
-        // Create a request to detect face rectangles.
-        facePoseRequest = VNDetectFaceRectanglesRequest()
-        facePoseRequest.revision = VNDetectFaceRectanglesRequestRevision3
-
         // Create a request to segment a person from an image.
         segmentationRequest = VNGeneratePersonSegmentationRequest()
         segmentationRequest.qualityLevel = .balanced
@@ -112,35 +124,38 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
     }
 
     func switchCamera() {
-        var newInput: AVCaptureDeviceInput
+        sessionQueue.async {
+            var newInput: AVCaptureDeviceInput
 
-        if self.usingFrontCamera {
-            newInput = getBackCameraInput()
-        } else {
-            newInput = getFrontCameraInput()
-        }
+            if self.usingFrontCamera {
+                newInput = self.getBackCameraInput()
+            } else {
+                newInput = self.getFrontCameraInput()
+            }
 
-        if let firstInput = session?.inputs.first {
-            session?.removeInput(firstInput)
-        }
+            if let firstInput = self.session?.inputs.first {
+                self.session?.removeInput(firstInput)
+            }
 
-        // Stop and restart the session to prevent a weird glitch when rotating our local view
-        self.session?.stopRunning()
-        self.session?.addInput(newInput)
+            // Stop and restart the session to prevent a weird glitch when rotating our local view
+            self.session?.stopRunning()
+            self.session?.addInput(newInput)
 
-        // We need to set the orientation again, because otherweise after switching the video is turned
-        self.session?.outputs.first?.connections.first?.videoOrientation = .portrait
-        self.session?.startRunning()
-        self.usingFrontCamera = !self.usingFrontCamera
+            // We need to set the orientation again, because otherweise after switching the video is turned
+            self.session?.outputs.first?.connections.first?.videoOrientation = .portrait
+            self.session?.startRunning()
+            self.usingFrontCamera = !self.usingFrontCamera
+        }
     }
 
     // See ARDCaptureController from the WebRTC project
     func getVideoFormat(for device: AVCaptureDevice) -> AVCaptureDevice.Format? {
-        let settings = NCSettingsController.sharedInstance().videoSettingsModel
         let formats = RTCCameraVideoCapturer.supportedFormats(for: device)
 
-        let targetWidth = settings?.currentVideoResolutionWidthFromStore() ?? 0
-        let targetHeight = settings?.currentVideoResolutionHeightFromStore() ?? 0
+        // The governor starts with the resolution from the settings and lowers it under load
+        let captureFormat = self.currentCaptureFormat()
+        let targetWidth = captureFormat.width
+        let targetHeight = captureFormat.height
         var selectedFormat: AVCaptureDevice.Format?
         var currentDiff = INT_MAX
 
@@ -165,7 +180,7 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
             maxFramerate = fmax(maxFramerate, fpsRange.maxFrameRate)
         }
 
-        return fmin(maxFramerate, framerateLimit)
+        return fmin(maxFramerate, self.currentCaptureFormat().fps)
     }
 
     func setFormat(for device: AVCaptureDevice) {
@@ -213,7 +228,7 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
     }
 
     func initAVCaptureSession() {
-        DispatchQueue.global(qos: .userInitiated).async { [weak self] in
+        sessionQueue.async { [weak self] in
             guard let self = self else { return }
             self.session = AVCaptureSession()
 
@@ -236,7 +251,61 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
     }
 
     public func stopAVCaptureSession() {
-        self.session?.stopRunning()
+        sessionQueue.async {
+            self.session?.stopRunning()
+        }
+    }
+
+    // MARK: - Capture format
+
+    func currentCaptureFormat() -> CaptureFormat {
+        dispatchPrecondition(condition: .onQueue(sessionQueue))
+
+        return formatGovernor.currentFormat
+    }
+
+    /// Passes the current load to the capture format governor and switches the format of the camera, if needed.
+    /// The report needs to contain the statistics of the local video sender.
+    public func updateCaptureLoad(statisticsReport: RTCStatisticsReport, subscriberCount: Int) {
+        let report = CallStatsSampler.plainReport(from: statisticsReport)
+
+        sessionQueue.async {
+            self.lastDroppedFrameRatio = self.frameDropCounter.droppedFrameRatio(from: report)
+            self.lastSubscriberCount = subscriberCount
+            self.observeCaptureLoad()
+        }
+    }
+
+    private func observeCaptureLoad() {
+        dispatchPrecondition(condition: .onQueue(sessionQueue))
+
+        let observation = CaptureLoadObservation(timestamp: ProcessInfo.processInfo.systemUptime,
+                                                 thermalState: NCCameraController.captureThermalState(for: ProcessInfo.processInfo.thermalState),
+                                                 droppedFrameRatio: lastDroppedFrameRatio,
+                                                 subscriberCount: lastSubscriberCount)
+
+        guard let captureFormat = formatGovernor.observe(observation) else { return }
+
+        NCUtils.log(String(format: "Switching capture format to %dx%d@%.0f", captureFormat.width, captureFormat.height, captureFormat.fps))
+
+        if let device = (self.session?.inputs.first as? AVCaptureDeviceInput)?.device {
+            self.setFormat(for: device)
+        }
+    }
+
+    private class func captureThermalState(for thermalState: ProcessInfo.ThermalState) -> CaptureThermalState {
+        switch thermalState {
+        case .nominal:
+            return .nominal
+        case .fair:
+            return .fair
+        case .serious:
+            return .serious
+        case .critical:
+            return .critical
+        @unknown default:
+            return .nominal
+        }
     }
 
     // MARK: - Public switches
@@ -266,9 +335,18 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
         let scaleY = originalImage.extent.height / maskImage.extent.height
         maskImage = maskImage.transformed(by: .init(scaleX: scaleX, y: scaleY))
 
+        // Blur a downscaled image and scale it back up, the blurred background doesn't need the full resolution
+        let blurScale = BlurMaskScheduler.blurScale
+        let blurSigma = BlurMaskScheduler.scaledBlurSigma(8)
+
         // Use "clampedToExtent()" to prevent black borders after applying the gaussian blur
         // Make sure to crop the image back afterwards to its original size, otherwise the result is disorted
-        let backgroundImage = originalImage.clampedToExtent().applyingGaussianBlur(sigma: 8).cropped(to: originalImage.extent)
+        let backgroundImage = originalImage
+            .transformed(by: .init(scaleX: blurScale, y: blurScale))
+            .clampedToExtent()
+            .applyingGaussianBlur(sigma: blurSigma)
+            .transformed(by: .init(scaleX: 1 / blurScale, y: 1 / blurScale))
+            .cropped(to: originalImage.extent)
 
         // Blend the original, background, and mask images.
         let blendFilter = CIFilter.blendWithRedMask()
@@ -285,13 +363,25 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
         var frameImage = CIImage(cvPixelBuffer: framePixelBuffer)
 
         if self.backgroundBlurEnabled {
-            // Perform the requests on the pixel buffer that contains the video frame.
-            try? requestHandler.perform([facePoseRequest, segmentationRequest],
-                                        on: pixelBuffer,
-                                        orientation: .right)
+            let lumaSignature = self.lumaSignature(of: pixelBuffer)
+
+            if maskScheduler.shouldSegment(frameWithLumaSignature: lumaSignature) {
+                // Perform the request on the pixel buffer that contains the video frame.
+                try? requestHandler.perform([segmentationRequest],
+                                            on: pixelBuffer,
+                                            orientation: .right)
+
+                if let segmentationMask = segmentationRequest.results?.first?.pixelBuffer {
+                    self.updateSmoothedMask(with: segmentationMask)
+                } else {
+                    // Try again with the next frame
+                    maskScheduler.reset()
+                    smoothedMask = nil
+                }
+            }
 
             // Get the pixel buffer that contains the mask image.
-            guard let maskPixelBuffer = segmentationRequest.results?.first?.pixelBuffer else {
+            guard let maskPixelBuffer = smoothedMask else {
                 return
             }
 
@@ -300,6 +390,10 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
                 context.render(newImage, to: pixelBuffer)
                 frameImage = newImage
             }
+        } else if smoothedMask != nil {
+            // Don't reuse an old mask when the blur is enabled again
+            maskScheduler.reset()
+            smoothedMask = nil
         }
 
         self.lastImage = frameImage
@@ -323,6 +417,60 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
         }
     }
 
+    func lumaSignature(of pixelBuffer: CVPixelBuffer) -> [UInt8]? {
+        let pixelFormat = CVPixelBufferGetPixelFormatType(pixelBuffer)
+
+        guard pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange || pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange else {
+            return nil
+        }
+
+        CVPixelBufferLockBaseAddress(pixelBuffer, .readOnly)
+        defer { CVPixelBufferUnlockBaseAddress(pixelBuffer, .readOnly) }
+
+        guard let lumaPlane = CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 0) else {
+            return nil
+        }
+
+        return BlurMaskScheduler.lumaSignature(of: lumaPlane,
+                                               width: CVPixelBufferGetWidthOfPlane(pixelBuffer, 0),
+                                               height: CVPixelBufferGetHeightOfPlane(pixelBuffer, 0),
+                                               bytesPerRow: CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 0))
+    }
+
+    func updateSmoothedMask(with segmentationMask: CVPixelBuffer) {
+        let width = CVPixelBufferGetWidth(segmentationMask)
+        let height = CVPixelBufferGetHeight(segmentationMask)
+        var smoothingFactor = maskScheduler.maskSmoothingFactor
+
+        // The segmentation mask is owned by Vision and might be reused, so we keep our own copy
+        let hasMatchingMask = smoothedMask.map { CVPixelBufferGetWidth($0) == width && CVPixelBufferGetHeight($0) == height } ?? false
+
+        if !hasMatchingMask {
+            let attributes = [kCVPixelBufferIOSurfacePropertiesKey: [:]] as CFDictionary
+            var newMask: CVPixelBuffer?
+
+            CVPixelBufferCreate(kCFAllocatorDefault, width, height, kCVPixelFormatType_OneComponent8, attributes, &newMask)
+            smoothedMask = newMask
+
+            // Nothing to smooth with, take the new mask as it is
+            smoothingFactor = 1
+        }
+
+        guard let smoothedMask else { return }
+
+        CVPixelBufferLockBaseAddress(segmentationMask, .readOnly)
+        CVPixelBufferLockBaseAddress(smoothedMask, [])
+
+        if let maskBaseAddress = CVPixelBufferGetBaseAddress(smoothedMask), let segmentationBaseAddress = CVPixelBufferGetBaseAddress(segmentationMask) {
+            BlurMaskScheduler.smoothMask(maskBaseAddress, bytesPerRow: CVPixelBufferGetBytesPerRow(smoothedMask),
+                                         towards: segmentationBaseAddress, newMaskBytesPerRow: CVPixelBufferGetBytesPerRow(segmentationMask),
+                                         width: width, height: height, factor: smoothingFactor)
+        }
+
+        CVPixelBufferUnlockBaseAddress(smoothedMask, [])
+        CVPixelBufferUnlockBaseAddress(segmentationMask, .readOnly)
+    }
+
     // MARK: - AVCaptureVideoDataOutputSampleBufferDelegate
 
     func captureOutput(_ output: AVCaptureOutput, didOutput sampleBuffer: CMSampleBuffer, from connection: AVCaptureConnection) {
@@ -390,6 +538,12 @@ class NCCameraController: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate
         self.updateVideoRotationBasedOnDeviceOrientation()
     }
 
+    func thermalStateDidChangeNotification() {
+        sessionQueue.async {
+            self.observeCaptureLoad()
+        }
+    }
+
     func updateVideoRotationBasedOnDeviceOrientation() {
         // Handle video rotation based on device orientation
         if deviceOrientation == .portrait {
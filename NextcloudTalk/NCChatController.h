@@ -57,7 +57,7 @@ extern NSString * const NCChatControllerDidReceiveMessagesInBackgroundNotificati
 - (void)getHistoryBatchOfflineFromMessagesId:(NSInteger)messageId;
 - (BOOL)hasOlderStoredMessagesThanMessageId:(NSInteger)messageId;
 - (void)checkForNewMessagesFromMessageId:(NSInteger)messageId;
-- (void)updateHistoryInBackgroundWithCompletionBlock:(UpdateHistoryInBackgroundCompletionBlock)block;
+- (NSURLSessionDataTask *)updateHistoryInBackgroundWithCompletionBlock:(UpdateHistoryInBackgroundCompletionBlock)block;
 - (void)startReceivingNewChatMessages;
 - (void)stopReceivingNewChatMessages;
 - (void)stopChatController;
@@ -26,6 +26,8 @@
 #import "NCChatBlock.h"
 #import "NCDatabaseManager.h"
 #import "NCIntentController.h"
+#import "NCLogger.h"
+#import "NCReadModelCache.h"
 #import "NCRoomsManager.h"
 
 #import "NextcloudTalk-Swift.h"
@@ -58,7 +60,8 @@ NSString * const NCChatControllerDidReceiveMessagesInBackgroundNotification
 {
     self = [super init];
     if (self) {
-        _room = room;
+        // Rooms returned by the rooms manager are shared snapshots, we need our own copy as we modify it
+        _room = [[NCRoom alloc] initWithValue:room];
         _account = [[NCDatabaseManager sharedInstance] talkAccountForAccountId:_room.accountId];
     }
     
@@ -69,16 +72,19 @@ NSString * const NCChatControllerDidReceiveMessagesInBackgroundNotification
 
 - (NSArray *)chatBlocksForRoom
 {
-    RLMResults *managedBlocks = [NCChatBlock objectsWhere:@"internalId = %@", _room.internalId];
-    RLMResults *managedSortedBlocks = [managedBlocks sortedResultsUsingKeyPath:@"newestMessageId" ascending:YES];
-    // Create an unmanaged copy of the blocks
-    NSMutableArray *sortedBlocks = [NSMutableArray new];
-    for (NCChatBlock *managedBlock in managedSortedBlocks) {
-        NCChatBlock *sortedBlock = [[NCChatBlock alloc] initWithValue:managedBlock];
-        [sortedBlocks addObject:sortedBlock];
-    }
-    
-    return sortedBlocks;
+    NSString *snapshotKey = [NSString stringWithFormat:@"chatBlocks-%@", _room.internalId];
+    return [[NCReadModelCache sharedInstance] snapshotForKey:snapshotKey createdWithBlock:^id{
+        RLMResults *managedBlocks = [NCChatBlock objectsWhere:@"internalId = %@", self->_room.internalId];
+        RLMResults *managedSortedBlocks = [managedBlocks sortedResultsUsingKeyPath:@"newestMessageId" ascending:YES];
+        // Create an unmanaged copy of the blocks
+        NSMutableArray *sortedBlocks = [NSMutableArray new];
+        for (NCChatBlock *managedBlock in managedSortedBlocks) {
+            NCChatBlock *sortedBlock = [[NCChatBlock alloc] initWithValue:managedBlock];
+            [sortedBlocks addObject:sortedBlock];
+        }
+
+        return [sortedBlocks copy];
+    }];
 }
 
 - (NSArray *)getBatchOfMessagesInBlock:(NCChatBlock *)chatBlock fromMessageId:(NSInteger)messageId included:(BOOL)included
@@ -118,6 +124,8 @@ NSString * const NCChatControllerDidReceiveMessagesInBackgroundNotification
 }
 
 - (void)storeMessages:(NSArray *)messages withRealm:(RLMRealm *)realm {
+    NSMutableArray *messagesToIndex = [NSMutableArray new];
+
     // Add or update messages
     for (NSDictionary *messageDict in messages) {
         NCChatMessage *message = [NCChatMessage messageWithDictionary:messageDict andAccountId:_account.accountId];
@@ -144,7 +152,18 @@ NSString * const NCChatControllerDidReceiveMessagesInBackgroundNotification
         } else if (parent) {
             [realm addObject:parent];
         }
+
+        if (message) {
+            [messagesToIndex addObject:message];
+        }
+
+        if (parent) {
+            [messagesToIndex addObject:parent];
+        }
     }
+
+    // Keep the local search index up to date with the stored messages
+    [[ChatMessageSearchIndex shared] indexWithMessages:messagesToIndex];
 }
 
 - (void)storeMessages:(NSArray *)messages
@@ -169,6 +188,8 @@ NSString * const NCChatControllerDidReceiveMessagesInBackgroundNotification
         [realm deleteObjects:[NCChatMessage objectsWithPredicate:query]];
         [realm deleteObjects:[NCChatBlock objectsWithPredicate:query]];
     }];
+
+    [[ChatMessageSearchIndex shared] removeMessagesForAccountId:_account.accountId token:_room.token];
 }
 
 - (void)removeExpiredMessages
@@ -344,7 +365,7 @@ NSString * const NCChatControllerDidReceiveMessagesInBackgroundNotification
     return sortedMessages;
 }
 
-- (void)updateHistoryInBackgroundWithCompletionBlock:(UpdateHistoryInBackgroundCompletionBlock)block
+- (NSURLSessionDataTask *)updateHistoryInBackgroundWithCompletionBlock:(UpdateHistoryInBackgroundCompletionBlock)block
 {
     // If there's a pull task running right now, we should not interfere with that
     if (_pullMessagesTask && _pullMessagesTask.state == NSURLSessionTaskStateRunning) {
@@ -353,7 +374,7 @@ NSString * const NCChatControllerDidReceiveMessagesInBackgroundNotification
             block(error);
         }
 
-        return;
+        return nil;
     }
 
     NCChatBlock *lastChatBlock = [self chatBlocksForRoom].lastObject;
@@ -404,6 +425,8 @@ NSString * const NCChatControllerDidReceiveMessagesInBackgroundNotification
 
         [bgTask stopBackgroundTask];
     }];
+
+    return _pullMessagesTask;
 }
 
 - (void)checkForNewMessagesFromMessageId:(NSInteger)messageId
@@ -683,9 +706,11 @@ NSString * const NCChatControllerDidReceiveMessagesInBackgroundNotification
 - (void)sendChatMessage:(NSString *)message replyTo:(NSInteger)replyTo referenceId:(NSString *)referenceId silently:(BOOL)silently
 {
     BGTaskHelper *bgTask = [BGTaskHelper startBackgroundTaskWithName:@"NCChatControllerSendMessage" expirationHandler:^(BGTaskHelper *task) {
-        [NCUtils log:@"ExpirationHandler called - sendChatMessage"];
+        [NCUtils log:@"ExpirationHandler called - sendChatMessage" subsystem:@"chat" accountId:self->_account.accountId roomToken:self->_room.token latency:kNCLoggerNoLatency];
     }];
 
+    CFAbsoluteTime sendStartTime = CFAbsoluteTimeGetCurrent();
+
     NSMutableDictionary *userInfo = [NSMutableDictionary new];
     [userInfo setObject:message forKey:@"message"];
 
@@ -727,7 +752,11 @@ NSString * const NCChatControllerDidReceiveMessagesInBackgroundNotification
                 }
             }
 
-            [NCUtils log:[NSString stringWithFormat:@"Could not send chat message. Error: %@", error.description]];
+            [NCUtils log:[NSString stringWithFormat:@"Could not send chat message. Error: %@", error.description]
+               subsystem:@"chat"
+               accountId:self->_account.accountId
+               roomToken:self->_room.token
+                 latency:CFAbsoluteTimeGetCurrent() - sendStartTime];
         } else {
             [[NCIntentController sharedInstance] donateSendMessageIntentForRoom:self->_room];
         }
@@ -0,0 +1,40 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import "NCChatFileCacheEntry.h"
+
+@implementation NCChatFileCacheEntry
+
++ (NSString *)primaryKey {
+    return @"internalId";
+}
+
++ (NSArray<NSString *> *)indexedProperties {
+    return @[@"accountId", @"lastAccess"];
+}
+
++ (NSString *)internalIdForFileId:(NSString *)fileId andAccountId:(NSString *)accountId
+{
+    return [NSString stringWithFormat:@"%@@%@", accountId, fileId];
+}
+
+@end
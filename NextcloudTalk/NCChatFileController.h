@@ -37,6 +37,11 @@ extern NSString * const NCChatFileControllerDidChangeDownloadProgressNotificatio
 - (void)fileControllerDidLoadFile:(NCChatFileController *)fileController withFileStatus:(NCChatFileStatus *)fileStatus;
 - (void)fileControllerDidFailLoadingFile:(NCChatFileController *)fileController withErrorDescription:(NSString *)errorDescription;
 
+@optional
+// Called for large files that are not cached yet, the partial file is filled sequentially and can be used to play media
+// while the file is downloaded. Download progress notifications tell how much of it is available.
+- (void)fileControllerCanStreamFile:(NCChatFileController *)fileController withFileStatus:(NCChatFileStatus *)fileStatus partialFilePath:(NSString *)partialFilePath;
+
 @end
 
 @interface NCChatFileController : NSObject
@@ -25,17 +25,27 @@
 @import NextcloudKit;
 
 #import "NCAPIController.h"
+#import "NCChatFileCacheEntry.h"
 #import "NCDatabaseManager.h"
 
+#import "NextcloudTalk-Swift.h"
+
 NSString * const NCChatFileControllerDidChangeIsDownloadingNotification     = @"NCChatFileControllerDidChangeIsDownloadingNotification";
 NSString * const NCChatFileControllerDidChangeDownloadProgressNotification  = @"NCChatFileControllerDidChangeDownloadProgressNotification";
 
-int const kNCChatFileControllerDeleteFilesOlderThanDays = 7;
+long long const kNCChatFileControllerCacheSizeLimit = 512 * 1024 * 1024;
+long long const kNCChatFileControllerStreamingThreshold = 10 * 1024 * 1024;
+
+// Disk usage per account, calculated once from the cache index and then kept up to date
+static NSMutableDictionary<NSString *, NSNumber *> *diskUsageForAccounts;
+// Accounts for which files that are not part of the cache index have already been removed in this process
+static NSMutableSet<NSString *> *cleanedUpAccounts;
 
 @interface NCChatFileController ()
 
 @property (nonatomic, strong) NCChatFileStatus *fileStatus;
-@property (nonatomic, strong) NSString *tempDirectoryPath;
+@property (nonatomic, strong) NSString *downloadDirectoryPath;
+@property (nonatomic, strong, nullable) FileDownloadEngine *downloadEngine;
 
 @end
 
@@ -46,39 +56,63 @@ int const kNCChatFileControllerDeleteFilesOlderThanDays = 7;
 {
     NSString *encodedAccountId = [account.accountId stringByAddingPercentEncodingWithAllowedCharacters:NSCharacterSet.URLHostAllowedCharacterSet];
     NSFileManager *fileManager = [NSFileManager defaultManager];
-    _tempDirectoryPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"/download/"];
-    _tempDirectoryPath = [_tempDirectoryPath stringByAppendingPathComponent:encodedAccountId];
+    // The temporary directory is purged by the system at any time, the cache index needs the files to stay around
+    NSString *cachesDirectoryPath = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+    _downloadDirectoryPath = [cachesDirectoryPath stringByAppendingPathComponent:@"/download/"];
+    _downloadDirectoryPath = [_downloadDirectoryPath stringByAppendingPathComponent:encodedAccountId];
     
-    NSLog(@"Directory for downloads: %@", _tempDirectoryPath);
+    NSLog(@"Directory for downloads: %@", _downloadDirectoryPath);
     
-    if (![fileManager fileExistsAtPath:_tempDirectoryPath]) {
+    if (![fileManager fileExistsAtPath:_downloadDirectoryPath]) {
         // Make sure our download directory exists
-        [fileManager createDirectoryAtPath:_tempDirectoryPath withIntermediateDirectories:YES attributes:nil error:nil];
+        [fileManager createDirectoryAtPath:_downloadDirectoryPath withIntermediateDirectories:YES attributes:nil error:nil];
     }
     
-    [self removeOldFilesFromCache:kNCChatFileControllerDeleteFilesOlderThanDays];
+    [self removeNotIndexedFilesForAccount:account];
 }
 
-- (void)removeOldFilesFromCache:(int)thresholdDays
+- (void)removeNotIndexedFilesForAccount:(TalkAccount *)account
 {
+    @synchronized (NCChatFileController.class) {
+        if (!cleanedUpAccounts) {
+            cleanedUpAccounts = [NSMutableSet new];
+        }
+
+        if ([cleanedUpAccounts containsObject:account.accountId]) {
+            return;
+        }
+
+        [cleanedUpAccounts addObject:account.accountId];
+    }
+
+    // Files are stored in a directory per fileId, everything else in the download directory is not tracked by the index
+    // (e.g. files downloaded by an older version), so we only need to look at the top level once
     NSFileManager *fileManager = [NSFileManager defaultManager];
-    NSDirectoryEnumerator *enumerator = [fileManager enumeratorAtPath:_tempDirectoryPath];
-    
-    NSDateComponents *dayComponent = [[NSDateComponents alloc] init];
-    dayComponent.day = -thresholdDays;
+    NSArray *contents = [fileManager contentsOfDirectoryAtPath:_downloadDirectoryPath error:nil];
+    NSMutableSet *indexedFileIds = [NSMutableSet new];
+    NSMutableArray *entriesWithoutFile = [NSMutableArray new];
 
-    NSDate *thresholdDate = [[NSCalendar currentCalendar] dateByAddingComponents:dayComponent toDate:[NSDate date] options:0];
-    NSString *file;
-    
-    while (file = [enumerator nextObject])
-    {
-        NSString *filePath = [_tempDirectoryPath stringByAppendingPathComponent:file];
-        NSDate *creationDate = [[fileManager attributesOfItemAtPath:filePath error:nil] fileCreationDate];
-        
-        if ([creationDate compare:thresholdDate] == NSOrderedAscending) {
-            NSLog(@"Deleting file from cache: %@", filePath);
-        
-            [fileManager removeItemAtPath:filePath error:nil];
+    for (NCChatFileCacheEntry *entry in [NCChatFileCacheEntry objectsWhere:@"accountId = %@", account.accountId]) {
+        [indexedFileIds addObject:entry.fileId];
+
+        // Files might have been removed by the system when running low on storage
+        if (![contents containsObject:entry.fileId]) {
+            [entriesWithoutFile addObject:entry];
+        }
+    }
+
+    for (NCChatFileCacheEntry *entry in entriesWithoutFile) {
+        [self removeCacheEntry:entry];
+    }
+
+    for (NSString *item in contents) {
+        // Keep partially downloaded files, so these downloads can be resumed
+        NSArray *itemContents = [fileManager contentsOfDirectoryAtPath:[_downloadDirectoryPath stringByAppendingPathComponent:item] error:nil];
+        BOOL hasPartialDownload = [[itemContents filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF ENDSWITH '.partinfo'"]] count] > 0;
+
+        if (![indexedFileIds containsObject:item] && !hasPartialDownload) {
+            NSLog(@"Deleting file from cache: %@", item);
+            [fileManager removeItemAtPath:[_downloadDirectoryPath stringByAppendingPathComponent:item] error:nil];
         }
     }
 }
@@ -88,9 +122,18 @@ int const kNCChatFileControllerDeleteFilesOlderThanDays = 7;
     NSFileManager *fileManager = [NSFileManager defaultManager];
     
     [self initDownloadDirectoryForAccount:account];
-    [fileManager removeItemAtPath:_tempDirectoryPath error:nil];
+    [fileManager removeItemAtPath:_downloadDirectoryPath error:nil];
+
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm transactionWithBlock:^{
+        [realm deleteObjects:[NCChatFileCacheEntry objectsWhere:@"accountId = %@", account.accountId]];
+    }];
+
+    @synchronized (NCChatFileController.class) {
+        [diskUsageForAccounts removeObjectForKey:account.accountId];
+    }
     
-    NSLog(@"Deleted download directory: %@", _tempDirectoryPath);
+    NSLog(@"Deleted download directory: %@", _downloadDirectoryPath);
 }
 
 - (void)clearDownloadDirectoryForAccount:(TalkAccount *)account
@@ -101,54 +144,145 @@ int const kNCChatFileControllerDeleteFilesOlderThanDays = 7;
 
 - (NSInteger)getDiskUsageForAccount:(TalkAccount *)account
 {
-    [self initDownloadDirectoryForAccount:account];
+    return (NSInteger)[self diskUsageForAccountId:account.accountId];
+}
 
-    NSFileManager *fileManager = [NSFileManager defaultManager];
-    NSDirectoryEnumerator *enumerator = [fileManager enumeratorAtPath:_tempDirectoryPath];
+#pragma mark - Cache index
+
+- (long long)diskUsageForAccountId:(NSString *)accountId
+{
+    @synchronized (NCChatFileController.class) {
+        if (!diskUsageForAccounts) {
+            diskUsageForAccounts = [NSMutableDictionary new];
+        }
+
+        NSNumber *diskUsage = [diskUsageForAccounts objectForKey:accountId];
+
+        if (!diskUsage) {
+            diskUsage = [[NCChatFileCacheEntry objectsWhere:@"accountId = %@", accountId] sumOfProperty:@"size"];
+            [diskUsageForAccounts setObject:diskUsage forKey:accountId];
+        }
 
-    NSString *file;
-    NSInteger folderSize = 0;
+        return diskUsage.longLongValue;
+    }
+}
+
+- (void)changeDiskUsageForAccountId:(NSString *)accountId by:(long long)bytes
+{
+    long long diskUsage = [self diskUsageForAccountId:accountId] + bytes;
 
-    while (file = [enumerator nextObject])
-    {
-        NSDictionary *fileAttributes = [[NSFileManager defaultManager] attributesOfItemAtPath:[_tempDirectoryPath stringByAppendingPathComponent:file] error:nil];
-        folderSize += [[fileAttributes objectForKey:NSFileSize] intValue];
+    @synchronized (NCChatFileController.class) {
+        [diskUsageForAccounts setObject:@(MAX(diskUsage, 0)) forKey:accountId];
     }
+}
 
-    return folderSize;
+- (NSString *)localPathForFileId:(NSString *)fileId withFileName:(NSString *)fileName
+{
+    // Files are stored by fileId, so a file shared in multiple conversations is only downloaded once
+    NSString *fileDirectory = [_downloadDirectoryPath stringByAppendingPathComponent:fileId];
+    return [fileDirectory stringByAppendingPathComponent:fileName];
 }
 
-- (BOOL)isFileInCache:(NSString *)filePath withModificationDate:(NSDate *)date withSize:(double)size
+- (BOOL)isFileInCache:(NKFile *)file forAccount:(TalkAccount *)account
 {
-    NSFileManager *fileManager = [NSFileManager defaultManager];
-    
-    if (![fileManager fileExistsAtPath:filePath]) {
+    NSString *internalId = [NCChatFileCacheEntry internalIdForFileId:_fileStatus.fileId andAccountId:account.accountId];
+    NCChatFileCacheEntry *entry = [NCChatFileCacheEntry objectForPrimaryKey:internalId];
+
+    if (!entry) {
         return NO;
     }
-    
-    NSError *error = nil;
-    NSDictionary<NSFileAttributeKey, id> *fileAttributes = [fileManager attributesOfItemAtPath:filePath error:&error];
-    
-    NSDate *modificationDate = [fileAttributes fileModificationDate];
-    long long fileSize = [fileAttributes fileSize];
-    
-    if ([date compare:modificationDate] == NSOrderedSame && fileSize == (long long)size) {
+
+    BOOL sameEtag = (entry.etag.length > 0 && [entry.etag isEqualToString:file.etag]);
+    BOOL sameModificationDate = ([entry.modificationDate isEqualToDate:file.date] && entry.size == (long long)file.size);
+    NSString *cachedFilePath = [self localPathForFileId:entry.fileId withFileName:entry.fileName];
+
+    if ((sameEtag || sameModificationDate) && [[NSFileManager defaultManager] fileExistsAtPath:cachedFilePath]) {
+        _fileStatus.fileLocalPath = cachedFilePath;
+
+        RLMRealm *realm = [RLMRealm defaultRealm];
+        [realm transactionWithBlock:^{
+            entry.lastAccess = [NSDate date];
+        }];
+
         return YES;
     }
-    
-    // At this point there's a file in our cache but there's a different one on the server
-    NSLog(@"Deleting file from cache: %@", filePath);
-    [fileManager removeItemAtPath:filePath error:nil];
-    
+
+    // At this point there's a file in our cache but there's a different one on the server (or it was removed by the system)
+    NSLog(@"Deleting file from cache: %@", cachedFilePath);
+    [self removeCacheEntry:entry];
+
     return NO;
 }
 
-- (void)setCreationDateOnFile:(NSString *)filePath withCreationDate:(NSDate *)date
+- (void)addFileToCache:(NKFile *)file withEtag:(nullable NSString *)etag forAccount:(TalkAccount *)account
 {
-    NSFileManager *fileManager = [NSFileManager defaultManager];
-    
-    NSDictionary *creationDateAttr = [NSDictionary dictionaryWithObjectsAndKeys:date, NSFileCreationDate, nil];
-    [fileManager setAttributes:creationDateAttr ofItemAtPath:filePath error:nil];
+    NSDictionary *fileAttributes = [[NSFileManager defaultManager] attributesOfItemAtPath:_fileStatus.fileLocalPath error:nil];
+
+    NCChatFileCacheEntry *entry = [[NCChatFileCacheEntry alloc] init];
+    entry.internalId = [NCChatFileCacheEntry internalIdForFileId:_fileStatus.fileId andAccountId:account.accountId];
+    entry.accountId = account.accountId;
+    entry.fileId = _fileStatus.fileId;
+    entry.fileName = _fileStatus.fileName;
+    entry.etag = etag.length > 0 ? etag : file.etag;
+    entry.modificationDate = file.date;
+    entry.size = [fileAttributes fileSize];
+    entry.lastAccess = [NSDate date];
+
+    NCChatFileCacheEntry *previousEntry = [NCChatFileCacheEntry objectForPrimaryKey:entry.internalId];
+    long long previousSize = previousEntry ? previousEntry.size : 0;
+
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm transactionWithBlock:^{
+        [realm addOrUpdateObject:entry];
+    }];
+
+    [self changeDiskUsageForAccountId:account.accountId by:entry.size - previousSize];
+    [self evictFilesForAccount:account keepingFileId:entry.fileId];
+}
+
+- (void)evictFilesForAccount:(TalkAccount *)account keepingFileId:(NSString *)fileId
+{
+    long long diskUsage = [self diskUsageForAccountId:account.accountId];
+
+    if (diskUsage <= kNCChatFileControllerCacheSizeLimit) {
+        return;
+    }
+
+    // Remove least recently used files until we are below our budget again, files that are in use are kept
+    RLMResults *entries = [[NCChatFileCacheEntry objectsWhere:@"accountId = %@ AND fileId != %@", account.accountId, fileId] sortedResultsUsingKeyPath:@"lastAccess" ascending:YES];
+    NSMutableDictionary<NSString *, NCChatFileCacheEntry *> *entriesForFilePaths = [NSMutableDictionary new];
+    NSMutableArray<NSString *> *filePaths = [NSMutableArray new];
+    NSMutableArray<NSNumber *> *sizes = [NSMutableArray new];
+
+    for (NCChatFileCacheEntry *entry in entries) {
+        NSString *filePath = [self localPathForFileId:entry.fileId withFileName:entry.fileName];
+        [entriesForFilePaths setObject:entry forKey:filePath];
+        [filePaths addObject:filePath];
+        [sizes addObject:@(entry.size)];
+    }
+
+    NSArray *filePathsToEvict = [ChatFileLease filePathsToEvict:filePaths withSizes:sizes diskUsage:diskUsage sizeLimit:kNCChatFileControllerCacheSizeLimit];
+
+    for (NSString *filePath in filePathsToEvict) {
+        NCChatFileCacheEntry *entry = [entriesForFilePaths objectForKey:filePath];
+        NSLog(@"Evicting file from cache: %@", entry.fileName);
+        [self removeCacheEntry:entry];
+    }
+}
+
+- (void)removeCacheEntry:(NCChatFileCacheEntry *)entry
+{
+    NSString *accountId = entry.accountId;
+    long long size = entry.size;
+
+    [[NSFileManager defaultManager] removeItemAtPath:[_downloadDirectoryPath stringByAppendingPathComponent:entry.fileId] error:nil];
+
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm transactionWithBlock:^{
+        [realm deleteObject:entry];
+    }];
+
+    [self changeDiskUsageForAccountId:accountId by:-size];
 }
 
 - (void)setModificationDateOnFile:(NSString *)filePath withModificationDate:(NSDate *)date
@@ -195,7 +329,7 @@ int const kNCChatFileControllerDeleteFilesOlderThanDays = 7;
     [self initDownloadDirectoryForAccount:activeAccount];
     
     NSString *serverUrlFileName = [NSString stringWithFormat:@"%@%@/%@", activeAccount.server, [[NCAPIController sharedInstance] filesPathForAccount:activeAccount], _fileStatus.filePath];
-    _fileStatus.fileLocalPath = [_tempDirectoryPath stringByAppendingPathComponent:_fileStatus.fileName];
+    _fileStatus.fileLocalPath = [self localPathForFileId:_fileStatus.fileId withFileName:_fileStatus.fileName];
     
     // Setting just isDownloading without a concrete progress will show an indeterminate activity indicator
     [self didChangeIsDownloadingNotification:YES];
@@ -207,7 +341,7 @@ int const kNCChatFileControllerDeleteFilesOlderThanDays = 7;
             // File exists on server -> check our cache
             NKFile *file = files.firstObject;
         
-            if ([self isFileInCache:self->_fileStatus.fileLocalPath withModificationDate:file.date withSize:file.size]) {
+            if ([self isFileInCache:file forAccount:activeAccount]) {
                 NSLog(@"Found file in cache: %@", self->_fileStatus.fileLocalPath);
                 
                 [self.delegate fileControllerDidLoadFile:self withFileStatus:self->_fileStatus];
@@ -215,26 +349,48 @@ int const kNCChatFileControllerDeleteFilesOlderThanDays = 7;
                 
                 return;
             }
-            [[NextcloudKit shared] downloadWithServerUrlFileName:serverUrlFileName fileNameLocalPath:self->_fileStatus.fileLocalPath customUserAgent:nil addCustomHeaders:nil queue:dispatch_get_main_queue() taskHandler:^(NSURLSessionTask *task) {
-                NSLog(@"Download task");
-            } progressHandler:^(NSProgress *progress) {
-                [self didChangeDownloadProgressNotification:progress.fractionCompleted];
-            } completionHandler:^(NSString *account, NSString *etag, NSDate *date, int64_t length, NSDictionary *allHeaderFields, NKError *error) {
-                if (error.errorCode == 0) {
-                    // Set modification date to invalidate our cache
+
+            // Make sure the directory for this fileId exists
+            NSString *fileDirectory = [self->_fileStatus.fileLocalPath stringByDeletingLastPathComponent];
+            [[NSFileManager defaultManager] createDirectoryAtPath:fileDirectory withIntermediateDirectories:YES attributes:nil error:nil];
+
+            // Large media files can already be played from the partial file while they are downloaded
+            BOOL canStreamFile = file.size >= kNCChatFileControllerStreamingThreshold && [FileDownloadEngine canStreamFileWithName:self->_fileStatus.fileName] && [self.delegate respondsToSelector:@selector(fileControllerCanStreamFile:withFileStatus:partialFilePath:)];
+
+            NSString *encodedServerUrlFileName = [serverUrlFileName stringByAddingPercentEncodingWithAllowedCharacters:NSCharacterSet.URLPathAllowedCharacterSet];
+            self->_downloadEngine = [[FileDownloadEngine alloc] initWithAccount:activeAccount];
+            self->_downloadEngine.allowsParallelSegments = !canStreamFile;
+
+            if (canStreamFile) {
+                // The index of some containers is stored at the end of the file, it's downloaded first
+                self->_downloadEngine.tailLength = [FileDownloadEngine streamingTailLengthForFileName:self->_fileStatus.fileName fileSize:file.size];
+            }
+
+            [self->_downloadEngine downloadFileFromURL:[NSURL URLWithString:encodedServerUrlFileName] toPath:self->_fileStatus.fileLocalPath fileSize:file.size etag:file.etag progressBlock:^(double fractionCompleted, double playableFraction) {
+                [self didChangeDownloadProgressNotification:fractionCompleted playableProgress:playableFraction];
+            } completionBlock:^(NSString *errorDescription) {
+                self->_downloadEngine = nil;
+
+                if (!errorDescription) {
+                    // Keep the modification date of the server file on the local copy
                     [self setModificationDateOnFile:self->_fileStatus.fileLocalPath withModificationDate:file.date];
 
-                    // Set creation date to delete older files from cache
-                    [self setCreationDateOnFile:self->_fileStatus.fileLocalPath withCreationDate:[NSDate date]];
+                    // Add the file to our cache index (this might evict older files)
+                    [self addFileToCache:file withEtag:file.etag forAccount:activeAccount];
 
                     [self.delegate fileControllerDidLoadFile:self withFileStatus:self->_fileStatus];
                 } else {
-                    NSLog(@"Error downloading file: %ld - %@", error.errorCode, error.errorDescription);
-                    [self.delegate fileControllerDidFailLoadingFile:self withErrorDescription:error.errorDescription];
+                    NSLog(@"Error downloading file: %@", errorDescription);
+                    [self.delegate fileControllerDidFailLoadingFile:self withErrorDescription:errorDescription];
                 }
 
                 [self didChangeIsDownloadingNotification:NO];
             }];
+
+            if (canStreamFile) {
+                NSString *partialFilePath = [FileDownloadEngine partialFilePathForLocalPath:self->_fileStatus.fileLocalPath];
+                [self.delegate fileControllerCanStreamFile:self withFileStatus:self->_fileStatus partialFilePath:partialFilePath];
+            }
         } else {
             [self didChangeIsDownloadingNotification:NO];
             
@@ -256,13 +412,14 @@ int const kNCChatFileControllerDeleteFilesOlderThanDays = 7;
                                                       userInfo:userInfo];
 }
 
-- (void)didChangeDownloadProgressNotification:(double)progress
+- (void)didChangeDownloadProgressNotification:(double)progress playableProgress:(double)playableProgress
 {
     _fileStatus.downloadProgress = progress;
     
     NSMutableDictionary *userInfo = [NSMutableDictionary new];
     [userInfo setObject:_fileStatus forKey:@"fileStatus"];
     [userInfo setObject:@(progress) forKey:@"progress"];
+    [userInfo setObject:@(playableProgress) forKey:@"playableProgress"];
     [[NSNotificationCenter defaultCenter] postNotificationName:NCChatFileControllerDidChangeDownloadProgressNotification
                                                         object:self
                                                       userInfo:userInfo];
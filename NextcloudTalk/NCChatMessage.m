@@ -816,7 +816,7 @@ NSString * const kSharedItemTypeRecording   = @"recording";
     } else {
         TalkAccount *account = [[NCDatabaseManager sharedInstance] talkAccountForAccountId:_accountId];
 
-        [[NCAPIController sharedInstance] getReferenceForUrlString:_urlDetected forAccount:account withCompletionBlock:^(NSDictionary *references, NSError *error) {
+        [[ReferenceDataCache shared] referencesForUrlString:_urlDetected account:account completionBlock:^(NSDictionary *references) {
             if (block) {
                 block(self, references, self->_urlDetected);
             }
@@ -0,0 +1,49 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^NCChatOutboxCompletionBlock)(void);
+
+/**
+ Sends the messages that could not be sent while being offline. The queued messages are the temporary
+ messages marked as offline messages in the database, so the outbox survives app restarts.
+ Messages of a room are sent strictly one after the other, different rooms are sent in parallel.
+ Send requests that arrive while sending are coalesced into a single follow-up run.
+ All methods need to be called on the main thread.
+ */
+@interface NCChatOutbox : NSObject
+
+// Maximum number of rooms sending messages at the same time
+@property (nonatomic, assign) NSInteger maxConcurrentRooms;
+
++ (instancetype)sharedInstance;
+
+// Pass a nil token to send the offline messages of all rooms
+- (void)sendOfflineMessagesForToken:(nullable NSString *)token withCompletionBlock:(nullable NCChatOutboxCompletionBlock)block;
+
+@end
+
+NS_ASSUME_NONNULL_END
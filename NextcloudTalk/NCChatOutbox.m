@@ -0,0 +1,381 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#import "NCChatOutbox.h"
+
+#import <Realm/Realm.h>
+
+#import "NCAPIController.h"
+#import "NCChatController.h"
+#import "NCChatMessage.h"
+#import "NCChatOutboxRetryPolicy.h"
+#import "NCChatOutboxSendQueue.h"
+#import "NCDatabaseManager.h"
+#import "NCIntentController.h"
+#import "NCLogger.h"
+#import "NCRoomsManager.h"
+#import "NCUtils.h"
+
+#import "NextcloudTalk-Swift.h"
+
+@interface NCChatOutbox ()
+
+@property (nonatomic, assign) BOOL isSending;
+@property (nonatomic, assign) BOOL allRoomsRequested;
+@property (nonatomic, strong) NSMutableSet<NSString *> *requestedTokens;
+@property (nonatomic, strong) NSMutableArray<NCChatOutboxCompletionBlock> *completionBlocks;
+@property (nonatomic, strong) NCChatOutboxRetryPolicy *retryPolicy;
+// The queue of the current run, queues of a previous (expired) run don't continue sending
+@property (nonatomic, strong) NCChatOutboxSendQueue *sendQueue;
+@property (nonatomic, assign) BOOL retryScheduled;
+@property (nonatomic, strong) BGTaskHelper *backgroundTask;
+
+@end
+
+@implementation NCChatOutbox
+
++ (instancetype)sharedInstance
+{
+    static dispatch_once_t once;
+    static NCChatOutbox *sharedInstance;
+    dispatch_once(&once, ^{
+        sharedInstance = [[self alloc] init];
+    });
+    return sharedInstance;
+}
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        _maxConcurrentRooms = 3;
+        _requestedTokens = [NSMutableSet new];
+        _completionBlocks = [NSMutableArray new];
+        _retryPolicy = [NCChatOutboxRetryPolicy new];
+    }
+
+    return self;
+}
+
+- (void)sendOfflineMessagesForToken:(NSString *)token withCompletionBlock:(NCChatOutboxCompletionBlock)block
+{
+    if (token) {
+        [_requestedTokens addObject:token];
+    } else {
+        _allRoomsRequested = YES;
+    }
+
+    if (block) {
+        [_completionBlocks addObject:block];
+    }
+
+    [self startNextRunIfPossible];
+}
+
+#pragma mark - Runs
+
+- (void)startNextRunIfPossible
+{
+    // Requests during a run are sent in the next run
+    if (_isSending) {
+        return;
+    }
+
+    if (!_allRoomsRequested && _requestedTokens.count == 0) {
+        [self callCompletionBlocks];
+        return;
+    }
+
+    NSTimeInterval remainingBackoff = [_retryPolicy remainingBackoffAtDate:[NSDate date]];
+
+    if (remainingBackoff > 0) {
+        // Don't send bursts of requests while sending keeps failing, the requests are kept for the retry
+        [self scheduleRetryAfter:remainingBackoff];
+        [self callCompletionBlocks];
+        return;
+    }
+
+    [self startRun];
+}
+
+- (void)scheduleRetryAfter:(NSTimeInterval)delay
+{
+    if (_retryScheduled) {
+        return;
+    }
+
+    _retryScheduled = YES;
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        self->_retryScheduled = NO;
+        [self startNextRunIfPossible];
+    });
+}
+
+- (void)startRun
+{
+    _isSending = YES;
+
+    NSMutableDictionary<NSString *, TalkAccount *> *accounts = [NSMutableDictionary new];
+
+    for (TalkAccount *account in [[NCDatabaseManager sharedInstance] allAccounts]) {
+        [accounts setObject:account forKey:account.accountId];
+    }
+
+    NCChatOutboxSendQueue *sendQueue = [[NCChatOutboxSendQueue alloc] initWithSendBlock:^NSURLSessionTask *(NCChatMessage *message, NCChatOutboxSendCompletionBlock completionBlock) {
+        TalkAccount *account = [accounts objectForKey:message.accountId];
+
+        return [[NCAPIController sharedInstance] sendChatMessage:message.sendingMessage toRoom:message.token displayName:nil replyTo:message.parentMessageId referenceId:message.referenceId silently:message.isSilent forAccount:account withCompletionBlock:^(NSError *error) {
+            completionBlock(error);
+        }];
+    }];
+
+    // The send queue doesn't outlive the run, but don't keep the outbox alive through it
+    __weak NCChatOutboxSendQueue *weakSendQueue = sendQueue;
+
+    sendQueue.maxConcurrentRooms = _maxConcurrentRooms;
+    sendQueue.messageSentBlock = ^(NCChatMessage *message, NSString *roomKey) {
+        [self markMessageAsSent:message];
+        [self postDidSendNotificationForMessage:message withError:nil isOfflineMessage:NO];
+
+        if (weakSendQueue.isCancelled) {
+            return;
+        }
+
+        NCRoom *room = [[NCRoomsManager sharedInstance] roomWithToken:message.token forAccountId:message.accountId];
+        if (room) {
+            [[NCIntentController sharedInstance] donateSendMessageIntentForRoom:room];
+        }
+    };
+    sendQueue.roomFailedBlock = ^(NSString *roomKey, NSArray<NCChatMessage *> *unsentMessages, NSError *error) {
+        [self storeFailedMessage:unsentMessages.firstObject withUnsentMessages:unsentMessages error:error];
+    };
+    sendQueue.finishedBlock = ^(BOOL hadFailures) {
+        [self finishRunWithFailures:hadFailures];
+    };
+
+    _sendQueue = sendQueue;
+
+    _backgroundTask = [BGTaskHelper startBackgroundTaskWithName:@"NCChatOutbox" expirationHandler:^(BGTaskHelper *task) {
+        [NCUtils log:@"ExpirationHandler called - NCChatOutbox"];
+
+        if (sendQueue == self->_sendQueue) {
+            [self expireRun];
+        }
+
+        [task stopBackgroundTask];
+    }];
+
+    NSPredicate *query;
+
+    if (_allRoomsRequested) {
+        query = [NSPredicate predicateWithFormat:@"isOfflineMessage = true"];
+    } else {
+        query = [NSPredicate predicateWithFormat:@"isOfflineMessage = true AND token IN %@", _requestedTokens.allObjects];
+    }
+
+    _allRoomsRequested = NO;
+    [_requestedTokens removeAllObjects];
+
+    NSDate *now = [NSDate date];
+    NSMutableArray<NCChatMessage *> *expiredMessages = [NSMutableArray new];
+    NSMutableSet<NSString *> *roomKeys = [NSMutableSet new];
+
+    // Messages stay marked as offline messages until they were sent, so they are not lost when the app is
+    // suspended or killed during a run. Runs don't overlap, so a message is never sent twice at the same time.
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm transactionWithBlock:^{
+        NSMutableArray<NCChatMessage *> *managedMessages = [NSMutableArray new];
+
+        for (NCChatMessage *managedMessage in [[NCChatMessage objectsWithPredicate:query] sortedResultsUsingKeyPath:@"timestamp" ascending:YES]) {
+            [managedMessages addObject:managedMessage];
+        }
+
+        for (NCChatMessage *managedMessage in managedMessages) {
+            if ([self->_retryPolicy isMessageExpiredWithTimestamp:managedMessage.timestamp atDate:now]) {
+                managedMessage.isOfflineMessage = NO;
+                managedMessage.sendingFailed = YES;
+                [expiredMessages addObject:[[NCChatMessage alloc] initWithValue:managedMessage]];
+                continue;
+            }
+
+            // Messages of accounts that were removed are not sent
+            if (![accounts objectForKey:managedMessage.accountId]) {
+                continue;
+            }
+
+            // Rooms with the oldest pending messages are sent first
+            NSString *roomKey = [NSString stringWithFormat:@"%@@%@", managedMessage.accountId, managedMessage.token];
+            [roomKeys addObject:roomKey];
+            [sendQueue addMessage:[[NCChatMessage alloc] initWithValue:managedMessage] forRoomKey:roomKey];
+        }
+    }];
+
+    for (NCChatMessage *expiredMessage in expiredMessages) {
+        NSError *error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorTimedOut userInfo:nil];
+        [self postDidSendNotificationForMessage:expiredMessage withError:error isOfflineMessage:NO];
+    }
+
+    if (expiredMessages.count > 0 || roomKeys.count > 0) {
+        [NCUtils log:[NSString stringWithFormat:@"Sending offline messages of %ld rooms, %ld messages expired", (long)roomKeys.count, (long)expiredMessages.count]];
+    }
+
+    [sendQueue start];
+}
+
+- (void)expireRun
+{
+    // Stop sending, all messages that were not sent yet are still marked as offline messages and sent in the next run
+    NSInteger pendingMessages = [_sendQueue cancel];
+
+    [NCUtils log:[NSString stringWithFormat:@"Sending offline messages expired, %ld messages remain queued", (long)pendingMessages]];
+
+    _sendQueue = nil;
+    _allRoomsRequested = YES;
+    _isSending = NO;
+
+    [_backgroundTask stopBackgroundTask];
+    _backgroundTask = nil;
+
+    [self callCompletionBlocks];
+}
+
+- (void)finishRunWithFailures:(BOOL)hadFailures
+{
+    [_retryPolicy recordRunWithFailures:hadFailures atDate:[NSDate date]];
+
+    if (hadFailures) {
+        // Messages that are still queued are retried after the backoff
+        _allRoomsRequested = YES;
+    }
+
+    _sendQueue = nil;
+    _isSending = NO;
+
+    [_backgroundTask stopBackgroundTask];
+    _backgroundTask = nil;
+
+    [self startNextRunIfPossible];
+}
+
+- (void)callCompletionBlocks
+{
+    NSArray<NCChatOutboxCompletionBlock> *completionBlocks = [_completionBlocks copy];
+    [_completionBlocks removeAllObjects];
+
+    for (NCChatOutboxCompletionBlock block in completionBlocks) {
+        block();
+    }
+}
+
+#pragma mark - Messages
+
+- (void)storeFailedMessage:(NCChatMessage *)failedMessage withUnsentMessages:(NSArray<NCChatMessage *> *)unsentMessages error:(NSError *)error
+{
+    __block BOOL failedPermanently = NO;
+
+    // Store the status of the failed message and all messages queued after it in a single transaction
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm transactionWithBlock:^{
+        for (NCChatMessage *message in unsentMessages) {
+            if (!message.referenceId) {
+                continue;
+            }
+
+            NCChatMessage *managedChatMessage = [NCChatMessage objectsWhere:@"referenceId = %@ AND isTemporary = true", message.referenceId].firstObject;
+
+            if (!managedChatMessage) {
+                continue;
+            }
+
+            if (message == failedMessage) {
+                if ([self->_retryPolicy shouldGiveUpMessageWithRetryCount:managedChatMessage.offlineMessageRetryCount]) {
+                    managedChatMessage.sendingFailed = YES;
+                    managedChatMessage.isOfflineMessage = NO;
+                    failedPermanently = YES;
+                    continue;
+                }
+
+                managedChatMessage.offlineMessageRetryCount += 1;
+            }
+
+            managedChatMessage.sendingFailed = NO;
+            managedChatMessage.isOfflineMessage = YES;
+        }
+    }];
+
+    [NCUtils log:[NSString stringWithFormat:@"Could not send offline message. Error: %@", error.description]
+       subsystem:@"chat"
+       accountId:failedMessage.accountId
+       roomToken:failedMessage.token
+         latency:kNCLoggerNoLatency];
+
+    [self postDidSendNotificationForMessage:failedMessage withError:error isOfflineMessage:!failedPermanently];
+}
+
+- (void)markMessageAsSent:(NCChatMessage *)message
+{
+    if (!message.internalId) {
+        return;
+    }
+
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm transactionWithBlock:^{
+        NCChatMessage *managedChatMessage = [NCChatMessage objectForPrimaryKey:message.internalId];
+        managedChatMessage.isOfflineMessage = NO;
+    }];
+}
+
+#pragma mark - Notifications
+
+- (void)postDidSendNotificationForMessage:(NCChatMessage *)message withError:(NSError *)error isOfflineMessage:(BOOL)isOfflineMessage
+{
+    NSMutableDictionary *userInfo = [NSMutableDictionary new];
+    [userInfo setObject:(message.sendingMessage ?: @"") forKey:@"message"];
+
+    if (message.token) {
+        [userInfo setObject:message.token forKey:@"token"];
+    }
+
+    if (message.accountId) {
+        [userInfo setObject:message.accountId forKey:@"accountId"];
+    }
+
+    if (message.referenceId) {
+        [userInfo setObject:message.referenceId forKey:@"referenceId"];
+    }
+
+    if (error) {
+        [userInfo setObject:error forKey:@"error"];
+    }
+
+    if (isOfflineMessage) {
+        [userInfo setObject:@(YES) forKey:@"isOfflineMessage"];
+    }
+
+    [[NSNotificationCenter defaultCenter] postNotificationName:NCChatControllerDidSendChatMessageNotification
+                                                        object:self
+                                                      userInfo:userInfo];
+}
+
+@end
@@ -0,0 +1,54 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Decides when sending offline messages is retried and when a message is given up
+@interface NCChatOutboxRetryPolicy : NSObject
+
+// If we were unable to send a message after this time, it is marked as failed
+@property (nonatomic, assign) NSTimeInterval messageExpiration;
+// After this number of retries, we assume sending the message is not possible
+@property (nonatomic, assign) NSInteger maxRetries;
+// The backoff doubles with every failed run up to this value
+@property (nonatomic, assign) NSTimeInterval maxBackoff;
+// A random delay of up to this value is added to the backoff, so the retries of several rooms and devices don't line up
+@property (nonatomic, assign) NSTimeInterval maxJitter;
+
+@property (nonatomic, assign, readonly) NSInteger consecutiveFailedRuns;
+@property (nonatomic, strong, readonly, nullable) NSDate *nextAttemptDate;
+
+- (BOOL)isMessageExpiredWithTimestamp:(NSInteger)timestamp atDate:(NSDate *)date;
+// Pass the number of retries of the message before it failed again
+- (BOOL)shouldGiveUpMessageWithRetryCount:(NSInteger)retryCount;
+// Backoff without the jitter
+- (NSTimeInterval)backoffAfterConsecutiveFailedRuns:(NSInteger)failedRuns;
+
+- (void)recordRunWithFailures:(BOOL)hadFailures atDate:(NSDate *)date;
+// Time until the next run should start, 0 if it can start right away
+- (NSTimeInterval)remainingBackoffAtDate:(NSDate *)date;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,85 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import "NCChatOutboxRetryPolicy.h"
+
+@implementation NCChatOutboxRetryPolicy
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        _messageExpiration = 60 * 60 * 12;
+        _maxRetries = 5;
+        _maxBackoff = 64;
+        _maxJitter = 1;
+    }
+
+    return self;
+}
+
+- (BOOL)isMessageExpiredWithTimestamp:(NSInteger)timestamp atDate:(NSDate *)date
+{
+    return timestamp < [date timeIntervalSince1970] - _messageExpiration;
+}
+
+- (BOOL)shouldGiveUpMessageWithRetryCount:(NSInteger)retryCount
+{
+    return retryCount >= _maxRetries;
+}
+
+- (NSTimeInterval)backoffAfterConsecutiveFailedRuns:(NSInteger)failedRuns
+{
+    if (failedRuns <= 0) {
+        return 0;
+    }
+
+    // Don't let pow overflow for very long offline periods
+    return MIN(pow(2, MIN(failedRuns, 62)), _maxBackoff);
+}
+
+- (void)recordRunWithFailures:(BOOL)hadFailures atDate:(NSDate *)date
+{
+    if (!hadFailures) {
+        _consecutiveFailedRuns = 0;
+        _nextAttemptDate = nil;
+        return;
+    }
+
+    _consecutiveFailedRuns += 1;
+
+    NSTimeInterval jitter = _maxJitter > 0 ? (arc4random_uniform(1000) / 1000.0) * _maxJitter : 0;
+    NSTimeInterval backoff = [self backoffAfterConsecutiveFailedRuns:_consecutiveFailedRuns] + jitter;
+
+    _nextAttemptDate = [date dateByAddingTimeInterval:backoff];
+}
+
+- (NSTimeInterval)remainingBackoffAtDate:(NSDate *)date
+{
+    if (!_nextAttemptDate) {
+        return 0;
+    }
+
+    return MAX([_nextAttemptDate timeIntervalSinceDate:date], 0);
+}
+
+@end
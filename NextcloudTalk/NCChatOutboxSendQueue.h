@@ -0,0 +1,59 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^NCChatOutboxSendCompletionBlock)(NSError * _Nullable error);
+// Returns the task of the request, so it can be cancelled
+typedef NSURLSessionTask * _Nullable (^NCChatOutboxSendBlock)(id message, NCChatOutboxSendCompletionBlock completionBlock);
+
+/**
+ Sends the messages of a single outbox run. Messages of a room are sent strictly one after the other in the order they were added.
+ A failed message stops its room, otherwise the following messages would arrive out of order.
+ Different rooms are sent in parallel, in the order their first message was added.
+ All methods and the completion blocks of the send block need to be called on the main thread.
+ */
+@interface NCChatOutboxSendQueue : NSObject
+
+// Maximum number of rooms sending messages at the same time
+@property (nonatomic, assign) NSInteger maxConcurrentRooms;
+// Called for every sent message, also for messages that were sent after the queue was cancelled
+@property (nonatomic, copy, nullable) void (^messageSentBlock)(id message, NSString *roomKey);
+// The unsent messages start with the failed message
+@property (nonatomic, copy, nullable) void (^roomFailedBlock)(NSString *roomKey, NSArray *unsentMessages, NSError *error);
+// Called once all rooms finished, it is not called for a cancelled queue
+@property (nonatomic, copy, nullable) void (^finishedBlock)(BOOL hadFailures);
+
+@property (nonatomic, assign, readonly) BOOL isCancelled;
+
+- (instancetype)initWithSendBlock:(NCChatOutboxSendBlock)sendBlock;
+
+- (void)addMessage:(id)message forRoomKey:(NSString *)roomKey;
+- (void)start;
+// Cancels the running requests, failures reported afterwards are ignored. Returns the number of messages that were not sent.
+- (NSInteger)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,200 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import "NCChatOutboxSendQueue.h"
+
+@interface NCChatOutboxSendQueueRoom : NSObject
+
+@property (nonatomic, strong) NSString *roomKey;
+@property (nonatomic, strong) NSMutableArray *messages;
+@property (nonatomic, strong) id sendingMessage;
+@property (nonatomic, strong) NSURLSessionTask *sendTask;
+
+@end
+
+@implementation NCChatOutboxSendQueueRoom
+@end
+
+@interface NCChatOutboxSendQueue ()
+
+@property (nonatomic, copy) NCChatOutboxSendBlock sendBlock;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NCChatOutboxSendQueueRoom *> *roomsByKey;
+@property (nonatomic, strong) NSMutableArray<NCChatOutboxSendQueueRoom *> *waitingRooms;
+@property (nonatomic, strong) NSMutableArray<NCChatOutboxSendQueueRoom *> *activeRooms;
+@property (nonatomic, assign) BOOL isStarted;
+@property (nonatomic, assign) BOOL isFinished;
+@property (nonatomic, assign) BOOL hadFailures;
+
+@end
+
+@implementation NCChatOutboxSendQueue
+
+- (instancetype)initWithSendBlock:(NCChatOutboxSendBlock)sendBlock
+{
+    self = [super init];
+    if (self) {
+        _maxConcurrentRooms = 3;
+        _sendBlock = sendBlock;
+        _roomsByKey = [NSMutableDictionary new];
+        _waitingRooms = [NSMutableArray new];
+        _activeRooms = [NSMutableArray new];
+    }
+
+    return self;
+}
+
+- (void)addMessage:(id)message forRoomKey:(NSString *)roomKey
+{
+    NSAssert(!_isStarted, @"Messages need to be added before the queue is started");
+
+    NCChatOutboxSendQueueRoom *room = [_roomsByKey objectForKey:roomKey];
+
+    if (!room) {
+        room = [NCChatOutboxSendQueueRoom new];
+        room.roomKey = roomKey;
+        room.messages = [NSMutableArray new];
+        [_roomsByKey setObject:room forKey:roomKey];
+        [_waitingRooms addObject:room];
+    }
+
+    [room.messages addObject:message];
+}
+
+- (void)start
+{
+    if (_isStarted) {
+        return;
+    }
+
+    _isStarted = YES;
+    [self startWaitingRooms];
+}
+
+- (NSInteger)cancel
+{
+    if (_isCancelled || _isFinished) {
+        return 0;
+    }
+
+    _isCancelled = YES;
+
+    NSInteger unsentMessages = 0;
+
+    for (NCChatOutboxSendQueueRoom *room in [_activeRooms arrayByAddingObjectsFromArray:_waitingRooms]) {
+        unsentMessages += room.messages.count;
+        [room.sendTask cancel];
+    }
+
+    [_activeRooms removeAllObjects];
+    [_waitingRooms removeAllObjects];
+
+    return unsentMessages;
+}
+
+#pragma mark - Rooms
+
+- (void)startWaitingRooms
+{
+    if (_isCancelled || _isFinished) {
+        return;
+    }
+
+    while (_activeRooms.count < MAX(_maxConcurrentRooms, 1) && _waitingRooms.count > 0) {
+        NCChatOutboxSendQueueRoom *room = _waitingRooms.firstObject;
+        [_waitingRooms removeObjectAtIndex:0];
+
+        [_activeRooms addObject:room];
+        [self sendNextMessageOfRoom:room];
+    }
+
+    // A room that finished synchronously might have finished the queue already
+    if (_activeRooms.count == 0 && !_isFinished && !_isCancelled) {
+        _isFinished = YES;
+
+        if (_finishedBlock) {
+            _finishedBlock(_hadFailures);
+        }
+    }
+}
+
+- (void)sendNextMessageOfRoom:(NCChatOutboxSendQueueRoom *)room
+{
+    id message = room.messages.firstObject;
+
+    if (!message) {
+        [self finishRoom:room];
+        return;
+    }
+
+    room.sendingMessage = message;
+
+    NSURLSessionTask *sendTask = _sendBlock(message, ^(NSError *error) {
+        [self didSendMessage:message ofRoom:room withError:error];
+    });
+
+    // Only keep the task if the message was not sent synchronously
+    if (room.sendingMessage == message) {
+        room.sendTask = sendTask;
+    }
+}
+
+- (void)didSendMessage:(id)message ofRoom:(NCChatOutboxSendQueueRoom *)room withError:(NSError *)error
+{
+    room.sendingMessage = nil;
+    room.sendTask = nil;
+
+    if (error) {
+        // The message was not sent, a cancelled queue leaves it for the next run
+        if (_isCancelled) {
+            return;
+        }
+
+        _hadFailures = YES;
+
+        if (_roomFailedBlock) {
+            _roomFailedBlock(room.roomKey, [room.messages copy], error);
+        }
+
+        [self finishRoom:room];
+        return;
+    }
+
+    [room.messages removeObjectAtIndex:0];
+
+    if (_messageSentBlock) {
+        _messageSentBlock(message, room.roomKey);
+    }
+
+    if (_isCancelled) {
+        return;
+    }
+
+    [self sendNextMessageOfRoom:room];
+}
+
+- (void)finishRoom:(NCChatOutboxSendQueueRoom *)room
+{
+    [_activeRooms removeObject:room];
+    [self startWaitingRooms];
+}
+
+@end
@@ -54,6 +54,7 @@
 #import "NCAppBranding.h"
 #import "NCChatFileController.h"
 #import "NCChatMessage.h"
+#import "NCChatOutbox.h"
 #import "NCChatTitleView.h"
 #import "NCConnectionController.h"
 #import "NCDatabaseManager.h"
@@ -127,6 +128,7 @@ NSString * const kActionTypeTranscribeVoiceMessage   = @"transcribe-voice-messag
 @property (nonatomic, strong) NSMutableArray *dateSections;
 @property (nonatomic, strong) NSMutableDictionary *mentionsDict;
 @property (nonatomic, strong) NSMutableArray *autocompletionUsers;
+@property (nonatomic, strong) MentionSuggestionEngine *mentionSuggestionEngine;
 @property (nonatomic, assign) BOOL hasPresentedLobby;
 @property (nonatomic, assign) BOOL hasRequestedInitialHistory;
 @property (nonatomic, assign) BOOL hasReceiveInitialHistory;
@@ -150,6 +152,7 @@ NSString * const kActionTypeTranscribeVoiceMessage   = @"transcribe-voice-messag
 @property (nonatomic, strong) BarButtonItemWithActivity *voiceCallButton;
 @property (nonatomic, assign) BOOL isPreviewControllerShown;
 @property (nonatomic, strong) NSString *previewControllerFilePath;
+@property (nonatomic, strong) ChatFileLease *previewControllerFileLease;
 @property (nonatomic, strong) dispatch_group_t animationDispatchGroup;
 @property (nonatomic, strong) dispatch_queue_t animationDispatchQueue;
 @property (nonatomic, strong) UIView *inputbarBorderView;
@@ -175,6 +178,7 @@ NSString * const kActionTypeTranscribeVoiceMessage   = @"transcribe-voice-messag
 @property (nonatomic, strong) UIView *contextMenuReactionView;
 @property (nonatomic, strong) UIView *contextMenuMessageView;
 @property (nonatomic, copy, nullable) void (^contextMenuActionBlock)(void);
+@property (nonatomic, strong) FileUploadEngine *uploadEngine;
 
 @end
 
@@ -188,7 +192,8 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
 {
     self = [super initWithTableViewStyle:UITableViewStylePlain];
     if (self) {
-        self.room = room;
+        // Rooms returned by the rooms manager are shared snapshots, we need our own copy as we modify it
+        self.room = [[NCRoom alloc] initWithValue:room];
         self.chatController = [[NCChatController alloc] initForRoom:room];
         self.hidesBottomBarWhenPushed = YES;
         // Fixes problem with tableView contentSize on iOS 11
@@ -269,6 +274,7 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
     
     self.messages = [[NSMutableDictionary alloc] init];
     self.mentionsDict = [[NSMutableDictionary alloc] init];
+    self.mentionSuggestionEngine = [[MentionSuggestionEngine alloc] initWithRoom:_room];
     self.dateSections = [[NSMutableArray alloc] init];
 
     self.bounces = NO;
@@ -2136,14 +2142,7 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
     NSURL *url = [NSURL fileURLWithPath:filePath];
     
     NSString *contactFileName = [NSString stringWithFormat:@"%@.vcf", contact.identifier];
-    TalkAccount *activeAccount = [[NCDatabaseManager sharedInstance] activeAccount];
-    [[NCAPIController sharedInstance] uniqueNameForFileUploadWithName:contactFileName originalName:YES forAccount:activeAccount withCompletionBlock:^(NSString *fileServerURL, NSString *fileServerPath, NSInteger errorCode, NSString *errorDescription) {
-        if (fileServerURL && fileServerPath) {
-            [self uploadFileAtPath:url.path withFileServerURL:fileServerURL andFileServerPath:fileServerPath withMetaData:nil];
-        } else {
-            NSLog(@"Could not find unique name for voice message file.");
-        }
-    }];
+    [self uploadFileAtPath:url.path withFileName:contactFileName andMetaData:nil];
 }
 
 #pragma mark - Voice messages recording
@@ -2268,45 +2267,30 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
         audioFileName = [audioFileName substringWithRange:NSMakeRange(0, 146)];
     }
     audioFileName = [audioFileName stringByAppendingString:@".mp3"];
-    TalkAccount *activeAccount = [[NCDatabaseManager sharedInstance] activeAccount];
-    [[NCAPIController sharedInstance] uniqueNameForFileUploadWithName:audioFileName originalName:YES forAccount:activeAccount withCompletionBlock:^(NSString *fileServerURL, NSString *fileServerPath, NSInteger errorCode, NSString *errorDescription) {
-        if (fileServerURL && fileServerPath) {
-            NSDictionary *talkMetaData = @{@"messageType" : @"voice-message"};
-            [self uploadFileAtPath:self->_recorder.url.path withFileServerURL:fileServerURL andFileServerPath:fileServerPath withMetaData:talkMetaData];
-        } else {
-            NSLog(@"Could not find unique name for voice message file.");
-        }
-    }];
+    NSDictionary *talkMetaData = @{@"messageType" : @"voice-message"};
+    [self uploadFileAtPath:_recorder.url.path withFileName:audioFileName andMetaData:talkMetaData];
 }
 
-- (void)uploadFileAtPath:(NSString *)localPath withFileServerURL:(NSString *)fileServerURL andFileServerPath:(NSString *)fileServerPath withMetaData:(NSDictionary *)talkMetaData
+- (void)uploadFileAtPath:(NSString *)localPath withFileName:(NSString *)fileName andMetaData:(NSDictionary *)talkMetaData
 {
     TalkAccount *activeAccount = [[NCDatabaseManager sharedInstance] activeAccount];
-    [[NCAPIController sharedInstance] setupNCCommunicationForAccount:activeAccount];
-    [[NextcloudKit shared] uploadWithServerUrlFileName:fileServerURL fileNameLocalPath:localPath dateCreationFile:nil dateModificationFile:nil customUserAgent:nil addCustomHeaders:nil queue:dispatch_get_main_queue() taskHandler:^(NSURLSessionTask *task) {
-        NSLog(@"Upload task");
-    } progressHandler:^(NSProgress *progress) {
-        NSLog(@"Progress:%f", progress.fractionCompleted);
-    } completionHandler:^(NSString *account, NSString *ocId, NSString *etag, NSDate *date, int64_t size, NSDictionary *allHeaderFields, NKError *error) {
-        NSLog(@"Upload completed with error code: %ld", (long)error.errorCode);
-
-        if (error.errorCode == 0) {
-            [[NCAPIController sharedInstance] shareFileOrFolderForAccount:activeAccount atPath:fileServerPath toRoom:self->_room.token talkMetaData:talkMetaData withCompletionBlock:^(NSError *error) {
-                if (error) {
-                    NSLog(@"Failed to share voice message");
-                }
-            }];
-        } else if (error.errorCode == 404 || error.errorCode == 409) {
-            [[NCAPIController sharedInstance] checkOrCreateAttachmentFolderForAccount:activeAccount withCompletionBlock:^(BOOL created, NSInteger errorCode) {
-                if (created) {
-                    [self uploadFileAtPath:localPath withFileServerURL:fileServerURL andFileServerPath:fileServerPath withMetaData:talkMetaData];
-                } else {
-                    NSLog(@"Failed to check or create attachment folder");
-                }
-            }];
-        } else {
-            NSLog(@"Failed upload voice message");
+
+    // The upload engine finds a unique name, creates the attachment folder if needed and retries failed uploads
+    if (!_uploadEngine || ![_uploadEngine.account.accountId isEqualToString:activeAccount.accountId]) {
+        _uploadEngine = [[FileUploadEngine alloc] initWithAccount:activeAccount];
+    }
+
+    [_uploadEngine uploadFileAtPath:localPath withName:fileName progressBlock:nil completionBlock:^(NSString *fileServerPath, NSString *errorDescription) {
+        if (!fileServerPath) {
+            [NCUtils log:[NSString stringWithFormat:@"Failed to upload file %@: %@", fileName, errorDescription]];
+            return;
         }
+
+        [[NCAPIController sharedInstance] shareFileOrFolderForAccount:activeAccount atPath:fileServerPath toRoom:self->_room.token talkMetaData:talkMetaData withCompletionBlock:^(NSError *error) {
+            if (error) {
+                NSLog(@"Failed to share file %@", fileName);
+            }
+        }];
     }];
 }
 
@@ -2632,7 +2616,7 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
         return;
     }
     
-    _room = room;
+    _room = [[NCRoom alloc] initWithValue:room];
     [self setTitleView];
     
     if (!_hasStopped) {
@@ -2661,7 +2645,7 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
 
     NCRoom *room = [notification.userInfo objectForKey:@"room"];
     if (room) {
-        _room = room;
+        _room = [[NCRoom alloc] initWithValue:room];
     }
     
     _hasJoinedRoom = YES;
@@ -3004,7 +2988,12 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
 - (void)didSendChatMessage:(NSNotification *)notification
 {
     dispatch_async(dispatch_get_main_queue(), ^{
-        if (notification.object != self->_chatController) {
+        // Offline messages are sent by the outbox instead of our chat controller
+        BOOL isOutboxMessageForRoom = notification.object == [NCChatOutbox sharedInstance] &&
+                                      [[notification.userInfo objectForKey:@"token"] isEqualToString:self->_room.token] &&
+                                      [[notification.userInfo objectForKey:@"accountId"] isEqualToString:self->_room.accountId];
+
+        if (notification.object != self->_chatController && !isOutboxMessageForRoom) {
             return;
         }
         
@@ -3360,6 +3349,8 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
 
 - (void)appendMessages:(NSMutableArray *)messages inDictionary:(NSMutableDictionary *)dictionary
 {
+    [self preparseMarkdownOfMessages:messages];
+
     for (NCChatMessage *newMessage in messages) {
         NSDate *newMessageDate = [NSDate dateWithTimeIntervalSince1970: newMessage.timestamp];
         NSDate *keyDate = [self getKeyForDate:newMessageDate inDictionary:dictionary];
@@ -3398,6 +3389,26 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
     [self sortDateSections];
 }
 
+- (void)preparseMarkdownOfMessages:(NSArray *)messages
+{
+    // Message parameters are resolved here, only the markdown parsing happens in the background
+    NSMutableArray *markdownStrings = [[NSMutableArray alloc] init];
+
+    for (NCChatMessage *message in messages) {
+        if (!message.isMarkdownMessage || [message isUpdateMessage]) {
+            continue;
+        }
+
+        NSMutableAttributedString *parsedMessage = message.parsedMessage;
+
+        if (parsedMessage) {
+            [markdownStrings addObject:parsedMessage];
+        }
+    }
+
+    [SwiftMarkdownObjCBridge preparseMarkdownWithMarkdownStrings:markdownStrings];
+}
+
 - (void)insertMessages:(NSMutableArray *)messages
 {
     for (NCChatMessage *newMessage in messages) {
@@ -4132,20 +4143,21 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
 
 - (void)showSuggestionsForString:(NSString *)string
 {
+    // Suggestions of a previous string should not be shown while the new ones are loaded
     self.autocompletionUsers = nil;
-    [[NCAPIController sharedInstance] getMentionSuggestionsInRoom:_room.token forString:string forAccount:[[NCDatabaseManager sharedInstance] activeAccount] withCompletionBlock:^(NSMutableArray *mentions, NSError *error) {
-        if (!error) {
-            self.autocompletionUsers = [[NSMutableArray alloc] initWithArray:mentions];
-            BOOL show = (self.autocompletionUsers.count > 0);
-            // Check if the '@' is still there
-            [self.textView lookForPrefixes:self.registeredPrefixes completion:^(NSString *prefix, NSString *word, NSRange wordRange) {
-                if (prefix.length > 0 && word.length > 0) {
-                    [self showAutoCompletionView:show];
-                } else {
-                    [self cancelAutoCompletion];
-                }
-            }];
-        }
+
+    // Suggestions are debounced and cached, only the suggestions for the last string are returned
+    [self.mentionSuggestionEngine suggestionsFor:string completionBlock:^(NSArray *suggestions) {
+        self.autocompletionUsers = [[NSMutableArray alloc] initWithArray:suggestions];
+        BOOL show = (self.autocompletionUsers.count > 0);
+        // Check if the '@' is still there
+        [self.textView lookForPrefixes:self.registeredPrefixes completion:^(NSString *prefix, NSString *word, NSRange wordRange) {
+            if (prefix.length > 0 && word.length > 0) {
+                [self showAutoCompletionView:show];
+            } else {
+                [self cancelAutoCompletion];
+            }
+        }];
     }];
 }
 
@@ -4348,6 +4360,14 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
     return cell;
 }
 
+- (void)tableView:(UITableView *)tableView didEndDisplayingCell:(UITableViewCell *)cell forRowAtIndexPath:(NSIndexPath *)indexPath
+{
+    // Don't download or decode previews for cells that are not visible anymore
+    if ([cell isKindOfClass:[FileMessageTableViewCell class]]) {
+        [(FileMessageTableViewCell *)cell cancelPreviewRequest];
+    }
+}
+
 - (CGFloat)tableView:(UITableView *)tableView heightForRowAtIndexPath:(NSIndexPath *)indexPath
 {
     if ([tableView isEqual:self.tableView]) {
@@ -5204,19 +5224,7 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
         return;
     }
     
-    BOOL isFileCellStillVisible = NO;
-    
-    for (NSIndexPath *indexPath in self.tableView.indexPathsForVisibleRows) {
-        NSDate *sectionDate = [_dateSections objectAtIndex:indexPath.section];
-        NCChatMessage *message = [[_messages objectForKey:sectionDate] objectAtIndex:indexPath.row];
-        
-        if (message.file && [message.file.parameterId isEqualToString:fileStatus.fileId] && [message.file.path isEqualToString:fileStatus.filePath]) {
-            isFileCellStillVisible = YES;
-            break;
-        }
-    }
-    
-    if (!isFileCellStillVisible) {
+    if (![self isFileCellVisibleForFileStatus:fileStatus]) {
         // Only open file when the corresponding cell is still visible on the screen
         return;
     }
@@ -5224,6 +5232,7 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
     dispatch_async(dispatch_get_main_queue(), ^{
         self->_isPreviewControllerShown = YES;
         self->_previewControllerFilePath = fileStatus.fileLocalPath;
+        self->_previewControllerFileLease = [[ChatFileLease alloc] initWithFilePath:fileStatus.fileLocalPath];
 
         // When the keyboard is not dismissed, dismissing the previewController might result in a corrupted keyboardView
         [self dismissKeyboard:NO];
@@ -5232,11 +5241,7 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
 
         // For WebM we use the VLCKitVideoViewController because the native PreviewController does not support WebM
         if ([extension isEqualToString:@"webm"]) {
-            VLCKitVideoViewController *vlcKitViewController = [[VLCKitVideoViewController alloc] initWithFilePath:fileStatus.fileLocalPath];
-            vlcKitViewController.delegate = self;
-            vlcKitViewController.modalPresentationStyle = UIModalPresentationFullScreen;
-            [self presentViewController:vlcKitViewController animated:YES completion:nil];
-
+            [self presentVLCKitVideoViewControllerWithFilePath:fileStatus.fileLocalPath partialFilePath:nil];
             return;
         }
 
@@ -5262,6 +5267,29 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
     });
 }
 
+- (void)fileControllerCanStreamFile:(NCChatFileController *)fileController withFileStatus:(NCChatFileStatus *)fileStatus partialFilePath:(NSString *)partialFilePath
+{
+    if (fileController.messageType || _isPreviewControllerShown) {
+        return;
+    }
+
+    // Only WebM files are played with VLCKit, which is able to stream the file while it is downloaded
+    NSString *extension = [[NSURL fileURLWithPath:fileStatus.fileLocalPath].pathExtension lowercaseString];
+
+    if (![extension isEqualToString:@"webm"] || ![self isFileCellVisibleForFileStatus:fileStatus]) {
+        return;
+    }
+
+    dispatch_async(dispatch_get_main_queue(), ^{
+        self->_isPreviewControllerShown = YES;
+        self->_previewControllerFilePath = fileStatus.fileLocalPath;
+        self->_previewControllerFileLease = [[ChatFileLease alloc] initWithFilePath:fileStatus.fileLocalPath];
+
+        [self dismissKeyboard:NO];
+        [self presentVLCKitVideoViewControllerWithFilePath:fileStatus.fileLocalPath partialFilePath:partialFilePath];
+    });
+}
+
 - (void)fileControllerDidFailLoadingFile:(NCChatFileController *)fileController withErrorDescription:(NSString *)errorDescription
 {
     UIAlertController * alert = [UIAlertController
@@ -5279,6 +5307,28 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
     [[NCUserInterfaceController sharedInstance] presentAlertViewController:alert];
 }
 
+- (BOOL)isFileCellVisibleForFileStatus:(NCChatFileStatus *)fileStatus
+{
+    for (NSIndexPath *indexPath in self.tableView.indexPathsForVisibleRows) {
+        NSDate *sectionDate = [_dateSections objectAtIndex:indexPath.section];
+        NCChatMessage *message = [[_messages objectForKey:sectionDate] objectAtIndex:indexPath.row];
+
+        if (message.file && [message.file.parameterId isEqualToString:fileStatus.fileId] && [message.file.path isEqualToString:fileStatus.filePath]) {
+            return YES;
+        }
+    }
+
+    return NO;
+}
+
+- (void)presentVLCKitVideoViewControllerWithFilePath:(NSString *)filePath partialFilePath:(NSString *)partialFilePath
+{
+    VLCKitVideoViewController *vlcKitViewController = [[VLCKitVideoViewController alloc] initWithFilePath:filePath partialFilePath:partialFilePath];
+    vlcKitViewController.delegate = self;
+    vlcKitViewController.modalPresentationStyle = UIModalPresentationFullScreen;
+    [self presentViewController:vlcKitViewController animated:YES completion:nil];
+}
+
 #pragma mark - QLPreviewControllerDelegate/DataSource
 
 - (NSInteger)numberOfPreviewItemsInPreviewController:(nonnull QLPreviewController *)controller {
@@ -5292,6 +5342,7 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
 - (void)previewControllerDidDismiss:(QLPreviewController *)controller
 {
     _isPreviewControllerShown = NO;
+    _previewControllerFileLease = nil;
 }
 
 #pragma mark - VLCVideoViewControllerDelegate
@@ -5299,6 +5350,7 @@ NSString * const NCChatViewControllerTalkToUserNotification = @"NCChatViewContro
 - (void)vlckitVideoViewControllerDismissed:(VLCKitVideoViewController *)controller
 {
     _isPreviewControllerShown = NO;
+    _previewControllerFileLease = nil;
 }
 
 #pragma mark - NCChatTitleViewDelegate
@@ -0,0 +1,43 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Immutable snapshot of the capabilities of an account, so we don't need to query the database for every capability check
+@interface NCCompiledServerCapabilities : NSObject
+
+@property (nonatomic, assign, readonly) uint64_t talkCapabilityBits;
+@property (nonatomic, strong, readonly) NSSet<NSString *> *talkCapabilities;
+@property (nonatomic, strong, readonly) NSSet<NSString *> *notificationsCapabilities;
+
+// Every known capability maps to a bit (0-63) in talkCapabilityBits, other capabilities are looked up in talkCapabilities
+- (instancetype)initWithTalkCapabilities:(NSArray<NSString *> *)talkCapabilities
+               notificationsCapabilities:(NSArray<NSString *> *)notificationsCapabilities
+                 knownTalkCapabilityBits:(NSDictionary<NSString *, NSNumber *> *)knownTalkCapabilityBits;
+
+- (BOOL)hasTalkCapability:(NSString *)capability;
+
+@end
+
+NS_ASSUME_NONNULL_END
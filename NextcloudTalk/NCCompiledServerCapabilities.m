@@ -0,0 +1,71 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import "NCCompiledServerCapabilities.h"
+
+@interface NCCompiledServerCapabilities ()
+{
+    NSDictionary<NSString *, NSNumber *> *_knownTalkCapabilityBits;
+}
+
+@end
+
+@implementation NCCompiledServerCapabilities
+
+- (instancetype)initWithTalkCapabilities:(NSArray<NSString *> *)talkCapabilities
+               notificationsCapabilities:(NSArray<NSString *> *)notificationsCapabilities
+                 knownTalkCapabilityBits:(NSDictionary<NSString *, NSNumber *> *)knownTalkCapabilityBits
+{
+    self = [super init];
+    if (self) {
+        uint64_t talkCapabilityBits = 0;
+
+        for (NSString *capability in talkCapabilities) {
+            NSNumber *bit = [knownTalkCapabilityBits objectForKey:capability];
+
+            if (bit) {
+                talkCapabilityBits |= (1ULL << bit.unsignedIntegerValue);
+            }
+        }
+
+        _knownTalkCapabilityBits = knownTalkCapabilityBits;
+        _talkCapabilityBits = talkCapabilityBits;
+        _talkCapabilities = [NSSet setWithArray:talkCapabilities];
+        _notificationsCapabilities = [NSSet setWithArray:notificationsCapabilities];
+    }
+
+    return self;
+}
+
+- (BOOL)hasTalkCapability:(NSString *)capability
+{
+    NSNumber *bit = [_knownTalkCapabilityBits objectForKey:capability];
+
+    if (bit) {
+        return (_talkCapabilityBits & (1ULL << bit.unsignedIntegerValue)) != 0;
+    }
+
+    // Capabilities the app doesn't know about are not part of the bitset
+    return [_talkCapabilities containsObject:capability];
+}
+
+@end
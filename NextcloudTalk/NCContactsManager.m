@@ -25,8 +25,10 @@
 #import <Contacts/Contacts.h>
 
 #import "NCAPIController.h"
+#import "NCAddressBookDiff.h"
 #import "NCDatabaseManager.h"
 #import "NCSettingsController.h"
+#import "NCUtils.h"
 #import "ABContact.h"
 #import "NCContact.h"
 
@@ -43,6 +45,8 @@
 NSString * const NCContactsManagerContactsUpdatedNotification       = @"NCContactsManagerContactsUpdatedNotification";
 NSString * const NCContactsManagerContactsAccessUpdatedNotification = @"NCContactsManagerContactsAccessUpdatedNotification";
 
+static NSString * const kNCContactsManagerHistoryTokenKey = @"NCContactsManagerHistoryToken";
+
 + (NCContactsManager *)sharedInstance
 {
     static dispatch_once_t once;
@@ -96,31 +100,23 @@ NSString * const NCContactsManagerContactsAccessUpdatedNotification = @"NCContac
     }
     
     if ([self isContactAccessAuthorized] && ([self isTimeToSyncContacts] || forceSync)) {
-        NSMutableDictionary *phoneNumbersDict = [NSMutableDictionary new];
-        NSMutableArray *contacts = [NSMutableArray new];
+        TalkAccount *account = [[NCDatabaseManager sharedInstance] activeAccount];
         NSInteger updateTimestamp = [[NSDate date] timeIntervalSince1970];
-        NSError *error = nil;
-        NSArray *keysToFetch = @[CNContactGivenNameKey, CNContactFamilyNameKey, CNContactPhoneNumbersKey];
-        CNContactFetchRequest *request = [[CNContactFetchRequest alloc] initWithKeysToFetch:keysToFetch];
-        [_contactStore enumerateContactsWithFetchRequest:request error:&error usingBlock:^(CNContact * __nonnull contact, BOOL * __nonnull stop) {
-            NSMutableArray *phoneNumbers = [NSMutableArray new];
-            for (CNLabeledValue *phoneNumberValue in contact.phoneNumbers) {
-                [phoneNumbers addObject:[[phoneNumberValue valueForKey:@"value"] valueForKey:@"digits"]];
-            }
-            if (phoneNumbers.count > 0) {
-                NSString *identifier = [contact valueForKey:@"identifier"];
-                NSString *givenName = [contact valueForKey:@"givenName"];
-                NSString *familyName = [contact valueForKey:@"familyName"];
-                NSString *name = [[NSString stringWithFormat:@"%@ %@", givenName, familyName] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
-                ABContact *abContact = [ABContact contactWithIdentifier:identifier name:name phoneNumbers:phoneNumbers lastUpdate:updateTimestamp];
-                if (abContact) {
-                    [contacts addObject:abContact];
-                }
-                [phoneNumbersDict setValue:phoneNumbers forKey:identifier];
+
+        // Only read the whole address book when it changed since it was read the last time
+        NSData *historyToken = _contactStore.currentHistoryToken;
+        NSData *lastHistoryToken = [[NSUserDefaults standardUserDefaults] objectForKey:kNCContactsManagerHistoryTokenKey];
+        BOOL hasAddressBookCopy = [ABContact allObjects].count > 0;
+        if (forceSync || !hasAddressBookCopy || !historyToken || ![historyToken isEqualToData:lastHistoryToken]) {
+            if ([self updateAddressBookCopyWithTimestamp:updateTimestamp] && historyToken) {
+                [[NSUserDefaults standardUserDefaults] setObject:historyToken forKey:kNCContactsManagerHistoryTokenKey];
             }
-        }];
-        [self updateAddressBookCopyWithContacts:contacts andTimestamp:updateTimestamp];
-        [self searchForPhoneNumbers:phoneNumbersDict forAccount:[[NCDatabaseManager sharedInstance] activeAccount]];
+        }
+
+        // Only search for phone numbers that changed since the last sync of this account
+        NSInteger changedSince = [NCAddressBookDiff searchTimestampForLastContactSync:account.lastContactSync forceSync:forceSync];
+        NSDictionary *phoneNumbersDict = [self phoneNumbersOfContactsChangedSince:changedSince];
+        [self searchForPhoneNumbers:phoneNumbersDict forAccount:account fullSync:(changedSince == 0) syncTimestamp:updateTimestamp];
     } else if (![self isContactAccessDetermined]) {
         [self requestContactsAccess:^(BOOL granted) {
             if (granted) {
@@ -130,72 +126,186 @@ NSString * const NCContactsManagerContactsAccessUpdatedNotification = @"NCContac
     }
 }
 
-- (void)updateAddressBookCopyWithContacts:(NSArray *)contacts andTimestamp:(NSInteger)timestamp
+- (BOOL)updateAddressBookCopyWithTimestamp:(NSInteger)timestamp
 {
+    NSMutableDictionary<NSString *, ABContact *> *contacts = [NSMutableDictionary new];
+    NSMutableDictionary<NSString *, NSString *> *currentDigests = [NSMutableDictionary new];
+    NSError *error = nil;
+    NSArray *keysToFetch = @[CNContactGivenNameKey, CNContactFamilyNameKey, CNContactPhoneNumbersKey];
+    CNContactFetchRequest *request = [[CNContactFetchRequest alloc] initWithKeysToFetch:keysToFetch];
+    [_contactStore enumerateContactsWithFetchRequest:request error:&error usingBlock:^(CNContact * __nonnull contact, BOOL * __nonnull stop) {
+        NSMutableArray *phoneNumbers = [NSMutableArray new];
+        for (CNLabeledValue *phoneNumberValue in contact.phoneNumbers) {
+            [phoneNumbers addObject:[[phoneNumberValue valueForKey:@"value"] valueForKey:@"digits"]];
+        }
+        if (phoneNumbers.count > 0) {
+            NSString *identifier = [contact valueForKey:@"identifier"];
+            NSString *givenName = [contact valueForKey:@"givenName"];
+            NSString *familyName = [contact valueForKey:@"familyName"];
+            NSString *name = [[NSString stringWithFormat:@"%@ %@", givenName, familyName] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+            ABContact *abContact = [ABContact contactWithIdentifier:identifier name:name phoneNumbers:phoneNumbers lastUpdate:timestamp];
+            if (abContact) {
+                [contacts setObject:abContact forKey:identifier];
+                [currentDigests setObject:abContact.phoneNumbersDigest forKey:identifier];
+            }
+        }
+    }];
+
+    if (error) {
+        [NCUtils log:[NSString stringWithFormat:@"Error reading address book contacts: %@", error.description]];
+        return NO;
+    }
+
     RLMRealm *realm = [RLMRealm defaultRealm];
     [realm transactionWithBlock:^{
-        // Add or update contacts
-        for (ABContact *contact in contacts) {
-            ABContact *managedABContact = [ABContact objectsWhere:@"identifier = %@", contact.identifier].firstObject;
-            if (managedABContact) {
-                [ABContact updateContact:managedABContact withContact:contact];
-            } else {
-                [realm addObject:contact];
+        NSMutableDictionary<NSString *, ABContact *> *managedABContacts = [NSMutableDictionary new];
+        NSMutableDictionary<NSString *, NSString *> *storedDigests = [NSMutableDictionary new];
+        NSMutableArray *managedABContactsToBeDeleted = [NSMutableArray new];
+
+        for (ABContact *managedABContact in [ABContact allObjects]) {
+            // Duplicate of an already handled contact
+            if ([managedABContacts objectForKey:managedABContact.identifier]) {
+                [managedABContactsToBeDeleted addObject:managedABContact];
+                continue;
+            }
+
+            [managedABContacts setObject:managedABContact forKey:managedABContact.identifier];
+            [storedDigests setObject:(managedABContact.phoneNumbersDigest ?: @"") forKey:managedABContact.identifier];
+        }
+
+        NCAddressBookDiff *diff = [[NCAddressBookDiff alloc] initWithStoredDigests:storedDigests currentDigests:currentDigests];
+
+        // Only contacts with changed phone numbers get a new lastUpdate, so they are searched again
+        for (NSString *identifier in diff.changedIdentifiers) {
+            [ABContact updateContact:[managedABContacts objectForKey:identifier] withContact:[contacts objectForKey:identifier]];
+        }
+
+        [managedABContacts enumerateKeysAndObjectsUsingBlock:^(NSString *identifier, ABContact *managedABContact, BOOL *stop) {
+            ABContact *contact = [contacts objectForKey:identifier];
+
+            if (contact && ![diff.changedIdentifiers containsObject:identifier] && ![managedABContact.name isEqualToString:contact.name]) {
+                managedABContact.name = contact.name;
             }
+        }];
+
+        for (NSString *identifier in diff.addedIdentifiers) {
+            [realm addObject:[contacts objectForKey:identifier]];
         }
-        // Delete old contacts
-        NSPredicate *query = [NSPredicate predicateWithFormat:@"lastUpdate != %ld", (long)timestamp];
-        RLMResults *managedABContactsToBeDeleted = [ABContact objectsWithPredicate:query];
-        // Delete matching nc contacts
-        for (ABContact *managedABContact in managedABContactsToBeDeleted) {
-            NSPredicate *query2 = [NSPredicate predicateWithFormat:@"identifier = %@", managedABContact.identifier];
-            [realm deleteObjects:[NCContact objectsWithPredicate:query2]];
+
+        // Delete contacts that were removed from the address book and their matching nc contacts
+        for (NSString *identifier in diff.removedIdentifiers) {
+            [managedABContactsToBeDeleted addObject:[managedABContacts objectForKey:identifier]];
+        }
+
+        if (diff.removedIdentifiers.count > 0) {
+            [realm deleteObjects:[NCContact objectsWhere:@"identifier IN %@", diff.removedIdentifiers.allObjects]];
         }
+
         [realm deleteObjects:managedABContactsToBeDeleted];
-        NSLog(@"Address Book Contacts updated");
+
+        [NCUtils log:[NSString stringWithFormat:@"Address Book Contacts updated: %ld added, %ld changed, %ld deleted",
+                      (long)diff.addedIdentifiers.count, (long)diff.changedIdentifiers.count, (long)diff.removedIdentifiers.count]];
     }];
+
+    return YES;
+}
+
+- (NSDictionary *)phoneNumbersOfContactsChangedSince:(NSInteger)timestamp
+{
+    NSMutableDictionary *phoneNumbersDict = [NSMutableDictionary new];
+    RLMResults *managedABContacts = [ABContact objectsWhere:@"lastUpdate > %ld", (long)timestamp];
+
+    for (ABContact *managedABContact in managedABContacts) {
+        NSMutableArray *phoneNumbers = [NSMutableArray new];
+        for (NSString *phoneNumber in managedABContact.phoneNumbers) {
+            [phoneNumbers addObject:phoneNumber];
+        }
+        [phoneNumbersDict setObject:phoneNumbers forKey:managedABContact.identifier];
+    }
+
+    return phoneNumbersDict;
 }
 
-- (void)searchForPhoneNumbers:(NSDictionary *)phoneNumbers forAccount:(TalkAccount *)account
+- (void)searchForPhoneNumbers:(NSDictionary *)phoneNumbers forAccount:(TalkAccount *)account fullSync:(BOOL)fullSync syncTimestamp:(NSInteger)syncTimestamp
 {
+    if (phoneNumbers.count == 0) {
+        // No phone numbers changed, there's nothing to search for
+        [self storeMatchedContacts:@{} forSearchedIdentifiers:@[] forAccount:account fullSync:fullSync syncTimestamp:syncTimestamp];
+        return;
+    }
+
+    [NCUtils log:[NSString stringWithFormat:@"Searching for %ld contacts in the server (full sync: %@)", (long)phoneNumbers.count, fullSync ? @"YES" : @"NO"]];
+
     [[NCAPIController sharedInstance] searchContactsForAccount:account withPhoneNumbers:phoneNumbers andCompletionBlock:^(NSDictionary *contacts, NSError *error) {
         if (!error) {
             BGTaskHelper *bgTask = [BGTaskHelper startBackgroundTaskWithName:@"NCUpdateContacts" expirationHandler:nil];
-            RLMRealm *realm = [RLMRealm defaultRealm];
-            [realm transactionWithBlock:^{
-                NSInteger updateTimestamp = [[NSDate date] timeIntervalSince1970];
-                // Add or update matched contacts
-                if (contacts.count > 0) {
-                    for (NSString *identifier in contacts.allKeys) {
-                        NSString *cloudId = [contacts objectForKey:identifier];
-                        NCContact *contact = [NCContact contactWithIdentifier:identifier cloudId:cloudId lastUpdate:updateTimestamp andAccountId:account.accountId];
-                        // Filter out app user (it could have its own phone number in address book)
-                        if ([contact.userId isEqualToString:account.userId]) {
-                            continue;
-                        }
-                        NCContact *managedNCContact = [NCContact objectsWhere:@"identifier = %@ AND accountId = %@", identifier, account.accountId].firstObject;
-                        if (managedNCContact) {
-                            [NCContact updateContact:managedNCContact withContact:contact];
-                        } else {
-                            [realm addObject:contact];
-                        }
-                    }
-                }
-                // Delete old contacts
-                NSPredicate *query = [NSPredicate predicateWithFormat:@"accountId = %@ AND lastUpdate != %ld", account.accountId, (long)updateTimestamp];
-                RLMResults *managedNCContactsToBeDeleted = [NCContact objectsWithPredicate:query];
-                [realm deleteObjects:managedNCContactsToBeDeleted];
-                // Update last sync for account
-                NSPredicate *accountQuery = [NSPredicate predicateWithFormat:@"accountId = %@", account.accountId];
-                TalkAccount *managedAccount = [TalkAccount objectsWithPredicate:accountQuery].firstObject;
-                managedAccount.lastContactSync = updateTimestamp;
-                NSLog(@"Matched NC Contacts updated");
-                [[NSNotificationCenter defaultCenter] postNotificationName:NCContactsManagerContactsUpdatedNotification
-                                                                    object:self
-                                                                  userInfo:nil];
-                [bgTask stopBackgroundTask];
-            }];
+            [self storeMatchedContacts:contacts forSearchedIdentifiers:phoneNumbers.allKeys forAccount:account fullSync:fullSync syncTimestamp:syncTimestamp];
+            [bgTask stopBackgroundTask];
+        }
+    }];
+}
+
+- (void)storeMatchedContacts:(NSDictionary *)contacts forSearchedIdentifiers:(NSArray *)searchedIdentifiers forAccount:(TalkAccount *)account fullSync:(BOOL)fullSync syncTimestamp:(NSInteger)syncTimestamp
+{
+    RLMRealm *realm = [RLMRealm defaultRealm];
+    [realm transactionWithBlock:^{
+        NSInteger updateTimestamp = [[NSDate date] timeIntervalSince1970];
+
+        // Only the searched contacts can change, unless everything was searched again
+        RLMResults *managedNCContacts;
+        if (fullSync) {
+            managedNCContacts = [NCContact objectsWhere:@"accountId = %@", account.accountId];
+        } else {
+            managedNCContacts = [NCContact objectsWhere:@"accountId = %@ AND identifier IN %@", account.accountId, searchedIdentifiers];
+        }
+
+        NSMutableDictionary<NSString *, NCContact *> *managedNCContactsDict = [NSMutableDictionary new];
+        NSMutableArray *managedNCContactsToBeDeleted = [NSMutableArray new];
+        for (NCContact *managedNCContact in managedNCContacts) {
+            if ([managedNCContactsDict objectForKey:managedNCContact.identifier]) {
+                [managedNCContactsToBeDeleted addObject:managedNCContact];
+            } else {
+                [managedNCContactsDict setObject:managedNCContact forKey:managedNCContact.identifier];
+            }
         }
+
+        NSMutableArray<NSString *> *matchedIdentifiers = [NSMutableArray new];
+
+        // Add or update matched contacts
+        for (NSString *identifier in contacts.allKeys) {
+            NSString *cloudId = [contacts objectForKey:identifier];
+            NCContact *contact = [NCContact contactWithIdentifier:identifier cloudId:cloudId lastUpdate:updateTimestamp andAccountId:account.accountId];
+            // Filter out app user (it could have its own phone number in address book)
+            if ([contact.userId isEqualToString:account.userId]) {
+                continue;
+            }
+            [matchedIdentifiers addObject:identifier];
+            NCContact *managedNCContact = [managedNCContactsDict objectForKey:identifier];
+            if (managedNCContact) {
+                [NCContact updateContact:managedNCContact withContact:contact];
+            } else {
+                [realm addObject:contact];
+            }
+        }
+
+        // Delete contacts that don't match anymore
+        NSSet *staleMatches = [NCAddressBookDiff staleMatchesInStoredMatches:managedNCContactsDict.allKeys
+                                                              currentMatches:matchedIdentifiers
+                                                         searchedIdentifiers:searchedIdentifiers
+                                                                    fullSync:fullSync];
+        for (NSString *identifier in staleMatches) {
+            [managedNCContactsToBeDeleted addObject:[managedNCContactsDict objectForKey:identifier]];
+        }
+        [realm deleteObjects:managedNCContactsToBeDeleted];
+
+        // Update last sync for account, contacts changed after the sync started are searched in the next sync
+        NSPredicate *accountQuery = [NSPredicate predicateWithFormat:@"accountId = %@", account.accountId];
+        TalkAccount *managedAccount = [TalkAccount objectsWithPredicate:accountQuery].firstObject;
+        managedAccount.lastContactSync = syncTimestamp;
+        [NCUtils log:[NSString stringWithFormat:@"Matched NC Contacts updated: %ld matches, %ld removed", (long)matchedIdentifiers.count, (long)staleMatches.count]];
+        [[NSNotificationCenter defaultCenter] postNotificationName:NCContactsManagerContactsUpdatedNotification
+                                                            object:self
+                                                          userInfo:nil];
     }];
 }
 
@@ -26,14 +26,19 @@
 #import "NCAppBranding.h"
 #import "NCChatBlock.h"
 #import "NCChatMessage.h"
+#import "NCCompiledServerCapabilities.h"
 #import "NCContact.h"
+#import "NCReadModelCache.h"
 #import "NCRoom.h"
+#import "NotificationCenterNotifications.h"
+
+#import <os/lock.h>
 
 #import "NextcloudTalk-Swift.h"
 
 NSString *const kTalkDatabaseFolder                 = @"Library/Application Support/Talk";
 NSString *const kTalkDatabaseFileName               = @"talk.realm";
-uint64_t const kTalkDatabaseSchemaVersion           = 54;
+uint64_t const kTalkDatabaseSchemaVersion           = 56;
 
 NSString * const kCapabilitySystemMessages          = @"system-messages";
 NSString * const kCapabilityNotificationLevels      = @"notification-levels";
@@ -87,6 +92,51 @@ NSString * const kNotificationsCapabilityExists     = @"exists";
 
 NSString * const kMinimumRequiredTalkCapability     = kCapabilitySystemMessages; // Talk 4.0 is the minimum required version
 
+// Maps every known capability to a bit in NCCompiledServerCapabilities.talkCapabilityBits
+static NSDictionary<NSString *, NSNumber *> *knownTalkCapabilityBits(void)
+{
+    static NSDictionary *capabilityBits;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        NSArray *knownCapabilities = @[kCapabilitySystemMessages, kCapabilityNotificationLevels, kCapabilityInviteGroupsAndMails,
+                                       kCapabilityLockedOneToOneRooms, kCapabilityWebinaryLobby, kCapabilityChatReadMarker,
+                                       kCapabilityStartCallFlag, kCapabilityCirclesSupport, kCapabilityChatReferenceId,
+                                       kCapabilityPhonebookSearch, kCapabilityChatReadStatus, kCapabilityReadOnlyRooms,
+                                       kCapabilityListableRooms, kCapabilityDeleteMessages, kCapabilityCallFlags,
+                                       kCapabilityRoomDescription, kCapabilityTempUserAvatarAPI, kCapabilityLocationSharing,
+                                       kCapabilityConversationV4, kCapabilitySIPSupport, kCapabilitySIPSupportNoPIN,
+                                       kCapabilityVoiceMessage, kCapabilitySignalingV3, kCapabilityClearHistory,
+                                       kCapabilityDirectMentionFlag, kCapabilityNotificationCalls, kCapabilityConversationPermissions,
+                                       kCapabilityChatUnread, kCapabilityReactions, kCapabilityRichObjectListMedia,
+                                       kCapabilityRichObjectDelete, kCapabilityUnifiedSearch, kCapabilityChatPermission,
+                                       kCapabilityMessageExpiration, kCapabilitySilentSend, kCapabilitySilentCall,
+                                       kCapabilitySendCallNotification, kCapabilityTalkPolls, kCapabilityRaiseHand,
+                                       kCapabilityRecordingV1, kCapabilitySingleConvStatus, kCapabilityChatKeepNotifications,
+                                       kCapabilityConversationAvatars, kCapabilityTypingIndicators, kCapabilityPublishingPermissions,
+                                       kCapabilityRemindMeLater, kCapabilityMarkdownMessages];
+
+        NSCAssert(knownCapabilities.count <= 64, @"Known capabilities need to fit into a 64 bit bitset");
+
+        NSMutableDictionary *bits = [NSMutableDictionary new];
+        [knownCapabilities enumerateObjectsUsingBlock:^(NSString *capability, NSUInteger index, BOOL *stop) {
+            [bits setObject:@(index) forKey:capability];
+        }];
+
+        capabilityBits = bits;
+    });
+
+    return capabilityBits;
+}
+
+@interface NCDatabaseManager ()
+{
+    os_unfair_lock _compiledCapabilitiesLock;
+    NSMutableDictionary<NSString *, NCCompiledServerCapabilities *> *_compiledCapabilities;
+    RLMNotificationToken *_serverCapabilitiesNotificationToken;
+}
+
+@end
+
 @implementation NCDatabaseManager
 
 + (NCDatabaseManager *)sharedInstance
@@ -125,6 +175,12 @@ NSString * const kMinimumRequiredTalkCapability     = kCapabilitySystemMessages;
         // Now that we've told Realm how to handle the schema change, opening the file
         // will automatically perform the migration
         [RLMRealm defaultRealm];
+
+        _compiledCapabilitiesLock = OS_UNFAIR_LOCK_INIT;
+        _compiledCapabilities = [NSMutableDictionary new];
+        [self observeServerCapabilities];
+
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(talkConfigurationHasChanged:) name:NCTalkConfigurationHashChangedNotification object:nil];
         
 #ifdef DEBUG
         // Copy Talk DB to Documents directory
@@ -147,41 +203,54 @@ NSString * const kMinimumRequiredTalkCapability     = kCapabilitySystemMessages;
 
 - (TalkAccount *)activeAccount
 {
-    TalkAccount *managedActiveAccount = [TalkAccount objectsWhere:(@"active = true")].firstObject;
-    if (managedActiveAccount) {
-        return [[TalkAccount alloc] initWithValue:managedActiveAccount];
-    }
-    return nil;
+    return [[NCReadModelCache sharedInstance] snapshotForKey:@"activeAccount" createdWithBlock:^id{
+        TalkAccount *managedActiveAccount = [TalkAccount objectsWhere:(@"active = true")].firstObject;
+        if (managedActiveAccount) {
+            return [[TalkAccount alloc] initWithValue:managedActiveAccount];
+        }
+        return nil;
+    }];
 }
 
 - (NSArray *)allAccounts
 {
-    NSMutableArray *allAccounts = [NSMutableArray new];
-    for (TalkAccount *managedAccount in [TalkAccount allObjects]) {
-        TalkAccount *account = [[TalkAccount alloc] initWithValue:managedAccount];
-        [allAccounts addObject:account];
-    }
-    return allAccounts;
+    return [[NCReadModelCache sharedInstance] snapshotForKey:@"allAccounts" createdWithBlock:^id{
+        NSMutableArray *allAccounts = [NSMutableArray new];
+        for (TalkAccount *managedAccount in [TalkAccount allObjects]) {
+            TalkAccount *account = [[TalkAccount alloc] initWithValue:managedAccount];
+            [allAccounts addObject:account];
+        }
+        return [allAccounts copy];
+    }];
 }
 
 - (NSArray *)inactiveAccounts
 {
-    NSMutableArray *inactiveAccounts = [NSMutableArray new];
-    for (TalkAccount *managedInactiveAccount in [TalkAccount objectsWhere:(@"active = false")]) {
-        TalkAccount *inactiveAccount = [[TalkAccount alloc] initWithValue:managedInactiveAccount];
-        [inactiveAccounts addObject:inactiveAccount];
-    }
-    return inactiveAccounts;
+    return [[NCReadModelCache sharedInstance] snapshotForKey:@"inactiveAccounts" createdWithBlock:^id{
+        NSMutableArray *inactiveAccounts = [NSMutableArray new];
+        for (TalkAccount *managedInactiveAccount in [TalkAccount objectsWhere:(@"active = false")]) {
+            TalkAccount *inactiveAccount = [[TalkAccount alloc] initWithValue:managedInactiveAccount];
+            [inactiveAccounts addObject:inactiveAccount];
+        }
+        return [inactiveAccounts copy];
+    }];
 }
 
 - (TalkAccount *)talkAccountForAccountId:(NSString *)accountId
 {
-    NSPredicate *query = [NSPredicate predicateWithFormat:@"accountId = %@", accountId];
-    TalkAccount *managedAccount = [TalkAccount objectsWithPredicate:query].firstObject;
-    if (managedAccount) {
-        return [[TalkAccount alloc] initWithValue:managedAccount];
+    if (!accountId) {
+        return nil;
     }
-    return nil;
+
+    NSString *snapshotKey = [NSString stringWithFormat:@"account-%@", accountId];
+    return [[NCReadModelCache sharedInstance] snapshotForKey:snapshotKey createdWithBlock:^id{
+        NSPredicate *query = [NSPredicate predicateWithFormat:@"accountId = %@", accountId];
+        TalkAccount *managedAccount = [TalkAccount objectsWithPredicate:query].firstObject;
+        if (managedAccount) {
+            return [[TalkAccount alloc] initWithValue:managedAccount];
+        }
+        return nil;
+    }];
 }
 
 - (TalkAccount *)talkAccountForUserId:(NSString *)userId inServer:(NSString *)server
@@ -248,6 +317,8 @@ NSString * const kMinimumRequiredTalkCapability     = kCapabilitySystemMessages;
         [realm deleteObjects:[ABContact allObjects]];
     }
     [realm commitWriteTransaction];
+
+    [self invalidateCompiledCapabilitiesForAccountId:accountId];
 }
 
 - (void)increaseUnreadBadgeNumberForAccountId:(NSString *)accountId
@@ -450,6 +521,95 @@ NSString * const kMinimumRequiredTalkCapability     = kCapabilitySystemMessages;
     [realm transactionWithBlock:^{
         [realm addOrUpdateObject:capabilities];
     }];
+
+    NCCompiledServerCapabilities *compiledCapabilities = [self compiledCapabilitiesWithServerCapabilities:capabilities];
+
+    os_unfair_lock_lock(&_compiledCapabilitiesLock);
+    [_compiledCapabilities setObject:compiledCapabilities forKey:accountId];
+    os_unfair_lock_unlock(&_compiledCapabilitiesLock);
+}
+
+- (NCCompiledServerCapabilities *)compiledCapabilitiesWithServerCapabilities:(ServerCapabilities *)serverCapabilities
+{
+    return [[NCCompiledServerCapabilities alloc] initWithTalkCapabilities:[serverCapabilities.talkCapabilities valueForKey:@"self"]
+                                                notificationsCapabilities:[serverCapabilities.notificationsCapabilities valueForKey:@"self"]
+                                                  knownTalkCapabilityBits:knownTalkCapabilityBits()];
+}
+
+- (NCCompiledServerCapabilities *)compiledCapabilitiesForAccountId:(NSString *)accountId
+{
+    if (!accountId) {
+        return nil;
+    }
+
+    os_unfair_lock_lock(&_compiledCapabilitiesLock);
+    NCCompiledServerCapabilities *compiledCapabilities = [_compiledCapabilities objectForKey:accountId];
+    os_unfair_lock_unlock(&_compiledCapabilitiesLock);
+
+    if (compiledCapabilities) {
+        return compiledCapabilities;
+    }
+
+    // Not compiled yet (e.g. after app start), use the stored capabilities
+    NSPredicate *query = [NSPredicate predicateWithFormat:@"accountId = %@", accountId];
+    ServerCapabilities *managedServerCapabilities = [ServerCapabilities objectsWithPredicate:query].firstObject;
+
+    if (!managedServerCapabilities) {
+        return nil;
+    }
+
+    compiledCapabilities = [self compiledCapabilitiesWithServerCapabilities:managedServerCapabilities];
+
+    os_unfair_lock_lock(&_compiledCapabilitiesLock);
+    [_compiledCapabilities setObject:compiledCapabilities forKey:accountId];
+    os_unfair_lock_unlock(&_compiledCapabilitiesLock);
+
+    return compiledCapabilities;
+}
+
+- (void)invalidateCompiledCapabilitiesForAccountId:(NSString *)accountId
+{
+    if (!accountId) {
+        return;
+    }
+
+    os_unfair_lock_lock(&_compiledCapabilitiesLock);
+    [_compiledCapabilities removeObjectForKey:accountId];
+    os_unfair_lock_unlock(&_compiledCapabilitiesLock);
+}
+
+- (void)invalidateAllCompiledCapabilities
+{
+    os_unfair_lock_lock(&_compiledCapabilitiesLock);
+    [_compiledCapabilities removeAllObjects];
+    os_unfair_lock_unlock(&_compiledCapabilitiesLock);
+}
+
+- (void)observeServerCapabilities
+{
+    // Realm only delivers notifications on threads with a run loop
+    if (![NSThread isMainThread]) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self observeServerCapabilities];
+        });
+
+        return;
+    }
+
+    // The extensions store capabilities in their own process, Realm notifies us about their writes as well
+    __weak typeof(self) weakSelf = self;
+    _serverCapabilitiesNotificationToken = [[ServerCapabilities allObjects] addNotificationBlock:^(RLMResults *results, RLMCollectionChange *change, NSError *error) {
+        // The initial notification has no changes
+        if (change) {
+            [weakSelf invalidateAllCompiledCapabilities];
+        }
+    }];
+}
+
+- (void)talkConfigurationHasChanged:(NSNotification *)notification
+{
+    // Capabilities will be fetched again, until then they are compiled again from the database on the next check
+    [self invalidateCompiledCapabilitiesForAccountId:[notification.userInfo objectForKey:@"accountId"]];
 }
 
 - (BOOL)serverHasTalkCapability:(NSString *)capability
@@ -460,29 +620,14 @@ NSString * const kMinimumRequiredTalkCapability     = kCapabilitySystemMessages;
 
 - (BOOL)serverHasTalkCapability:(NSString *)capability forAccountId:(NSString *)accountId
 {
-    ServerCapabilities *serverCapabilities  = [self serverCapabilitiesForAccountId:accountId];
-    if (serverCapabilities) {
-        NSArray *talkFeatures = [serverCapabilities.talkCapabilities valueForKey:@"self"];
-        if ([talkFeatures containsObject:capability]) {
-            return YES;
-        }
-    }
-    return NO;
+    return [[self compiledCapabilitiesForAccountId:accountId] hasTalkCapability:capability];
 }
 
 - (BOOL)serverHasNotificationsCapability:(NSString *)capability forAccountId:(NSString *)accountId
 {
-    ServerCapabilities *serverCapabilities  = [self serverCapabilitiesForAccountId:accountId];
-    if (serverCapabilities) {
-        NSArray *notificationsFeatures = [serverCapabilities.notificationsCapabilities valueForKey:@"self"];
-        if ([notificationsFeatures containsObject:capability]) {
-            return YES;
-        }
-    }
-    return NO;
+    return [[self compiledCapabilitiesForAccountId:accountId].notificationsCapabilities containsObject:capability];
 }
 
-
 - (void)setExternalSignalingServerVersion:(NSString *)version forAccountId:(NSString *)accountId
 {
     RLMRealm *realm = [RLMRealm defaultRealm];
@@ -67,6 +67,7 @@ typedef void (^JoinRoomExternalSignalingCompletionBlock)(NSError *error);
 - (void)leaveRoom:(NSString *)roomId;
 - (void)sendCallMessage:(NCSignalingMessage *)message;
 - (void)requestOfferForSessionId:(NSString *)sessionId andRoomType:(NSString *)roomType;
+- (void)selectStream:(NSDictionary *)streamSelection forSessionId:(NSString *)sessionId andRoomType:(NSString *)roomType;
 - (NSString *)getUserIdFromSessionId:(NSString *)sessionId;
 - (NSString *)getDisplayNameFromSessionId:(NSString *)sessionId;
 - (NSMutableDictionary *)getParticipantMap;
@@ -468,6 +468,27 @@ NSString * const NCExternalSignalingControllerDidReceiveStoppedTypingNotificatio
     [self sendMessage:messageDict withCompletionBlock:nil];
 }
 
+- (void)selectStream:(NSDictionary *)streamSelection forSessionId:(NSString *)sessionId andRoomType:(NSString *)roomType
+{
+    // Handled by the MCU for the subscriber of the given session, e.g. {"video": false} pauses the video
+    NSDictionary *messageDict = @{
+                                  @"type": @"message",
+                                  @"message": @{
+                                          @"recipient": @{
+                                                  @"type": @"session",
+                                                  @"sessionid": sessionId
+                                                  },
+                                          @"data": @{
+                                                  @"type": @"selectStream",
+                                                  @"roomType": roomType,
+                                                  @"payload": streamSelection
+                                                  }
+                                          }
+                                  };
+
+    [self sendMessage:messageDict withCompletionBlock:nil];
+}
+
 - (void)roomMessageReceived:(NSDictionary *)messageDict
 {
     NSString *newRoomId = [[messageDict objectForKey:@"room"] objectForKey:@"roomid"];
@@ -0,0 +1,54 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+extern NSTimeInterval const kNCLoggerNoLatency;
+
+/**
+ Log entries are only stored in a preallocated lock-free ring buffer on the calling thread.
+ Formatting and writing to the logfile happens periodically on a background queue.
+ When the writer can't keep up, new entries are dropped and the number of dropped entries is logged.
+ */
+@interface NCLogger : NSObject
+
+// Maximum size of the current logfile before it gets rotated
+@property (nonatomic, assign) unsigned long long maxLogfileSize;
+// Maximum number of rotated logfiles to keep
+@property (nonatomic, assign) NSInteger maxRotatedLogfiles;
+
++ (instancetype)sharedInstance;
+
+// Writes the logfiles to the given directory instead of the logs directory in the documents directory
+- (instancetype)initWithLogDirectoryPath:(nullable NSString *)logDirectoryPath;
+
+- (void)logMessage:(NSString *)message;
+- (void)logMessage:(NSString *)message subsystem:(nullable NSString *)subsystem accountId:(nullable NSString *)accountId roomToken:(nullable NSString *)roomToken latency:(NSTimeInterval)latency;
+
+// Writes all buffered entries to the logfile before returning
+- (void)flush;
+
+@end
+
+NS_ASSUME_NONNULL_END
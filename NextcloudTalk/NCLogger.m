@@ -0,0 +1,418 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import "NCLogger.h"
+
+#import <os/log.h>
+#import <stdatomic.h>
+
+#if TARGET_OS_IPHONE
+#import <UIKit/UIKit.h>
+#endif
+
+NSTimeInterval const kNCLoggerNoLatency = -1;
+
+// Must be a power of two
+static NSUInteger const kNCLoggerBufferCapacity         = 2048;
+static NSUInteger const kNCLoggerQueueLabelLength       = 64;
+static NSUInteger const kNCLoggerFlushThreshold         = 256;
+static NSTimeInterval const kNCLoggerFlushInterval      = 2;
+static NSInteger const kNCLoggerMaxLogfileAgeInDays     = 10;
+static NSString * const kNCLoggerCurrentLogfileName     = @"debug.log";
+
+// A slot of the ring buffer. The sequence tells whether the slot can be filled by a logging thread (sequence == position)
+// or read by the writer (sequence == position + 1), see Dmitry Vyukov's bounded MPMC queue.
+typedef struct {
+    atomic_size_t sequence;
+    CFAbsoluteTime timestamp;
+    NSTimeInterval latency;
+    __strong NSString *message;
+    __strong NSString *subsystem;
+    __strong NSString *accountId;
+    __strong NSString *roomToken;
+    char queueLabel[kNCLoggerQueueLabelLength];
+} NCLogEntry;
+
+@interface NCLogger ()
+{
+    // Preallocated ring buffer, logging threads only claim a slot with a compare-and-swap and never allocate or lock
+    NCLogEntry *_entries;
+    atomic_size_t _enqueuePosition;
+    atomic_size_t _dequeuePosition;
+    atomic_size_t _droppedEntries;
+    atomic_bool _flushScheduled;
+
+    dispatch_queue_t _writeQueue;
+    dispatch_source_t _flushTimer;
+    NSFileHandle *_fileHandle;
+    NSString *_logDirectoryPath;
+    NSDateFormatter *_entryDateFormatter;
+    NSDateFormatter *_fileDateFormatter;
+    os_log_t _osLog;
+}
+
+@end
+
+@implementation NCLogger
+
++ (instancetype)sharedInstance
+{
+    static dispatch_once_t once;
+    static NCLogger *sharedInstance;
+    dispatch_once(&once, ^{
+        sharedInstance = [[self alloc] init];
+    });
+    return sharedInstance;
+}
+
+- (instancetype)init
+{
+    return [self initWithLogDirectoryPath:nil];
+}
+
+- (instancetype)initWithLogDirectoryPath:(NSString *)logDirectoryPath
+{
+    self = [super init];
+    if (self) {
+        _maxLogfileSize = 2 * 1024 * 1024;
+        _maxRotatedLogfiles = 10;
+
+        if (logDirectoryPath) {
+            [[NSFileManager defaultManager] createDirectoryAtPath:logDirectoryPath withIntermediateDirectories:YES attributes:nil error:nil];
+            _logDirectoryPath = logDirectoryPath;
+        }
+
+        _entries = calloc(kNCLoggerBufferCapacity, sizeof(NCLogEntry));
+
+        for (NSUInteger i = 0; i < kNCLoggerBufferCapacity; i++) {
+            atomic_init(&_entries[i].sequence, i);
+        }
+
+        atomic_init(&_enqueuePosition, 0);
+        atomic_init(&_dequeuePosition, 0);
+        atomic_init(&_droppedEntries, 0);
+        atomic_init(&_flushScheduled, false);
+
+        _writeQueue = dispatch_queue_create("com.nextcloud.Talk.NCLogger", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+        _osLog = os_log_create("com.nextcloud.Talk", "NCLogger");
+
+        _entryDateFormatter = [[NSDateFormatter alloc] init];
+        _entryDateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        _entryDateFormatter.dateFormat = @"y-MM-dd H:mm:ss.SSSS";
+
+        _fileDateFormatter = [[NSDateFormatter alloc] init];
+        _fileDateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        _fileDateFormatter.dateFormat = @"yyyy-MM-dd-HHmmss-SSS";
+
+        // Periodically write buffered entries, even if the flush threshold was not reached
+        _flushTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _writeQueue);
+        dispatch_source_set_timer(_flushTimer, dispatch_time(DISPATCH_TIME_NOW, kNCLoggerFlushInterval * NSEC_PER_SEC), kNCLoggerFlushInterval * NSEC_PER_SEC, NSEC_PER_SEC / 2);
+
+        __weak typeof(self) weakSelf = self;
+        dispatch_source_set_event_handler(_flushTimer, ^{
+            [weakSelf writeBufferedEntries];
+        });
+        dispatch_resume(_flushTimer);
+
+        dispatch_async(_writeQueue, ^{
+            [self removeOldLogfiles];
+        });
+
+#if TARGET_OS_IPHONE
+        // Make sure everything is written before we might get suspended
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(flush) name:UIApplicationDidEnterBackgroundNotification object:nil];
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(flush) name:UIApplicationWillTerminateNotification object:nil];
+#endif
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    dispatch_source_cancel(_flushTimer);
+
+    // The struct contains strong references, release them before freeing the buffer
+    for (NSUInteger i = 0; i < kNCLoggerBufferCapacity; i++) {
+        _entries[i].message = nil;
+        _entries[i].subsystem = nil;
+        _entries[i].accountId = nil;
+        _entries[i].roomToken = nil;
+    }
+
+    free(_entries);
+}
+
+#pragma mark - Logging
+
+- (void)logMessage:(NSString *)message
+{
+    [self logMessage:message subsystem:nil accountId:nil roomToken:nil latency:kNCLoggerNoLatency];
+}
+
+- (void)logMessage:(NSString *)message subsystem:(NSString *)subsystem accountId:(NSString *)accountId roomToken:(NSString *)roomToken latency:(NSTimeInterval)latency
+{
+    CFAbsoluteTime timestamp = CFAbsoluteTimeGetCurrent();
+    size_t position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+    NCLogEntry *entry;
+
+    // Claim the next free slot
+    while (true) {
+        entry = &_entries[position & (kNCLoggerBufferCapacity - 1)];
+        size_t sequence = atomic_load_explicit(&entry->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&_enqueuePosition, &position, position + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // Buffer is full and the writer could not keep up -> drop the entry
+            atomic_fetch_add_explicit(&_droppedEntries, 1, memory_order_relaxed);
+            return;
+        } else {
+            // Another thread claimed the slot in the meantime
+            position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+        }
+    }
+
+    entry->timestamp = timestamp;
+    entry->message = message;
+    entry->subsystem = subsystem;
+    entry->accountId = accountId;
+    entry->roomToken = roomToken;
+    entry->latency = latency;
+
+    const char *queueLabel = dispatch_queue_get_label(DISPATCH_CURRENT_QUEUE_LABEL);
+    strlcpy(entry->queueLabel, queueLabel ?: "", kNCLoggerQueueLabelLength);
+
+    // Hand the slot over to the writer
+    atomic_store_explicit(&entry->sequence, position + 1, memory_order_release);
+
+    size_t bufferedEntries = position + 1 - atomic_load_explicit(&_dequeuePosition, memory_order_relaxed);
+
+    if (bufferedEntries >= kNCLoggerFlushThreshold && !atomic_exchange_explicit(&_flushScheduled, true, memory_order_relaxed)) {
+        dispatch_async(_writeQueue, ^{
+            [self writeBufferedEntries];
+        });
+    }
+}
+
+- (void)flush
+{
+    dispatch_sync(_writeQueue, ^{
+        [self writeBufferedEntries];
+        [self->_fileHandle synchronizeFile];
+    });
+}
+
+#pragma mark - Writing
+
+- (void)writeBufferedEntries
+{
+    atomic_store_explicit(&_flushScheduled, false, memory_order_relaxed);
+
+    NSMutableString *output = [NSMutableString new];
+    size_t droppedEntries = atomic_exchange_explicit(&_droppedEntries, 0, memory_order_relaxed);
+
+    if (droppedEntries > 0) {
+        [output appendFormat:@"%@: Dropped %ld log entries\n", [_entryDateFormatter stringFromDate:[NSDate date]], (long)droppedEntries];
+    }
+
+    // This is the only consumer, so the entries can be read without claiming them
+    size_t position = atomic_load_explicit(&_dequeuePosition, memory_order_relaxed);
+
+    while (true) {
+        NCLogEntry *entry = &_entries[position & (kNCLoggerBufferCapacity - 1)];
+
+        if (atomic_load_explicit(&entry->sequence, memory_order_acquire) != position + 1) {
+            break;
+        }
+
+        NSString *line = [self formattedLogEntry:entry];
+        [output appendString:line];
+
+        os_log(_osLog, "%{public}@", line);
+
+        entry->message = nil;
+        entry->subsystem = nil;
+        entry->accountId = nil;
+        entry->roomToken = nil;
+
+        // Hand the slot back to the logging threads for the next round
+        atomic_store_explicit(&entry->sequence, position + kNCLoggerBufferCapacity, memory_order_release);
+        position++;
+    }
+
+    atomic_store_explicit(&_dequeuePosition, position, memory_order_relaxed);
+
+    if (output.length == 0) {
+        return;
+    }
+
+    @try {
+        NSFileHandle *fileHandle = [self currentLogfileHandle];
+        [fileHandle writeData:[output dataUsingEncoding:NSUTF8StringEncoding]];
+
+        if ([fileHandle offsetInFile] >= _maxLogfileSize) {
+            [self rotateLogfile];
+        }
+    } @catch (NSException *exception) {
+        NSLog(@"Exception in NCLogger: %@", exception.description);
+
+        [_fileHandle closeFile];
+        _fileHandle = nil;
+    }
+}
+
+- (NSString *)formattedLogEntry:(NCLogEntry *)entry
+{
+    NSMutableString *line = [NSMutableString stringWithString:[_entryDateFormatter stringFromDate:[NSDate dateWithTimeIntervalSinceReferenceDate:entry->timestamp]]];
+
+    [line appendFormat:@" (%s)", entry->queueLabel[0] ? entry->queueLabel : "unknown"];
+
+    if (entry->subsystem) {
+        [line appendFormat:@" [%@]", entry->subsystem];
+    }
+
+    if (entry->accountId) {
+        [line appendFormat:@" account=%@", entry->accountId];
+    }
+
+    if (entry->roomToken) {
+        [line appendFormat:@" room=%@", entry->roomToken];
+    }
+
+    if (entry->latency >= 0) {
+        [line appendFormat:@" latency=%.0fms", entry->latency * 1000];
+    }
+
+    [line appendFormat:@": %@\n", entry->message];
+
+    return line;
+}
+
+#pragma mark - Logfiles
+
+- (NSString *)logDirectoryPath
+{
+    if (_logDirectoryPath) {
+        return _logDirectoryPath;
+    }
+
+    NSURL *documentDir = [[[NSFileManager defaultManager] URLsForDirectory:NSDocumentDirectory inDomains:NSUserDomainMask] firstObject];
+
+    if (!documentDir) {
+        NSLog(@"Unable to retrieve document directory");
+        return nil;
+    }
+
+    NSString *logPath = [[documentDir URLByAppendingPathComponent:@"logs"] path];
+
+    // Allow writing to files while the app is in the background
+    if (![[NSFileManager defaultManager] fileExistsAtPath:logPath]) {
+        [[NSFileManager defaultManager] createDirectoryAtPath:logPath withIntermediateDirectories:YES attributes:nil error:nil];
+    }
+#if TARGET_OS_IPHONE
+    [[NSFileManager defaultManager] setAttributes:@{NSFileProtectionKey:NSFileProtectionNone} ofItemAtPath:logPath error:nil];
+#endif
+
+    _logDirectoryPath = logPath;
+
+    return _logDirectoryPath;
+}
+
+- (NSFileHandle *)currentLogfileHandle
+{
+    if (_fileHandle) {
+        return _fileHandle;
+    }
+
+    NSString *logDirectoryPath = [self logDirectoryPath];
+
+    if (!logDirectoryPath) {
+        return nil;
+    }
+
+    NSString *logfilePath = [logDirectoryPath stringByAppendingPathComponent:kNCLoggerCurrentLogfileName];
+
+    if (![[NSFileManager defaultManager] fileExistsAtPath:logfilePath]) {
+        [[NSFileManager defaultManager] createFileAtPath:logfilePath contents:nil attributes:nil];
+    }
+
+    _fileHandle = [NSFileHandle fileHandleForWritingAtPath:logfilePath];
+    [_fileHandle seekToEndOfFile];
+
+    return _fileHandle;
+}
+
+- (void)rotateLogfile
+{
+    NSString *logDirectoryPath = [self logDirectoryPath];
+
+    [_fileHandle closeFile];
+    _fileHandle = nil;
+
+    NSString *currentLogfilePath = [logDirectoryPath stringByAppendingPathComponent:kNCLoggerCurrentLogfileName];
+    NSString *rotatedLogfileDate = [_fileDateFormatter stringFromDate:[NSDate date]];
+    NSString *rotatedLogfilePath = [logDirectoryPath stringByAppendingPathComponent:[NSString stringWithFormat:@"debug-%@.log", rotatedLogfileDate]];
+
+    // Make sure we never overwrite another rotated logfile, even if rotations happen within the same millisecond
+    NSInteger counter = 1;
+    while ([[NSFileManager defaultManager] fileExistsAtPath:rotatedLogfilePath]) {
+        NSString *rotatedLogfileName = [NSString stringWithFormat:@"debug-%@-%ld.log", rotatedLogfileDate, (long)counter++];
+        rotatedLogfilePath = [logDirectoryPath stringByAppendingPathComponent:rotatedLogfileName];
+    }
+
+    [[NSFileManager defaultManager] moveItemAtPath:currentLogfilePath toPath:rotatedLogfilePath error:nil];
+
+    [self removeOldLogfiles];
+}
+
+- (void)removeOldLogfiles
+{
+    NSString *logDirectoryPath = [self logDirectoryPath];
+
+    if (!logDirectoryPath) {
+        return;
+    }
+
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSArray *files = [fileManager contentsOfDirectoryAtPath:logDirectoryPath error:nil];
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"SELF BEGINSWITH 'debug-' AND SELF ENDSWITH '.log'"];
+
+    // Rotated logfiles contain their date in the name, so sorting them by name sorts them by age (newest first)
+    NSArray *rotatedLogfiles = [[files filteredArrayUsingPredicate:predicate] sortedArrayUsingSelector:@selector(compare:)].reverseObjectEnumerator.allObjects;
+    NSDate *thresholdDate = [NSDate dateWithTimeIntervalSinceNow:-kNCLoggerMaxLogfileAgeInDays * 24 * 60 * 60];
+
+    for (NSUInteger i = 0; i < rotatedLogfiles.count; i++) {
+        NSString *filePath = [logDirectoryPath stringByAppendingPathComponent:rotatedLogfiles[i]];
+        NSDate *modificationDate = [[fileManager attributesOfItemAtPath:filePath error:nil] fileModificationDate];
+
+        if (i >= _maxRotatedLogfiles || [modificationDate compare:thresholdDate] == NSOrderedAscending) {
+            NSLog(@"Deleting old logfile %@", filePath);
+            [fileManager removeItemAtPath:filePath error:nil];
+        }
+    }
+}
+
+@end
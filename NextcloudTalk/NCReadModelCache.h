@@ -0,0 +1,44 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef id _Nullable (^NCReadModelCacheCreateBlock)(void);
+
+/**
+ Caches unmanaged copies of database objects on the main thread, so repeated reads don't need to query the database.
+ All snapshots are dropped whenever the default realm changes.
+ Every caller gets its own copy of the cached objects (also inside of arrays), so callers can modify them.
+ Reads from other threads are not cached.
+ */
+@interface NCReadModelCache : NSObject
+
++ (instancetype)sharedInstance;
+
+- (nullable id)snapshotForKey:(NSString *)key createdWithBlock:(NCReadModelCacheCreateBlock)block;
+- (void)invalidate;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,117 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import "NCReadModelCache.h"
+
+#import <Realm/Realm.h>
+
+@interface NCReadModelCache ()
+
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *snapshots;
+@property (nonatomic, strong) RLMNotificationToken *realmNotificationToken;
+
+@end
+
+@implementation NCReadModelCache
+
++ (instancetype)sharedInstance
+{
+    static dispatch_once_t once;
+    static NCReadModelCache *sharedInstance;
+    dispatch_once(&once, ^{
+        sharedInstance = [[self alloc] init];
+    });
+    return sharedInstance;
+}
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        _snapshots = [NSMutableDictionary new];
+    }
+
+    return self;
+}
+
+- (id)snapshotForKey:(NSString *)key createdWithBlock:(NCReadModelCacheCreateBlock)block
+{
+    // The realm of the main thread only advances when the run loop refreshes it (which triggers our notification)
+    // or when a transaction is committed on the main thread (which triggers the notification synchronously).
+    // That guarantees the cached snapshots are never older than a managed object read on the main thread.
+    if (![NSThread isMainThread] || [RLMRealm defaultRealm].inWriteTransaction) {
+        return block();
+    }
+
+    if (!_realmNotificationToken) {
+        __weak typeof(self) weakSelf = self;
+        _realmNotificationToken = [[RLMRealm defaultRealm] addNotificationBlock:^(RLMNotification notification, RLMRealm *realm) {
+            [weakSelf invalidate];
+        }];
+    }
+
+    id snapshot = [_snapshots objectForKey:key];
+
+    if (snapshot) {
+        return (snapshot == [NSNull null]) ? nil : [self copyOfSnapshot:snapshot];
+    }
+
+    snapshot = block();
+    [_snapshots setObject:(snapshot ?: [NSNull null]) forKey:key];
+
+    return [self copyOfSnapshot:snapshot];
+}
+
+- (id)copyOfSnapshot:(id)snapshot
+{
+    // Unmanaged objects are mutable, every caller gets its own copy, so a modification never leaks into the cache
+    if ([snapshot isKindOfClass:[RLMObject class]]) {
+        return [[[snapshot class] alloc] initWithValue:snapshot];
+    }
+
+    if ([snapshot isKindOfClass:[NSArray class]]) {
+        NSMutableArray *copies = [NSMutableArray arrayWithCapacity:[snapshot count]];
+
+        for (id object in snapshot) {
+            [copies addObject:[self copyOfSnapshot:object]];
+        }
+
+        return [copies copy];
+    }
+
+    return snapshot;
+}
+
+- (void)invalidate
+{
+    if (![NSThread isMainThread]) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self invalidate];
+        });
+
+        return;
+    }
+
+    [_snapshots removeAllObjects];
+}
+
+@end
@@ -30,8 +30,11 @@
 #import "NCChatBlock.h"
 #import "NCChatController.h"
 #import "NCChatMessage.h"
+#import "NCChatOutbox.h"
 #import "NCDatabaseManager.h"
 #import "NCExternalSignalingController.h"
+#import "NCLogger.h"
+#import "NCReadModelCache.h"
 #import "NCSettingsController.h"
 #import "NCUserInterfaceController.h"
 #import "NCUtils.h"
@@ -161,7 +164,11 @@ static NSInteger kNotJoiningAnymoreStatusCode = 999;
                 [userInfo setObject:error forKey:@"error"];
                 [userInfo setObject:@(statusCode) forKey:@"statusCode"];
                 [userInfo setObject:[self getJoinRoomErrorReason:statusCode] forKey:@"errorReason"];
-                [NCUtils log:[NSString stringWithFormat:@"Could not join room. Status code: %ld. Error: %@", (long)statusCode, error.description]];
+                [NCUtils log:[NSString stringWithFormat:@"Could not join room. Status code: %ld. Error: %@", (long)statusCode, error.description]
+                   subsystem:@"rooms"
+                   accountId:[[NCDatabaseManager sharedInstance] activeAccount].accountId
+                   roomToken:token
+                     latency:kNCLoggerNoLatency];
             }
 
             // Send join room notification
@@ -346,6 +353,18 @@ static NSInteger kNotJoiningAnymoreStatusCode = 999;
 }
 
 - (NSArray *)roomsForAccountId:(NSString *)accountId witRealm:(RLMRealm *)realm
+{
+    if (realm) {
+        return [self sortedRoomsForAccountId:accountId withRealm:realm];
+    }
+
+    NSString *snapshotKey = [NSString stringWithFormat:@"rooms-%@", accountId];
+    return [[NCReadModelCache sharedInstance] snapshotForKey:snapshotKey createdWithBlock:^id{
+        return [self sortedRoomsForAccountId:accountId withRealm:nil];
+    }];
+}
+
+- (NSArray *)sortedRoomsForAccountId:(NSString *)accountId withRealm:(RLMRealm *)realm
 {
     NSPredicate *query = [NSPredicate predicateWithFormat:@"accountId = %@", accountId];
     RLMResults *managedRooms = nil;
@@ -354,10 +373,17 @@ static NSInteger kNotJoiningAnymoreStatusCode = 999;
     } else {
         managedRooms = [NCRoom objectsWithPredicate:query];
     }
+
+    // Reuse snapshots of single rooms that were already requested since the last change
+    NCReadModelCache *readModelCache = [NCReadModelCache sharedInstance];
+
     // Create an unmanaged copy of the rooms
     NSMutableArray *unmanagedRooms = [NSMutableArray new];
     for (NCRoom *managedRoom in managedRooms) {
-        NCRoom *unmanagedRoom = [[NCRoom alloc] initWithValue:managedRoom];
+        NSString *snapshotKey = [NSString stringWithFormat:@"room-%@-%@", accountId, managedRoom.token];
+        NCRoom *unmanagedRoom = realm ? [[NCRoom alloc] initWithValue:managedRoom] : [readModelCache snapshotForKey:snapshotKey createdWithBlock:^id{
+            return [[NCRoom alloc] initWithValue:managedRoom];
+        }];
         // Filter out breakout rooms with lobby enabled
         if ([unmanagedRoom isBreakoutRoom] && unmanagedRoom.lobbyState == NCRoomLobbyStateModeratorsOnly) {
             continue;
@@ -380,18 +406,20 @@ static NSInteger kNotJoiningAnymoreStatusCode = 999;
     NSArray *descriptors = [NSArray arrayWithObjects:favoriteSorting, valueDescriptor, nil];
     [unmanagedRooms sortUsingDescriptors:descriptors];
     
-    return unmanagedRooms;
+    return [unmanagedRooms copy];
 }
 
 - (NCRoom *)roomWithToken:(NSString *)token forAccountId:(NSString *)accountId
 {
-    NCRoom *unmanagedRoom = nil;
-    NSPredicate *query = [NSPredicate predicateWithFormat:@"token = %@ AND accountId = %@", token, accountId];
-    NCRoom *managedRoom = [NCRoom objectsWithPredicate:query].firstObject;
-    if (managedRoom) {
-        unmanagedRoom = [[NCRoom alloc] initWithValue:managedRoom];
-    }
-    return unmanagedRoom;
+    NSString *snapshotKey = [NSString stringWithFormat:@"room-%@-%@", accountId, token];
+    return [[NCReadModelCache sharedInstance] snapshotForKey:snapshotKey createdWithBlock:^id{
+        NSPredicate *query = [NSPredicate predicateWithFormat:@"token = %@ AND accountId = %@", token, accountId];
+        NCRoom *managedRoom = [NCRoom objectsWithPredicate:query].firstObject;
+        if (managedRoom) {
+            return [[NCRoom alloc] initWithValue:managedRoom];
+        }
+        return nil;
+    }];
 }
 
 - (void)resendOfflineMessagesWithCompletionBlock:(SendOfflineMessagesCompletionBlock)block
@@ -402,51 +430,7 @@ static NSInteger kNotJoiningAnymoreStatusCode = 999;
 
 - (void)resendOfflineMessagesForToken:(NSString *)token withCompletionBlock:(SendOfflineMessagesCompletionBlock)block
 {
-    NSPredicate *query;
-
-    if (!token) {
-        query = [NSPredicate predicateWithFormat:@"isOfflineMessage = true"];
-    } else {
-        query = [NSPredicate predicateWithFormat:@"isOfflineMessage = true AND token = %@", token];
-    }
-
-    RLMRealm *realm = [RLMRealm defaultRealm];
-    RLMResults *managedTemporaryMessages = [NCChatMessage objectsWithPredicate:query];
-    NSInteger twelveHoursAgoTimestamp = [[NSDate date] timeIntervalSince1970] - (60 * 60 * 12);
-
-    for (NCChatMessage *offlineMessage in managedTemporaryMessages) {
-        // If we were unable to send a message after 12 hours, mark as failed
-        if (offlineMessage.timestamp < twelveHoursAgoTimestamp) {
-            [realm transactionWithBlock:^{
-                NCChatMessage *managedChatMessage = [NCChatMessage objectsWhere:@"referenceId = %@ AND isTemporary = true", offlineMessage.referenceId].firstObject;
-                managedChatMessage.isOfflineMessage = NO;
-                managedChatMessage.sendingFailed = YES;
-            }];
-
-            NSMutableDictionary *userInfo = [NSMutableDictionary new];
-            [userInfo setObject:offlineMessage forKey:@"message"];
-            [userInfo setObject:@(NO) forKey:@"isOfflineMessage"];
-
-            if (offlineMessage.referenceId) {
-                [userInfo setObject:offlineMessage.referenceId forKey:@"referenceId"];
-            }
-
-            // Inform the callViewController about this change
-            [[NSNotificationCenter defaultCenter] postNotificationName:NCChatControllerDidSendChatMessageNotification
-                                                                object:self
-                                                              userInfo:userInfo];
-            return;
-        }
-
-        NCRoom *room = [[NCRoomsManager sharedInstance] roomWithToken:offlineMessage.token forAccountId:offlineMessage.accountId];
-        NCChatController *chatController = [[NCChatController alloc] initForRoom:room];
-
-        [chatController sendChatMessage:offlineMessage];
-    }
-
-    if (block) {
-        block();
-    }
+    [[NCChatOutbox sharedInstance] sendOfflineMessagesForToken:token withCompletionBlock:block];
 }
 
 - (void)updateRoomsUpdatingUserStatus:(BOOL)updateStatus onlyLastModified:(BOOL)onlyLastModified
@@ -474,36 +458,39 @@ static NSInteger kNotJoiningAnymoreStatusCode = 999;
         }
         
         NSLog(@"Finished rooms update with %lu rooms with new messages", [roomsWithNewMessages count]);
-        dispatch_group_t chatUpdateGroup = dispatch_group_create();
-        
-        // When in low power mode, we only update the conversation list and don't load new messages for each room
-        if (![NSProcessInfo processInfo].isLowPowerModeEnabled && [[NCDatabaseManager sharedInstance] serverHasTalkCapability:kCapabilityChatKeepNotifications forAccountId:account.accountId]) {
-            for (NCRoom *room in roomsWithNewMessages) {
-                dispatch_group_enter(chatUpdateGroup);
-
-                NSLog(@"Updating room %@", room.internalId);
-                NCChatController *chatController;
-
-                if (self.chatViewController && self.chatViewController.chatController && [self.chatViewController.room.internalId isEqualToString:room.internalId]) {
-                    // If there's already a chatController for this room, don't create a new one
-                    chatController = self.chatViewController.chatController;
-                } else {
-                    chatController = [[NCChatController alloc] initForRoom:room];
-                }
 
-                [chatController updateHistoryInBackgroundWithCompletionBlock:^(NSError *error) {
-                    NSLog(@"Finished updating room %@", room.internalId);
-                    dispatch_group_leave(chatUpdateGroup);
-                }];
+        // When in low power mode, we only update the conversation list and don't load new messages for each room
+        if ([NSProcessInfo processInfo].isLowPowerModeEnabled || ![[NCDatabaseManager sharedInstance] serverHasTalkCapability:kCapabilityChatKeepNotifications forAccountId:account.accountId]) {
+            if (block) {
+                block(nil);
             }
+
+            return;
         }
-                
-        dispatch_group_notify(chatUpdateGroup, dispatch_get_main_queue(), ^{
+
+        // Rooms are refreshed by importance with limited parallelism, rooms that don't fit
+        // into the time budget of this run are refreshed first in the next one
+        [[RoomRefreshScheduler shared] refreshWithRooms:roomsWithNewMessages forAccountId:account.accountId using:^NSURLSessionTask *(NCRoom *room, void (^completionBlock)(void)) {
+            NSLog(@"Updating room %@", room.internalId);
+            NCChatController *chatController;
+
+            if (self.chatViewController && self.chatViewController.chatController && [self.chatViewController.room.internalId isEqualToString:room.internalId]) {
+                // If there's already a chatController for this room, don't create a new one
+                chatController = self.chatViewController.chatController;
+            } else {
+                chatController = [[NCChatController alloc] initForRoom:room];
+            }
+
+            return [chatController updateHistoryInBackgroundWithCompletionBlock:^(NSError *error) {
+                NSLog(@"Finished updating room %@", room.internalId);
+                completionBlock();
+            }];
+        } completionBlock:^{
             // Notify backgroundFetch that we're finished
             if (block) {
                 block(nil);
             }
-        });
+        }];
     }];
 }
 
@@ -545,6 +532,8 @@ static NSInteger kNotJoiningAnymoreStatusCode = 999;
                         NSPredicate *query2 = [NSPredicate predicateWithFormat:@"accountId = %@ AND token = %@", activeAccount.accountId, managedRoom.token];
                         [realm deleteObjects:[NCChatMessage objectsWithPredicate:query2]];
                         [realm deleteObjects:[NCChatBlock objectsWithPredicate:query2]];
+                        // Messages of rooms we are not part of anymore should not be found by the local search
+                        [[ChatMessageSearchIndex shared] removeMessagesForAccountId:activeAccount.accountId token:managedRoom.token];
                     }
                     [realm deleteObjects:managedRoomsToBeDeleted];
                 }];
@@ -553,7 +542,11 @@ static NSInteger kNotJoiningAnymoreStatusCode = 999;
             [bgTask stopBackgroundTask];
         } else {
             [userInfo setObject:error forKey:@"error"];
-            [NCUtils log:[NSString stringWithFormat:@"Could not update rooms. Error: %@", error.description]];
+            [NCUtils log:[NSString stringWithFormat:@"Could not update rooms. Error: %@", error.description]
+               subsystem:@"rooms"
+               accountId:activeAccount.accountId
+               roomToken:nil
+                 latency:kNCLoggerNoLatency];
         }
         
         [[NSNotificationCenter defaultCenter] postNotificationName:NCRoomsManagerDidUpdateRoomsNotification
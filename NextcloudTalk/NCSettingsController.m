@@ -112,8 +112,8 @@ NSString * const kDidReceiveCallsFromOldAccount = @"receivedCallsFromOldAccount"
         _signalingConfigurations = [NSMutableDictionary new];
         _externalSignalingControllers = [NSMutableDictionary new];
         
+        // The accounts file for the share extension is created after launch, see AppDelegate
         [self configureDatabase];
-        [self createAccountsFile];
         [self checkStoredDataInKechain];
         [self configureAppSettings];
         
@@ -451,7 +451,10 @@ NSString * const kDidReceiveCallsFromOldAccount = @"receivedCallsFromOldAccount"
     NCExternalSignalingController *extSignalingController = [self externalSignalingControllerForAccountId:removingAccount.accountId];
     [extSignalingController disconnect];
     [[NCAPIController sharedInstance] removeProfileImageForAccount:removingAccount];
+    [[NCAPIController sharedInstance] removeAPISessionManagerForAccountId:removingAccount.accountId];
     [[NCDatabaseManager sharedInstance] removeAccountWithAccountId:removingAccount.accountId];
+    [[ChatMessageSearchIndex shared] removeMessagesForAccountId:removingAccount.accountId token:nil];
+    [[RoomListSnapshot shared] removeForAccountId:removingAccount.accountId];
     [[[NCChatFileController alloc] init] deleteDownloadDirectoryForAccount:removingAccount];
     [[[NCRoomsManager sharedInstance] chatViewController] leaveChat];
     [self createAccountsFile];
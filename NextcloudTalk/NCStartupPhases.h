@@ -0,0 +1,47 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, NCStartupPhase) {
+    // Everything needed to show the room list
+    NCStartupPhaseCriticalPath = 0,
+    // Work that is started after the app finished launching
+    NCStartupPhaseDeferred
+};
+
+/**
+ Signpost intervals for the phases of the app start, so time-to-first-frame can be measured with Instruments
+ (subsystem "com.nextcloud.Talk", category "Startup"). Needs to be used from the main thread.
+ */
+@interface NCStartupPhases : NSObject
+
++ (void)beginPhase:(NCStartupPhase)phase;
++ (void)endPhase:(NCStartupPhase)phase;
+// Emitted once, when the room list is shown for the first time after launch
++ (void)markFirstFrameWithSnapshot:(BOOL)fromSnapshot;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,81 @@
+/**
+ * @copyright Copyright (c) 2026 agent <agent@local>
+ *
+ * @author agent <agent@local>
+ *
+ * @license GNU GPL version 3 or any later version
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import "NCStartupPhases.h"
+
+#import <os/signpost.h>
+
+static os_log_t startupLog(void)
+{
+    static os_log_t log;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        log = os_log_create("com.nextcloud.Talk", "Startup");
+    });
+
+    return log;
+}
+
+@implementation NCStartupPhases
+
+static BOOL firstFrameMarked = NO;
+
++ (void)beginPhase:(NCStartupPhase)phase
+{
+    os_log_t log = startupLog();
+
+    // Signpost names need to be string literals
+    switch (phase) {
+        case NCStartupPhaseCriticalPath:
+            os_signpost_interval_begin(log, OS_SIGNPOST_ID_EXCLUSIVE, "CriticalPath");
+            break;
+        case NCStartupPhaseDeferred:
+            os_signpost_interval_begin(log, OS_SIGNPOST_ID_EXCLUSIVE, "Deferred");
+            break;
+    }
+}
+
++ (void)endPhase:(NCStartupPhase)phase
+{
+    os_log_t log = startupLog();
+
+    switch (phase) {
+        case NCStartupPhaseCriticalPath:
+            os_signpost_interval_end(log, OS_SIGNPOST_ID_EXCLUSIVE, "CriticalPath");
+            break;
+        case NCStartupPhaseDeferred:
+            os_signpost_interval_end(log, OS_SIGNPOST_ID_EXCLUSIVE, "Deferred");
+            break;
+    }
+}
+
++ (void)markFirstFrameWithSnapshot:(BOOL)fromSnapshot
+{
+    if (firstFrameMarked) {
+        return;
+    }
+
+    firstFrameMarked = YES;
+    os_signpost_event_emit(startupLog(), OS_SIGNPOST_ID_EXCLUSIVE, "FirstFrame", "snapshot=%d", fromSnapshot);
+}
+
+@end
@@ -64,6 +64,7 @@ NS_ASSUME_NONNULL_BEGIN
 + (NSString *)valueForKey:(NSString *)key fromQueryItems:(NSArray *)queryItems;
 
 + (void)log:(NSString *)message;
++ (void)log:(NSString *)message subsystem:(nullable NSString *)subsystem accountId:(nullable NSString *)accountId roomToken:(nullable NSString *)roomToken latency:(NSTimeInterval)latency;
 
 + (BOOL)isiOSAppOnMac;
 
@@ -28,6 +28,7 @@
 #import "OpenInFirefoxControllerObjC.h"
 
 #import "NCDatabaseManager.h"
+#import "NCLogger.h"
 #import "NCUserDefaults.h"
 #import "NSDate+DateTools.h"
 
@@ -421,98 +422,14 @@ static NSString *const nextcloudScheme = @"nextcloud:";
     return queryItem.value;
 }
 
-+ (NSURL *)getLogfilePath
-{
-    NSURL *documentDir = [[[NSFileManager defaultManager] URLsForDirectory:NSDocumentDirectory inDomains:NSUserDomainMask] firstObject];
-
-    if (!documentDir) {
-        NSLog(@"Unable to retrieve document directory");
-        return nil;
-    }
-
-    NSURL *logDir = [documentDir URLByAppendingPathComponent:@"logs"];
-    NSString *logPath = [logDir path];
-
-    // Allow writing to files while the app is in the background
-    if (![[NSFileManager defaultManager] fileExistsAtPath:logPath]) {
-        [[NSFileManager defaultManager] createDirectoryAtPath:logPath withIntermediateDirectories:YES attributes:nil error:nil];
-    }
-    [[NSFileManager defaultManager] setAttributes:@{NSFileProtectionKey:NSFileProtectionNone} ofItemAtPath:logPath error:nil];
-
-    return logDir;
-}
-
-+ (void)removeOldLogfiles
++ (void)log:(NSString *)message
 {
-    NSURL *logPathURL = [self getLogfilePath];
-
-    if (!logPathURL) {
-        return;
-    }
-
-    NSString *logPath = [logPathURL path];
-
-    NSFileManager *fileManager = [NSFileManager defaultManager];
-    NSDirectoryEnumerator *enumerator = [fileManager enumeratorAtPath:logPath];
-
-    NSDateComponents *dayComponent = [[NSDateComponents alloc] init];
-    dayComponent.day = -10;
-
-    NSDate *thresholdDate = [[NSCalendar currentCalendar] dateByAddingComponents:dayComponent toDate:[NSDate date] options:0];
-    NSString *file;
-
-    while (file = [enumerator nextObject])
-    {
-        NSString *filePath = [logPath stringByAppendingPathComponent:file];
-        NSDate *creationDate = [[fileManager attributesOfItemAtPath:filePath error:nil] fileCreationDate];
-
-        if ([creationDate compare:thresholdDate] == NSOrderedAscending && [file hasPrefix:@"debug-"] && [file hasSuffix:@".log"]) {
-            NSLog(@"Deleting old logfile %@", filePath);
-
-            [fileManager removeItemAtPath:filePath error:nil];
-        }
-    }
+    [[NCLogger sharedInstance] logMessage:message];
 }
 
-+ (void)log:(NSString *)message
++ (void)log:(NSString *)message subsystem:(NSString *)subsystem accountId:(NSString *)accountId roomToken:(NSString *)roomToken latency:(NSTimeInterval)latency
 {
-    @try {
-        [self removeOldLogfiles];
-
-        NSURL *logPath = [self getLogfilePath];
-
-        if (!logPath) {
-            return;
-        }
-
-        dispatch_queue_t currentQueue = dispatch_get_current_queue();
-        NSDate *now = [NSDate date];
-
-        NSString *logMessage = [NSString stringWithFormat:@"%@ (%@): %@\n",
-                                [now formattedDateWithFormat:@"y-MM-dd H:mm:ss.SSSS"],
-                                [currentQueue description],
-                                message
-        ];
-
-
-        NSString *dateString = [now formattedDateWithFormat:@"yyyy-MM-dd"];
-        NSString *logfileName = [NSString stringWithFormat:@"debug-%@.log", dateString];
-        NSString *fullPath = [[logPath URLByAppendingPathComponent:logfileName] path];
-
-        NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingAtPath:fullPath];
-        if (fileHandle) {
-            [fileHandle seekToEndOfFile];
-            [fileHandle writeData:[logMessage dataUsingEncoding:NSUTF8StringEncoding]];
-            [fileHandle closeFile];
-        } else {
-            [logMessage writeToFile:fullPath atomically:NO encoding:NSUTF8StringEncoding error:nil];
-        }
-
-        NSLog(@"%@", logMessage);
-    } @catch (NSException *exception) {
-        NSLog(@"Exception in NCUtils.log: %@", exception.description);
-        NSLog(@"Message: %@", message);
-    }
+    [[NCLogger sharedInstance] logMessage:message subsystem:subsystem accountId:accountId roomToken:roomToken latency:latency];
 }
 
 + (BOOL)isiOSAppOnMac
@@ -23,6 +23,7 @@
 #ifndef NextcloudTalk_Bridging_Header_Extensions_h
 #define NextcloudTalk_Bridging_Header_Extensions_h
 
+#import "CCCertificate.h"
 #import "NCAPIController.h"
 #import "NCAppBranding.h"
 #import "NCDatabaseManager.h"
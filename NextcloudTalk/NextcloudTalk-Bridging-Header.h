@@ -24,6 +24,7 @@
 #define NextcloudTalk_Bridging_Header_h
 
 #import "ARDSettingsModel.h"
+#import "CCCertificate.h"
 #import "CallParticipantViewCell.h"
 #import "ContactsTableViewCell.h"
 #import "DetailedOptionsSelectorTableViewController.h"
@@ -41,6 +42,7 @@
 #import "NCExternalSignalingController.h"
 #import "NCImageSessionManager.h"
 #import "NCNavigationController.h"
+#import "NCPeerConnection.h"
 #import "NCPoll.h"
 #import "NCRoomsManager.h"
 #import "NCSettingsController.h"
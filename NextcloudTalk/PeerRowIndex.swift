@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Rows of the participants by peerId and peerIdentifier, kept in sync with the order of the participants.
+/// Invariants: `peerIds` and `peerIdentifiers` have one entry per row, every peerIdentifier is contained only once,
+/// and the rows stored for a key are the (last) row containing that key.
+/// Appending and looking up rows is O(1), removing rows only needs to update the rows after the first removed row.
+struct PeerRowIndex {
+
+    private(set) var peerIds: [String] = []
+    private(set) var peerIdentifiers: [String] = []
+
+    private var rowsByPeerId: [String: Int] = [:]
+    private var rowsByPeerIdentifier: [String: Int] = [:]
+
+    var count: Int {
+        return peerIdentifiers.count
+    }
+
+    func row(forPeerId peerId: String) -> Int? {
+        return rowsByPeerId[peerId]
+    }
+
+    func row(forPeerIdentifier peerIdentifier: String) -> Int? {
+        return rowsByPeerIdentifier[peerIdentifier]
+    }
+
+    /// Returns the row of the new entry, or nil if the peerIdentifier is already contained
+    mutating func append(peerId: String, peerIdentifier: String) -> Int? {
+        guard rowsByPeerIdentifier[peerIdentifier] == nil else { return nil }
+
+        let row = peerIdentifiers.count
+
+        peerIds.append(peerId)
+        peerIdentifiers.append(peerIdentifier)
+        rowsByPeerId[peerId] = row
+        rowsByPeerIdentifier[peerIdentifier] = row
+
+        return row
+    }
+
+    /// Rows of the given peerIdentifiers that are contained, every row only once
+    func rows(forPeerIdentifiers peerIdentifiers: [String]) -> IndexSet {
+        var rows = IndexSet()
+
+        for peerIdentifier in peerIdentifiers {
+            if let row = rowsByPeerIdentifier[peerIdentifier] {
+                rows.insert(row)
+            }
+        }
+
+        return rows
+    }
+
+    mutating func remove(rows: IndexSet) {
+        let rows = rows.filteredIndexSet { $0 < count }
+
+        guard let firstRow = rows.first else { return }
+
+        for row in rows {
+            rowsByPeerId.removeValue(forKey: peerIds[row])
+            rowsByPeerIdentifier.removeValue(forKey: peerIdentifiers[row])
+        }
+
+        for row in rows.reversed() {
+            peerIds.remove(at: row)
+            peerIdentifiers.remove(at: row)
+        }
+
+        // A removed peerId might still be contained in an earlier row, the last one of them is stored
+        for row in (0..<firstRow).reversed() where rowsByPeerId[peerIds[row]] == nil {
+            rowsByPeerId[peerIds[row]] = row
+        }
+
+        for row in firstRow..<count {
+            rowsByPeerId[peerIds[row]] = row
+            rowsByPeerIdentifier[peerIdentifiers[row]] = row
+        }
+    }
+
+    mutating func removeAll() {
+        peerIds.removeAll()
+        peerIdentifiers.removeAll()
+        rowsByPeerId.removeAll()
+        rowsByPeerIdentifier.removeAll()
+    }
+}
@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+import CryptoKit
+
+/// Caches resolved references (link previews) per account and normalized URL, in memory and on disk.
+/// URLs without a reference are cached as well, but for a shorter time. Failed requests are not cached.
+/// Concurrent lookups of the same URL share one request. Needs to be used from the main thread.
+@objcMembers class ReferenceDataCache: NSObject {
+
+    public typealias ReferencesCompletionBlock = (_ references: [String: Any]?) -> Void
+
+    private typealias CachedReferences = ReferenceDataStore.CachedReferences
+
+    public static let shared = ReferenceDataCache()
+
+    public var referenceLifetime: TimeInterval {
+        get { return store.referenceLifetime }
+        set { store.referenceLifetime = newValue }
+    }
+
+    public var missingReferenceLifetime: TimeInterval {
+        get { return store.missingReferenceLifetime }
+        set { store.missingReferenceLifetime = newValue }
+    }
+
+    public var maxDiskEntries = 500
+
+    private let store = ReferenceDataStore(capacity: 200)
+
+    private let diskQueue = DispatchQueue(label: "com.nextcloud.Talk.referenceDataCache", qos: .utility)
+    private var numberOfDiskWrites = 0
+
+    private lazy var directoryURL: URL? = {
+        guard let cachesURL = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first else { return nil }
+
+        let directoryURL = cachesURL.appendingPathComponent("References", isDirectory: true)
+        try? FileManager.default.createDirectory(at: directoryURL, withIntermediateDirectories: true)
+
+        return directoryURL
+    }()
+
+    // MARK: - Lookup
+
+    /// Completion block is called with the references of the URL, an empty dictionary if there's no reference
+    /// or nil if the references could not be retrieved.
+    public func references(forUrlString urlString: String, account: TalkAccount?, completionBlock: @escaping ReferencesCompletionBlock) {
+        guard let account, let accountId = account.accountId else {
+            completionBlock(nil)
+            return
+        }
+
+        let key = ReferenceDataStore.cacheKey(forUrlString: urlString, accountId: accountId)
+        let now = Date().timeIntervalSince1970
+
+        store.references(forKey: key, now: now, fetchBlock: { fetchCompletionBlock in
+            self.readFromDisk(key: key) { cachedReferences in
+                if let cachedReferences, self.store.isValid(cachedReferences, now: now) {
+                    fetchCompletionBlock(cachedReferences)
+                    return
+                }
+
+                NCAPIController.sharedInstance().getReferenceForUrlString(urlString, for: account) { references, error in
+                    guard error == nil, let references = references as? [String: Any] else {
+                        fetchCompletionBlock(nil)
+                        return
+                    }
+
+                    let cachedReferences = CachedReferences(timestamp: Date().timeIntervalSince1970, references: references)
+
+                    self.writeToDisk(cachedReferences, key: key)
+                    fetchCompletionBlock(cachedReferences)
+                }
+            }
+        }, completionBlock: completionBlock)
+    }
+
+    public func removeAll() {
+        store.removeAll()
+
+        diskQueue.async {
+            guard let directoryURL = self.directoryURL else { return }
+
+            try? FileManager.default.removeItem(at: directoryURL)
+            try? FileManager.default.createDirectory(at: directoryURL, withIntermediateDirectories: true)
+        }
+    }
+
+    // MARK: - Disk
+
+    private func fileURL(forKey key: String) -> URL? {
+        let digest = SHA256.hash(data: Data(key.utf8))
+        let fileName = digest.map { String(format: "%02x", $0) }.joined()
+
+        return directoryURL?.appendingPathComponent(fileName)
+    }
+
+    private func readFromDisk(key: String, completionBlock: @escaping (_ cachedReferences: CachedReferences?) -> Void) {
+        diskQueue.async {
+            var cachedReferences: CachedReferences?
+
+            if let fileURL = self.fileURL(forKey: key), let data = try? Data(contentsOf: fileURL) {
+                cachedReferences = try? JSONDecoder().decode(CachedReferences.self, from: data)
+            }
+
+            DispatchQueue.main.async {
+                completionBlock(cachedReferences)
+            }
+        }
+    }
+
+    private func writeToDisk(_ cachedReferences: CachedReferences, key: String) {
+        diskQueue.async {
+            guard let fileURL = self.fileURL(forKey: key), let data = try? JSONEncoder().encode(cachedReferences) else { return }
+
+            try? data.write(to: fileURL, options: .atomic)
+
+            // Trimming needs to list the directory, so don't do it for every write
+            self.numberOfDiskWrites += 1
+
+            if self.numberOfDiskWrites % 50 == 1 {
+                self.trimDiskEntries()
+            }
+        }
+    }
+
+    private func trimDiskEntries() {
+        guard let directoryURL,
+              let fileURLs = try? FileManager.default.contentsOfDirectory(at: directoryURL, includingPropertiesForKeys: [.contentModificationDateKey]),
+              fileURLs.count > maxDiskEntries
+        else { return }
+
+        let sortedFileURLs = fileURLs.sorted { first, second in
+            let firstDate = (try? first.resourceValues(forKeys: [.contentModificationDateKey]).contentModificationDate) ?? .distantPast
+            let secondDate = (try? second.resourceValues(forKeys: [.contentModificationDateKey]).contentModificationDate) ?? .distantPast
+
+            return firstDate < secondDate
+        }
+
+        for fileURL in sortedFileURLs.prefix(fileURLs.count - maxDiskEntries) {
+            try? FileManager.default.removeItem(at: fileURL)
+        }
+    }
+}
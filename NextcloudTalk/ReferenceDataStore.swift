@@ -0,0 +1,143 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Memory part of the ReferenceDataCache: keeps the references of recently used keys until their lifetime is over
+/// and lets concurrent lookups of the same key share one fetch. Doesn't know about the API or the disk. Not thread safe.
+class ReferenceDataStore {
+
+    typealias ReferencesCompletionBlock = (_ references: [String: Any]?) -> Void
+    /// Needs to call the completion block with the fetched references or nil if they could not be retrieved
+    typealias FetchBlock = (_ completionBlock: @escaping (_ cachedReferences: CachedReferences?) -> Void) -> Void
+
+    struct CachedReferences: Codable {
+        let timestamp: TimeInterval
+        // JSON of the references, empty if there's no reference for the URL
+        let referencesData: Data
+
+        init(timestamp: TimeInterval, referencesData: Data) {
+            self.timestamp = timestamp
+            self.referencesData = referencesData
+        }
+
+        init(timestamp: TimeInterval, references: [String: Any]) {
+            self.timestamp = timestamp
+            self.referencesData = references.isEmpty ? Data() : (try? JSONSerialization.data(withJSONObject: references)) ?? Data()
+        }
+
+        var hasReferences: Bool {
+            return !referencesData.isEmpty
+        }
+
+        var references: [String: Any] {
+            guard hasReferences else { return [:] }
+
+            return (try? JSONSerialization.jsonObject(with: referencesData)) as? [String: Any] ?? [:]
+        }
+    }
+
+    var referenceLifetime: TimeInterval = 60 * 60
+    var missingReferenceLifetime: TimeInterval = 10 * 60
+
+    private var memoryCache: LRUCache<String, CachedReferences>
+    private var pendingBlocks: [String: [ReferencesCompletionBlock]] = [:]
+
+    init(capacity: Int = 200) {
+        self.memoryCache = LRUCache(capacity: capacity)
+    }
+
+    var count: Int {
+        return memoryCache.count
+    }
+
+    // MARK: - Lookup
+
+    /// Completion block is called with the references of the key, an empty dictionary if there's no reference
+    /// or nil if the references could not be retrieved. Fetches only if there's no valid entry and no fetch of the key running.
+    func references(forKey key: String, now: TimeInterval, fetchBlock: FetchBlock, completionBlock: @escaping ReferencesCompletionBlock) {
+        if let cachedReferences = memoryCache.value(forKey: key) {
+            if self.isValid(cachedReferences, now: now) {
+                completionBlock(cachedReferences.references)
+                return
+            }
+
+            memoryCache.removeValue(forKey: key)
+        }
+
+        if pendingBlocks[key] != nil {
+            pendingBlocks[key]?.append(completionBlock)
+            return
+        }
+
+        pendingBlocks[key] = [completionBlock]
+
+        fetchBlock { cachedReferences in
+            // Failed requests are not cached
+            if let cachedReferences {
+                self.memoryCache.setValue(cachedReferences, forKey: key)
+            }
+
+            self.finish(key: key, references: cachedReferences?.references)
+        }
+    }
+
+    func isValid(_ cachedReferences: CachedReferences, now: TimeInterval) -> Bool {
+        let lifetime = cachedReferences.hasReferences ? referenceLifetime : missingReferenceLifetime
+
+        return now - cachedReferences.timestamp < lifetime
+    }
+
+    func removeAll() {
+        memoryCache.removeAll()
+    }
+
+    private func finish(key: String, references: [String: Any]?) {
+        let blocks = pendingBlocks.removeValue(forKey: key) ?? []
+
+        for block in blocks {
+            block(references)
+        }
+    }
+
+    // MARK: - Keys
+
+    class func cacheKey(forUrlString urlString: String, accountId: String) -> String {
+        return accountId + "\n" + normalizedUrlString(urlString)
+    }
+
+    /// Scheme and host are case insensitive and default ports can be omitted, everything else might be relevant for the reference
+    class func normalizedUrlString(_ urlString: String) -> String {
+        let trimmedUrlString = urlString.trimmingCharacters(in: .whitespacesAndNewlines)
+
+        guard var components = URLComponents(string: trimmedUrlString) else { return trimmedUrlString }
+
+        components.scheme = components.scheme?.lowercased()
+        components.host = components.host?.lowercased()
+
+        if (components.scheme == "https" && components.port == 443) || (components.scheme == "http" && components.port == 80) {
+            components.port = nil
+        }
+
+        return components.string ?? trimmedUrlString
+    }
+}
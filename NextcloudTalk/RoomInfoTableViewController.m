@@ -147,6 +147,8 @@ typedef enum FileAction {
 @property (nonatomic, strong) UIAlertAction *setPasswordAction;
 @property (nonatomic, strong) UIActivityIndicatorView *fileDownloadIndicator;
 @property (nonatomic, strong) NSString *previewControllerFilePath;
+// Kept until another file is previewed, as there's no callback when the pushed preview controller is closed
+@property (nonatomic, strong) ChatFileLease *previewControllerFileLease;
 
 @end
 
@@ -2357,6 +2359,7 @@ typedef enum FileAction {
         if (cell) {
             // Only show preview controller if cell is still visible
             self->_previewControllerFilePath = fileStatus.fileLocalPath;
+            self->_previewControllerFileLease = [[ChatFileLease alloc] initWithFilePath:fileStatus.fileLocalPath];
 
             QLPreviewController * preview = [[QLPreviewController alloc] init];
             UIColor *themeColor = [NCAppBranding themeColor];
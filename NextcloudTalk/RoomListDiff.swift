@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// The properties of a room that are shown in the room list
+struct RoomListItem: Equatable {
+    let internalId: String
+    var token = ""
+    var displayName = ""
+    var name = ""
+    var type = 0
+    var lastActivity = 0
+    var lastMessageId = ""
+    // An edited or deleted message keeps its id, so its content is compared as well
+    var lastMessageContent = ""
+    var unreadMessages = 0
+    var unreadMention = false
+    var unreadMentionDirect = false
+    var hasCall = false
+    var isFavorite = false
+    var status = ""
+    var statusIcon = ""
+    var avatarVersion = ""
+}
+
+/// Difference between two room lists, keyed by the internalId of the rooms.
+/// Deleted and moved-from rows refer to the old list, all other rows to the new list,
+/// so the changes can be applied in a single batch update followed by reconfiguring the updated rows.
+/// Doesn't depend on any UI state, so it can be computed on any thread.
+struct RoomListDiff {
+
+    private(set) var deletedRows: [Int] = []
+    private(set) var insertedRows: [Int] = []
+    private(set) var movedFromRows: [Int] = []
+    private(set) var movedToRows: [Int] = []
+    private(set) var updatedRows: [Int] = []
+    // Set when the lists can't be diffed (e.g. duplicated rooms), the whole list needs to be reloaded
+    private(set) var requiresReload = false
+
+    var hasChanges: Bool {
+        return requiresReload || hasStructuralChanges || !updatedRows.isEmpty
+    }
+
+    var hasStructuralChanges: Bool {
+        return !deletedRows.isEmpty || !insertedRows.isEmpty || !movedFromRows.isEmpty
+    }
+
+    static func diff(from oldItems: [RoomListItem], to newItems: [RoomListItem]) -> RoomListDiff {
+        var diff = RoomListDiff()
+
+        var oldIndexes: [String: Int] = [:]
+        oldIndexes.reserveCapacity(oldItems.count)
+
+        for (index, item) in oldItems.enumerated() {
+            guard oldIndexes.updateValue(index, forKey: item.internalId) == nil else {
+                diff.requiresReload = true
+                return diff
+            }
+        }
+
+        var newInternalIds = Set<String>()
+        newInternalIds.reserveCapacity(newItems.count)
+
+        // Old indexes of the rooms that are part of both lists, in the order of the new list
+        var commonRooms: [(oldIndex: Int, newIndex: Int)] = []
+
+        for (newIndex, item) in newItems.enumerated() {
+            guard newInternalIds.insert(item.internalId).inserted else {
+                diff.requiresReload = true
+                return diff
+            }
+
+            guard let oldIndex = oldIndexes[item.internalId] else {
+                diff.insertedRows.append(newIndex)
+                continue
+            }
+
+            commonRooms.append((oldIndex, newIndex))
+
+            if oldItems[oldIndex] != item {
+                diff.updatedRows.append(newIndex)
+            }
+        }
+
+        for (oldIndex, item) in oldItems.enumerated() where !newInternalIds.contains(item.internalId) {
+            diff.deletedRows.append(oldIndex)
+        }
+
+        // Rooms that keep their relative order don't need to move, only the others do
+        let stableRooms = longestIncreasingSubsequence(of: commonRooms.map { $0.oldIndex })
+
+        for (position, commonRoom) in commonRooms.enumerated() where !stableRooms.contains(position) {
+            diff.movedFromRows.append(commonRoom.oldIndex)
+            diff.movedToRows.append(commonRoom.newIndex)
+        }
+
+        return diff
+    }
+
+    /// Returns the positions of the elements forming a longest strictly increasing subsequence
+    private static func longestIncreasingSubsequence(of values: [Int]) -> Set<Int> {
+        // tails[length - 1] is the position of the smallest value ending an increasing subsequence of that length
+        var tails: [Int] = []
+        var predecessors = [Int](repeating: -1, count: values.count)
+
+        for (position, value) in values.enumerated() {
+            var low = 0
+            var high = tails.count
+
+            while low < high {
+                let middle = (low + high) / 2
+
+                if values[tails[middle]] < value {
+                    low = middle + 1
+                } else {
+                    high = middle
+                }
+            }
+
+            if low > 0 {
+                predecessors[position] = tails[low - 1]
+            }
+
+            if low == tails.count {
+                tails.append(position)
+            } else {
+                tails[low] = position
+            }
+        }
+
+        var result = Set<Int>()
+        var position = tails.last ?? -1
+
+        while position >= 0 {
+            result.insert(position)
+            position = predecessors[position]
+        }
+
+        return result
+    }
+}
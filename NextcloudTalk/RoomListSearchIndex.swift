@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Searches the rooms of the room list with a RoomSearchIndex, see there for details.
+/// Needs to be used from the main thread.
+@objcMembers class RoomListSearchIndex: NSObject {
+
+    private let searchIndex = RoomSearchIndex()
+
+    public func update(rooms: [NCRoom]) {
+        searchIndex.update(entries: rooms.compactMap { RoomListSearchIndex.searchEntry(for: $0) })
+    }
+
+    public func removeAllRooms() {
+        searchIndex.removeAllEntries()
+    }
+
+    /// Returns the given rooms that match the search term, ranked by where the term matched.
+    /// Rooms with the same rank keep their order.
+    public func rooms(matching searchTerm: String, in rooms: [NCRoom]) -> [NCRoom] {
+        if searchTerm.trimmingCharacters(in: .whitespacesAndNewlines).isEmpty {
+            return rooms
+        }
+
+        var roomsByInternalId: [String: NCRoom] = [:]
+
+        for room in rooms {
+            if let internalId = room.internalId {
+                roomsByInternalId[internalId] = room
+            }
+        }
+
+        let internalIds = searchIndex.internalIds(matching: searchTerm, in: rooms.compactMap { $0.internalId })
+
+        return internalIds.compactMap { roomsByInternalId[$0] }
+    }
+
+    private class func searchEntry(for room: NCRoom) -> RoomSearchEntry? {
+        guard let internalId = room.internalId else { return nil }
+
+        return RoomSearchEntry(internalId: internalId,
+                               displayName: room.displayName ?? "",
+                               name: room.name ?? "",
+                               participants: (room.participants?.value(forKey: "self") as? [String]) ?? [])
+    }
+}
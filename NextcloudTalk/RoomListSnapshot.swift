@@ -0,0 +1,146 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Everything the room list shows for a room, without any reference to the database
+@objcMembers class RoomListSnapshotEntry: NSObject, Codable {
+    public var token = ""
+    public var displayName = ""
+    public var lastMessageString: String?
+    public var lastActivity = 0
+    public var unreadMessages = 0
+    public var mentioned = false
+    public var groupMentioned = false
+    public var hasCall = false
+    public var isFavorite = false
+    public var isOneToOne = false
+    public var status: String?
+    public var statusIcon: String?
+}
+
+private struct RoomListSnapshotFile: Codable {
+    let accountId: String
+    let entries: [RoomListSnapshotEntry]
+}
+
+/// Compact copy of the first rooms of the last rendered room list of the active account.
+/// Loading the snapshot only reads a small file, so the room list can be shown before the rooms are loaded from the database.
+/// Needs to be used from the main thread, the file is written in the background.
+@objcMembers class RoomListSnapshot: NSObject {
+
+    public static let shared = RoomListSnapshot()
+
+    // Enough rows to fill the first screen of large devices
+    public var maxEntries = 30
+
+    private let fileQueue = DispatchQueue(label: "com.nextcloud.talk.roomListSnapshot", qos: .utility)
+    // Avoids writing the file again when the first rooms didn't change
+    private var lastSavedData: Data?
+
+    private lazy var fileURL: URL? = {
+        guard let cachesURL = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first else { return nil }
+        return cachesURL.appendingPathComponent("RoomListSnapshot.json")
+    }()
+
+    // MARK: - Public
+
+    /// Returns the entries of the stored snapshot, or no entries if it was stored for another account
+    public func loadEntries(forAccountId accountId: String) -> [RoomListSnapshotEntry] {
+        guard let fileURL, let data = try? Data(contentsOf: fileURL) else { return [] }
+
+        guard let file = try? JSONDecoder().decode(RoomListSnapshotFile.self, from: data) else {
+            NSLog("RoomListSnapshot: could not decode stored snapshot")
+            return []
+        }
+
+        // The snapshot of a previously active account must not be shown, not even until the rooms are loaded
+        guard file.accountId == accountId else { return [] }
+
+        lastSavedData = data
+
+        return file.entries
+    }
+
+    public func save(rooms: [NCRoom], forAccountId accountId: String, withDirectMentionFlag directMentionFlag: Bool) {
+        let entries = rooms.prefix(maxEntries).map { RoomListSnapshot.entry(for: $0, withDirectMentionFlag: directMentionFlag) }
+        let file = RoomListSnapshotFile(accountId: accountId, entries: entries)
+
+        guard let fileURL, let data = try? JSONEncoder().encode(file), data != lastSavedData else { return }
+
+        lastSavedData = data
+
+        fileQueue.async {
+            do {
+                try data.write(to: fileURL, options: [.atomic, .completeFileProtectionUntilFirstUserAuthentication])
+            } catch {
+                NSLog("RoomListSnapshot: could not store snapshot: %@", error.localizedDescription)
+            }
+        }
+    }
+
+    /// Removes the stored snapshot if it belongs to the given account
+    public func remove(forAccountId accountId: String) {
+        guard let fileURL else { return }
+
+        lastSavedData = nil
+
+        fileQueue.async {
+            guard let data = try? Data(contentsOf: fileURL),
+                  let file = try? JSONDecoder().decode(RoomListSnapshotFile.self, from: data),
+                  file.accountId == accountId
+            else { return }
+
+            try? FileManager.default.removeItem(at: fileURL)
+        }
+    }
+
+    // MARK: - Entries
+
+    private class func entry(for room: NCRoom, withDirectMentionFlag directMentionFlag: Bool) -> RoomListSnapshotEntry {
+        let entry = RoomListSnapshotEntry()
+        let isOneToOne = room.type == kNCRoomTypeOneToOne
+
+        entry.token = room.token
+        entry.displayName = room.displayName ?? ""
+        entry.lastMessageString = room.lastMessage != nil ? room.lastMessageString : nil
+        entry.lastActivity = room.lastActivity
+        entry.unreadMessages = room.unreadMessages
+        entry.hasCall = room.hasCall
+        entry.isFavorite = room.isFavorite
+        entry.isOneToOne = isOneToOne
+        entry.status = room.status
+        entry.statusIcon = room.statusIcon
+
+        // Same as the room list, which checks the server capabilities when configuring the cells
+        let oneToOneLike = isOneToOne || room.type == kNCRoomTypeFormerOneToOne
+
+        if directMentionFlag {
+            entry.mentioned = room.unreadMentionDirect || oneToOneLike
+            entry.groupMentioned = room.unreadMention && !room.unreadMentionDirect
+        } else {
+            entry.mentioned = room.unreadMention || oneToOneLike
+        }
+
+        return entry
+    }
+}
@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import UIKit
+
+/// A snapshot of the shown properties of the rooms in a room list, created on any thread
+@objcMembers class RoomListItems: NSObject {
+
+    fileprivate let items: [RoomListItem]
+
+    private init(items: [RoomListItem]) {
+        self.items = items
+    }
+
+    public class func items(for rooms: [NCRoom]) -> RoomListItems {
+        var lastMessageContents: [String: String] = [:]
+
+        autoreleasepool {
+            // Can be called from different threads of a queue, so use a realm for this call that also sees the latest changes
+            let realm = RLMRealm.default()
+            realm.refresh()
+
+            let lastMessageIds = rooms.compactMap { $0.lastMessageId }
+            let lastMessages = NCChatMessage.objects(in: realm, with: NSPredicate(format: "internalId IN %@", lastMessageIds))
+
+            for index in 0..<lastMessages.count {
+                if let message = lastMessages.object(at: index) as? NCChatMessage, let internalId = message.internalId {
+                    lastMessageContents[internalId] = content(of: message)
+                }
+            }
+        }
+
+        let items = rooms.map { room in
+            RoomListItem(internalId: room.internalId ?? "",
+                         token: room.token ?? "",
+                         displayName: room.displayName ?? "",
+                         name: room.name ?? "",
+                         type: Int(room.type.rawValue),
+                         lastActivity: room.lastActivity,
+                         lastMessageId: room.lastMessageId ?? "",
+                         lastMessageContent: room.lastMessageId.flatMap { lastMessageContents[$0] } ?? "",
+                         unreadMessages: room.unreadMessages,
+                         unreadMention: room.unreadMention,
+                         unreadMentionDirect: room.unreadMentionDirect,
+                         hasCall: room.hasCall,
+                         isFavorite: room.isFavorite,
+                         status: room.status ?? "",
+                         statusIcon: room.statusIcon ?? "",
+                         avatarVersion: room.avatarVersion ?? "")
+        }
+
+        return RoomListItems(items: items)
+    }
+
+    /// Everything the last message line of a room is created from
+    private class func content(of message: NCChatMessage) -> String {
+        return [message.message ?? "", message.messageParametersJSONString ?? "", message.messageType ?? "",
+                message.systemMessage ?? "", message.actorDisplayName ?? ""].joined(separator: "\n")
+    }
+}
+
+/// A RoomListDiff with index paths for a table view section, see RoomListDiff for details
+@objcMembers class RoomListTableDiff: NSObject {
+
+    public let deletedIndexPaths: [IndexPath]
+    public let insertedIndexPaths: [IndexPath]
+    public let movedFromIndexPaths: [IndexPath]
+    public let movedToIndexPaths: [IndexPath]
+    public let updatedIndexPaths: [IndexPath]
+    public let requiresReload: Bool
+    public let hasChanges: Bool
+    public let hasStructuralChanges: Bool
+
+    private init(diff: RoomListDiff, section: Int) {
+        let indexPaths = { (rows: [Int]) in rows.map { IndexPath(row: $0, section: section) } }
+
+        deletedIndexPaths = indexPaths(diff.deletedRows)
+        insertedIndexPaths = indexPaths(diff.insertedRows)
+        movedFromIndexPaths = indexPaths(diff.movedFromRows)
+        movedToIndexPaths = indexPaths(diff.movedToRows)
+        updatedIndexPaths = indexPaths(diff.updatedRows)
+        requiresReload = diff.requiresReload
+        hasChanges = diff.hasChanges
+        hasStructuralChanges = diff.hasStructuralChanges
+    }
+
+    public class func diff(from oldItems: RoomListItems, to newItems: RoomListItems, inSection section: Int) -> RoomListTableDiff {
+        return RoomListTableDiff(diff: RoomListDiff.diff(from: oldItems.items, to: newItems.items), section: section)
+    }
+}
@@ -0,0 +1,258 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// The properties of a room that decide how important it is to refresh it
+struct RoomRefreshCandidate: Equatable {
+    let internalId: String
+    let token: String
+    var hasUnreadMention = false
+    var isOneToOne = false
+    var isFavorite = false
+    var lastActivity = 0
+}
+
+/// Refreshes rooms in the order of their importance, with a limited number of parallel refreshes and a time budget per run.
+/// Rooms that were not refreshed in a run are stored and refreshed in the next run, ranked together with the new rooms.
+/// All methods need to be called on the main thread (or the queue that scheduleOnMain dispatches to).
+final class RoomRefreshQueue {
+
+    /// Returns a block that cancels the refresh, so it can be cancelled when the time runs out
+    typealias RefreshBlock = (_ room: RoomRefreshCandidate, _ completionBlock: @escaping () -> Void) -> (() -> Void)?
+
+    var maxConcurrentRefreshes = 3
+    // Background app refresh tasks get around 30s, leave some time for the remaining work
+    var timeBudget: TimeInterval = 20
+    var logBlock: ((_ message: String) -> Void)?
+    // Called when a run ended, after the completion blocks
+    var runDidEnd: (() -> Void)?
+
+    private(set) var runId = 0
+
+    var isRunning: Bool {
+        return refreshBlock != nil
+    }
+
+    private let pendingRoomsKey = "NCRoomRefreshSchedulerPendingRooms"
+    private let userDefaults: UserDefaults
+    private let now: () -> Date
+    private let scheduleOnMain: (_ block: @escaping () -> Void) -> Void
+    // Returns the current state of a room that was stored for the next run
+    private let roomForToken: (_ token: String, _ accountId: String) -> RoomRefreshCandidate?
+
+    private var accountId: String?
+    private var queuedRooms: [RoomRefreshCandidate] = []
+    // Rooms that are refreshed at the moment, keyed by their internalId
+    private var runningRefreshes: [String: (room: RoomRefreshCandidate, cancelBlock: (() -> Void)?)] = [:]
+    private var completedRefreshes = 0
+    private var deadline = Date.distantFuture
+    private var isStopped = false
+    private var refreshBlock: RefreshBlock?
+    private var completionBlocks: [() -> Void] = []
+
+    init(userDefaults: UserDefaults = .standard,
+         now: @escaping () -> Date = Date.init,
+         scheduleOnMain: @escaping (_ block: @escaping () -> Void) -> Void = { DispatchQueue.main.async(execute: $0) },
+         roomForToken: @escaping (_ token: String, _ accountId: String) -> RoomRefreshCandidate?) {
+
+        self.userDefaults = userDefaults
+        self.now = now
+        self.scheduleOnMain = scheduleOnMain
+        self.roomForToken = roomForToken
+    }
+
+    // MARK: - Public
+
+    func refresh(rooms: [RoomRefreshCandidate], forAccountId accountId: String, using refreshBlock: @escaping RefreshBlock, completionBlock: (() -> Void)?) {
+        if self.accountId == accountId, self.refreshBlock != nil {
+            // A run is already in progress, just add the new rooms to it
+            if let completionBlock {
+                completionBlocks.append(completionBlock)
+            }
+
+            self.enqueue(rooms)
+            self.startQueuedRefreshes()
+            return
+        }
+
+        // Another account is refreshed at the moment, end its run and keep its remaining rooms for the next one
+        self.endRun(cancellingRunningRefreshes: true)
+
+        if let completionBlock {
+            completionBlocks.append(completionBlock)
+        }
+
+        self.accountId = accountId
+        self.refreshBlock = refreshBlock
+        self.queuedRooms = []
+        self.runningRefreshes = [:]
+        self.completedRefreshes = 0
+        self.runId += 1
+        self.deadline = now().addingTimeInterval(timeBudget)
+        self.isStopped = false
+
+        // Rooms that were not refreshed in the last run still have new messages we didn't load
+        self.enqueue(self.loadPendingRooms(forAccountId: accountId) + rooms)
+        self.startQueuedRefreshes()
+    }
+
+    /// Don't start any new refreshes, remaining rooms are refreshed in the next run
+    func stop() {
+        isStopped = true
+        self.finishIfPossible()
+    }
+
+    /// End the run right away (e.g. when the background time expires), running refreshes are cancelled and refreshed again in the next run
+    func cancel() {
+        self.endRun(cancellingRunningRefreshes: true)
+    }
+
+    /// Rooms with mentions first, then one-to-one conversations, then favorites, each ordered by their last activity
+    class func rankedRooms(_ rooms: [RoomRefreshCandidate]) -> [RoomRefreshCandidate] {
+        return rooms.sorted { first, second in
+            if first.hasUnreadMention != second.hasUnreadMention {
+                return first.hasUnreadMention
+            }
+
+            if first.isOneToOne != second.isOneToOne {
+                return first.isOneToOne
+            }
+
+            if first.isFavorite != second.isFavorite {
+                return first.isFavorite
+            }
+
+            return first.lastActivity > second.lastActivity
+        }
+    }
+
+    // MARK: - Scheduling
+
+    private func enqueue(_ rooms: [RoomRefreshCandidate]) {
+        // Rooms that are refreshed at the moment don't need to be refreshed again
+        var knownRooms = Set(queuedRooms.map { $0.internalId }).union(runningRefreshes.keys)
+        var newRooms: [RoomRefreshCandidate] = []
+
+        for room in rooms where !knownRooms.contains(room.internalId) {
+            knownRooms.insert(room.internalId)
+            newRooms.append(room)
+        }
+
+        queuedRooms = RoomRefreshQueue.rankedRooms(queuedRooms + newRooms)
+    }
+
+    private func startQueuedRefreshes() {
+        guard let refreshBlock else { return }
+
+        if now() >= deadline, !isStopped {
+            logBlock?("RoomRefreshScheduler: time budget exhausted with \(queuedRooms.count) rooms remaining")
+            isStopped = true
+        }
+
+        while !isStopped, runningRefreshes.count < max(maxConcurrentRefreshes, 1), !queuedRooms.isEmpty {
+            let room = queuedRooms.removeFirst()
+            let internalId = room.internalId
+            let currentRunId = runId
+
+            runningRefreshes[internalId] = (room, nil)
+
+            let cancelBlock = refreshBlock(room) { [weak self] in
+                self?.scheduleOnMain {
+                    guard let self, self.runId == currentRunId, self.runningRefreshes.removeValue(forKey: internalId) != nil else { return }
+
+                    self.completedRefreshes += 1
+                    self.startQueuedRefreshes()
+                }
+            }
+
+            // The refresh might have completed synchronously already
+            if runningRefreshes[internalId] != nil {
+                runningRefreshes[internalId] = (room, cancelBlock)
+            }
+        }
+
+        self.finishIfPossible()
+    }
+
+    private func finishIfPossible() {
+        guard refreshBlock != nil, runningRefreshes.isEmpty, isStopped || queuedRooms.isEmpty else { return }
+
+        self.endRun(cancellingRunningRefreshes: false)
+    }
+
+    private func endRun(cancellingRunningRefreshes: Bool) {
+        guard refreshBlock != nil else { return }
+
+        if cancellingRunningRefreshes {
+            // Rooms that were not refreshed completely are refreshed again in the next run
+            let interruptedRooms = runningRefreshes.values.map { $0.room }
+
+            for runningRefresh in runningRefreshes.values {
+                runningRefresh.cancelBlock?()
+            }
+
+            queuedRooms = RoomRefreshQueue.rankedRooms(interruptedRooms + queuedRooms)
+        }
+
+        logBlock?("RoomRefreshScheduler: refreshed \(completedRefreshes) rooms, \(queuedRooms.count) remaining for the next run")
+
+        self.savePendingRooms()
+
+        let completionBlocks = self.completionBlocks
+
+        self.completionBlocks = []
+        self.refreshBlock = nil
+        self.queuedRooms = []
+        self.runningRefreshes = [:]
+        self.runId += 1
+
+        for completionBlock in completionBlocks {
+            completionBlock()
+        }
+
+        self.runDidEnd?()
+    }
+
+    // MARK: - Resume state
+
+    private func savePendingRooms() {
+        guard let accountId else { return }
+
+        var pendingRooms = userDefaults.dictionary(forKey: pendingRoomsKey) as? [String: [String]] ?? [:]
+
+        if queuedRooms.isEmpty {
+            pendingRooms.removeValue(forKey: accountId)
+        } else {
+            pendingRooms[accountId] = queuedRooms.map { $0.token }
+        }
+
+        userDefaults.set(pendingRooms, forKey: pendingRoomsKey)
+    }
+
+    private func loadPendingRooms(forAccountId accountId: String) -> [RoomRefreshCandidate] {
+        let pendingRooms = userDefaults.dictionary(forKey: pendingRoomsKey) as? [String: [String]] ?? [:]
+        let tokens = pendingRooms[accountId] ?? []
+
+        return tokens.compactMap { roomForToken($0, accountId) }
+    }
+}
@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// Refreshes the chats of rooms with new messages with a RoomRefreshQueue, see there for details.
+/// Each run is executed in a background task. All methods need to be called on the main thread.
+@objcMembers class RoomRefreshScheduler: NSObject {
+
+    /// Returns the task of the refresh, so it can be cancelled when the time runs out
+    public typealias RefreshBlock = (_ room: NCRoom, _ completionBlock: @escaping () -> Void) -> URLSessionTask?
+
+    public static let shared = RoomRefreshScheduler()
+
+    public var maxConcurrentRefreshes: Int {
+        get { return refreshQueue.maxConcurrentRefreshes }
+        set { refreshQueue.maxConcurrentRefreshes = newValue }
+    }
+
+    public var timeBudget: TimeInterval {
+        get { return refreshQueue.timeBudget }
+        set { refreshQueue.timeBudget = newValue }
+    }
+
+    private let refreshQueue = RoomRefreshQueue(roomForToken: { token, accountId in
+        guard let room = NCRoomsManager.sharedInstance().room(withToken: token, forAccountId: accountId) else { return nil }
+        return RoomRefreshScheduler.refreshCandidate(for: room)
+    })
+
+    private var backgroundTask: BGTaskHelper?
+    private var backgroundTaskRunId = 0
+
+    override init() {
+        super.init()
+
+        refreshQueue.logBlock = { message in
+            NCUtils.log(message)
+        }
+
+        refreshQueue.runDidEnd = { [weak self] in
+            self?.backgroundTask?.stopBackgroundTask()
+            self?.backgroundTask = nil
+        }
+    }
+
+    // MARK: - Public
+
+    public func refresh(rooms: [NCRoom], forAccountId accountId: String, using refreshBlock: @escaping RefreshBlock, completionBlock: (() -> Void)?) {
+        // The refresh block gets the rooms it was called with, rooms from a previous run are loaded from the database
+        var roomsByInternalId: [String: NCRoom] = [:]
+
+        for room in rooms {
+            if let internalId = room.internalId {
+                roomsByInternalId[internalId] = room
+            }
+        }
+
+        refreshQueue.refresh(rooms: rooms.compactMap { RoomRefreshScheduler.refreshCandidate(for: $0) }, forAccountId: accountId, using: { candidate, completionBlock in
+            guard let room = roomsByInternalId[candidate.internalId] ?? NCRoomsManager.sharedInstance().room(withToken: candidate.token, forAccountId: accountId) else {
+                completionBlock()
+                return nil
+            }
+
+            let task = refreshBlock(room, completionBlock)
+
+            return task.map { task in { task.cancel() } }
+        }, completionBlock: completionBlock)
+
+        // A new run was started (and did not end right away)
+        if refreshQueue.isRunning, refreshQueue.runId != backgroundTaskRunId {
+            self.startBackgroundTask()
+        }
+    }
+
+    /// Don't start any new refreshes, remaining rooms are refreshed in the next run
+    public func stop() {
+        refreshQueue.stop()
+    }
+
+    // MARK: - Background task
+
+    private func startBackgroundTask() {
+        let runId = refreshQueue.runId
+        backgroundTaskRunId = runId
+
+        backgroundTask = BGTaskHelper.startBackgroundTask(withName: "RoomRefreshScheduler") { [weak self] task in
+            NCUtils.log("ExpirationHandler called - RoomRefreshScheduler")
+
+            // Expiration handlers are called on the main thread and the background task needs to end right away,
+            // running refreshes are cancelled and refreshed again in the next run
+            if let self, self.refreshQueue.runId == runId {
+                self.refreshQueue.cancel()
+            }
+
+            task.stopBackgroundTask()
+        }
+    }
+
+    private class func refreshCandidate(for room: NCRoom) -> RoomRefreshCandidate? {
+        guard let internalId = room.internalId else { return nil }
+
+        return RoomRefreshCandidate(internalId: internalId,
+                                    token: room.token,
+                                    hasUnreadMention: room.unreadMention || room.unreadMentionDirect,
+                                    isOneToOne: room.type == kNCRoomTypeOneToOne,
+                                    isFavorite: room.isFavorite,
+                                    lastActivity: room.lastActivity)
+    }
+}
@@ -0,0 +1,207 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+/// The searchable texts of a room
+struct RoomSearchEntry: Equatable {
+    let internalId: String
+    var displayName = ""
+    var name = ""
+    var participants: [String] = []
+}
+
+private struct RoomSearchDocument {
+    let signature: String
+    let displayName: String
+    let otherFields: String
+    let grams: Set<String>
+}
+
+/// In-memory index over the display names, names and participants of rooms.
+/// Every substring of up to 3 characters of the case and diacritics folded texts is indexed, so search terms of up to
+/// 3 characters are a single lookup and longer terms only need to verify the rooms that contain all of their trigrams.
+/// Needs to be used from a single thread.
+final class RoomSearchIndex {
+
+    private let gramLength = 3
+
+    private var documents: [String: RoomSearchDocument] = [:]
+    private var postings: [String: Set<String>] = [:]
+
+    // MARK: - Indexing
+
+    /// Indexes the given rooms, only rooms that changed since the last update are indexed again.
+    /// Rooms that are not part of the given rooms are removed from the index.
+    func update(entries: [RoomSearchEntry]) {
+        var removedRooms = Set(documents.keys)
+
+        for entry in entries {
+            let internalId = entry.internalId
+
+            removedRooms.remove(internalId)
+
+            let signature = [entry.displayName, entry.name].joined(separator: "\n") + "\n" + entry.participants.joined(separator: "\n")
+
+            if let document = documents[internalId], document.signature == signature {
+                continue
+            }
+
+            self.remove(roomWithInternalId: internalId)
+
+            let displayName = RoomSearchIndex.fold(entry.displayName)
+            let otherFields = RoomSearchIndex.fold(([entry.name] + entry.participants).joined(separator: "\n"))
+            let grams = self.grams(of: displayName).union(self.grams(of: otherFields))
+
+            documents[internalId] = RoomSearchDocument(signature: signature, displayName: displayName, otherFields: otherFields, grams: grams)
+
+            for gram in grams {
+                postings[gram, default: []].insert(internalId)
+            }
+        }
+
+        for internalId in removedRooms {
+            self.remove(roomWithInternalId: internalId)
+        }
+    }
+
+    func removeAllEntries() {
+        documents.removeAll()
+        postings.removeAll()
+    }
+
+    private func remove(roomWithInternalId internalId: String) {
+        guard let document = documents.removeValue(forKey: internalId) else { return }
+
+        for gram in document.grams {
+            postings[gram]?.remove(internalId)
+
+            if postings[gram]?.isEmpty == true {
+                postings.removeValue(forKey: gram)
+            }
+        }
+    }
+
+    // MARK: - Search
+
+    /// Returns the internal ids of the given rooms that match the search term, ranked by where the term matched.
+    /// Rooms with the same rank keep their order.
+    func internalIds(matching searchTerm: String, in internalIds: [String]) -> [String] {
+        let term = RoomSearchIndex.fold(searchTerm).trimmingCharacters(in: .whitespacesAndNewlines)
+
+        if term.isEmpty {
+            return internalIds
+        }
+
+        guard let candidates = self.candidates(for: term) else { return [] }
+
+        var rankedRooms: [(rank: Int, position: Int, internalId: String)] = []
+
+        for (position, internalId) in internalIds.enumerated() {
+            guard candidates.contains(internalId), let document = documents[internalId],
+                  let rank = self.rank(of: document, for: term)
+            else { continue }
+
+            rankedRooms.append((rank, position, internalId))
+        }
+
+        rankedRooms.sort { ($0.rank, $0.position) < ($1.rank, $1.position) }
+
+        return rankedRooms.map { $0.internalId }
+    }
+
+    private func candidates(for term: String) -> Set<String>? {
+        if term.count <= gramLength {
+            return postings[term]
+        }
+
+        // Start with the smallest posting list to keep the intersections small
+        let termGrams = self.grams(of: term, minLength: gramLength)
+        var postingLists: [Set<String>] = []
+
+        for gram in termGrams {
+            guard let posting = postings[gram] else { return nil }
+            postingLists.append(posting)
+        }
+
+        postingLists.sort { $0.count < $1.count }
+
+        guard var candidates = postingLists.first else { return nil }
+
+        for posting in postingLists.dropFirst() {
+            candidates.formIntersection(posting)
+
+            if candidates.isEmpty {
+                break
+            }
+        }
+
+        return candidates
+    }
+
+    private func rank(of document: RoomSearchDocument, for term: String) -> Int? {
+        if let range = document.displayName.range(of: term) {
+            if range.lowerBound == document.displayName.startIndex {
+                return 0
+            }
+
+            // Match at the start of another word
+            if document.displayName.range(of: " " + term) != nil {
+                return 1
+            }
+
+            return 2
+        }
+
+        // Trigram candidates might still not contain the whole term
+        if document.otherFields.contains(term) {
+            return 3
+        }
+
+        return nil
+    }
+
+    // MARK: - Helpers
+
+    private class func fold(_ string: String) -> String {
+        return string.folding(options: [.caseInsensitive, .diacriticInsensitive, .widthInsensitive], locale: nil)
+    }
+
+    private func grams(of string: String, minLength: Int = 1) -> Set<String> {
+        let characters = Array(string)
+        var grams = Set<String>()
+
+        guard !characters.isEmpty else { return grams }
+
+        for start in 0..<characters.count {
+            let maxLength = min(gramLength, characters.count - start)
+
+            guard maxLength >= minLength else { continue }
+
+            for length in minLength...maxLength {
+                grams.insert(String(characters[start..<(start + length)]))
+            }
+        }
+
+        return grams
+    }
+}
@@ -34,11 +34,14 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, strong) NSArray *users;
 @property (nonatomic, strong) NSArray *listableRooms;
 @property (nonatomic, strong) NSArray *messages;
+// Results of the local search index, shown before the messages found on the server
+@property (nonatomic, strong) NSArray *localMessages;
 @property (nonatomic, assign) BOOL searchingMessages;
 
 - (NCRoom *)roomForIndexPath:(NSIndexPath *)indexPath;
 - (NCUser *)userForIndexPath:(NSIndexPath *)indexPath;
-- (NKSearchEntry *)messageForIndexPath:(NSIndexPath *)indexPath;
+// Returns a NKSearchEntry or a ChatMessageSearchResult
+- (nullable id)messageForIndexPath:(NSIndexPath *)indexPath;
 - (void)showSearchingFooterView;
 - (void)clearSearchedResults;
 
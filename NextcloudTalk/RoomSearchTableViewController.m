@@ -45,6 +45,7 @@ typedef enum RoomSearchSection {
 @interface RoomSearchTableViewController ()
 {
     PlaceholderView *_roomSearchBackgroundView;
+    NSArray *_mergedMessages;
 }
 @end
 
@@ -93,6 +94,14 @@ typedef enum RoomSearchSection {
 - (void)setMessages:(NSArray *)messages
 {
     _messages = messages;
+    [self mergeMessages];
+    [self reloadAndCheckSearchingIndicator];
+}
+
+- (void)setLocalMessages:(NSArray *)localMessages
+{
+    _localMessages = localMessages;
+    [self mergeMessages];
     [self reloadAndCheckSearchingIndicator];
 }
 
@@ -146,6 +155,8 @@ typedef enum RoomSearchSection {
     _users = @[];
     _listableRooms = @[];
     _messages = @[];
+    _localMessages = @[];
+    _mergedMessages = @[];
     
     [self reloadAndCheckSearchingIndicator];
 }
@@ -153,6 +164,27 @@ typedef enum RoomSearchSection {
 
 #pragma mark - Utils
 
+- (void)mergeMessages
+{
+    NSMutableArray *mergedMessages = [NSMutableArray arrayWithArray:_localMessages];
+    NSMutableSet *localMessageKeys = [NSMutableSet new];
+
+    for (ChatMessageSearchResult *localMessage in _localMessages) {
+        [localMessageKeys addObject:[NSString stringWithFormat:@"%@/%ld", localMessage.token, (long)localMessage.messageId]];
+    }
+
+    // Only add server results that were not found locally
+    for (NKSearchEntry *messageEntry in _messages) {
+        NSString *roomToken = [messageEntry.attributes objectForKey:@"conversation"];
+        NSInteger messageId = [[messageEntry.attributes objectForKey:@"messageId"] integerValue];
+        if (![localMessageKeys containsObject:[NSString stringWithFormat:@"%@/%ld", roomToken, (long)messageId]]) {
+            [mergedMessages addObject:messageEntry];
+        }
+    }
+
+    _mergedMessages = mergedMessages;
+}
+
 - (NSArray *)searchSections
 {
     NSMutableArray *sections = [NSMutableArray new];
@@ -165,7 +197,7 @@ typedef enum RoomSearchSection {
     if (_listableRooms.count > 0) {
         [sections addObject:@(RoomSearchSectionListable)];
     }
-    if (_messages.count > 0) {
+    if (_mergedMessages.count > 0) {
         [sections addObject:@(RoomSearchSectionMessages)];
     }
     return [NSArray arrayWithArray:sections];
@@ -183,11 +215,11 @@ typedef enum RoomSearchSection {
     return nil;
 }
 
-- (NKSearchEntry *)messageForIndexPath:(NSIndexPath *)indexPath
+- (id)messageForIndexPath:(NSIndexPath *)indexPath
 {
     NSInteger searchSection = [[[self searchSections] objectAtIndex:indexPath.section] integerValue];
-    if (searchSection == RoomSearchSectionMessages && indexPath.row < _messages.count) {
-        return [_messages objectAtIndex:indexPath.row];;
+    if (searchSection == RoomSearchSectionMessages && indexPath.row < _mergedMessages.count) {
+        return [_mergedMessages objectAtIndex:indexPath.row];
     }
     
     return nil;
@@ -195,19 +227,36 @@ typedef enum RoomSearchSection {
 
 - (UITableViewCell *)tableView:(UITableView *)tableView cellForMessageAtIndexPath:(NSIndexPath *)indexPath
 {
-    NKSearchEntry *messageEntry = [_messages objectAtIndex:indexPath.row];
+    id message = [_mergedMessages objectAtIndex:indexPath.row];
     RoomTableViewCell *cell = [tableView dequeueReusableCellWithIdentifier:kRoomCellIdentifier];
     if (!cell) {
         cell = [[RoomTableViewCell alloc] initWithStyle:UITableViewCellStyleDefault reuseIdentifier:kRoomCellIdentifier];
     }
-    
-    cell.titleLabel.text = messageEntry.title;
-    cell.subtitleLabel.text = messageEntry.subline;
+
+    NSURL *thumbnailURL = nil;
+    NSString *actorId = nil;
+    NSString *actorType = nil;
+    NSInteger timestamp = 0;
+
+    if ([message isKindOfClass:[ChatMessageSearchResult class]]) {
+        ChatMessageSearchResult *localMessage = (ChatMessageSearchResult *)message;
+        cell.titleLabel.text = localMessage.actorDisplayName;
+        cell.subtitleLabel.text = localMessage.snippet;
+        actorId = localMessage.actorId;
+        actorType = localMessage.actorType;
+        timestamp = localMessage.timestamp;
+    } else {
+        NKSearchEntry *messageEntry = (NKSearchEntry *)message;
+        cell.titleLabel.text = messageEntry.title;
+        cell.subtitleLabel.text = messageEntry.subline;
+        thumbnailURL = [[NSURL alloc] initWithString:messageEntry.thumbnailURL];
+        actorId = [messageEntry.attributes objectForKey:@"actorId"];
+        actorType = [messageEntry.attributes objectForKey:@"actorType"];
+        // Add message date (if it is included in attributes)
+        timestamp = [[messageEntry.attributes objectForKey:@"timestamp"] integerValue];
+    }
     
     // Thumbnail image
-    NSURL *thumbnailURL = [[NSURL alloc] initWithString:messageEntry.thumbnailURL];
-    NSString *actorId = [messageEntry.attributes objectForKey:@"actorId"];
-    NSString *actorType = [messageEntry.attributes objectForKey:@"actorType"];
     if ([actorType isEqualToString:@"users"] && actorId) {
         [cell.roomImage setUserAvatarFor:actorId with:self.traitCollection.userInterfaceStyle];
     } else if ([actorType isEqualToString:@"guests"]) {
@@ -226,8 +275,6 @@ typedef enum RoomSearchSection {
     cell.dateLabel.text = @"";
     [cell setUnreadMessages:0 mentioned:NO groupMentioned:NO];
     
-    // Add message date (if it is included in attributes)
-    NSInteger timestamp = [[messageEntry.attributes objectForKey:@"timestamp"] integerValue];
     if (timestamp > 0) {
         NSDate *date = [[NSDate alloc] initWithTimeIntervalSince1970:timestamp];
         cell.dateLabel.text = [NCUtils readableTimeOrDateFromDate:date];
@@ -279,7 +326,7 @@ typedef enum RoomSearchSection {
         case RoomSearchSectionListable:
             return _listableRooms.count;
         case RoomSearchSectionMessages:
-            return _messages.count;
+            return _mergedMessages.count;
         default:
             return 0;
     }
@@ -38,6 +38,7 @@ import QuickLook
     var currentLastItemId: Int = -1
     var sharedItemsBackgroundView: PlaceholderView = PlaceholderView()
     var previewControllerFilePath: String = ""
+    var previewControllerFileLease: ChatFileLease?
     var isPreviewControllerShown: Bool = false
 
     init(room: NCRoom) {
@@ -283,6 +284,7 @@ import QuickLook
             }
 
             self.previewControllerFilePath = fileStatus.fileLocalPath
+            self.previewControllerFileLease = ChatFileLease(filePath: fileStatus.fileLocalPath)
             self.isPreviewControllerShown = true
 
             let fileExtension = NSURL(fileURLWithPath: fileStatus.fileLocalPath).pathExtension
@@ -327,10 +329,12 @@ import QuickLook
 
     func previewControllerDidDismiss(_ controller: QLPreviewController) {
         isPreviewControllerShown = false
+        previewControllerFileLease = nil
     }
 
     func vlckitVideoViewControllerDismissed(_ controller: VLCKitVideoViewController) {
         isPreviewControllerShown = false
+        previewControllerFileLease = nil
     }
 
     // MARK: - Locations
@@ -37,6 +37,7 @@
 #import "NCNotificationController.h"
 #import "NCRoomsManager.h"
 #import "NCSettingsController.h"
+#import "NCStartupPhases.h"
 #import "NCUserInterfaceController.h"
 #import "NCUtils.h"
 #import "NewRoomTableViewController.h"
@@ -61,12 +62,21 @@ typedef enum RoomsFilter {
     RLMNotificationToken *_rlmNotificationToken;
     NSMutableArray *_rooms;
     NSMutableArray *_allRooms;
+    NSArray<RoomListSnapshotEntry *> *_snapshotEntries;
     UIRefreshControl *_refreshControl;
     BOOL _allowEmptyGroupRooms;
     UISearchController *_searchController;
     NSString *_searchString;
     RoomSearchTableViewController *_resultTableViewController;
     NCUnifiedSearchController *_unifiedSearchController;
+    RoomListSearchIndex *_roomSearchIndex;
+    NSURLSessionDataTask *_searchContactsTask;
+    NSURLSessionDataTask *_searchListableRoomsTask;
+    dispatch_queue_t _roomListDiffQueue;
+    NSInteger _roomListUpdateGeneration;
+    RoomListItems *_displayedRoomListItems;
+    // The rooms the displayed room list items were created for
+    NSArray *_displayedRoomListItemsRooms;
     PlaceholderView *_roomsBackgroundView;
     UIBarButtonItem *_settingsButton;
     NSTimer *_refreshRoomsTimer;
@@ -82,6 +92,16 @@ typedef enum RoomsFilter {
 - (void)viewDidLoad
 {
     [super viewDidLoad];
+
+    _roomSearchIndex = [[RoomListSearchIndex alloc] init];
+    _roomListDiffQueue = dispatch_queue_create("com.nextcloud.talk.roomListDiff", DISPATCH_QUEUE_SERIAL);
+
+    // Show the last rendered room list until the rooms are loaded from the database
+    NSString *activeAccountId = [[NCDatabaseManager sharedInstance] activeAccount].accountId;
+    NSArray *snapshotEntries = activeAccountId ? [[RoomListSnapshot shared] loadEntriesForAccountId:activeAccountId] : @[];
+    if (snapshotEntries.count > 0) {
+        _snapshotEntries = snapshotEntries;
+    }
     
     __weak typeof(self) weakSelf = self;
     _rlmNotificationToken = [[NCRoom allObjects] addNotificationBlock:^(RLMResults * _Nullable results, RLMCollectionChange * _Nullable change, NSError * _Nullable error) {
@@ -125,6 +145,7 @@ typedef enum RoomsFilter {
     [_roomsBackgroundView.placeholderTextView setText:NSLocalizedString(@"You are not part of any conversation. Press + to start a new one.", nil)];
     [_roomsBackgroundView.placeholderView setHidden:YES];
     [_roomsBackgroundView.loadingView startAnimating];
+    [_roomsBackgroundView.loadingView setHidden:(_snapshotEntries != nil)];
     self.tableView.backgroundView = _roomsBackgroundView;
     
     // Unread mentions bottom indicator
@@ -175,6 +196,7 @@ typedef enum RoomsFilter {
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(userProfileImageUpdated:) name:NCUserProfileImageUpdatedNotification object:nil];
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(appWillEnterForeground:) name:UIApplicationWillEnterForegroundNotification object:nil];
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(appWillResignActive:) name:UIApplicationWillResignActiveNotification object:nil];
+    [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(significantTimeChange:) name:UIApplicationSignificantTimeChangeNotification object:nil];
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(roomCreated:) name:NCSelectedContactForChatNotification object:nil];
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(roomCreated:) name:NCRoomCreatedNotification object:nil];
 }
@@ -248,8 +270,16 @@ typedef enum RoomsFilter {
 - (void)viewWillAppear:(BOOL)animated
 {
     [super viewWillAppear:animated];
-    
-    [self refreshRoomList];
+
+    if (_snapshotEntries) {
+        // Let the snapshot be rendered first, loading the rooms replaces it
+        [NCStartupPhases markFirstFrameWithSnapshot:YES];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self refreshRoomList];
+        });
+    } else {
+        [self refreshRoomList];
+    }
     
     self.clearsSelectionOnViewWillAppear = self.splitViewController.isCollapsed;
 
@@ -339,6 +369,16 @@ typedef enum RoomsFilter {
 - (void)appWillResignActive:(NSNotification *)notification
 {
     [self stopRefreshRoomsTimer];
+    [self saveRoomListSnapshot];
+}
+
+- (void)significantTimeChange:(NSNotification *)notification
+{
+    // Date labels show the time for today and the date otherwise, so they are outdated after midnight
+    NSArray *visibleIndexPaths = self.tableView.indexPathsForVisibleRows;
+    if (visibleIndexPaths.count > 0) {
+        [self.tableView reloadRowsAtIndexPaths:visibleIndexPaths withRowAnimation:UITableViewRowAnimationNone];
+    }
 }
 
 - (void)roomCreated:(NSNotification *)notification
@@ -498,6 +538,7 @@ typedef enum RoomsFilter {
     _searchString = searchString;
     // Cancel previous call to search listable rooms and messages
     [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(searchListableRoomsAndMessages) object:nil];
+    [self cancelServerSearches];
     
     // Search for listable rooms and messages
     if (searchString.length > 0) {
@@ -508,6 +549,8 @@ typedef enum RoomsFilter {
         }
         // Throttle listable rooms and messages search
         [self performSelector:@selector(searchListableRoomsAndMessages) withObject:nil afterDelay:1];
+        // Local messages can be searched right away, also without connection
+        [self searchLocalMessages];
     } else {
         // Clear search results
         [self setLoadMoreButtonHidden:YES];
@@ -519,6 +562,13 @@ typedef enum RoomsFilter {
     [self filterRooms];
 }
 
+- (void)willPresentSearchController:(UISearchController *)searchController
+{
+    // Index messages that were stored before the local search index existed, in the background
+    TalkAccount *account = [[NCDatabaseManager sharedInstance] activeAccount];
+    [[ChatMessageSearchIndex shared] backfillIfNeededForAccountId:account.accountId];
+}
+
 - (void)willDismissSearchController:(UISearchController *)searchController
 {
     _searchController.searchBar.text = @"";
@@ -539,9 +589,7 @@ typedef enum RoomsFilter {
 
     NSString *searchString = _searchController.searchBar.text;
     if (searchString.length == 0) {
-        _rooms = [[NSMutableArray alloc] initWithArray:filteredRooms];
-        [self calculateLastRoomWithMention];
-        [self.tableView reloadData];
+        [self updateDisplayedRooms:filteredRooms];
     } else {
         _resultTableViewController.rooms = [self filterRooms:filteredRooms withString:searchString];
     }
@@ -551,9 +599,15 @@ typedef enum RoomsFilter {
 {
     NSString *searchString = _searchController.searchBar.text;
     TalkAccount *account = [[NCDatabaseManager sharedInstance] activeAccount];
+    [self cancelServerSearches];
     // Search for contacts
     _resultTableViewController.users = @[];
-    [[NCAPIController sharedInstance] getContactsForAccount:account forRoom:nil groupRoom:NO withSearchParam:searchString andCompletionBlock:^(NSArray *indexes, NSMutableDictionary *contacts, NSMutableArray *contactList, NSError *error) {
+    _searchContactsTask = [[NCAPIController sharedInstance] getContactsForAccount:account forRoom:nil groupRoom:NO withSearchParam:searchString andCompletionBlock:^(NSArray *indexes, NSMutableDictionary *contacts, NSMutableArray *contactList, NSError *error) {
+        // Ignore results of outdated searches
+        if (![searchString isEqualToString:self->_searchString]) {
+            return;
+        }
+
         if (!error) {
             NSArray *users = [self usersWithoutOneToOneConversations:contactList];
             if ([[NCSettingsController sharedInstance] isContactSyncEnabled] && [[NCDatabaseManager sharedInstance] serverHasTalkCapability:kCapabilityPhonebookSearch]) {
@@ -567,7 +621,11 @@ typedef enum RoomsFilter {
     // Search for listable rooms
     if ([[NCDatabaseManager sharedInstance] serverHasTalkCapability:kCapabilityListableRooms]) {
         _resultTableViewController.listableRooms = @[];
-        [[NCAPIController sharedInstance] getListableRoomsForAccount:account withSearchTerm:searchString andCompletionBlock:^(NSArray *rooms, NSError *error, NSInteger statusCode) {
+        _searchListableRoomsTask = [[NCAPIController sharedInstance] getListableRoomsForAccount:account withSearchTerm:searchString andCompletionBlock:^(NSArray *rooms, NSError *error, NSInteger statusCode) {
+            if (![searchString isEqualToString:self->_searchString]) {
+                return;
+            }
+
             if (!error) {
                 self->_resultTableViewController.listableRooms = rooms;
             }
@@ -581,6 +639,30 @@ typedef enum RoomsFilter {
     }
 }
 
+- (void)searchLocalMessages
+{
+    NSString *searchString = _searchString;
+    TalkAccount *account = [[NCDatabaseManager sharedInstance] activeAccount];
+    [[ChatMessageSearchIndex shared] search:searchString forAccountId:account.accountId limit:20 completionBlock:^(NSArray<ChatMessageSearchResult *> *results) {
+        // Ignore results of outdated searches
+        if (![searchString isEqualToString:self->_searchString]) {
+            return;
+        }
+
+        self->_resultTableViewController.localMessages = results;
+    }];
+}
+
+- (void)cancelServerSearches
+{
+    [_searchContactsTask cancel];
+    _searchContactsTask = nil;
+    [_searchListableRoomsTask cancel];
+    _searchListableRoomsTask = nil;
+    // Unified search requests can't be cancelled, their results are ignored
+    _unifiedSearchController = nil;
+}
+
 - (NSArray *)usersWithoutOneToOneConversations:(NSArray *)users
 {
     NSPredicate *oneToOnePredicate = [NSPredicate predicateWithFormat:@"type == %ld", kNCRoomTypeOneToOne];
@@ -592,8 +674,14 @@ typedef enum RoomsFilter {
 
 - (void)searchForMessagesWithCurrentSearchTerm
 {
-    [_unifiedSearchController searchMessagesWithCompletionHandler:^(NSArray<NKSearchEntry *> *entries) {
+    NCUnifiedSearchController *unifiedSearchController = _unifiedSearchController;
+    [unifiedSearchController searchMessagesWithCompletionHandler:^(NSArray<NKSearchEntry *> *entries) {
         dispatch_async(dispatch_get_main_queue(), ^{
+            // Ignore results of outdated searches
+            if (unifiedSearchController != self->_unifiedSearchController) {
+                return;
+            }
+
             self->_resultTableViewController.searchingMessages = NO;
             self->_resultTableViewController.messages = entries;
             [self setLoadMoreButtonHidden:!self->_unifiedSearchController.showMore];
@@ -615,7 +703,7 @@ typedef enum RoomsFilter {
 
 - (NSArray *)filterRooms:(NSArray *)rooms withString:(NSString *)searchString
 {
-    return [rooms filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"displayName CONTAINS[c] %@", searchString]];
+    return [_roomSearchIndex roomsMatching:searchString in:rooms];
 }
 
 - (void)setLoadMoreButtonHidden:(BOOL)hidden
@@ -683,25 +771,136 @@ typedef enum RoomsFilter {
     TalkAccount *account = [[NCDatabaseManager sharedInstance] activeAccount];
     NSArray *accountRooms = [[NCRoomsManager sharedInstance] roomsForAccountId:account.accountId witRealm:nil];
     _allRooms = [[NSMutableArray alloc] initWithArray:accountRooms];
-    _rooms = [[NSMutableArray alloc] initWithArray:accountRooms];
+    [_roomSearchIndex updateWithRooms:accountRooms];
     
     // Show/Hide placeholder view
     [_roomsBackgroundView.loadingView stopAnimating];
     [_roomsBackgroundView.loadingView setHidden:YES];
-    [_roomsBackgroundView.placeholderView setHidden:(_rooms.count > 0)];
+    [_roomsBackgroundView.placeholderView setHidden:(accountRooms.count > 0)];
 
-    // Filter rooms
+    // Filter rooms (this also updates the room list)
     [self filterRooms];
-    
-    // Reload room list
+}
+
+- (void)updateDisplayedRooms:(NSArray *)rooms
+{
+    NSArray *oldRooms = [_rooms copy];
+    RoomListItems *oldItems = [_displayedRoomListItemsRooms isEqualToArray:oldRooms] ? _displayedRoomListItems : nil;
+    NSInteger generation = ++_roomListUpdateGeneration;
+
+    // Nothing to animate, just show the new list
+    if (oldRooms.count == 0 || rooms.count == 0 || !oldItems || !self.tableView.window) {
+        [self reloadDisplayedRooms:rooms];
+        return;
+    }
+
+    // Only changed rows are updated, so unchanged cells keep their content (e.g. avatars)
+    dispatch_async(_roomListDiffQueue, ^{
+        RoomListItems *newItems = [RoomListItems itemsFor:rooms];
+        RoomListTableDiff *diff = [RoomListTableDiff diffFrom:oldItems to:newItems inSection:0];
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            // A newer list is already being diffed
+            if (generation != self->_roomListUpdateGeneration) {
+                return;
+            }
+
+            // The list was modified while diffing (e.g. a room was deleted)
+            if (diff.requiresReload || ![self->_rooms isEqualToArray:oldRooms]) {
+                [self reloadDisplayedRooms:rooms];
+                return;
+            }
+
+            self->_displayedRoomListItems = newItems;
+            self->_displayedRoomListItemsRooms = rooms;
+            [self applyRoomListDiff:diff withRooms:rooms];
+        });
+    });
+}
+
+- (void)reloadDisplayedRooms:(NSArray *)rooms
+{
+    _snapshotEntries = nil;
+    _rooms = [[NSMutableArray alloc] initWithArray:rooms];
     [self.tableView reloadData];
-    
+    [self didUpdateDisplayedRooms];
+
+    // The next update is diffed against the rooms shown now
+    [self createDisplayedRoomListItemsForRooms:rooms];
+}
+
+- (void)createDisplayedRoomListItemsForRooms:(NSArray *)rooms
+{
+    NSInteger generation = _roomListUpdateGeneration;
+
+    _displayedRoomListItems = nil;
+    _displayedRoomListItemsRooms = nil;
+
+    if (rooms.count == 0) {
+        return;
+    }
+
+    dispatch_async(_roomListDiffQueue, ^{
+        RoomListItems *items = [RoomListItems itemsFor:rooms];
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (generation != self->_roomListUpdateGeneration) {
+                return;
+            }
+
+            self->_displayedRoomListItems = items;
+            self->_displayedRoomListItemsRooms = rooms;
+        });
+    });
+}
+
+- (void)applyRoomListDiff:(RoomListTableDiff *)diff withRooms:(NSArray *)rooms
+{
+    if (diff.hasStructuralChanges) {
+        [self.tableView performBatchUpdates:^{
+            self->_rooms = [[NSMutableArray alloc] initWithArray:rooms];
+            [self.tableView deleteRowsAtIndexPaths:diff.deletedIndexPaths withRowAnimation:UITableViewRowAnimationFade];
+            [self.tableView insertRowsAtIndexPaths:diff.insertedIndexPaths withRowAnimation:UITableViewRowAnimationFade];
+            for (NSInteger i = 0; i < diff.movedFromIndexPaths.count; i++) {
+                [self.tableView moveRowAtIndexPath:diff.movedFromIndexPaths[i] toIndexPath:diff.movedToIndexPaths[i]];
+            }
+        } completion:nil];
+    } else {
+        _rooms = [[NSMutableArray alloc] initWithArray:rooms];
+    }
+
+    // Reload instead of reconfigure, so the cells are prepared for reuse before they are configured again
+    if (diff.updatedIndexPaths.count > 0) {
+        [self.tableView reloadRowsAtIndexPaths:diff.updatedIndexPaths withRowAnimation:UITableViewRowAnimationNone];
+    }
+
+    [self didUpdateDisplayedRooms];
+}
+
+- (void)didUpdateDisplayedRooms
+{
+    [NCStartupPhases markFirstFrameWithSnapshot:NO];
+
+    [self calculateLastRoomWithMention];
+
     // Update unread mentions indicator
     [self updateMentionsIndicator];
 
     [self highlightSelectedRoom];
 }
 
+- (void)saveRoomListSnapshot
+{
+    // Only store rooms that are loaded from the database
+    if (_snapshotEntries || !_allRooms) {
+        return;
+    }
+
+    TalkAccount *account = [[NCDatabaseManager sharedInstance] activeAccount];
+    BOOL directMentionFlag = [[NCDatabaseManager sharedInstance] serverHasTalkCapability:kCapabilityDirectMentionFlag];
+    [[RoomListSnapshot shared] saveWithRooms:_allRooms forAccountId:account.accountId withDirectMentionFlag:directMentionFlag];
+}
+
 - (void)adaptInterfaceForAppState:(AppState)appState
 {
     switch (appState) {
@@ -1168,6 +1367,11 @@ typedef enum RoomsFilter {
 - (void)presentChatForRoomAtIndexPath:(NSIndexPath *)indexPath
 {
     NCRoom *room = [self roomForIndexPath:indexPath];
+
+    // Rooms of the snapshot can't be opened until the rooms are loaded
+    if (!room) {
+        return;
+    }
     
     [[NCRoomsManager sharedInstance] startChatInRoom:room];
 }
@@ -1204,6 +1408,11 @@ typedef enum RoomsFilter {
 {
     NSString *roomToken = [message.attributes objectForKey:@"conversation"];
     NSString *messageId = [message.attributes objectForKey:@"messageId"];
+    [self presentMessageInChatWithRoomToken:roomToken messageId:messageId];
+}
+
+- (void)presentMessageInChatWithRoomToken:(NSString *)roomToken messageId:(NSString *)messageId
+{
     if (roomToken && messageId) {
         // Present message in chat view
         NSMutableDictionary *userInfo = [[NSMutableDictionary alloc] init];
@@ -1243,6 +1452,10 @@ typedef enum RoomsFilter {
 
 - (NSInteger)tableView:(UITableView *)tableView numberOfRowsInSection:(NSInteger)section
 {
+    if (_snapshotEntries) {
+        return _snapshotEntries.count;
+    }
+
     return _rooms.count;
 }
 
@@ -1253,6 +1466,10 @@ typedef enum RoomsFilter {
 
 - (UISwipeActionsConfiguration *)tableView:(UITableView *)tableView trailingSwipeActionsConfigurationForRowAtIndexPath:(NSIndexPath *)indexPath
 {
+    if (![self roomForIndexPath:indexPath]) {
+        return nil;
+    }
+
     UIContextualAction *moreAction = [UIContextualAction contextualActionWithStyle:UIContextualActionStyleNormal title:nil
                                                                             handler:^(UIContextualAction * _Nonnull action, __kindof UIView * _Nonnull sourceView, void (^ _Nonnull completionHandler)(BOOL)) {
                                                                                 [self presentMoreActionsForRoomAtIndexPath:indexPath];
@@ -1331,6 +1548,10 @@ typedef enum RoomsFilter {
 
 - (UITableViewCell *)tableView:(UITableView *)tableView cellForRowAtIndexPath:(NSIndexPath *)indexPath
 {
+    if (_snapshotEntries) {
+        return [self tableView:tableView cellForSnapshotEntry:[_snapshotEntries objectAtIndex:indexPath.row]];
+    }
+
     NCRoom *room = [_rooms objectAtIndex:indexPath.row];
     RoomTableViewCell *cell = [tableView dequeueReusableCellWithIdentifier:kRoomCellIdentifier];
     if (!cell) {
@@ -1385,6 +1606,48 @@ typedef enum RoomsFilter {
     return cell;
 }
 
+- (UITableViewCell *)tableView:(UITableView *)tableView cellForSnapshotEntry:(RoomListSnapshotEntry *)entry
+{
+    RoomTableViewCell *cell = [tableView dequeueReusableCellWithIdentifier:kRoomCellIdentifier];
+    if (!cell) {
+        cell = [[RoomTableViewCell alloc] initWithStyle:UITableViewCellStyleDefault reuseIdentifier:kRoomCellIdentifier];
+    }
+
+    // Same as a room cell, but without avatar, which is loaded together with the rooms
+    cell.titleLabel.text = entry.displayName;
+
+    if (entry.lastMessageString) {
+        cell.titleOnly = NO;
+        cell.subtitleLabel.text = entry.lastMessageString;
+    } else {
+        cell.titleOnly = YES;
+    }
+    NSDate *date = [[NSDate alloc] initWithTimeIntervalSince1970:entry.lastActivity];
+    cell.dateLabel.text = [NCUtils readableTimeOrDateFromDate:date];
+
+    [cell setUnreadMessages:entry.unreadMessages mentioned:entry.mentioned groupMentioned:entry.groupMentioned];
+
+    if (entry.isOneToOne && [entry.status length] != 0) {
+        if (![entry.status isEqualToString:@"dnd"] && [entry.statusIcon length] != 0) {
+            [cell setUserStatusIcon:entry.statusIcon];
+        } else {
+            [cell setUserStatus:entry.status];
+        }
+    }
+
+    if (entry.hasCall) {
+        [cell.favoriteImage setTintColor:[UIColor systemRedColor]];
+        [cell.favoriteImage setImage:[UIImage systemImageNamed:@"video.fill"]];
+    } else if (entry.isFavorite) {
+        [cell.favoriteImage setTintColor:[UIColor systemYellowColor]];
+        [cell.favoriteImage setImage:[UIImage systemImageNamed:@"star.fill"]];
+    }
+
+    cell.roomToken = entry.token;
+
+    return cell;
+}
+
 - (void)tableView:(UITableView *)tableView didSelectRowAtIndexPath:(NSIndexPath *)indexPath
 {
     [self setSelectedRoomToken:nil];
@@ -1392,8 +1655,12 @@ typedef enum RoomsFilter {
 
     if (tableView == _resultTableViewController.tableView) {
         // Messages
-        NKSearchEntry *message = [_resultTableViewController messageForIndexPath:indexPath];
-        if (message) {
+        id message = [_resultTableViewController messageForIndexPath:indexPath];
+        if ([message isKindOfClass:[ChatMessageSearchResult class]]) {
+            ChatMessageSearchResult *localMessage = (ChatMessageSearchResult *)message;
+            [self presentMessageInChatWithRoomToken:localMessage.token messageId:[NSString stringWithFormat:@"%ld", (long)localMessage.messageId]];
+            return;
+        } else if (message) {
             [self presentSelectedMessageInChat:message];
             return;
         }
@@ -0,0 +1,562 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+#if canImport(FoundationNetworking)
+import FoundationNetworking
+#endif
+
+struct DownloadSegment: Codable, Equatable {
+    var start: Int64
+    var end: Int64 // inclusive
+    var receivedBytes: Int64
+
+    var length: Int64 {
+        return end - start + 1
+    }
+
+    var nextOffset: Int64 {
+        return start + receivedBytes
+    }
+
+    var isComplete: Bool {
+        return receivedBytes >= length
+    }
+}
+
+struct PartialDownloadState: Codable {
+    var etag: String
+    var fileSize: Int64
+    // The segments are downloaded in this order, when they are not downloaded in parallel
+    var segments: [DownloadSegment]
+    // Number of bytes at the end of the file that are needed, before the beginning of the file can be played
+    var tailLength: Int64
+
+    var receivedBytes: Int64 {
+        return segments.reduce(0) { $0 + min($1.receivedBytes, $1.length) }
+    }
+
+    /// Number of bytes from the start of the file that can already be read by a player
+    var playableBytes: Int64 {
+        var playableBytes: Int64 = 0
+
+        for segment in segments.sorted(by: { $0.start < $1.start }) {
+            guard segment.start == playableBytes else { break }
+
+            playableBytes += min(segment.receivedBytes, segment.length)
+
+            if !segment.isComplete {
+                break
+            }
+        }
+
+        if playableBytes >= fileSize || tailLength <= 0 {
+            return playableBytes
+        }
+
+        // Containers with an index at the end (e.g. MP4 without faststart or WebM cues) can't be played without it
+        let tailStart = fileSize - tailLength
+        let tailSegments = segments.filter { $0.start >= tailStart }
+        let hasTail = !tailSegments.isEmpty && tailSegments.allSatisfy { $0.isComplete }
+
+        return hasTail ? playableBytes : 0
+    }
+
+    init(etag: String, fileSize: Int64, numberOfSegments: Int, tailLength: Int64) {
+        self.etag = etag
+        self.fileSize = fileSize
+        self.segments = []
+        self.tailLength = 0
+
+        if tailLength > 0, tailLength < fileSize {
+            // Download the end of the file first, then the rest from the beginning
+            self.tailLength = tailLength
+            self.segments.append(DownloadSegment(start: fileSize - tailLength, end: fileSize - 1, receivedBytes: 0))
+            self.segments.append(DownloadSegment(start: 0, end: fileSize - tailLength - 1, receivedBytes: 0))
+
+            return
+        }
+
+        let numberOfSegments = max(numberOfSegments, 1)
+        let segmentSize = (fileSize + Int64(numberOfSegments) - 1) / Int64(numberOfSegments)
+
+        for index in 0..<numberOfSegments {
+            let start = Int64(index) * segmentSize
+            let end = min(start + segmentSize, fileSize) - 1
+
+            if start <= end {
+                self.segments.append(DownloadSegment(start: start, end: end, receivedBytes: 0))
+            }
+        }
+    }
+}
+
+private class SegmentTask {
+    let index: Int
+    var attempt = 0
+    var dataTask: URLSessionDataTask?
+    var fileHandle: FileHandle?
+    var unsavedBytes: Int64 = 0
+
+    init(index: Int) {
+        self.index = index
+    }
+}
+
+/// Downloads a file with HTTP range requests into a partial file next to the destination.
+/// The received byte ranges are stored in a small state file, so an interrupted download continues where it stopped
+/// as long as the etag of the file on the server did not change. Large files are split into segments that are downloaded in parallel.
+/// Files that are played while they are downloaded are downloaded from the start, after an optional tail segment.
+class SegmentedFileDownloader: NSObject, URLSessionDataDelegate {
+
+    typealias ProgressBlock = (_ fractionCompleted: Double, _ playableFraction: Double) -> Void
+    typealias CompletionBlock = (_ errorDescription: String?) -> Void
+    typealias ChallengeBlock = (_ challenge: URLAuthenticationChallenge) -> (URLSession.AuthChallengeDisposition, URLCredential?)
+
+    public var maxParallelSegments = 4
+    public var parallelDownloadThreshold: Int64 = 32 * 1024 * 1024
+    // Disable for files that are played while they are downloaded, so the partial file is filled from the start
+    public var allowsParallelSegments = true
+    // Downloaded before the rest of the file, when segments are not downloaded in parallel
+    public var tailLength: Int64 = 0
+    public var maxRetries = 4
+    public var retryBaseDelay: TimeInterval = 1
+    public var callbackQueue = DispatchQueue.main
+    public var challengeBlock: ChallengeBlock?
+    public var logBlock: ((_ message: String) -> Void)?
+
+    private let configuration: URLSessionConfiguration
+    private let requestHeaders: [String: String]
+
+    // All state is only accessed from the delegate queue of the session
+    private let delegateQueue: OperationQueue = {
+        let queue = OperationQueue()
+        queue.maxConcurrentOperationCount = 1
+        queue.name = "com.nextcloud.Talk.SegmentedFileDownloader"
+        return queue
+    }()
+
+    private var urlSession: URLSession?
+    private var sourceURL: URL?
+    private var localPath = ""
+    private var state: PartialDownloadState?
+    private var segmentTasks: [Int: SegmentTask] = [:]
+    private var lastReportedProgress: Double = 0
+    private var progressBlock: ProgressBlock?
+    private var completionBlock: CompletionBlock?
+
+    private var partialFilePath: String {
+        return SegmentedFileDownloader.partialFilePath(forLocalPath: localPath)
+    }
+
+    private var stateFilePath: String {
+        return localPath + ".partinfo"
+    }
+
+    init(configuration: URLSessionConfiguration, requestHeaders: [String: String]) {
+        self.configuration = configuration
+        self.requestHeaders = requestHeaders
+        super.init()
+    }
+
+    // MARK: - Public
+
+    /// The file the download is written to until it's complete, it has the final size from the beginning
+    class func partialFilePath(forLocalPath localPath: String) -> String {
+        return localPath + ".part"
+    }
+
+    /// Returns how many bytes from the end of the file need to be downloaded first to play the file while it's downloaded,
+    /// or nil if the container of the file can't be played from a partial file
+    class func streamingTailLength(forFileName fileName: String, fileSize: Int64) -> Int64? {
+        switch (fileName as NSString).pathExtension.lowercased() {
+        case "mp4", "m4v", "m4a", "mov", "3gp", "webm", "mkv", "mka", "avi":
+            // The index (moov atom, cues, idx1) might be stored at the end of the file, it's usually far below 3% of the file
+            return min(max(fileSize / 32, 1024 * 1024), 16 * 1024 * 1024)
+        case "ts", "mts", "m2ts", "mpg", "mpeg", "mp3", "aac", "ogg", "oga", "ogv", "opus", "flac", "wav":
+            return 0
+        default:
+            return nil
+        }
+    }
+
+    func downloadFile(fromURL url: URL, toPath localPath: String, fileSize: Int64, etag: String,
+                      progressBlock: ProgressBlock?, completionBlock: @escaping CompletionBlock) {
+
+        delegateQueue.addOperation {
+            self.sourceURL = url
+            self.localPath = localPath
+            self.progressBlock = progressBlock
+            self.completionBlock = completionBlock
+
+            self.configuration.httpMaximumConnectionsPerHost = max(self.maxParallelSegments, 1)
+
+            self.urlSession = URLSession(configuration: self.configuration, delegate: self, delegateQueue: self.delegateQueue)
+            self.state = self.resumableState(forFileSize: fileSize, etag: etag) ??
+                self.newState(forFileSize: fileSize, etag: etag, numberOfSegments: self.numberOfSegments(forFileSize: fileSize),
+                              tailLength: self.allowsParallelSegments ? 0 : self.tailLength)
+
+            guard self.state != nil else {
+                self.finish(withErrorDescription: NSLocalizedString("Unable to save file", comment: ""))
+                return
+            }
+
+            self.startIncompleteSegments()
+        }
+    }
+
+    func cancel() {
+        delegateQueue.addOperation {
+            // Keep the partial file and its state, so the download can be resumed later
+            self.saveState()
+            self.completionBlock = nil
+            self.progressBlock = nil
+            self.closeFileHandles()
+            self.urlSession?.invalidateAndCancel()
+            self.urlSession = nil
+        }
+    }
+
+    // MARK: - Partial download state
+
+    private func resumableState(forFileSize fileSize: Int64, etag: String) -> PartialDownloadState? {
+        guard let data = FileManager.default.contents(atPath: stateFilePath),
+              let state = try? JSONDecoder().decode(PartialDownloadState.self, from: data),
+              state.fileSize == fileSize, !etag.isEmpty, state.etag == etag,
+              allowsParallelSegments || (state.segments.count <= 2 && state.tailLength == tailLength),
+              let attributes = try? FileManager.default.attributesOfItem(atPath: partialFilePath),
+              (attributes[.size] as? NSNumber)?.int64Value == fileSize
+        else { return nil }
+
+        logBlock?("Resuming download of \((localPath as NSString).lastPathComponent) at \(state.receivedBytes)/\(fileSize) bytes")
+
+        return state
+    }
+
+    private func numberOfSegments(forFileSize fileSize: Int64) -> Int {
+        guard allowsParallelSegments, fileSize >= parallelDownloadThreshold else { return 1 }
+
+        return max(1, min(maxParallelSegments, Int(fileSize / (parallelDownloadThreshold / 4))))
+    }
+
+    private func newState(forFileSize fileSize: Int64, etag: String, numberOfSegments: Int, tailLength: Int64) -> PartialDownloadState? {
+        let fileManager = FileManager.default
+
+        try? fileManager.removeItem(atPath: partialFilePath)
+        try? fileManager.removeItem(atPath: stateFilePath)
+
+        // Preallocate the partial file, so every segment can write at its own offset
+        guard fileManager.createFile(atPath: partialFilePath, contents: nil),
+              let fileHandle = FileHandle(forWritingAtPath: partialFilePath)
+        else { return nil }
+
+        fileHandle.truncateFile(atOffset: UInt64(fileSize))
+        fileHandle.closeFile()
+
+        let state = PartialDownloadState(etag: etag, fileSize: fileSize, numberOfSegments: numberOfSegments, tailLength: tailLength)
+        self.state = state
+        self.saveState()
+
+        return state
+    }
+
+    private func saveState() {
+        guard let state, let data = try? JSONEncoder().encode(state) else { return }
+
+        try? data.write(to: URL(fileURLWithPath: stateFilePath), options: .atomic)
+    }
+
+    // MARK: - Segments
+
+    private func startIncompleteSegments() {
+        guard let state else { return }
+
+        let incompleteSegments = state.segments.indices.filter { !state.segments[$0].isComplete }
+
+        if incompleteSegments.isEmpty {
+            self.assembleFile()
+            return
+        }
+
+        // When the file is played while it's downloaded, the segments are downloaded one after another
+        let segmentsToStart = allowsParallelSegments ? incompleteSegments : Array(incompleteSegments.prefix(1))
+
+        // Segments that are running or waiting for a retry already have a task
+        for index in segmentsToStart where segmentTasks[index] == nil {
+            self.start(segmentTask: SegmentTask(index: index))
+        }
+    }
+
+    private func start(segmentTask: SegmentTask) {
+        guard let state, let sourceURL, let urlSession else { return }
+
+        let segment = state.segments[segmentTask.index]
+        segmentTasks[segmentTask.index] = segmentTask
+
+        var request = URLRequest(url: sourceURL)
+
+        for (field, value) in requestHeaders {
+            request.setValue(value, forHTTPHeaderField: field)
+        }
+
+        request.setValue("bytes=\(segment.nextOffset)-\(segment.end)", forHTTPHeaderField: "Range")
+
+        if !state.etag.isEmpty {
+            // Only return the requested range if the file did not change, otherwise the full file is returned
+            request.setValue("\"\(state.etag)\"", forHTTPHeaderField: "If-Range")
+        }
+
+        let task = urlSession.dataTask(with: request)
+        segmentTask.dataTask = task
+        task.resume()
+    }
+
+    private func segmentTask(for task: URLSessionTask) -> SegmentTask? {
+        // Tasks that were cancelled or replaced (e.g. after a restart) are not assigned to a segment anymore
+        return segmentTasks.values.first { $0.dataTask === task }
+    }
+
+    private func restartWithoutSegments() {
+        guard let state else { return }
+
+        // The server ignored our range request (e.g. the file changed), so start again with a single request
+        logBlock?("Server did not return a partial response, restarting download of \((localPath as NSString).lastPathComponent)")
+
+        self.closeFileHandles()
+
+        for segmentTask in segmentTasks.values {
+            segmentTask.dataTask?.cancel()
+        }
+
+        segmentTasks.removeAll()
+
+        guard self.newState(forFileSize: state.fileSize, etag: "", numberOfSegments: 1, tailLength: 0) != nil else {
+            self.finish(withErrorDescription: NSLocalizedString("Unable to save file", comment: ""))
+            return
+        }
+
+        // The end of the file is now only available once the download is complete, so it can't be played before
+        self.state?.tailLength = state.tailLength
+        self.saveState()
+
+        self.startIncompleteSegments()
+    }
+
+    private func assembleFile() {
+        let fileManager = FileManager.default
+
+        self.closeFileHandles()
+
+        do {
+            try? fileManager.removeItem(atPath: localPath)
+            try fileManager.moveItem(atPath: partialFilePath, toPath: localPath)
+            try? fileManager.removeItem(atPath: stateFilePath)
+
+            self.reportProgress(force: true)
+            self.finish(withErrorDescription: nil)
+        } catch {
+            self.finish(withErrorDescription: error.localizedDescription)
+        }
+    }
+
+    private func finish(withErrorDescription errorDescription: String?) {
+        let completionBlock = self.completionBlock
+
+        self.completionBlock = nil
+        self.progressBlock = nil
+        self.closeFileHandles()
+
+        // The session retains its delegate, invalidate it to break the cycle
+        urlSession?.finishTasksAndInvalidate()
+        urlSession = nil
+
+        callbackQueue.async {
+            completionBlock?(errorDescription)
+        }
+    }
+
+    private func closeFileHandles() {
+        for segmentTask in segmentTasks.values {
+            segmentTask.fileHandle?.closeFile()
+            segmentTask.fileHandle = nil
+        }
+    }
+
+    private func reportProgress(force: Bool) {
+        guard let state, state.fileSize > 0, let progressBlock else { return }
+
+        let progress = Double(state.receivedBytes) / Double(state.fileSize)
+
+        // Don't flood the main queue with progress updates
+        if force || progress - lastReportedProgress >= 0.01 {
+            lastReportedProgress = progress
+
+            let playableFraction = Double(state.playableBytes) / Double(state.fileSize)
+
+            callbackQueue.async {
+                progressBlock(progress, playableFraction)
+            }
+        }
+    }
+
+    private func statusCode(for response: URLResponse?, error: Error?) -> Int {
+        if let error = error as NSError? {
+            return error.code
+        }
+
+        return (response as? HTTPURLResponse)?.statusCode ?? 0
+    }
+
+    private func shouldRetry(_ segmentTask: SegmentTask, errorCode: Int) -> Bool {
+        guard segmentTask.attempt < maxRetries else { return false }
+
+        // Network errors (NSURLError codes are negative) except cancellations
+        if errorCode < 0 {
+            return errorCode != NSURLErrorCancelled
+        }
+
+        return errorCode == 408 || errorCode == 429 || errorCode >= 500
+    }
+
+    // MARK: - URLSessionDataDelegate
+
+    func urlSession(_ session: URLSession, dataTask: URLSessionDataTask, didReceive response: URLResponse,
+                    completionHandler: @escaping (URLSession.ResponseDisposition) -> Void) {
+
+        guard let state, let segmentTask = self.segmentTask(for: dataTask) else {
+            completionHandler(.cancel)
+            return
+        }
+
+        let statusCode = (response as? HTTPURLResponse)?.statusCode ?? 0
+        let segment = state.segments[segmentTask.index]
+
+        if statusCode == 200 {
+            // A full response is only usable, when we requested the whole file anyway
+            if state.segments.count > 1 || segment.nextOffset > 0 {
+                completionHandler(.cancel)
+                self.restartWithoutSegments()
+                return
+            }
+        } else if statusCode != 206 {
+            // Let didCompleteWithError handle the error
+            completionHandler(.allow)
+            return
+        }
+
+        guard let fileHandle = FileHandle(forWritingAtPath: partialFilePath) else {
+            completionHandler(.cancel)
+            return
+        }
+
+        fileHandle.seek(toFileOffset: UInt64(segment.nextOffset))
+        segmentTask.fileHandle = fileHandle
+
+        completionHandler(.allow)
+    }
+
+    func urlSession(_ session: URLSession, dataTask: URLSessionDataTask, didReceive data: Data) {
+        guard var state = self.state, let segmentTask = self.segmentTask(for: dataTask), let fileHandle = segmentTask.fileHandle else { return }
+
+        var segment = state.segments[segmentTask.index]
+        let remainingBytes = Int(max(segment.length - segment.receivedBytes, 0))
+        let receivedData = data.count > remainingBytes ? data.prefix(remainingBytes) : data
+
+        fileHandle.write(receivedData)
+
+        segment.receivedBytes += Int64(receivedData.count)
+        state.segments[segmentTask.index] = segment
+        self.state = state
+
+        // Persist our progress from time to time, not for every received packet
+        segmentTask.unsavedBytes += Int64(receivedData.count)
+
+        if segmentTask.unsavedBytes >= 1024 * 1024 {
+            segmentTask.unsavedBytes = 0
+            self.saveState()
+        }
+
+        self.reportProgress(force: false)
+    }
+
+    func urlSession(_ session: URLSession, task: URLSessionTask, didCompleteWithError error: Error?) {
+        guard session == urlSession, let state, let segmentTask = self.segmentTask(for: task) else { return }
+
+        segmentTask.fileHandle?.closeFile()
+        segmentTask.fileHandle = nil
+        segmentTask.unsavedBytes = 0
+        self.saveState()
+
+        let statusCode = self.statusCode(for: task.response, error: error)
+        let segment = state.segments[segmentTask.index]
+
+        segmentTask.dataTask = nil
+
+        if segment.isComplete {
+            segmentTasks.removeValue(forKey: segmentTask.index)
+
+            // Starts the next segment, when they are downloaded one after another
+            self.reportProgress(force: true)
+            self.startIncompleteSegments()
+
+            return
+        }
+
+        if statusCode == 416 {
+            // The requested range is not available anymore, the file on the server changed
+            self.restartWithoutSegments()
+        } else if self.shouldRetry(segmentTask, errorCode: statusCode) {
+            // Exponential backoff with jitter: ~1s, 2s, 4s, 8s...
+            let delay = retryBaseDelay * (pow(2.0, Double(segmentTask.attempt)) + Double.random(in: 0...0.5))
+            segmentTask.attempt += 1
+
+            logBlock?("Retrying download segment \(segmentTask.index) of \((localPath as NSString).lastPathComponent) in \(String(format: "%.1f", delay))s (attempt \(segmentTask.attempt))")
+
+            DispatchQueue.global().asyncAfter(deadline: .now() + delay) {
+                self.delegateQueue.addOperation {
+                    self.start(segmentTask: segmentTask)
+                }
+            }
+        } else {
+            let errorDescription = error?.localizedDescription ?? HTTPURLResponse.localizedString(forStatusCode: statusCode)
+
+            logBlock?("Error downloading file: \(statusCode) - \(errorDescription)")
+
+            for segmentTask in segmentTasks.values {
+                segmentTask.dataTask?.cancel()
+            }
+
+            self.finish(withErrorDescription: errorDescription)
+        }
+    }
+
+    func urlSession(_ session: URLSession, didReceive challenge: URLAuthenticationChallenge,
+                    completionHandler: @escaping (URLSession.AuthChallengeDisposition, URLCredential?) -> Void) {
+
+        if let challengeBlock {
+            let (disposition, credential) = challengeBlock(challenge)
+            completionHandler(disposition, credential)
+        } else {
+            completionHandler(.performDefaultHandling, nil)
+        }
+    }
+}
@@ -25,7 +25,29 @@ import UIKit
 
 @objcMembers class SwiftMarkdownObjCBridge: NSObject {
 
-    static let markdownParser: CDMarkdownParser = {
+    static let markdownParser: CDMarkdownParser = makeMarkdownParser()
+
+    // CDMarkdownParser is not thread safe, pre-parsing uses its own instance, only accessed on the preparseQueue
+    private static let backgroundMarkdownParser: CDMarkdownParser = makeMarkdownParser()
+    private static let preparseQueue = DispatchQueue(label: "com.nextcloud.Talk.markdownPreparse", qos: .utility)
+
+    static let parseCache = MarkdownParseCache(byteBudget: 8 * 1024 * 1024) { value in
+        // Colors and fonts are created for every message again, dynamic colors are compared by their light and dark appearance
+        if let color = value as? UIColor {
+            let lightColor = color.resolvedColor(with: UITraitCollection(userInterfaceStyle: .light))
+            let darkColor = color.resolvedColor(with: UITraitCollection(userInterfaceStyle: .dark))
+
+            return "\(SwiftMarkdownObjCBridge.colorComponents(of: lightColor))/\(SwiftMarkdownObjCBridge.colorComponents(of: darkColor))"
+        }
+
+        if let font = value as? UIFont {
+            return "\(font.fontName)-\(font.pointSize)"
+        }
+
+        return nil
+    }
+
+    private static func makeMarkdownParser() -> CDMarkdownParser {
         let markdownParser = CDMarkdownParser(font: .systemFont(ofSize: 16), fontColor: NCAppBranding.chatForegroundColor())
 
         markdownParser.code.backgroundColor = .secondarySystemBackground
@@ -48,9 +70,51 @@ import UIKit
         markdownParser.quote.color = nil
 
         return markdownParser
-    }()
+    }
+
+    private static func colorComponents(of color: UIColor) -> String {
+        var red: CGFloat = 0
+        var green: CGFloat = 0
+        var blue: CGFloat = 0
+        var alpha: CGFloat = 0
+
+        color.getRed(&red, green: &green, blue: &blue, alpha: &alpha)
+
+        return "\(red),\(green),\(blue),\(alpha)"
+    }
+
+    /// Parsed colors are dynamic, but the resolved appearance and the text size might still end up in the result
+    static func currentThemeKey() -> String {
+        let traitCollection = UITraitCollection.current
+
+        return "\(traitCollection.userInterfaceStyle.rawValue)-\(traitCollection.preferredContentSizeCategory.rawValue)"
+    }
 
     static func parseMarkdown(markdownString: NSAttributedString) -> NSMutableAttributedString {
-        return NSMutableAttributedString(attributedString: markdownParser.parse(markdownString))
+        let themeKey = currentThemeKey()
+
+        if let cachedResult = parseCache.result(for: markdownString, themeKey: themeKey) {
+            return NSMutableAttributedString(attributedString: cachedResult)
+        }
+
+        let result = markdownParser.parse(markdownString)
+        parseCache.store(result, for: markdownString, themeKey: themeKey)
+
+        return NSMutableAttributedString(attributedString: result)
+    }
+
+    /// Parses the given strings in the background, so they are already cached when they are displayed
+    static func preparseMarkdown(markdownStrings: [NSAttributedString]) {
+        let themeKey = currentThemeKey()
+        let sources = markdownStrings.compactMap { $0.copy() as? NSAttributedString }
+
+        guard !sources.isEmpty else { return }
+
+        preparseQueue.async {
+            for source in sources where !SwiftMarkdownObjCBridge.parseCache.contains(source, themeKey: themeKey) {
+                let result = SwiftMarkdownObjCBridge.backgroundMarkdownParser.parse(source)
+                SwiftMarkdownObjCBridge.parseCache.store(result, for: source, themeKey: themeKey)
+            }
+        }
     }
 }
@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+#if canImport(CryptoKit)
+import CryptoKit
+#else
+import Crypto
+#endif
+
+/// Palette index of a username, calculated the same way as by the web client.
+/// The indexes of recently used usernames are kept, as the MD5 hash is expensive compared to a lookup. Thread safe.
+final class UsernamePaletteIndexes {
+
+    let paletteSize: Int
+
+    private let lock = NSLock()
+    private var paletteIndexes: LRUCache<String, Int>
+
+    init(paletteSize: Int, capacity: Int = 1000) {
+        self.paletteSize = paletteSize
+        self.paletteIndexes = LRUCache(capacity: capacity)
+    }
+
+    func paletteIndex(for username: String) -> Int {
+        lock.lock()
+
+        if let paletteIndex = paletteIndexes.value(forKey: username) {
+            lock.unlock()
+            return paletteIndex
+        }
+
+        lock.unlock()
+
+        let paletteIndex = UsernamePaletteIndexes.paletteIndex(for: username, paletteSize: paletteSize)
+
+        lock.lock()
+        paletteIndexes.setValue(paletteIndex, forKey: username)
+        lock.unlock()
+
+        return paletteIndex
+    }
+
+    /// Same as the web client: the sum of all hex digits of the MD5 hash of the lowercased username, modulo the palette size
+    static func paletteIndex(for username: String, paletteSize: Int) -> Int {
+        var hashInt = 0
+
+        if let usernameData = username.lowercased().data(using: .utf8) {
+            let md5Hash = Insecure.MD5.hash(data: usernameData)
+
+            // Every byte is represented by two hex digits
+            hashInt = md5Hash.reduce(0) { $0 + Int($1 >> 4) + Int($1 & 0x0F) }
+        }
+
+        return hashInt % paletteSize
+    }
+}
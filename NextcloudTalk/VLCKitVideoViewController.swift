@@ -42,6 +42,16 @@ import MobileVLCKit
 
     private var mediaPlayer: VLCMediaPlayer?
     private var filePath: String
+    private var partialFilePath: String?
+    // The file must not be evicted from the cache while it's played
+    private let fileLease: ChatFileLease
+    // Part of the partial file that can be played, it's filled from the start (after the index at the end, if needed)
+    private var downloadedFraction: Float = 0
+    private var isWaitingForData = false
+    // The partial file could not be played, wait until the download is complete
+    private var streamingFailed = false
+    private let streamingStartFraction: Float = 0.05
+    private let streamingMargin: Float = 0.02
     private var setPosition: Bool = false
     private var timeObserver: NSKeyValueObservation?
     private var remainingTimeObserver: NSKeyValueObservation?
@@ -52,6 +62,16 @@ import MobileVLCKit
 
     init(filePath: String) {
         self.filePath = filePath
+        self.fileLease = ChatFileLease(filePath: filePath)
+
+        super.init(nibName: "VLCKitVideoViewController", bundle: nil)
+    }
+
+    /// Plays the media from the partial file as long as the file at filePath was not downloaded yet
+    init(filePath: String, partialFilePath: String?) {
+        self.filePath = filePath
+        self.partialFilePath = partialFilePath
+        self.fileLease = ChatFileLease(filePath: filePath)
 
         super.init(nibName: "VLCKitVideoViewController", bundle: nil)
     }
@@ -87,6 +107,10 @@ import MobileVLCKit
 
         // Set close button icon as template
         self.closeButton.setImage(UIImage(systemName: "xmark"), for: .normal)
+
+        if self.partialFilePath != nil {
+            NotificationCenter.default.addObserver(self, selector: #selector(downloadProgressDidChange(notification:)), name: NSNotification.Name.NCChatFileControllerDidChangeDownloadProgress, object: nil)
+        }
     }
 
     @objc private func dismissViewController() {
@@ -161,6 +185,7 @@ import MobileVLCKit
     }
 
     private func updateInformation() {
+        self.pauseIfDataIsMissing()
         self.positionSlider.value = self.mediaPlayer?.position ?? 0
 
         if let remainingTime = self.mediaPlayer?.remainingTime, let currentTime = self.mediaPlayer?.time {
@@ -172,8 +197,26 @@ import MobileVLCKit
         }
     }
 
+    private func isFileDownloaded() -> Bool {
+        return FileManager.default.fileExists(atPath: self.filePath)
+    }
+
+    private func isStreaming() -> Bool {
+        return self.partialFilePath != nil && !self.isFileDownloaded()
+    }
+
     private func resetMedia(drawFirstFrame: Bool) {
-        self.mediaPlayer?.media = VLCMedia(path: self.filePath)
+        if let partialFilePath = self.partialFilePath, self.isStreaming() {
+            // Wait until the beginning of the file is available
+            guard !self.streamingFailed, self.downloadedFraction >= self.streamingStartFraction else {
+                self.isWaitingForData = true
+                return
+            }
+
+            self.mediaPlayer?.media = VLCMedia(path: partialFilePath)
+        } else {
+            self.mediaPlayer?.media = VLCMedia(path: self.filePath)
+        }
 
         if drawFirstFrame {
             self.pauseAfterPlay = true
@@ -181,6 +224,49 @@ import MobileVLCKit
         }
     }
 
+    // MARK: Streaming
+
+    func downloadProgressDidChange(notification: Notification) {
+        guard let fileStatus = notification.userInfo?["fileStatus"] as? NCChatFileStatus, fileStatus.fileLocalPath == self.filePath,
+              let progress = notification.userInfo?["playableProgress"] as? NSNumber
+        else { return }
+
+        DispatchQueue.main.async {
+            self.downloadedFraction = progress.floatValue
+            self.resumeIfEnoughDataAvailable()
+        }
+    }
+
+    private func resumeIfEnoughDataAvailable() {
+        guard self.isWaitingForData else { return }
+
+        if self.mediaPlayer?.media == nil {
+            if (!self.streamingFailed && self.downloadedFraction >= self.streamingStartFraction) || !self.isStreaming() {
+                self.isWaitingForData = false
+                self.resetMedia(drawFirstFrame: true)
+            }
+
+            return
+        }
+
+        let position = self.mediaPlayer?.position ?? 0
+
+        if !self.isStreaming() || self.downloadedFraction >= min(position + self.streamingStartFraction, 1) {
+            self.isWaitingForData = false
+            self.mediaPlayer?.play()
+        }
+    }
+
+    private func pauseIfDataIsMissing() {
+        guard let mediaPlayer = self.mediaPlayer, mediaPlayer.isPlaying, self.isStreaming() else { return }
+
+        // The rest of the partial file is not downloaded yet, don't let the player read it
+        if mediaPlayer.position + self.streamingMargin >= self.downloadedFraction {
+            self.isWaitingForData = true
+            mediaPlayer.pause()
+        }
+    }
+
     private func mediaReachedEnd() -> Bool {
         guard let mediaPlayer = self.mediaPlayer else { return false }
 
@@ -237,6 +323,7 @@ import MobileVLCKit
         guard let mediaPlayer = self.mediaPlayer else { return }
 
         if mediaPlayer.isPlaying {
+            self.isWaitingForData = false
             mediaPlayer.pause()
         } else {
             // In VLCKit 3.3.17 the position parameter is not working correctly (fixed in 4.0.0)
@@ -253,6 +340,9 @@ import MobileVLCKit
     }
 
     @IBAction func shareButtonTap(_ sender: Any) {
+        // When streaming, the file can only be shared once the download finished
+        guard self.isFileDownloaded() else { return }
+
         let activityItem = NSURL(fileURLWithPath: filePath)
 
         let activityVC = UIActivityViewController(activityItems: [activityItem], applicationActivities: nil)
@@ -290,6 +380,16 @@ import MobileVLCKit
     func mediaPlayerStateChanged(_ aNotification: Notification!) {
         guard let mediaPlayer = self.mediaPlayer else { return }
 
+        if mediaPlayer.state == .error, self.isStreaming() {
+            // The container could not be read from the partial file (e.g. its index is larger than the prefetched tail)
+            NCUtils.log("Could not play partial file, waiting for the download to finish")
+            self.streamingFailed = true
+            self.isWaitingForData = true
+            mediaPlayer.media = nil
+
+            return
+        }
+
         if mediaPlayer.isPlaying {
             // When state changed to playing because we reseted the stream and
             // started playing to load it, we want to pause it here again, as it wasn't playing before
@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import Foundation
+
+enum VideoTileAction: Equatable {
+    // Add the renderer to the video track of the peer and show it in its cell
+    case attach(peerIdentifier: String, renderer: Int)
+    // Remove the renderer from the video track of the peer, it's kept in the pool for other peers
+    case detach(peerIdentifier: String, renderer: Int)
+    // The renderer is not needed anymore and can be released
+    case discard(renderer: Int)
+    // Ask the MCU to stop or start sending the video of the peer
+    case pauseVideo(peerIdentifier: String)
+    case resumeVideo(peerIdentifier: String)
+}
+
+/// Decides which peers with video get a renderer, based on the peers that are visible in the call grid.
+/// Renderers are identified by numbers and reused for other peers. Besides the attached renderers at most
+/// `maxIdleRenderers` idle renderers are kept, so at most one renderer per visible peer plus `maxIdleRenderers` exist.
+/// Peers that are not visible are paused, when `pausesHiddenPeers` is set (only useful with a MCU).
+/// Doesn't depend on any UI, the returned actions need to be applied in order.
+class VideoTileVisibilityController {
+
+    let maxIdleRenderers: Int
+    var pausesHiddenPeers = false
+
+    private(set) var attachedRenderers: [String: Int] = [:]
+    private(set) var idleRenderers: [Int] = []
+    private(set) var pausedPeers = Set<String>()
+
+    private var videoPeers = Set<String>()
+    private var visiblePeers = Set<String>()
+    private var nextRenderer = 0
+
+    init(maxIdleRenderers: Int = 2) {
+        self.maxIdleRenderers = max(maxIdleRenderers, 0)
+    }
+
+    var numberOfRenderers: Int {
+        return attachedRenderers.count + idleRenderers.count
+    }
+
+    // MARK: - Inputs
+
+    /// A peer started sending video
+    func addVideoPeer(_ peerIdentifier: String) -> [VideoTileAction] {
+        videoPeers.insert(peerIdentifier)
+        return self.reconcile(peerIdentifier)
+    }
+
+    /// A peer stopped sending video or left the call
+    func removeVideoPeer(_ peerIdentifier: String) -> [VideoTileAction] {
+        videoPeers.remove(peerIdentifier)
+        visiblePeers.remove(peerIdentifier)
+
+        // No need to resume a peer that is gone
+        pausedPeers.remove(peerIdentifier)
+
+        return self.reconcile(peerIdentifier)
+    }
+
+    /// A peer sends a new stream, a renderer of the previous stream is attached again.
+    /// The visibility of the peer is kept, so a visible peer is not paused in between.
+    func replaceVideoPeer(_ peerIdentifier: String) -> [VideoTileAction] {
+        videoPeers.insert(peerIdentifier)
+
+        var actions: [VideoTileAction] = []
+
+        if let renderer = attachedRenderers.removeValue(forKey: peerIdentifier) {
+            actions.append(.detach(peerIdentifier: peerIdentifier, renderer: renderer))
+            idleRenderers.append(renderer)
+        }
+
+        return actions + self.reconcile(peerIdentifier)
+    }
+
+    /// Peers whose cells are currently visible, including peers without video
+    func updateVisiblePeers(_ peerIdentifiers: Set<String>) -> [VideoTileAction] {
+        let changedPeers = visiblePeers.symmetricDifference(peerIdentifiers)
+        visiblePeers = peerIdentifiers
+
+        // Detach first, so the renderers can be reused for the peers becoming visible
+        let hiddenPeers = changedPeers.subtracting(peerIdentifiers).sorted()
+        let shownPeers = changedPeers.intersection(peerIdentifiers).sorted()
+
+        return (hiddenPeers + shownPeers).flatMap { self.reconcile($0) }
+    }
+
+    func removeAll() -> [VideoTileAction] {
+        let peers = videoPeers.union(attachedRenderers.keys).sorted()
+
+        videoPeers.removeAll()
+        visiblePeers.removeAll()
+        pausedPeers.removeAll()
+
+        var actions = peers.flatMap { self.reconcile($0) }
+
+        actions += idleRenderers.map { VideoTileAction.discard(renderer: $0) }
+        idleRenderers.removeAll()
+
+        return actions
+    }
+
+    // MARK: - Policy
+
+    private func reconcile(_ peerIdentifier: String) -> [VideoTileAction] {
+        let isVideoPeer = videoPeers.contains(peerIdentifier)
+        let shouldAttach = isVideoPeer && visiblePeers.contains(peerIdentifier)
+        let shouldPause = isVideoPeer && pausesHiddenPeers && !shouldAttach
+        var actions: [VideoTileAction] = []
+
+        if !shouldAttach, let renderer = attachedRenderers.removeValue(forKey: peerIdentifier) {
+            actions.append(.detach(peerIdentifier: peerIdentifier, renderer: renderer))
+
+            if idleRenderers.count < maxIdleRenderers {
+                idleRenderers.append(renderer)
+            } else {
+                actions.append(.discard(renderer: renderer))
+            }
+        }
+
+        if shouldPause, !pausedPeers.contains(peerIdentifier) {
+            pausedPeers.insert(peerIdentifier)
+            actions.append(.pauseVideo(peerIdentifier: peerIdentifier))
+        } else if !shouldPause, pausedPeers.contains(peerIdentifier) {
+            pausedPeers.remove(peerIdentifier)
+            actions.append(.resumeVideo(peerIdentifier: peerIdentifier))
+        }
+
+        if shouldAttach, attachedRenderers[peerIdentifier] == nil {
+            let renderer = idleRenderers.popLast() ?? self.makeRenderer()
+
+            attachedRenderers[peerIdentifier] = renderer
+            actions.append(.attach(peerIdentifier: peerIdentifier, renderer: renderer))
+        }
+
+        return actions
+    }
+
+    private func makeRenderer() -> Int {
+        nextRenderer += 1
+        return nextRenderer
+    }
+}
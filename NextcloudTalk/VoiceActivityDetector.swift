@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+// Only uses the Swift standard library, so the detector can be built and measured on any platform
+
+public enum VoiceActivityTransition {
+    case startedSpeaking
+    case stoppedSpeaking
+}
+
+/// Streaming voice activity detector working on short audio frames (e.g. 10ms of PCM).
+/// A frame is a speech candidate when its RMS is clearly above an adaptive noise floor and its zero-crossing rate is
+/// not noise-like. Speaking starts after `attackTime` of candidates and stops after `releaseTime` without candidates,
+/// while speaking the level thresholds are lowered by `speakingThresholdFactor`.
+/// Not thread safe, frames need to be processed in order from a single queue.
+public final class VoiceActivityDetector {
+
+    // RMS (relative to full scale) a frame needs to reach to be considered as speech at all, -50 dBFS
+    public var minimumSpeechLevel: Float = 0.00316
+    // RMS ratio to the noise floor a frame needs to reach to be considered as speech, 6 dB
+    public var speechToNoiseRatio: Float = 2.0
+    // While speaking, frames stay speech candidates down to this fraction of the thresholds above (-3 dB),
+    // so quieter syllables at the end of a sentence don't count as silence
+    public var speakingThresholdFactor: Float = 0.7
+    // Zero-crossing rate (crossings per sample) above which a frame is considered as noise
+    public var maximumZeroCrossingRate: Float = 0.35
+    // Seconds of speech candidates before speaking starts
+    public var attackTime: Float = 0.03
+    // Seconds without speech candidates before speaking stops
+    public var releaseTime: Float = 0.6
+
+    // How fast the noise floor follows lower levels (per second), it needs to drop quickly after speech or loud noise
+    public var noiseFloorFallRate: Float = 10
+    // How fast the noise floor follows higher levels (per second), slow enough to not adapt to speech
+    public var noiseFloorRiseRate: Float = 0.5
+
+    public private(set) var isSpeaking = false
+    public private(set) var noiseFloor: Float = 0
+
+    private var candidateTime: Float = 0
+    private var silenceTime: Float = 0
+
+    public init() {}
+
+    // MARK: - Frames
+
+    /// Processes 16 bit PCM samples, interleaved when there's more than one channel.
+    /// Returns a transition if the speaking state changed.
+    public func process(samples: UnsafeBufferPointer<Int16>, sampleRate: Int, channels: Int = 1) -> VoiceActivityTransition? {
+        let frameCount = channels > 0 ? samples.count / channels : 0
+
+        guard frameCount > 0, sampleRate > 0 else { return nil }
+
+        var sumOfSquares: Float = 0
+        var zeroCrossings = 0
+
+        // Zero crossings are only meaningful between consecutive samples of the same channel
+        for channel in 0..<channels {
+            var previousSample = samples[channel]
+
+            for frame in 0..<frameCount {
+                let sample = samples[frame * channels + channel]
+                let value = Float(sample) / Float(Int16.max)
+                sumOfSquares += value * value
+
+                if (sample >= 0) != (previousSample >= 0) {
+                    zeroCrossings += 1
+                }
+
+                previousSample = sample
+            }
+        }
+
+        let count = Float(frameCount * channels)
+        let rms = (sumOfSquares / count).squareRoot()
+
+        return self.process(rms: rms, zeroCrossingRate: Float(zeroCrossings) / count, duration: Float(frameCount) / Float(sampleRate))
+    }
+
+    /// Processes the features of a frame, the zero-crossing rate is optional for sources that only provide levels
+    public func process(rms: Float, zeroCrossingRate: Float?, duration: Float) -> VoiceActivityTransition? {
+        guard duration > 0 else { return nil }
+
+        if noiseFloor <= 0 {
+            // Start with the first level, but never above the speech level, otherwise speaking from the start is never detected
+            noiseFloor = min(rms, minimumSpeechLevel)
+        }
+
+        var threshold = max(minimumSpeechLevel, noiseFloor * speechToNoiseRatio)
+
+        if isSpeaking {
+            threshold *= speakingThresholdFactor
+        }
+
+        var isCandidate = rms >= threshold
+
+        if let zeroCrossingRate, zeroCrossingRate > maximumZeroCrossingRate {
+            isCandidate = false
+        }
+
+        self.updateNoiseFloor(rms: rms, isCandidate: isCandidate, duration: duration)
+
+        if isCandidate {
+            candidateTime += duration
+            silenceTime = 0
+        } else {
+            candidateTime = 0
+            silenceTime += duration
+        }
+
+        if !isSpeaking, candidateTime >= attackTime {
+            isSpeaking = true
+            return .startedSpeaking
+        }
+
+        if isSpeaking, silenceTime >= releaseTime {
+            isSpeaking = false
+            return .stoppedSpeaking
+        }
+
+        return nil
+    }
+
+    public func reset() {
+        isSpeaking = false
+        noiseFloor = 0
+        candidateTime = 0
+        silenceTime = 0
+    }
+
+    // MARK: - Noise floor
+
+    private func updateNoiseFloor(rms: Float, isCandidate: Bool, duration: Float) {
+        let rate: Float
+
+        if rms < noiseFloor {
+            rate = noiseFloorFallRate
+        } else if isCandidate {
+            // Follow a permanently louder environment, but a lot slower than without speech
+            rate = noiseFloorRiseRate / 10
+        } else {
+            rate = noiseFloorRiseRate
+        }
+
+        let weight = min(rate * duration, 1)
+        noiseFloor += (rms - noiseFloor) * weight
+    }
+}
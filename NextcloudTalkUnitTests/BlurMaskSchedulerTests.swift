@@ -0,0 +1,274 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class BlurMaskSchedulerTests: XCTestCase {
+
+    private let signatureSize = 16 * 16
+
+    private func signature(_ value: UInt8) -> [UInt8] {
+        return [UInt8](repeating: value, count: signatureSize)
+    }
+
+    // MARK: - Scheduling
+
+    func testEveryThirdFrameIsSegmented() {
+        let scheduler = BlurMaskScheduler()
+        var segmentedFrames: [Int] = []
+
+        for frame in 0..<10 where scheduler.shouldSegment(frameWithLumaSignature: signature(100)) {
+            segmentedFrames.append(frame)
+        }
+
+        XCTAssertEqual(segmentedFrames, [0, 3, 6, 9])
+        XCTAssertEqual(scheduler.segmentedFrames, 4)
+        XCTAssertEqual(scheduler.skippedFrames, 6)
+    }
+
+    func testFramesWithoutLumaSignatureOnlyUseTheInterval() {
+        let scheduler = BlurMaskScheduler()
+        scheduler.segmentationInterval = 2
+
+        let decisions = (0..<5).map { _ in scheduler.shouldSegment(frameWithLumaSignature: nil) }
+
+        XCTAssertEqual(decisions, [true, false, true, false, true])
+    }
+
+    func testLumaChangeTriggersSegmentationBeforeTheInterval() {
+        let scheduler = BlurMaskScheduler()
+
+        XCTAssertTrue(scheduler.shouldSegment(frameWithLumaSignature: signature(100)))
+
+        // 10 / 255 is below the threshold of 0.04, 11 / 255 is above
+        XCTAssertFalse(scheduler.shouldSegment(frameWithLumaSignature: signature(110)))
+        XCTAssertTrue(scheduler.shouldSegment(frameWithLumaSignature: signature(111)))
+
+        // The delta is measured against the last segmented frame, not the previous frame
+        XCTAssertFalse(scheduler.shouldSegment(frameWithLumaSignature: signature(118)))
+        XCTAssertFalse(scheduler.shouldSegment(frameWithLumaSignature: signature(104)))
+        XCTAssertTrue(scheduler.shouldSegment(frameWithLumaSignature: signature(104)))
+    }
+
+    func testResetSegmentsTheNextFrame() {
+        let scheduler = BlurMaskScheduler()
+
+        XCTAssertTrue(scheduler.shouldSegment(frameWithLumaSignature: signature(100)))
+        XCTAssertFalse(scheduler.shouldSegment(frameWithLumaSignature: signature(100)))
+
+        scheduler.reset()
+
+        XCTAssertTrue(scheduler.shouldSegment(frameWithLumaSignature: signature(100)))
+    }
+
+    // MARK: - Luma
+
+    func testLumaDelta() {
+        XCTAssertEqual(BlurMaskScheduler.lumaDelta(signature(0), signature(0)), 0)
+        XCTAssertEqual(BlurMaskScheduler.lumaDelta(signature(0), signature(255)), 1)
+        XCTAssertEqual(BlurMaskScheduler.lumaDelta([10, 20], [20, 10]), 10 / 255, accuracy: 0.0001)
+
+        // Signatures that can't be compared always trigger a segmentation
+        XCTAssertEqual(BlurMaskScheduler.lumaDelta([], []), 1)
+        XCTAssertEqual(BlurMaskScheduler.lumaDelta([1, 2], [1]), 1)
+    }
+
+    func testLumaSignatureIgnoresRowPadding() {
+        let width = 64
+        let height = 32
+        let bytesPerRow = 80
+        var plane = [UInt8](repeating: 255, count: bytesPerRow * height)
+
+        // Left half dark, right half bright, the padding at the end of each row is white
+        for y in 0..<height {
+            for x in 0..<width {
+                plane[y * bytesPerRow + x] = x < width / 2 ? 20 : 200
+            }
+        }
+
+        let signature = plane.withUnsafeBytes {
+            BlurMaskScheduler.lumaSignature(of: $0.baseAddress!, width: width, height: height, bytesPerRow: bytesPerRow)
+        }
+
+        XCTAssertEqual(signature.count, signatureSize)
+
+        for cellY in 0..<16 {
+            for cellX in 0..<16 {
+                XCTAssertEqual(signature[cellY * 16 + cellX], cellX < 8 ? 20 : 200)
+            }
+        }
+    }
+
+    func testLumaSignatureOfTooSmallPlanesIsEmpty() {
+        let plane = [UInt8](repeating: 0, count: 8 * 8)
+
+        let signature = plane.withUnsafeBytes {
+            BlurMaskScheduler.lumaSignature(of: $0.baseAddress!, width: 8, height: 8, bytesPerRow: 8)
+        }
+
+        XCTAssertTrue(signature.isEmpty)
+    }
+
+    // MARK: - Smoothing
+
+    private func smooth(_ mask: inout [UInt8], towards newMask: [UInt8], width: Int, height: Int, bytesPerRow: Int, factor: Double) {
+        mask.withUnsafeMutableBytes { maskBytes in
+            newMask.withUnsafeBytes { newMaskBytes in
+                BlurMaskScheduler.smoothMask(maskBytes.baseAddress!, bytesPerRow: bytesPerRow,
+                                             towards: newMaskBytes.baseAddress!, newMaskBytesPerRow: bytesPerRow,
+                                             width: width, height: height, factor: factor)
+            }
+        }
+    }
+
+    func testSmoothingUsesFixedPointWeights() {
+        var mask: [UInt8] = [0, 255, 100, 100]
+
+        smooth(&mask, towards: [255, 0, 100, 201], width: 4, height: 1, bytesPerRow: 4, factor: 0.5)
+
+        XCTAssertEqual(mask, [128, 127, 100, 151])
+
+        var fullMask: [UInt8] = [0, 255, 100]
+        smooth(&fullMask, towards: [255, 0, 42], width: 3, height: 1, bytesPerRow: 3, factor: 1)
+        XCTAssertEqual(fullMask, [255, 0, 42])
+
+        var unchangedMask: [UInt8] = [0, 255, 100]
+        smooth(&unchangedMask, towards: [255, 0, 42], width: 3, height: 1, bytesPerRow: 3, factor: 0)
+        XCTAssertEqual(unchangedMask, [0, 255, 100])
+    }
+
+    func testSmoothedMaskReachesAStableMaskExactly() {
+        var mask: [UInt8] = [0, 255, 0, 255]
+        let newMask: [UInt8] = [200, 0, 255, 1]
+
+        for _ in 0..<8 {
+            smooth(&mask, towards: newMask, width: 4, height: 1, bytesPerRow: 4, factor: 0.5)
+        }
+
+        XCTAssertEqual(mask, newMask)
+    }
+
+    func testSmoothingLeavesRowPaddingUntouched() {
+        var mask: [UInt8] = [0, 0, 7, 0, 0, 7]
+
+        smooth(&mask, towards: [255, 255, 9, 255, 255, 9], width: 2, height: 2, bytesPerRow: 3, factor: 1)
+
+        XCTAssertEqual(mask, [255, 255, 7, 255, 255, 7])
+    }
+
+    // MARK: - Composite
+
+    // Reference implementation of the composite on a single row, the gaussian blur is separable so a row is enough
+    // to compare blurring at full resolution with blurring the downscaled image
+
+    private func gaussianBlur(_ values: [Double], sigma: Double) -> [Double] {
+        let radius = Int((3 * sigma).rounded(.up))
+        let kernel = (-radius...radius).map { exp(-Double($0 * $0) / (2 * sigma * sigma)) }
+        let kernelSum = kernel.reduce(0, +)
+
+        return values.indices.map { index in
+            var sum = 0.0
+
+            for offset in -radius...radius {
+                // Same as clampedToExtent()
+                let sampleIndex = min(max(index + offset, 0), values.count - 1)
+                sum += kernel[offset + radius] * values[sampleIndex]
+            }
+
+            return sum / kernelSum
+        }
+    }
+
+    private func downscaledBlur(_ values: [Double], sigma: Double) -> [Double] {
+        let factor = Int(1 / BlurMaskScheduler.blurScale)
+        let downscaled = stride(from: 0, to: values.count, by: factor).map { start in
+            values[start..<min(start + factor, values.count)].reduce(0, +) / Double(factor)
+        }
+        let blurred = gaussianBlur(downscaled, sigma: BlurMaskScheduler.scaledBlurSigma(sigma))
+
+        // Linear interpolation between the centers of the downscaled pixels
+        return values.indices.map { index in
+            let position = (Double(index) + 0.5) * BlurMaskScheduler.blurScale - 0.5
+            let lower = Int(position.rounded(.down))
+            let fraction = position - Double(lower)
+            let lowerValue = blurred[min(max(lower, 0), blurred.count - 1)]
+            let upperValue = blurred[min(max(lower + 1, 0), blurred.count - 1)]
+
+            return lowerValue * (1 - fraction) + upperValue * fraction
+        }
+    }
+
+    private func composite(original: [Double], background: [Double], mask: [Double]) -> [Double] {
+        return original.indices.map { original[$0] * mask[$0] + background[$0] * (1 - mask[$0]) }
+    }
+
+    private func maxCompositeError(of row: [Double], mask: [Double]) -> Double {
+        let sigma = 8.0
+        let fullResolution = composite(original: row, background: gaussianBlur(row, sigma: sigma), mask: mask)
+        let reducedResolution = composite(original: row, background: downscaledBlur(row, sigma: sigma), mask: mask)
+
+        return zip(fullResolution, reducedResolution).map { abs($0 - $1) }.max() ?? 0
+    }
+
+    func testCompositeErrorOfDownscaledBlurIsBounded() {
+        // Multiple of the stripe width and the downscale factor, so both images end with the same values at the border
+        let width = 240
+        // Person in the middle, soft mask edges
+        let mask = (0..<width).map { index -> Double in
+            let distance = abs(Double(index) - Double(width) / 2)
+            return max(0, min(1, (64 - distance) / 8))
+        }
+
+        let edge = (0..<width).map { $0 < width / 3 ? 0.0 : 255.0 }
+        let stripes = (0..<width).map { ($0 / 3) % 2 == 0 ? 0.0 : 255.0 }
+        let noise = (0..<width).map { Double(($0 * 37) % 256) }
+
+        // Smooth content looks the same, even the worst case content stays within 5% of the value range
+        XCTAssertLessThan(maxCompositeError(of: edge, mask: mask), 1)
+        XCTAssertLessThan(maxCompositeError(of: stripes, mask: mask), 0.05 * 255)
+        XCTAssertLessThan(maxCompositeError(of: noise, mask: mask), 0.05 * 255)
+    }
+
+    func testCompositeKeepsTheForegroundUnchanged() {
+        let row = (0..<128).map { Double(($0 * 37) % 256) }
+        let mask = [Double](repeating: 1, count: row.count)
+
+        XCTAssertEqual(maxCompositeError(of: row, mask: mask), 0)
+    }
+
+    // MARK: - Performance
+
+    func testLumaSignaturePerformance() {
+        let width = 1280
+        let height = 720
+        let plane = (0..<(width * height)).map { UInt8(truncatingIfNeeded: $0 * 31) }
+
+        measure(metrics: [XCTClockMetric()]) {
+            for _ in 0..<100 {
+                _ = plane.withUnsafeBytes {
+                    BlurMaskScheduler.lumaSignature(of: $0.baseAddress!, width: width, height: height, bytesPerRow: width)
+                }
+            }
+        }
+    }
+}
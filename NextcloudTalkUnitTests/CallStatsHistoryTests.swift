@@ -0,0 +1,214 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class CallStatsHistoryTests: XCTestCase {
+
+    // Statistics of a single RTP stream, the timestamp is in seconds like the ones passed to the history
+    private func report(id: String = "stream", type: String = "inbound-rtp", kind: String = "audio", timestamp: Double,
+                        bytes: Double, packets: Double, packetsLost: Double = 0, jitter: Double? = nil) -> [String: [String: Any]] {
+
+        let isInbound = type == "inbound-rtp"
+        var values: [String: Any] = [
+            "type": type,
+            "kind": kind,
+            "timestamp": timestamp * 1000,
+            (isInbound ? "bytesReceived" : "bytesSent"): bytes,
+            (isInbound ? "packetsReceived" : "packetsSent"): packets
+        ]
+
+        if isInbound {
+            values["packetsLost"] = packetsLost
+        }
+
+        if let jitter {
+            values["jitter"] = jitter
+        }
+
+        return [id: values, "transport": ["type": "transport", "timestamp": timestamp * 1000]]
+    }
+
+    // MARK: - Rates
+
+    func testFirstReportHasNoRates() {
+        let sample = CallStatsRateCalculator().sample(from: report(timestamp: 10, bytes: 1000, packets: 10, jitter: 0.02), timestamp: 10)
+
+        XCTAssertEqual(sample.timestamp, 10)
+        XCTAssertEqual(sample.tracks.count, 1)
+        XCTAssertEqual(sample.tracks.first?.direction, "inbound")
+        XCTAssertNil(sample.tracks.first?.bitrate)
+        XCTAssertNil(sample.tracks.first?.packetRate)
+        XCTAssertNil(sample.tracks.first?.packetLoss)
+        // Jitter doesn't depend on the previous report
+        XCTAssertEqual(sample.tracks.first?.jitter ?? 0, 20, accuracy: 0.0001)
+    }
+
+    func testRatesOverTheReportInterval() {
+        let calculator = CallStatsRateCalculator()
+
+        _ = calculator.sample(from: report(timestamp: 10, bytes: 1000, packets: 10, packetsLost: 2), timestamp: 10)
+        let sample = calculator.sample(from: report(timestamp: 12, bytes: 11000, packets: 55, packetsLost: 7), timestamp: 12)
+        let track = sample.tracks.first
+
+        // 10,000 bytes and 45 packets in 2 seconds, 5 of 50 expected packets were lost
+        XCTAssertEqual(track?.bitrate ?? 0, 40000, accuracy: 0.0001)
+        XCTAssertEqual(track?.packetRate ?? 0, 22.5, accuracy: 0.0001)
+        XCTAssertEqual(track?.packetLoss ?? 0, 0.1, accuracy: 0.0001)
+    }
+
+    func testOutboundStreamsHaveNoPacketLoss() {
+        let calculator = CallStatsRateCalculator()
+
+        _ = calculator.sample(from: report(type: "outbound-rtp", timestamp: 0, bytes: 0, packets: 0), timestamp: 0)
+        let track = calculator.sample(from: report(type: "outbound-rtp", timestamp: 5, bytes: 5000, packets: 50), timestamp: 5).tracks.first
+
+        XCTAssertEqual(track?.direction, "outbound")
+        XCTAssertEqual(track?.bitrate ?? 0, 8000, accuracy: 0.0001)
+        XCTAssertNil(track?.packetLoss)
+    }
+
+    func testResetCountersResultInClampedRates() {
+        let calculator = CallStatsRateCalculator()
+
+        _ = calculator.sample(from: report(timestamp: 10, bytes: 50000, packets: 500, packetsLost: 20), timestamp: 10)
+        let resetTrack = calculator.sample(from: report(timestamp: 15, bytes: 1000, packets: 10, packetsLost: 0), timestamp: 15).tracks.first
+
+        XCTAssertEqual(resetTrack?.bitrate, 0)
+        XCTAssertEqual(resetTrack?.packetRate, 0)
+        XCTAssertEqual(resetTrack?.packetLoss, 0)
+
+        // The next report continues from the reset counters
+        let nextTrack = calculator.sample(from: report(timestamp: 20, bytes: 6000, packets: 60), timestamp: 20).tracks.first
+
+        XCTAssertEqual(nextTrack?.bitrate ?? 0, 8000, accuracy: 0.0001)
+        XCTAssertEqual(nextTrack?.packetRate ?? 0, 10, accuracy: 0.0001)
+    }
+
+    func testReportsWithoutElapsedTimeHaveNoRates() {
+        let calculator = CallStatsRateCalculator()
+
+        _ = calculator.sample(from: report(timestamp: 10, bytes: 1000, packets: 10), timestamp: 10)
+        let track = calculator.sample(from: report(timestamp: 10, bytes: 2000, packets: 20), timestamp: 10).tracks.first
+
+        XCTAssertNil(track?.bitrate)
+        XCTAssertNil(track?.packetRate)
+    }
+
+    func testStreamsMissingFromAReportAreForgotten() {
+        let calculator = CallStatsRateCalculator()
+
+        _ = calculator.sample(from: report(id: "first", timestamp: 0, bytes: 0, packets: 0), timestamp: 0)
+        _ = calculator.sample(from: report(id: "second", timestamp: 5, bytes: 0, packets: 0), timestamp: 5)
+        let track = calculator.sample(from: report(id: "first", timestamp: 10, bytes: 1000, packets: 10), timestamp: 10).tracks.first
+
+        XCTAssertEqual(track?.id, "first")
+        XCTAssertNil(track?.bitrate)
+    }
+
+    // MARK: - History
+
+    func testRingBufferKeepsTheNewestElements() {
+        var buffer = CallStatsRingBuffer<Int>(capacity: 3)
+
+        buffer.append(1)
+        buffer.append(2)
+        XCTAssertEqual(buffer.elements, [1, 2])
+
+        for element in 3...7 {
+            buffer.append(element)
+        }
+
+        XCTAssertEqual(buffer.count, 3)
+        XCTAssertEqual(buffer.elements, [5, 6, 7])
+    }
+
+    func testHistoryStaysBoundedOverEightHours() {
+        let interval = 5.0
+        let history = CallStatsHistory(samplesPerPeer: 720, maxPeers: 32)
+        var bytes = 0.0
+
+        // 8 hours with 5 second reports: 32 peers stay in the call, a new guest joins every 10 minutes and stays for an hour
+        for tick in 0..<(8 * 60 * 60 / Int(interval)) {
+            let timestamp = Double(tick) * interval
+            var peerIds = (0..<32).map { "peer-\($0)" }
+            let newestGuest = tick / 120
+
+            for guest in max(newestGuest - 5, 0)...newestGuest {
+                peerIds.append("guest-\(guest)")
+            }
+
+            bytes += 10000
+
+            for peerId in peerIds {
+                history.add(report: report(timestamp: timestamp, bytes: bytes, packets: bytes / 1000), forPeer: peerId, timestamp: timestamp)
+            }
+
+            XCTAssertLessThanOrEqual(history.numberOfPeers, 32)
+            XCTAssertLessThanOrEqual(history.numberOfSamples, 720 * 32)
+        }
+
+        let snapshot = history.snapshot()
+        let lastTimestamp = Double(8 * 60 * 60 / Int(interval) - 1) * interval
+
+        XCTAssertEqual(snapshot.count, 32)
+        XCTAssertEqual(history.numberOfSamples, snapshot.values.reduce(0) { $0 + $1.count })
+
+        for samples in snapshot.values {
+            XCTAssertLessThanOrEqual(samples.count, 720)
+            // Only the newest samples are kept, oldest first
+            XCTAssertEqual(samples.last?.timestamp, lastTimestamp)
+            XCTAssertEqual(samples.map { $0.timestamp }, samples.map { $0.timestamp }.sorted())
+        }
+    }
+
+    func testHistoryDropsThePeerThatWasNotUpdatedForTheLongestTime() {
+        let history = CallStatsHistory(samplesPerPeer: 10, maxPeers: 2)
+
+        history.add(report: report(timestamp: 0, bytes: 0, packets: 0), forPeer: "first", timestamp: 0)
+        history.add(report: report(timestamp: 1, bytes: 0, packets: 0), forPeer: "second", timestamp: 1)
+        history.add(report: report(timestamp: 2, bytes: 0, packets: 0), forPeer: "first", timestamp: 2)
+        history.add(report: report(timestamp: 3, bytes: 0, packets: 0), forPeer: "third", timestamp: 3)
+
+        XCTAssertEqual(Set(history.snapshot().keys), ["first", "third"])
+        XCTAssertEqual(history.snapshot()["first"]?.count, 2)
+
+        history.removeAll()
+
+        XCTAssertEqual(history.numberOfPeers, 0)
+        XCTAssertEqual(history.numberOfSamples, 0)
+    }
+
+    func testJSONExportCanBeDecoded() throws {
+        let history = CallStatsHistory(samplesPerPeer: 10, maxPeers: 2)
+
+        history.add(report: report(timestamp: 0, bytes: 0, packets: 0), forPeer: "peer", timestamp: 0)
+        history.add(report: report(timestamp: 5, bytes: 5000, packets: 50), forPeer: "peer", timestamp: 5)
+
+        let data = try XCTUnwrap(history.jsonData())
+        let decoded = try JSONDecoder().decode([String: [CallStatsSample]].self, from: data)
+
+        XCTAssertEqual(decoded["peer"]?.count, 2)
+        XCTAssertEqual(decoded["peer"]?.last?.tracks.first?.bitrate ?? 0, 8000, accuracy: 0.0001)
+    }
+}
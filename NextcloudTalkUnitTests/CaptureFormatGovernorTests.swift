@@ -0,0 +1,220 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class CaptureFormatGovernorTests: XCTestCase {
+
+    private struct FormatChange: Equatable {
+        let timestamp: TimeInterval
+        let index: Int
+    }
+
+    // Conditions that apply from `timestamp` on, until the next step of the trace
+    private struct TraceStep {
+        let timestamp: TimeInterval
+        var thermalState: CaptureThermalState = .nominal
+        var droppedFrameRatio = 0.0
+        var subscriberCount = 1
+    }
+
+    private func makeGovernor() -> CaptureFormatGovernor {
+        return CaptureFormatGovernor(ladder: CaptureFormatGovernor.ladder(maxWidth: 1280, maxHeight: 720, maxFps: 30))
+    }
+
+    // Replays the trace with one observation per second, like the statistics reports of a call
+    private func replay(_ trace: [TraceStep], until endTimestamp: TimeInterval, governor: CaptureFormatGovernor) -> [FormatChange] {
+        var changes: [FormatChange] = []
+        var stepIndex = 0
+
+        for second in 0...Int(endTimestamp) {
+            let timestamp = TimeInterval(second)
+
+            while stepIndex + 1 < trace.count, trace[stepIndex + 1].timestamp <= timestamp {
+                stepIndex += 1
+            }
+
+            let step = trace[stepIndex]
+            let observation = CaptureLoadObservation(timestamp: timestamp, thermalState: step.thermalState,
+                                                     droppedFrameRatio: step.droppedFrameRatio, subscriberCount: step.subscriberCount)
+
+            if let format = governor.observe(observation) {
+                XCTAssertEqual(format, governor.currentFormat)
+                changes.append(FormatChange(timestamp: timestamp, index: governor.currentIndex))
+            }
+        }
+
+        return changes
+    }
+
+    // MARK: - Ladder
+
+    func testLadderStartsWithTheTargetFormat() {
+        let ladder = CaptureFormatGovernor.ladder(maxWidth: 1280, maxHeight: 720, maxFps: 30)
+
+        XCTAssertEqual(ladder, [
+            CaptureFormat(width: 1280, height: 720, fps: 30),
+            CaptureFormat(width: 960, height: 540, fps: 30),
+            CaptureFormat(width: 640, height: 480, fps: 30),
+            CaptureFormat(width: 480, height: 360, fps: 30),
+            CaptureFormat(width: 320, height: 240, fps: 30),
+            CaptureFormat(width: 320, height: 240, fps: 15)
+        ])
+    }
+
+    func testLadderOfSmallTargetFormats() {
+        XCTAssertEqual(CaptureFormatGovernor.ladder(maxWidth: 640, maxHeight: 480, maxFps: 30).first, CaptureFormat(width: 640, height: 480, fps: 30))
+        XCTAssertEqual(CaptureFormatGovernor.ladder(maxWidth: 640, maxHeight: 480, maxFps: 30).count, 4)
+
+        // Nothing smaller than the smallest standard resolution, and no lower frame rate when it's already low
+        XCTAssertEqual(CaptureFormatGovernor.ladder(maxWidth: 320, maxHeight: 240, maxFps: 15), [CaptureFormat(width: 320, height: 240, fps: 15)])
+    }
+
+    // MARK: - Traces
+
+    func testThermalSpikeGoesDownAtOnceAndRecoversStepByStep() {
+        let governor = makeGovernor()
+        let trace = [
+            TraceStep(timestamp: 0),
+            TraceStep(timestamp: 60, thermalState: .serious),
+            TraceStep(timestamp: 120)
+        ]
+
+        let changes = replay(trace, until: 300, governor: governor)
+
+        // Down to the middle of the ladder right away, back up one step after every 30 seconds of good conditions
+        XCTAssertEqual(changes, [
+            FormatChange(timestamp: 60, index: 3),
+            FormatChange(timestamp: 150, index: 2),
+            FormatChange(timestamp: 181, index: 1),
+            FormatChange(timestamp: 212, index: 0)
+        ])
+    }
+
+    func testCriticalThermalStateUsesTheLowestFormat() {
+        let governor = makeGovernor()
+
+        let changes = replay([TraceStep(timestamp: 0, thermalState: .critical)], until: 60, governor: governor)
+
+        XCTAssertEqual(changes, [FormatChange(timestamp: 0, index: 5)])
+        XCTAssertEqual(governor.currentFormat, CaptureFormat(width: 320, height: 240, fps: 15))
+    }
+
+    func testDroppedFramesStepDownOncePerDwellTime() {
+        let governor = makeGovernor()
+        let trace = [
+            TraceStep(timestamp: 0, droppedFrameRatio: 0.3),
+            TraceStep(timestamp: 25, droppedFrameRatio: 0.1)
+        ]
+
+        let changes = replay(trace, until: 60, governor: governor)
+
+        // Between the thresholds the format stays the same, it is neither lowered nor raised
+        XCTAssertEqual(changes, [
+            FormatChange(timestamp: 0, index: 1),
+            FormatChange(timestamp: 10, index: 2),
+            FormatChange(timestamp: 20, index: 3)
+        ])
+    }
+
+    func testFairThermalStateDoesNotRaiseTheFormat() {
+        let governor = makeGovernor()
+        let trace = [
+            TraceStep(timestamp: 0, droppedFrameRatio: 0.3),
+            TraceStep(timestamp: 1, thermalState: .fair)
+        ]
+
+        XCTAssertEqual(replay(trace, until: 120, governor: governor), [FormatChange(timestamp: 0, index: 1)])
+    }
+
+    func testSubscribersLowerTheHighestFormat() {
+        let governor = makeGovernor()
+        let trace = [
+            TraceStep(timestamp: 0, subscriberCount: 4),
+            TraceStep(timestamp: 10, subscriberCount: 9),
+            TraceStep(timestamp: 60, subscriberCount: 2)
+        ]
+
+        let changes = replay(trace, until: 150, governor: governor)
+
+        // Every 4 subscribers lower the limit by one step
+        XCTAssertEqual(changes, [
+            FormatChange(timestamp: 10, index: 2),
+            FormatChange(timestamp: 90, index: 1),
+            FormatChange(timestamp: 121, index: 0)
+        ])
+    }
+
+    func testFormatDoesNotOscillateUnderFluctuatingLoad() {
+        let governor = makeGovernor()
+        var trace: [TraceStep] = []
+
+        // Dropped frames every other 5 seconds for 10 minutes
+        for timestamp in stride(from: 0.0, to: 600, by: 5) {
+            trace.append(TraceStep(timestamp: timestamp, droppedFrameRatio: Int(timestamp / 5) % 2 == 0 ? 0.25 : 0))
+        }
+
+        let changes = replay(trace, until: 600, governor: governor)
+
+        // The load never stays low for 30 seconds, so the format only goes down
+        XCTAssertEqual(changes.map { $0.index }, Array(1...5))
+
+        for (change, nextChange) in zip(changes, changes.dropFirst()) {
+            XCTAssertGreaterThanOrEqual(nextChange.timestamp - change.timestamp, governor.minimumDwellTime)
+        }
+    }
+
+    func testObservationsFromThePastAreIgnored() {
+        let governor = makeGovernor()
+
+        XCTAssertNil(governor.observe(CaptureLoadObservation(timestamp: 100, thermalState: .nominal, droppedFrameRatio: 0, subscriberCount: 1)))
+        XCTAssertNil(governor.observe(CaptureLoadObservation(timestamp: 50, thermalState: .critical, droppedFrameRatio: 1, subscriberCount: 1)))
+        XCTAssertEqual(governor.currentIndex, 0)
+    }
+
+    // MARK: - Dropped frames
+
+    private func encoderReport(capturedFrames: Double, encodedFrames: Double) -> [String: [String: Any]] {
+        return [
+            "source": ["type": "media-source", "kind": "video", "frames": capturedFrames],
+            "audio-source": ["type": "media-source", "kind": "audio"],
+            "sender": ["type": "outbound-rtp", "kind": "video", "framesEncoded": encodedFrames]
+        ]
+    }
+
+    func testDroppedFrameRatioBetweenReports() {
+        let counter = EncoderFrameDropCounter()
+
+        XCTAssertEqual(counter.droppedFrameRatio(from: encoderReport(capturedFrames: 100, encodedFrames: 50)), 0)
+        XCTAssertEqual(counter.droppedFrameRatio(from: encoderReport(capturedFrames: 200, encodedFrames: 130)), 0.2, accuracy: 0.0001)
+        XCTAssertEqual(counter.droppedFrameRatio(from: encoderReport(capturedFrames: 300, encodedFrames: 230)), 0, accuracy: 0.0001)
+
+        // Reset counters and reports without captured frames don't count as dropped frames
+        XCTAssertEqual(counter.droppedFrameRatio(from: encoderReport(capturedFrames: 10, encodedFrames: 5)), 0)
+        XCTAssertEqual(counter.droppedFrameRatio(from: encoderReport(capturedFrames: 10, encodedFrames: 5)), 0)
+
+        counter.reset()
+
+        XCTAssertEqual(counter.droppedFrameRatio(from: encoderReport(capturedFrames: 1000, encodedFrames: 0)), 0)
+    }
+}
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class ChatFileCachePolicyTests: XCTestCase {
+
+    // Least recently used first
+    let entries = [
+        ChatFileCachePolicy.Entry(filePath: "/download/1/a.mp4", size: 400),
+        ChatFileCachePolicy.Entry(filePath: "/download/2/b.pdf", size: 100),
+        ChatFileCachePolicy.Entry(filePath: "/download/3/c.jpg", size: 300),
+        ChatFileCachePolicy.Entry(filePath: "/download/4/d.jpg", size: 200)
+    ]
+
+    func testNothingIsEvictedWithinTheSizeLimit() {
+        let policy = ChatFileCachePolicy()
+
+        XCTAssertTrue(policy.entriesToEvict(from: entries, diskUsage: 1000, sizeLimit: 1000).isEmpty)
+    }
+
+    func testLeastRecentlyUsedEntriesAreEvictedUntilTheCacheFits() {
+        let policy = ChatFileCachePolicy()
+
+        XCTAssertEqual(policy.entriesToEvict(from: entries, diskUsage: 1000, sizeLimit: 600), [entries[0]])
+        XCTAssertEqual(policy.entriesToEvict(from: entries, diskUsage: 1000, sizeLimit: 550), Array(entries[0...1]))
+        XCTAssertEqual(policy.entriesToEvict(from: entries, diskUsage: 1000, sizeLimit: 0), entries)
+    }
+
+    func testEntriesInUseAreNotEvicted() {
+        let policy = ChatFileCachePolicy()
+
+        policy.acquireLease(forFileAtPath: entries[0].filePath)
+
+        XCTAssertTrue(policy.isInUse(fileAtPath: entries[0].filePath))
+        XCTAssertEqual(policy.entriesToEvict(from: entries, diskUsage: 1000, sizeLimit: 600), Array(entries[1...2]))
+
+        policy.releaseLease(forFileAtPath: entries[0].filePath)
+
+        XCTAssertFalse(policy.isInUse(fileAtPath: entries[0].filePath))
+        XCTAssertEqual(policy.entriesToEvict(from: entries, diskUsage: 1000, sizeLimit: 600), [entries[0]])
+    }
+
+    func testLeasesAreCounted() {
+        let policy = ChatFileCachePolicy()
+        let filePath = entries[0].filePath
+
+        policy.acquireLease(forFileAtPath: filePath)
+        policy.acquireLease(forFileAtPath: filePath)
+        policy.releaseLease(forFileAtPath: filePath)
+
+        XCTAssertTrue(policy.isInUse(fileAtPath: filePath))
+
+        policy.releaseLease(forFileAtPath: filePath)
+        XCTAssertFalse(policy.isInUse(fileAtPath: filePath))
+
+        // Releasing more often than acquired doesn't affect later leases
+        policy.releaseLease(forFileAtPath: filePath)
+        policy.acquireLease(forFileAtPath: filePath)
+        XCTAssertTrue(policy.isInUse(fileAtPath: filePath))
+    }
+
+    func testAllEntriesInUseKeepsTheCacheOverItsLimit() {
+        let policy = ChatFileCachePolicy()
+
+        for entry in entries {
+            policy.acquireLease(forFileAtPath: entry.filePath)
+        }
+
+        XCTAssertTrue(policy.entriesToEvict(from: entries, diskUsage: 1000, sizeLimit: 0).isEmpty)
+    }
+
+    func testConcurrentLeases() {
+        let policy = ChatFileCachePolicy()
+
+        DispatchQueue.concurrentPerform(iterations: 1000) { iteration in
+            let filePath = entries[iteration % entries.count].filePath
+
+            policy.acquireLease(forFileAtPath: filePath)
+            policy.releaseLease(forFileAtPath: filePath)
+        }
+
+        XCTAssertTrue(entries.allSatisfy { !policy.isInUse(fileAtPath: $0.filePath) })
+    }
+}
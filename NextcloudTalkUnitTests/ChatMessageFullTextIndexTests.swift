@@ -0,0 +1,183 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class ChatMessageFullTextIndexTests: XCTestCase {
+
+    private let accountId = "user@cloud.example.com"
+    private let now = 1_700_000_000
+
+    private func message(_ messageId: Int, _ text: String?, token: String = "room", accountId: String? = nil, timestamp: Int = 0,
+                         expirationTimestamp: Int = 0, actorDisplayName: String = "Alice") -> IndexedChatMessage {
+        let accountId = accountId ?? self.accountId
+
+        return IndexedChatMessage(internalId: "\(accountId)@\(token)@\(messageId)", accountId: accountId, token: token, messageId: messageId,
+                                  actorId: "alice", actorType: "users", actorDisplayName: actorDisplayName, timestamp: timestamp,
+                                  expirationTimestamp: expirationTimestamp, text: text)
+    }
+
+    private func messageIds(_ index: ChatMessageFullTextIndex, _ searchTerm: String, accountId: String? = nil) -> [Int] {
+        return index.search(searchTerm, forAccountId: accountId ?? self.accountId, limit: 20, now: now).map { $0.messageId }
+    }
+
+    // MARK: - Search
+
+    func testWordPrefixesAreFound() {
+        let index = ChatMessageFullTextIndex(databaseURL: nil)
+        XCTAssertTrue(index.store([message(1, "Let's meet at the café tomorrow"), message(2, "Meeting notes are in the file")]))
+
+        XCTAssertEqual(Set(messageIds(index, "meet")), [1, 2])
+        XCTAssertEqual(messageIds(index, "CAFE"), [1])
+        XCTAssertEqual(messageIds(index, "meet tomorrow"), [1])
+        XCTAssertTrue(messageIds(index, "eeting").isEmpty)
+        XCTAssertTrue(messageIds(index, " !? ").isEmpty)
+    }
+
+    func testSearchResultsContainTheMessage() {
+        let index = ChatMessageFullTextIndex(databaseURL: nil)
+        index.store([message(1, "The release is tomorrow", token: "release", timestamp: 42)])
+
+        let hits = index.search("release", forAccountId: accountId, limit: 20, now: now)
+
+        XCTAssertEqual(hits, [ChatMessageSearchHit(accountId: accountId, token: "release", messageId: 1, actorId: "alice", actorType: "users",
+                                                   actorDisplayName: "Alice", timestamp: 42, snippet: "The release is tomorrow")])
+    }
+
+    func testNewerMessagesComeFirstForEqualMatches() {
+        let index = ChatMessageFullTextIndex(databaseURL: nil)
+        index.store([message(1, "standup", timestamp: 10), message(2, "standup", timestamp: 30), message(3, "standup", timestamp: 20)])
+
+        XCTAssertEqual(messageIds(index, "standup"), [2, 3, 1])
+    }
+
+    func testSearchIsLimitedToTheAccount() {
+        let index = ChatMessageFullTextIndex(databaseURL: nil)
+        index.store([message(1, "budget"), message(2, "budget", accountId: "other@cloud.example.com")])
+
+        XCTAssertEqual(messageIds(index, "budget"), [1])
+        XCTAssertEqual(messageIds(index, "budget", accountId: "other@cloud.example.com"), [2])
+    }
+
+    func testExpiredMessagesAreNotFound() {
+        let index = ChatMessageFullTextIndex(databaseURL: nil)
+        index.store([message(1, "secret", expirationTimestamp: now - 1), message(2, "secret", expirationTimestamp: now + 60), message(3, "secret")])
+
+        XCTAssertEqual(Set(messageIds(index, "secret")), [2, 3])
+    }
+
+    // MARK: - Updates
+
+    func testMessagesWithoutTextAreRemoved() {
+        let index = ChatMessageFullTextIndex(databaseURL: nil)
+        index.store([message(1, "typo in this message")])
+
+        // e.g. the message was deleted
+        index.store([message(1, nil)])
+
+        XCTAssertTrue(messageIds(index, "typo").isEmpty)
+    }
+
+    func testStoringAgainReplacesTheText() {
+        let index = ChatMessageFullTextIndex(databaseURL: nil)
+        index.store([message(1, "first version")])
+        index.store([message(1, "second version", actorDisplayName: "Alice Smith")])
+
+        XCTAssertTrue(messageIds(index, "first").isEmpty)
+
+        let hits = index.search("second", forAccountId: accountId, limit: 20, now: now)
+        XCTAssertEqual(hits.map { $0.actorDisplayName }, ["Alice Smith"])
+    }
+
+    func testMessagesOfRoomsAndAccountsAreRemoved() {
+        let index = ChatMessageFullTextIndex(databaseURL: nil)
+        index.store([message(1, "report", token: "a"), message(2, "report", token: "b"), message(3, "report", accountId: "other@cloud.example.com")])
+
+        index.removeMessages(forAccountId: accountId, token: "a")
+        XCTAssertEqual(messageIds(index, "report"), [2])
+
+        index.removeMessages(forAccountId: accountId, token: nil)
+        XCTAssertTrue(messageIds(index, "report").isEmpty)
+        XCTAssertEqual(messageIds(index, "report", accountId: "other@cloud.example.com"), [3])
+    }
+
+    func testIndexIsStoredInTheDatabaseFile() throws {
+        let databaseURL = FileManager.default.temporaryDirectory.appendingPathComponent("ChatMessageFullTextIndexTests-\(UUID().uuidString).sqlite")
+        defer {
+            try? FileManager.default.removeItem(at: databaseURL)
+        }
+
+        ChatMessageFullTextIndex(databaseURL: databaseURL).store([message(1, "persisted")])
+
+        XCTAssertEqual(messageIds(ChatMessageFullTextIndex(databaseURL: databaseURL), "persisted"), [1])
+    }
+
+    // MARK: - Benchmark
+
+    private let words = ["meeting", "release", "budget", "café", "tomorrow", "design", "review", "lunch", "deploy", "ticket",
+                         "customer", "invoice", "holiday", "standup", "feedback", "roadmap", "bug", "fix", "server", "phone"]
+
+    private func benchmarkMessage(_ messageId: Int) -> IndexedChatMessage {
+        // Deterministic texts of 8 words, some words are rare
+        let text = (0..<8).map { words[(messageId * 7 + $0 * 13 + messageId / ($0 + 1)) % words.count] }.joined(separator: " ") + " #\(messageId)"
+
+        return message(messageId, text, token: "room\(messageId % 200)", timestamp: messageId)
+    }
+
+    private func makeIndex(numberOfMessages: Int) -> ChatMessageFullTextIndex {
+        let index = ChatMessageFullTextIndex(databaseURL: nil)
+        let batchSize = 10_000
+
+        for batchStart in stride(from: 0, to: numberOfMessages, by: batchSize) {
+            index.store((batchStart..<min(batchStart + batchSize, numberOfMessages)).map { benchmarkMessage($0) })
+        }
+
+        return index
+    }
+
+    func testBenchmarkSearchInOneMillionMessages() {
+        let index = makeIndex(numberOfMessages: 1_000_000)
+        let searchTerms = ["meet", "release budget", "cafe", "inv", "holiday roadmap", "unknownword"]
+
+        XCTAssertEqual(index.search("meeting", forAccountId: accountId, limit: 20, now: now).count, 20)
+
+        measure(metrics: [XCTClockMetric()]) {
+            for searchTerm in searchTerms {
+                _ = index.search(searchTerm, forAccountId: accountId, limit: 20, now: now)
+            }
+        }
+    }
+
+    // Throughput of the backfill, which stores batches of 500 messages
+    func testBenchmarkStoringBatches() {
+        let batches = (0..<20).map { batch in (0..<500).map { benchmarkMessage(batch * 500 + $0) } }
+
+        measure(metrics: [XCTClockMetric()]) {
+            let index = ChatMessageFullTextIndex(databaseURL: nil)
+
+            for batch in batches {
+                index.store(batch)
+            }
+        }
+    }
+}
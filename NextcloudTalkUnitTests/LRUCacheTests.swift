@@ -0,0 +1,80 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class LRUCacheTests: XCTestCase {
+
+    func testLeastRecentlyUsedEntryIsEvicted() {
+        var cache = LRUCache<String, Int>(capacity: 2)
+
+        XCTAssertNil(cache.setValue(1, forKey: "a"))
+        XCTAssertNil(cache.setValue(2, forKey: "b"))
+
+        // Reading "a" makes "b" the least recently used entry
+        XCTAssertEqual(cache.value(forKey: "a"), 1)
+
+        let evictedEntry = cache.setValue(3, forKey: "c")
+        XCTAssertEqual(evictedEntry?.key, "b")
+        XCTAssertEqual(evictedEntry?.value, 2)
+
+        XCTAssertEqual(cache.count, 2)
+        XCTAssertTrue(cache.contains(key: "a"))
+        XCTAssertFalse(cache.contains(key: "b"))
+        XCTAssertTrue(cache.contains(key: "c"))
+    }
+
+    func testUpdatingAnEntryDoesNotEvict() {
+        var cache = LRUCache<String, Int>(capacity: 2)
+
+        cache.setValue(1, forKey: "a")
+        cache.setValue(2, forKey: "b")
+
+        XCTAssertNil(cache.setValue(10, forKey: "a"))
+        XCTAssertEqual(cache.count, 2)
+
+        XCTAssertEqual(cache.removeLeastRecentlyUsed()?.key, "b")
+        XCTAssertEqual(cache.removeLeastRecentlyUsed()?.value, 10)
+        XCTAssertNil(cache.removeLeastRecentlyUsed())
+    }
+
+    func testRemovingEntries() {
+        var cache = LRUCache<String, Int>(capacity: 3)
+
+        cache.setValue(1, forKey: "a")
+        cache.setValue(2, forKey: "b")
+        cache.setValue(3, forKey: "c")
+
+        XCTAssertEqual(cache.removeValue(forKey: "b"), 2)
+        XCTAssertNil(cache.removeValue(forKey: "b"))
+        XCTAssertEqual(cache.removeLeastRecentlyUsed()?.key, "a")
+        XCTAssertEqual(cache.removeLeastRecentlyUsed()?.key, "c")
+
+        cache.setValue(4, forKey: "d")
+        cache.removeAll()
+
+        XCTAssertEqual(cache.count, 0)
+        XCTAssertNil(cache.value(forKey: "d"))
+        XCTAssertNil(cache.removeLeastRecentlyUsed())
+    }
+}
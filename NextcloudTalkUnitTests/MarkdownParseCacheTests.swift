@@ -0,0 +1,205 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class MarkdownParseCacheTests: XCTestCase {
+
+    let parsedKey = NSAttributedString.Key("parsed")
+
+    func message(_ index: Int) -> NSAttributedString {
+        return NSAttributedString(string: "Message \(index) " + String(repeating: "**lorem** ipsum ", count: index % 10 + 1))
+    }
+
+    // Stands in for the markdown parser, the result only needs to differ from the source
+    func parse(_ source: NSAttributedString) -> NSAttributedString {
+        return NSAttributedString(string: source.string.replacingOccurrences(of: "**", with: ""), attributes: [parsedKey: true])
+    }
+
+    func testScrollTraceHitRate() {
+        let numberOfMessages = 5000
+        let visibleRows = 20
+        let maxEntries = 2000
+        let messages = (0..<numberOfMessages).map { self.message($0) }
+        // Same budget as used for the chat
+        let cache = MarkdownParseCache(byteBudget: 8 * 1024 * 1024, maxEntries: maxEntries)
+        var numberOfParses = 0
+
+        func display(_ index: Int) {
+            if cache.result(for: messages[index], themeKey: "light") == nil {
+                numberOfParses += 1
+                cache.store(parse(messages[index]), for: messages[index], themeKey: "light")
+            }
+        }
+
+        // Open the chat at the newest message, scroll up to the first message and back down again,
+        // every step moves the visible rows by one and displays all of them
+        let firstRows = Array((0...(numberOfMessages - visibleRows)).reversed()) + Array(1...(numberOfMessages - visibleRows))
+
+        for firstRow in firstRows {
+            for index in firstRow..<(firstRow + visibleRows) {
+                display(index)
+            }
+        }
+
+        let lookups = cache.hits + cache.misses
+        let hitRate = Double(cache.hits) / Double(lookups)
+
+        // Every message is parsed once while scrolling up, scrolling down only parses the messages that were evicted
+        XCTAssertEqual(numberOfParses, numberOfMessages + (numberOfMessages - maxEntries))
+        XCTAssertEqual(cache.misses, numberOfParses)
+        XCTAssertEqual(lookups, firstRows.count * visibleRows)
+        XCTAssertGreaterThan(hitRate, 0.95)
+        XCTAssertEqual(cache.count, maxEntries)
+        XCTAssertLessThanOrEqual(cache.totalCost, cache.byteBudget)
+    }
+
+    func testEntriesAreEvictedWhenTheByteBudgetIsExceeded() {
+        // Same length for all sources, so all entries have the same cost
+        let sources = (10..<30).map { NSAttributedString(string: "Message \($0)") }
+        let entryCost = MarkdownParseCache.cost(of: sources[0], result: parse(sources[0]))
+        let cache = MarkdownParseCache(byteBudget: entryCost * 10)
+
+        for source in sources {
+            cache.store(parse(source), for: source, themeKey: "light")
+        }
+
+        XCTAssertEqual(cache.count, 10)
+        XCTAssertEqual(cache.totalCost, entryCost * 10)
+        XCTAssertTrue(sources[0..<10].allSatisfy { !cache.contains($0, themeKey: "light") })
+        XCTAssertTrue(sources[10..<20].allSatisfy { cache.contains($0, themeKey: "light") })
+
+        // A used entry is kept, the least recently used one is evicted instead
+        XCTAssertNotNil(cache.result(for: sources[10], themeKey: "light"))
+        cache.store(parse(sources[0]), for: sources[0], themeKey: "light")
+
+        XCTAssertTrue(cache.contains(sources[10], themeKey: "light"))
+        XCTAssertFalse(cache.contains(sources[11], themeKey: "light"))
+        XCTAssertEqual(cache.totalCost, entryCost * 10)
+    }
+
+    func testEntryLargerThanTheByteBudgetIsNotStored() {
+        let source = message(1)
+        let cache = MarkdownParseCache(byteBudget: MarkdownParseCache.cost(of: source, result: parse(source)) - 1)
+
+        cache.store(parse(source), for: source, themeKey: "light")
+
+        XCTAssertEqual(cache.count, 0)
+        XCTAssertEqual(cache.totalCost, 0)
+    }
+
+    func testNewThemeKeyInvalidatesEntries() {
+        let source = message(1)
+        let otherSource = message(2)
+        let cache = MarkdownParseCache(byteBudget: 1024 * 1024)
+
+        cache.store(parse(source), for: source, themeKey: "light")
+
+        XCTAssertNotNil(cache.result(for: source, themeKey: "light"))
+        XCTAssertNil(cache.result(for: source, themeKey: "dark"))
+
+        cache.store(parse(otherSource), for: otherSource, themeKey: "dark")
+
+        XCTAssertEqual(cache.count, 1)
+        XCTAssertFalse(cache.contains(source, themeKey: "light"))
+        XCTAssertNil(cache.result(for: source, themeKey: "light"))
+        XCTAssertEqual(cache.result(for: otherSource, themeKey: "dark")?.string, parse(otherSource).string)
+        XCTAssertEqual(cache.totalCost, MarkdownParseCache.cost(of: otherSource, result: parse(otherSource)))
+    }
+
+    func testSourceAttributesArePartOfTheKey() {
+        let source = message(1)
+        let attributedSource = NSAttributedString(string: source.string, attributes: [parsedKey: false])
+        let cache = MarkdownParseCache(byteBudget: 1024 * 1024)
+
+        cache.store(parse(source), for: source, themeKey: "light")
+
+        XCTAssertTrue(cache.contains(NSAttributedString(string: source.string), themeKey: "light"))
+        XCTAssertFalse(cache.contains(attributedSource, themeKey: "light"))
+    }
+
+    // MARK: - Message sources
+
+    // Stands in for a dynamic color, which is a new instance every time a message is parsed and only equal to itself
+    final class DynamicColor: NSObject {
+        let name: String
+
+        init(name: String) {
+            self.name = name
+        }
+    }
+
+    let colorKey = NSAttributedString.Key("color")
+    let linkKey = NSAttributedString.Key("link")
+
+    // Same structure as NCChatMessage parsedMessage: a color for the whole text, a highlighted mention and a link
+    func messageSource(_ text: String, mention: String, link: String, highlighted: Bool = false) -> NSAttributedString {
+        let source = NSMutableAttributedString(string: text, attributes: [colorKey: DynamicColor(name: "foreground")])
+        let nsText = text as NSString
+
+        source.addAttribute(colorKey, value: DynamicColor(name: highlighted ? "element" : "foreground"), range: nsText.range(of: mention))
+        source.addAttribute(linkKey, value: URL(string: link)!, range: nsText.range(of: link))
+
+        return source
+    }
+
+    func testSourcesWithNewDynamicColorsHit() {
+        let cache = MarkdownParseCache(byteBudget: 1024 * 1024)
+        let text = "@alice see https://example.com/a"
+        let source = messageSource(text, mention: "@alice", link: "https://example.com/a")
+        let sameSource = messageSource(text, mention: "@alice", link: "https://example.com/a")
+
+        // The sources are not equal, only because of the color instances
+        XCTAssertFalse(source.isEqual(to: sameSource))
+
+        cache.store(parse(source), for: source, themeKey: "light")
+
+        XCTAssertNotNil(cache.result(for: sameSource, themeKey: "light"))
+        XCTAssertEqual(cache.hits, 1)
+    }
+
+    func testMentionAndLinkRangesArePartOfTheKey() {
+        let cache = MarkdownParseCache(byteBudget: 1024 * 1024)
+        let text = "@alice and @bob see https://example.com/a https://example.com/b"
+        let source = messageSource(text, mention: "@alice", link: "https://example.com/a")
+
+        cache.store(parse(source), for: source, themeKey: "light")
+
+        XCTAssertTrue(cache.contains(messageSource(text, mention: "@alice", link: "https://example.com/a"), themeKey: "light"))
+        XCTAssertFalse(cache.contains(messageSource(text, mention: "@bob", link: "https://example.com/a"), themeKey: "light"))
+        XCTAssertFalse(cache.contains(messageSource(text, mention: "@alice", link: "https://example.com/b"), themeKey: "light"))
+    }
+
+    func testAttributeValueSignatureDistinguishesValues() {
+        let cache = MarkdownParseCache(byteBudget: 1024 * 1024) { value in
+            return (value as? DynamicColor)?.name
+        }
+        let text = "@alice hello"
+        let source = messageSource(text, mention: "@alice", link: "hello")
+
+        cache.store(parse(source), for: source, themeKey: "light")
+
+        XCTAssertTrue(cache.contains(messageSource(text, mention: "@alice", link: "hello"), themeKey: "light"))
+        XCTAssertFalse(cache.contains(messageSource(text, mention: "@alice", link: "hello", highlighted: true), themeKey: "light"))
+    }
+}
@@ -0,0 +1,248 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class MentionSuggestionEngineTests: XCTestCase {
+
+    // Records the requests of the engine, responses are sent by the tests
+    private class StubFetcher {
+        var requestedTerms: [String] = []
+        var cancelledTerms: [String] = []
+        var completionBlocks: [String: ([MentionSuggestion]?, Error?) -> Void] = [:]
+
+        func fetch(_ term: String, _ completionBlock: @escaping ([MentionSuggestion]?, Error?) -> Void) -> (() -> Void)? {
+            requestedTerms.append(term)
+            completionBlocks[term] = completionBlock
+
+            return { [weak self] in
+                self?.cancelledTerms.append(term)
+            }
+        }
+
+        func respond(to term: String, with suggestions: [MentionSuggestion]) {
+            completionBlocks[term]?(suggestions, nil)
+        }
+    }
+
+    private func suggestion(_ id: String, label: String? = nil) -> MentionSuggestion {
+        return ["id": id, "label": label ?? id.capitalized, "source": "users"]
+    }
+
+    private func ids(_ suggestions: [MentionSuggestion]?) -> [String]? {
+        return suggestions?.map { $0["id"] as? String ?? "" }
+    }
+
+    private func makeEngine(fetcher: StubFetcher, cache: MentionSuggestionCache = MentionSuggestionCache(resultLimit: 3),
+                            seedBlock: (() -> [MentionSuggestion])? = nil) -> MentionSuggestionEngine {
+
+        let engine = MentionSuggestionEngine(roomKey: "room", cache: cache, fetchBlock: { term, completionBlock in
+            fetcher.fetch(term, completionBlock)
+        }, seedBlock: seedBlock)
+
+        engine.debounceInterval = 0.05
+
+        return engine
+    }
+
+    // Lets the main queue run, so debounced requests are started and responses are delivered
+    private func waitForMainQueue(_ interval: TimeInterval = 0.2) {
+        let expectation = self.expectation(description: "Main queue")
+
+        DispatchQueue.main.asyncAfter(deadline: .now() + interval) {
+            expectation.fulfill()
+        }
+
+        wait(for: [expectation], timeout: interval + 5)
+    }
+
+    // MARK: - Engine
+
+    func testRequestsAreDebounced() {
+        let fetcher = StubFetcher()
+        let engine = makeEngine(fetcher: fetcher)
+        var deliveredResults: [[String]] = []
+
+        for term in ["a", "an", "ann"] {
+            engine.suggestions(for: term) { deliveredResults.append(self.ids($0) ?? []) }
+        }
+
+        waitForMainQueue()
+
+        XCTAssertEqual(fetcher.requestedTerms, ["ann"])
+
+        fetcher.respond(to: "ann", with: [suggestion("anna")])
+        waitForMainQueue(0.05)
+
+        XCTAssertEqual(deliveredResults, [["anna"]])
+    }
+
+    func testCancelledRequestsAreNotStarted() {
+        let fetcher = StubFetcher()
+        let engine = makeEngine(fetcher: fetcher)
+
+        engine.suggestions(for: "a") { _ in XCTFail("Cancelled request delivered results") }
+        engine.cancel()
+
+        waitForMainQueue()
+
+        XCTAssertTrue(fetcher.requestedTerms.isEmpty)
+    }
+
+    func testNewTermCancelsTheRunningRequestAndDiscardsItsResponse() {
+        let fetcher = StubFetcher()
+        let cache = MentionSuggestionCache(resultLimit: 3)
+        let engine = makeEngine(fetcher: fetcher, cache: cache)
+        var deliveredResults: [[String]] = []
+
+        engine.suggestions(for: "a") { deliveredResults.append(self.ids($0) ?? []) }
+        waitForMainQueue()
+
+        engine.suggestions(for: "b") { deliveredResults.append(self.ids($0) ?? []) }
+
+        XCTAssertEqual(fetcher.cancelledTerms, ["a"])
+
+        // The server answers the first request anyway
+        fetcher.respond(to: "a", with: [suggestion("anna")])
+        waitForMainQueue()
+
+        fetcher.respond(to: "b", with: [suggestion("bob")])
+        waitForMainQueue(0.05)
+
+        XCTAssertEqual(deliveredResults, [["bob"]])
+        // Responses of older generations are not stored either
+        XCTAssertNil(cache.cachedSuggestions(forTerm: "a", inRoom: "room", timestamp: ProcessInfo.processInfo.systemUptime))
+    }
+
+    func testCachedSuggestionsAreDeliveredWithoutRequest() {
+        let fetcher = StubFetcher()
+        let engine = makeEngine(fetcher: fetcher)
+        var deliveredResults: [[String]] = []
+
+        engine.suggestions(for: "an") { _ in }
+        waitForMainQueue()
+        fetcher.respond(to: "an", with: [suggestion("anna"), suggestion("andrew")])
+        waitForMainQueue(0.05)
+
+        // The result of "an" is complete, so "ann" is filtered from it
+        engine.suggestions(for: "ann") { deliveredResults.append(self.ids($0) ?? []) }
+        waitForMainQueue()
+
+        XCTAssertEqual(deliveredResults, [["anna"]])
+        XCTAssertEqual(fetcher.requestedTerms, ["an"])
+    }
+
+    func testSeededSuggestionsAreShownUntilTheServerAnswers() {
+        let fetcher = StubFetcher()
+        var seedCount = 0
+        let engine = makeEngine(fetcher: fetcher) {
+            seedCount += 1
+            return [self.suggestion("anna"), self.suggestion("bob")]
+        }
+        var deliveredResults: [[String]] = []
+
+        engine.suggestions(for: "b") { deliveredResults.append(self.ids($0) ?? []) }
+
+        XCTAssertEqual(deliveredResults, [["bob"]])
+
+        waitForMainQueue()
+        fetcher.respond(to: "b", with: [suggestion("bob"), suggestion("barbara")])
+        waitForMainQueue(0.05)
+
+        XCTAssertEqual(deliveredResults, [["bob"], ["bob", "barbara"]])
+
+        engine.suggestions(for: "x") { _ in }
+        engine.cancel()
+
+        // The participants are only loaded once per room
+        XCTAssertEqual(seedCount, 1)
+    }
+
+    // MARK: - Cache
+
+    func testCompleteResultsAnswerLongerTerms() {
+        let cache = MentionSuggestionCache(resultLimit: 3)
+
+        cache.store([suggestion("anna"), suggestion("joann", label: "Jo Ann"), suggestion("andrew")], forTerm: "an", inRoom: "room", timestamp: 0)
+
+        // Three suggestions are a full result, there might be more on the server
+        XCTAssertNil(cache.cachedSuggestions(forTerm: "ann", inRoom: "room", timestamp: 1))
+
+        cache.store([suggestion("anna"), suggestion("joann", label: "Jo Ann")], forTerm: "an", inRoom: "room", timestamp: 2)
+
+        XCTAssertEqual(ids(cache.cachedSuggestions(forTerm: "ann", inRoom: "room", timestamp: 3)), ["anna", "joann"])
+        XCTAssertEqual(ids(cache.cachedSuggestions(forTerm: "ANNA", inRoom: "room", timestamp: 3)), ["anna"])
+        XCTAssertEqual(ids(cache.cachedSuggestions(forTerm: "anx", inRoom: "room", timestamp: 3)), [])
+
+        // Only terms starting with the stored term are answered
+        XCTAssertNil(cache.cachedSuggestions(forTerm: "a", inRoom: "room", timestamp: 3))
+        XCTAssertNil(cache.cachedSuggestions(forTerm: "ann", inRoom: "other", timestamp: 3))
+    }
+
+    func testDiacriticsAreIgnored() {
+        let cache = MentionSuggestionCache(resultLimit: 3)
+
+        cache.store([suggestion("rene", label: "René")], forTerm: "", inRoom: "room", timestamp: 0)
+
+        XCTAssertEqual(ids(cache.cachedSuggestions(forTerm: "René", inRoom: "room", timestamp: 1)), ["rene"])
+        XCTAssertEqual(ids(cache.cachedSuggestions(forTerm: "RENE", inRoom: "room", timestamp: 1)), ["rene"])
+    }
+
+    func testOldResultsExpire() {
+        let cache = MentionSuggestionCache(resultLimit: 3)
+
+        cache.store([suggestion("anna")], forTerm: "an", inRoom: "room", timestamp: 0)
+
+        XCTAssertNotNil(cache.cachedSuggestions(forTerm: "an", inRoom: "room", timestamp: cache.maxAge - 1))
+        XCTAssertNil(cache.cachedSuggestions(forTerm: "an", inRoom: "room", timestamp: cache.maxAge))
+    }
+
+    func testLeastRecentlyUsedRoomIsEvicted() {
+        let cache = MentionSuggestionCache(resultLimit: 3)
+
+        for room in 0..<10 {
+            cache.store([suggestion("anna")], forTerm: "an", inRoom: "room-\(room)", timestamp: TimeInterval(room))
+        }
+
+        // Reading a room counts as use
+        XCTAssertNotNil(cache.cachedSuggestions(forTerm: "an", inRoom: "room-0", timestamp: 20))
+
+        cache.store([suggestion("anna")], forTerm: "an", inRoom: "room-10", timestamp: 21)
+
+        XCTAssertNotNil(cache.cachedSuggestions(forTerm: "an", inRoom: "room-0", timestamp: 22))
+        XCTAssertNil(cache.cachedSuggestions(forTerm: "an", inRoom: "room-1", timestamp: 22))
+        XCTAssertNotNil(cache.cachedSuggestions(forTerm: "an", inRoom: "room-10", timestamp: 22))
+    }
+
+    func testSeededSuggestionsAreFilteredAndLimited() {
+        let cache = MentionSuggestionCache(resultLimit: 2)
+
+        XCTAssertFalse(cache.hasSeededSuggestions(inRoom: "room"))
+
+        cache.seed([suggestion("anna"), suggestion("andrew"), suggestion("annika"), suggestion("bob")], inRoom: "room", timestamp: 0)
+
+        XCTAssertTrue(cache.hasSeededSuggestions(inRoom: "room"))
+        XCTAssertEqual(ids(cache.seededSuggestions(forTerm: "an", inRoom: "room")), ["anna", "andrew"])
+        XCTAssertEqual(ids(cache.seededSuggestions(forTerm: "b", inRoom: "room")), ["bob"])
+    }
+}
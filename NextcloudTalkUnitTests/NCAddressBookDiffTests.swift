@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#if canImport(NextcloudTalkObjCCore)
+import XCTest
+import NextcloudTalkObjCCore
+
+final class NCAddressBookDiffTests: XCTestCase {
+
+    private func digests(_ phoneNumbers: [String: [String]]) -> [String: String] {
+        return phoneNumbers.mapValues { NCAddressBookDiff.digest(forPhoneNumbers: $0) }
+    }
+
+    // MARK: - Digest
+
+    func testDigestIgnoresTheOrderOfPhoneNumbers() {
+        XCTAssertEqual(NCAddressBookDiff.digest(forPhoneNumbers: ["+491701", "+491702"]), NCAddressBookDiff.digest(forPhoneNumbers: ["+491702", "+491701"]))
+        XCTAssertNotEqual(NCAddressBookDiff.digest(forPhoneNumbers: ["+491701"]), NCAddressBookDiff.digest(forPhoneNumbers: ["+491701", "+491702"]))
+    }
+
+    func testDigestMatchesStoredDigests() {
+        // SHA-1 of "+491701,+491702", as stored by earlier versions
+        XCTAssertEqual(NCAddressBookDiff.digest(forPhoneNumbers: ["+491702", "+491701"]), "ffd0f6b5232050c51c02f8eb2867b09fba674152")
+    }
+
+    // MARK: - Changed numbers
+
+    func testChangedPhoneNumbersAreDetected() {
+        let stored = digests(["kept": ["1"], "reordered": ["2", "3"], "changed": ["4"], "removed": ["5"]])
+        let current = digests(["kept": ["1"], "reordered": ["3", "2"], "changed": ["4", "6"], "added": ["7"]])
+
+        let diff = NCAddressBookDiff(storedDigests: stored, currentDigests: current)
+
+        XCTAssertEqual(diff.addedIdentifiers, ["added"])
+        XCTAssertEqual(diff.changedIdentifiers, ["changed"])
+        XCTAssertEqual(diff.removedIdentifiers, ["removed"])
+    }
+
+    func testFirstReadAddsEverything() {
+        let current = digests(["a": ["1"], "b": ["2"]])
+
+        let diff = NCAddressBookDiff(storedDigests: [:], currentDigests: current)
+
+        XCTAssertEqual(diff.addedIdentifiers, ["a", "b"])
+        XCTAssertTrue(diff.changedIdentifiers.isEmpty)
+        XCTAssertTrue(diff.removedIdentifiers.isEmpty)
+    }
+
+    func testContactsWithoutStoredDigestAreSearchedAgain() {
+        // Contacts stored before digests existed
+        let diff = NCAddressBookDiff(storedDigests: ["a": ""], currentDigests: digests(["a": ["1"]]))
+
+        XCTAssertEqual(diff.changedIdentifiers, ["a"])
+    }
+
+    // MARK: - Full and incremental sync
+
+    func testSyncKind() {
+        // Never synced or forced: all contacts are searched
+        XCTAssertEqual(NCAddressBookDiff.searchTimestamp(forLastContactSync: 0, forceSync: false), 0)
+        XCTAssertEqual(NCAddressBookDiff.searchTimestamp(forLastContactSync: 1_700_000_000, forceSync: true), 0)
+
+        // Otherwise only contacts changed since the last sync
+        XCTAssertEqual(NCAddressBookDiff.searchTimestamp(forLastContactSync: 1_700_000_000, forceSync: false), 1_700_000_000)
+    }
+
+    func testFullSyncReplacesAllMatches() {
+        let staleMatches = NCAddressBookDiff.staleMatches(inStoredMatches: ["a", "b", "c"], currentMatches: ["a", "d"],
+                                                          searchedIdentifiers: ["a", "b", "c", "d"], fullSync: true)
+
+        XCTAssertEqual(staleMatches, ["b", "c"])
+    }
+
+    func testIncrementalSyncOnlyReplacesSearchedMatches() {
+        // Only "b" was changed and searched, "c" wasn't searched and still matches
+        let staleMatches = NCAddressBookDiff.staleMatches(inStoredMatches: ["a", "b", "c"], currentMatches: [],
+                                                          searchedIdentifiers: ["b"], fullSync: false)
+
+        XCTAssertEqual(staleMatches, ["b"])
+    }
+
+    func testIncrementalSyncKeepsRematchedContacts() {
+        let staleMatches = NCAddressBookDiff.staleMatches(inStoredMatches: ["a", "b"], currentMatches: ["b", "e"],
+                                                          searchedIdentifiers: ["b", "e"], fullSync: false)
+
+        XCTAssertTrue(staleMatches.isEmpty)
+    }
+
+    func testIncrementalSyncAfterChangingOneContact() {
+        let stored = digests(["a": ["1"], "b": ["2"], "c": ["3"]])
+        let current = digests(["a": ["1"], "b": ["20"], "c": ["3"]])
+
+        let diff = NCAddressBookDiff(storedDigests: stored, currentDigests: current)
+        let searchedIdentifiers = Array(diff.addedIdentifiers.union(diff.changedIdentifiers))
+
+        // "b" has a new number that doesn't match anymore, the other matches are kept
+        let staleMatches = NCAddressBookDiff.staleMatches(inStoredMatches: ["a", "b", "c"], currentMatches: [],
+                                                          searchedIdentifiers: searchedIdentifiers, fullSync: false)
+
+        XCTAssertEqual(searchedIdentifiers, ["b"])
+        XCTAssertEqual(staleMatches, ["b"])
+    }
+}
+#endif
@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#if canImport(NextcloudTalkObjCCore)
+import XCTest
+import NextcloudTalkObjCCore
+
+final class NCChatOutboxRetryPolicyTests: XCTestCase {
+
+    private let start = Date(timeIntervalSince1970: 1_000_000)
+
+    func testBackoffDoublesUpToTheMaximum() {
+        let policy = NCChatOutboxRetryPolicy()
+
+        XCTAssertEqual(policy.backoff(afterConsecutiveFailedRuns: 0), 0)
+        XCTAssertEqual(policy.backoff(afterConsecutiveFailedRuns: 1), 2)
+        XCTAssertEqual(policy.backoff(afterConsecutiveFailedRuns: 2), 4)
+        XCTAssertEqual(policy.backoff(afterConsecutiveFailedRuns: 5), 32)
+        XCTAssertEqual(policy.backoff(afterConsecutiveFailedRuns: 6), 64)
+        XCTAssertEqual(policy.backoff(afterConsecutiveFailedRuns: 7), 64)
+        XCTAssertEqual(policy.backoff(afterConsecutiveFailedRuns: 1000), 64)
+    }
+
+    func testFailedRunsDelayTheNextAttempt() {
+        let policy = NCChatOutboxRetryPolicy()
+        policy.maxJitter = 0
+
+        XCTAssertEqual(policy.remainingBackoff(at: start), 0)
+
+        policy.recordRun(withFailures: true, at: start)
+        XCTAssertEqual(policy.remainingBackoff(at: start), 2)
+        XCTAssertEqual(policy.remainingBackoff(at: start.addingTimeInterval(1.5)), 0.5)
+        XCTAssertEqual(policy.remainingBackoff(at: start.addingTimeInterval(3)), 0)
+
+        policy.recordRun(withFailures: true, at: start)
+        XCTAssertEqual(policy.remainingBackoff(at: start), 4)
+        XCTAssertEqual(policy.consecutiveFailedRuns, 2)
+
+        // A successful run resets the backoff
+        policy.recordRun(withFailures: false, at: start)
+        XCTAssertEqual(policy.remainingBackoff(at: start), 0)
+        XCTAssertEqual(policy.consecutiveFailedRuns, 0)
+    }
+
+    func testJitterIsBounded() {
+        let policy = NCChatOutboxRetryPolicy()
+
+        for _ in 0..<100 {
+            policy.recordRun(withFailures: false, at: start)
+            policy.recordRun(withFailures: true, at: start)
+
+            let backoff = policy.remainingBackoff(at: start)
+            XCTAssertGreaterThanOrEqual(backoff, 2)
+            XCTAssertLessThan(backoff, 2 + policy.maxJitter)
+        }
+    }
+
+    func testMessagesAreGivenUp() {
+        let policy = NCChatOutboxRetryPolicy()
+
+        XCTAssertFalse(policy.shouldGiveUpMessage(withRetryCount: 0))
+        XCTAssertFalse(policy.shouldGiveUpMessage(withRetryCount: 4))
+        XCTAssertTrue(policy.shouldGiveUpMessage(withRetryCount: 5))
+
+        let now = start.timeIntervalSince1970
+        XCTAssertFalse(policy.isMessageExpired(withTimestamp: Int(now - 60), at: start))
+        XCTAssertFalse(policy.isMessageExpired(withTimestamp: Int(now - policy.messageExpiration), at: start))
+        XCTAssertTrue(policy.isMessageExpired(withTimestamp: Int(now - policy.messageExpiration - 1), at: start))
+    }
+}
+#endif
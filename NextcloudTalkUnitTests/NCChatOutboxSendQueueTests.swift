@@ -0,0 +1,260 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#if canImport(NextcloudTalkObjCCore)
+import XCTest
+import NextcloudTalkObjCCore
+
+final class NCChatOutboxSendQueueTests: XCTestCase {
+
+    private struct SendFailure: Error {}
+
+    /// Stands in for the server, sends only complete when the test completes them and fail for the messages the test chooses
+    private final class FailingSender {
+        var failingMessages: Set<String> = []
+        var completesSynchronously = false
+        private(set) var sentMessages: [String] = []
+        private var completionBlocks: [String: NCChatOutboxSendCompletionBlock] = [:]
+
+        var sendingMessages: Set<String> {
+            return Set(completionBlocks.keys)
+        }
+
+        lazy var sendBlock: NCChatOutboxSendBlock = { [unowned self] message, completionBlock in
+            let message = message as! String
+            self.sentMessages.append(message)
+
+            if self.completesSynchronously {
+                completionBlock(self.failingMessages.contains(message) ? SendFailure() : nil)
+            } else {
+                self.completionBlocks[message] = completionBlock
+            }
+
+            return nil
+        }
+
+        func complete(_ message: String) {
+            let completionBlock = completionBlocks.removeValue(forKey: message)
+            completionBlock?(failingMessages.contains(message) ? SendFailure() : nil)
+        }
+
+        func completeAll() {
+            while let message = completionBlocks.keys.sorted().first {
+                complete(message)
+            }
+        }
+    }
+
+    private final class QueueResult {
+        var deliveredMessages: [String] = []
+        var failedRooms: [String: [String]] = [:]
+        var finishedRuns: [Bool] = []
+    }
+
+    private func makeQueue(sender: FailingSender, result: QueueResult, maxConcurrentRooms: Int = 3) -> NCChatOutboxSendQueue {
+        let queue = NCChatOutboxSendQueue(sendBlock: sender.sendBlock)
+        queue.maxConcurrentRooms = maxConcurrentRooms
+        queue.messageSentBlock = { message, _ in
+            result.deliveredMessages.append(message as! String)
+        }
+        queue.roomFailedBlock = { roomKey, unsentMessages, _ in
+            result.failedRooms[roomKey] = unsentMessages as? [String]
+        }
+        queue.finishedBlock = { hadFailures in
+            result.finishedRuns.append(hadFailures)
+        }
+
+        return queue
+    }
+
+    // MARK: - Ordering
+
+    func testMessagesOfARoomAreSentOneAfterTheOther() {
+        let sender = FailingSender()
+        let result = QueueResult()
+        let queue = makeQueue(sender: sender, result: result)
+
+        for message in ["a1", "a2", "a3"] {
+            queue.addMessage(message, forRoomKey: "a")
+        }
+
+        queue.start()
+
+        XCTAssertEqual(sender.sendingMessages, ["a1"])
+
+        sender.complete("a1")
+        XCTAssertEqual(sender.sendingMessages, ["a2"])
+
+        sender.completeAll()
+        sender.completeAll()
+
+        XCTAssertEqual(sender.sentMessages, ["a1", "a2", "a3"])
+        XCTAssertEqual(result.deliveredMessages, ["a1", "a2", "a3"])
+        XCTAssertEqual(result.finishedRuns, [false])
+    }
+
+    func testRoomsAreSentInParallelInTheOrderTheyWereAdded() {
+        let sender = FailingSender()
+        let result = QueueResult()
+        let queue = makeQueue(sender: sender, result: result, maxConcurrentRooms: 2)
+
+        queue.addMessage("a1", forRoomKey: "a")
+        queue.addMessage("b1", forRoomKey: "b")
+        queue.addMessage("c1", forRoomKey: "c")
+        queue.addMessage("a2", forRoomKey: "a")
+        queue.start()
+
+        XCTAssertEqual(sender.sendingMessages, ["a1", "b1"])
+
+        sender.complete("b1")
+
+        // Room b is done, so room c starts, room a continues on its own
+        XCTAssertEqual(sender.sendingMessages, ["a1", "c1"])
+
+        sender.complete("a1")
+        XCTAssertEqual(sender.sendingMessages, ["a2", "c1"])
+
+        sender.completeAll()
+
+        XCTAssertEqual(result.finishedRuns, [false])
+    }
+
+    func testFailedMessageStopsItsRoom() {
+        let sender = FailingSender()
+        sender.failingMessages = ["a2"]
+
+        let result = QueueResult()
+        let queue = makeQueue(sender: sender, result: result)
+
+        for message in ["a1", "a2", "a3", "a4"] {
+            queue.addMessage(message, forRoomKey: "a")
+        }
+
+        queue.addMessage("b1", forRoomKey: "b")
+        queue.addMessage("b2", forRoomKey: "b")
+        queue.start()
+
+        while !sender.sendingMessages.isEmpty {
+            sender.completeAll()
+        }
+
+        // The messages after the failed one are not sent, otherwise they would arrive out of order
+        XCTAssertEqual(sender.sentMessages.filter { $0.hasPrefix("a") }, ["a1", "a2"])
+        XCTAssertEqual(result.failedRooms, ["a": ["a2", "a3", "a4"]])
+
+        // Other rooms are not affected
+        XCTAssertEqual(result.deliveredMessages.filter { $0.hasPrefix("b") }, ["b1", "b2"])
+        XCTAssertEqual(result.finishedRuns, [true])
+    }
+
+    func testSynchronousSendsFinishOnce() {
+        let sender = FailingSender()
+        sender.completesSynchronously = true
+        sender.failingMessages = ["b1"]
+
+        let result = QueueResult()
+        let queue = makeQueue(sender: sender, result: result, maxConcurrentRooms: 1)
+
+        queue.addMessage("a1", forRoomKey: "a")
+        queue.addMessage("b1", forRoomKey: "b")
+        queue.addMessage("c1", forRoomKey: "c")
+        queue.start()
+
+        XCTAssertEqual(sender.sentMessages, ["a1", "b1", "c1"])
+        XCTAssertEqual(result.deliveredMessages, ["a1", "c1"])
+        XCTAssertEqual(result.finishedRuns, [true])
+    }
+
+    func testEmptyQueueFinishes() {
+        let result = QueueResult()
+        let queue = makeQueue(sender: FailingSender(), result: result)
+
+        queue.start()
+
+        XCTAssertEqual(result.finishedRuns, [false])
+    }
+
+    // MARK: - Cancel
+
+    func testCancelledQueueStopsSending() {
+        let sender = FailingSender()
+        sender.failingMessages = ["b1"]
+
+        let result = QueueResult()
+        let queue = makeQueue(sender: sender, result: result)
+
+        queue.addMessage("a1", forRoomKey: "a")
+        queue.addMessage("a2", forRoomKey: "a")
+        queue.addMessage("b1", forRoomKey: "b")
+        queue.start()
+
+        XCTAssertEqual(queue.cancel(), 3)
+
+        // A message that was delivered anyway is reported, failures are left for the next run
+        sender.complete("a1")
+        sender.complete("b1")
+
+        XCTAssertEqual(result.deliveredMessages, ["a1"])
+        XCTAssertTrue(result.failedRooms.isEmpty)
+        XCTAssertEqual(sender.sentMessages, ["a1", "b1"])
+        XCTAssertTrue(result.finishedRuns.isEmpty)
+    }
+
+    // MARK: - Retries
+
+    func testFailingRoomIsRetriedWithBackoff() {
+        let sender = FailingSender()
+        sender.completesSynchronously = true
+        sender.failingMessages = ["a2"]
+
+        let policy = NCChatOutboxRetryPolicy()
+        policy.maxJitter = 0
+
+        var now = Date(timeIntervalSince1970: 1_000_000)
+        var pendingMessages = ["a1", "a2", "a3"]
+        var attemptDates: [TimeInterval] = []
+
+        // Like the outbox: each run sends what is left, the next run waits for the backoff
+        for run in 0..<5 {
+            if run == 3 {
+                sender.failingMessages = []
+            }
+
+            now = now.addingTimeInterval(policy.remainingBackoff(at: now))
+            attemptDates.append(now.timeIntervalSince1970 - 1_000_000)
+
+            let result = QueueResult()
+            let queue = makeQueue(sender: sender, result: result)
+            pendingMessages.forEach { queue.addMessage($0, forRoomKey: "a") }
+            queue.start()
+
+            pendingMessages = result.failedRooms["a"] ?? []
+            policy.recordRun(withFailures: result.finishedRuns == [true], at: now)
+        }
+
+        XCTAssertEqual(attemptDates, [0, 2, 6, 14, 14])
+        XCTAssertEqual(sender.sentMessages, ["a1", "a2", "a2", "a2", "a2", "a3"])
+        XCTAssertEqual(policy.consecutiveFailedRuns, 0)
+        XCTAssertNil(policy.nextAttemptDate)
+    }
+}
+#endif
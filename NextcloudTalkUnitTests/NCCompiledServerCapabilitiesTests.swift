@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#if canImport(NextcloudTalkObjCCore)
+import XCTest
+import NextcloudTalkObjCCore
+
+final class NCCompiledServerCapabilitiesTests: XCTestCase {
+
+    private let knownCapabilities = (0..<47).map { "known-capability-\($0)" }
+
+    private var knownCapabilityBits: [String: NSNumber] {
+        var bits: [String: NSNumber] = [:]
+
+        for (index, capability) in knownCapabilities.enumerated() {
+            bits[capability] = NSNumber(value: index)
+        }
+
+        return bits
+    }
+
+    // Roughly what a current server announces: most known capabilities and a few the app doesn't know about
+    private var serverCapabilities: [String] {
+        return Array(knownCapabilities.prefix(40)) + ["unknown-capability-1", "unknown-capability-2"]
+    }
+
+    func testKnownCapabilitiesAreChecked() {
+        let compiledCapabilities = NCCompiledServerCapabilities(talkCapabilities: serverCapabilities, notificationsCapabilities: ["exists"],
+                                                                knownTalkCapabilityBits: knownCapabilityBits)
+
+        XCTAssertTrue(compiledCapabilities.hasTalkCapability("known-capability-0"))
+        XCTAssertTrue(compiledCapabilities.hasTalkCapability("known-capability-39"))
+        XCTAssertFalse(compiledCapabilities.hasTalkCapability("known-capability-40"))
+        XCTAssertFalse(compiledCapabilities.hasTalkCapability("known-capability-46"))
+        XCTAssertEqual(compiledCapabilities.talkCapabilityBits, (1 << 40) - 1)
+    }
+
+    func testUnknownCapabilitiesAreChecked() {
+        let compiledCapabilities = NCCompiledServerCapabilities(talkCapabilities: serverCapabilities, notificationsCapabilities: ["exists"],
+                                                                knownTalkCapabilityBits: knownCapabilityBits)
+
+        XCTAssertTrue(compiledCapabilities.hasTalkCapability("unknown-capability-2"))
+        XCTAssertFalse(compiledCapabilities.hasTalkCapability("unknown-capability-3"))
+        XCTAssertTrue(compiledCapabilities.notificationsCapabilities.contains("exists"))
+    }
+
+    func testNoCapabilities() {
+        let compiledCapabilities = NCCompiledServerCapabilities(talkCapabilities: [], notificationsCapabilities: [], knownTalkCapabilityBits: knownCapabilityBits)
+
+        XCTAssertEqual(compiledCapabilities.talkCapabilityBits, 0)
+        XCTAssertFalse(compiledCapabilities.hasTalkCapability("known-capability-0"))
+    }
+
+    // MARK: - Benchmark
+
+    private let numberOfChecks = 100_000
+
+    func testBenchmarkCompiledCapabilities() {
+        let compiledCapabilities = NCCompiledServerCapabilities(talkCapabilities: serverCapabilities, notificationsCapabilities: ["exists"],
+                                                                knownTalkCapabilityBits: knownCapabilityBits)
+        let capability = "known-capability-39"
+
+        measure(metrics: [XCTClockMetric()]) {
+            var matches = 0
+
+            for _ in 0..<numberOfChecks where compiledCapabilities.hasTalkCapability(capability) {
+                matches += 1
+            }
+
+            XCTAssertEqual(matches, numberOfChecks)
+        }
+    }
+
+    // Before, every check copied the stored capabilities and searched the features array.
+    // The database query that came first is not part of this benchmark, so the real difference was larger.
+    func testBenchmarkFeaturesArraySearch() {
+        let storedCapabilities = serverCapabilities as NSArray
+        let capability = "known-capability-39"
+
+        measure(metrics: [XCTClockMetric()]) {
+            var matches = 0
+
+            for _ in 0..<numberOfChecks {
+                let talkCapabilities = storedCapabilities.mutableCopy() as? NSMutableArray
+
+                if talkCapabilities?.contains(capability) ?? false {
+                    matches += 1
+                }
+            }
+
+            XCTAssertEqual(matches, numberOfChecks)
+        }
+    }
+}
+#endif
@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#if canImport(NextcloudTalkObjCCore)
+import XCTest
+import NextcloudTalkObjCCore
+
+/// How NCUtils logged before the NCLogger: scan the log directory, format the line, open, write and close the logfile
+private enum SynchronousLogger {
+
+    static func log(_ message: String, toDirectory logDirectoryPath: String) {
+        let fileManager = FileManager.default
+        let thresholdDate = Calendar.current.date(byAdding: .day, value: -10, to: Date()) ?? Date()
+
+        for file in fileManager.enumerator(atPath: logDirectoryPath)?.allObjects as? [String] ?? [] {
+            let filePath = (logDirectoryPath as NSString).appendingPathComponent(file)
+            let creationDate = (try? fileManager.attributesOfItem(atPath: filePath))?[.creationDate] as? Date
+
+            if let creationDate, creationDate < thresholdDate, file.hasPrefix("debug-"), file.hasSuffix(".log") {
+                try? fileManager.removeItem(atPath: filePath)
+            }
+        }
+
+        let now = Date()
+        let lineFormatter = DateFormatter()
+        lineFormatter.dateFormat = "y-MM-dd H:mm:ss.SSSS"
+        let fileFormatter = DateFormatter()
+        fileFormatter.dateFormat = "yyyy-MM-dd"
+
+        let logMessage = "\(lineFormatter.string(from: now)) (\(OperationQueue.current?.description ?? "")): \(message)\n"
+        let fullPath = (logDirectoryPath as NSString).appendingPathComponent("debug-\(fileFormatter.string(from: now)).log")
+
+        if let fileHandle = FileHandle(forWritingAtPath: fullPath) {
+            fileHandle.seekToEndOfFile()
+            fileHandle.write(logMessage.data(using: .utf8) ?? Data())
+            fileHandle.closeFile()
+        } else {
+            try? logMessage.write(toFile: fullPath, atomically: false, encoding: .utf8)
+        }
+
+        NSLog("%@", logMessage)
+    }
+}
+
+final class NCLoggerTests: XCTestCase {
+
+    private var directory: URL!
+
+    override func setUp() {
+        super.setUp()
+
+        directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: directory)
+        super.tearDown()
+    }
+
+    private func logfileLines() -> [String] {
+        let logfile = directory.appendingPathComponent("debug.log")
+        let content = (try? String(contentsOf: logfile, encoding: .utf8)) ?? ""
+
+        return content.split(separator: "\n").map(String.init)
+    }
+
+    func testStructuredFieldsAreWritten() {
+        let logger = NCLogger(logDirectoryPath: directory.path)
+
+        logger.logMessage("Plain message")
+        logger.logMessage("Request finished", subsystem: "api", accountId: "user@cloud.example.com", roomToken: "abc123", latency: 0.042)
+        logger.flush()
+
+        let lines = logfileLines()
+
+        XCTAssertEqual(lines.count, 2)
+        XCTAssertTrue(lines[0].hasSuffix(": Plain message"))
+        XCTAssertFalse(lines[0].contains("latency="))
+        XCTAssertTrue(lines[1].hasSuffix(" [api] account=user@cloud.example.com room=abc123 latency=42ms: Request finished"))
+    }
+
+    func testEntriesOfConcurrentThreadsAreWrittenCompletely() {
+        let logger = NCLogger(logDirectoryPath: directory.path)
+        let numberOfThreads = 8
+        let entriesPerThread = 200
+
+        // Fewer entries than the buffer capacity, so nothing is dropped even if the writer doesn't run in between
+        DispatchQueue.concurrentPerform(iterations: numberOfThreads) { thread in
+            for index in 0..<entriesPerThread {
+                logger.logMessage("Thread \(thread) entry \(index)")
+            }
+        }
+
+        logger.flush()
+
+        let lines = logfileLines()
+
+        XCTAssertEqual(lines.count, numberOfThreads * entriesPerThread)
+        XCTAssertEqual(Set(lines.map { $0.components(separatedBy: ": ").last ?? "" }).count, numberOfThreads * entriesPerThread)
+
+        // The entries of a single thread keep their order
+        let firstThreadEntries = lines.compactMap { line -> Int? in
+            guard let entry = line.components(separatedBy: ": Thread 0 entry ").last, line.contains(": Thread 0 entry ") else { return nil }
+            return Int(entry)
+        }
+
+        XCTAssertEqual(firstThreadEntries, Array(0..<entriesPerThread))
+    }
+
+    // MARK: - Benchmark
+
+    private let messages = (0..<500).map { "Failed to send message \($0) to room abc123" }
+
+    func testBenchmarkBufferedLogger() {
+        let logger = NCLogger(logDirectoryPath: directory.path)
+
+        measure(metrics: [XCTClockMetric()]) {
+            for message in messages {
+                logger.logMessage(message, subsystem: "chat", accountId: "user@cloud.example.com", roomToken: "abc123", latency: kNCLoggerNoLatency)
+            }
+        }
+
+        logger.flush()
+    }
+
+    func testBenchmarkSynchronousLogger() {
+        let logDirectoryPath = directory.path
+        try? FileManager.default.createDirectory(atPath: logDirectoryPath, withIntermediateDirectories: true)
+
+        measure(metrics: [XCTClockMetric()]) {
+            for message in messages {
+                SynchronousLogger.log(message, toDirectory: logDirectoryPath)
+            }
+        }
+    }
+}
+#endif
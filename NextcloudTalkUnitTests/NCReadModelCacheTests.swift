@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#if canImport(NextcloudTalkObjCCore)
+import XCTest
+import Realm
+import NextcloudTalkObjCCore
+
+final class CachedTestRoom: RLMObject {
+    @objc dynamic var internalId = ""
+    @objc dynamic var accountId = ""
+    @objc dynamic var token = ""
+    @objc dynamic var displayName = ""
+    @objc dynamic var lastActivity = 0
+    @objc dynamic var unreadMessages = 0
+
+    override class func primaryKey() -> String? {
+        return "internalId"
+    }
+}
+
+final class NCReadModelCacheTests: XCTestCase {
+
+    private let accountId = "user@cloud.example.com"
+
+    override func setUp() {
+        super.setUp()
+
+        let configuration = RLMRealmConfiguration.default()
+        configuration.inMemoryIdentifier = name
+        configuration.objectClasses = [CachedTestRoom.self]
+        RLMRealmConfiguration.setDefault(configuration)
+    }
+
+    private func storeRooms(count: Int) {
+        let realm = RLMRealm.default()
+        realm.beginWriteTransaction()
+
+        for index in 0..<count {
+            let room = CachedTestRoom()
+            room.internalId = "\(accountId)@room\(index)"
+            room.accountId = accountId
+            room.token = "room\(index)"
+            room.displayName = "Conversation \(index)"
+            room.lastActivity = index
+            realm.addOrUpdate(room)
+        }
+
+        try? realm.commitWriteTransaction()
+    }
+
+    // How the database manager creates its snapshots
+    private func unmanagedRooms() -> [CachedTestRoom] {
+        let managedRooms = CachedTestRoom.objects(with: NSPredicate(format: "accountId = %@", accountId))
+
+        return (0..<managedRooms.count).compactMap { index in
+            guard let managedRoom = managedRooms.object(at: index) as? CachedTestRoom else { return nil }
+            return CachedTestRoom(value: managedRoom)
+        }
+    }
+
+    private func unmanagedRoom(token: String) -> CachedTestRoom? {
+        guard let managedRoom = CachedTestRoom.objects(with: NSPredicate(format: "token = %@", token)).firstObject() as? CachedTestRoom else { return nil }
+
+        return CachedTestRoom(value: managedRoom)
+    }
+
+    func testCallersGetTheirOwnCopies() {
+        storeRooms(count: 1)
+
+        let cache = NCReadModelCache()
+        var createdSnapshots = 0
+
+        let firstRoom = cache.snapshot(forKey: "room0") {
+            createdSnapshots += 1
+            return self.unmanagedRoom(token: "room0")
+        } as? CachedTestRoom
+
+        firstRoom?.displayName = "Modified by a caller"
+
+        let secondRoom = cache.snapshot(forKey: "room0") {
+            createdSnapshots += 1
+            return self.unmanagedRoom(token: "room0")
+        } as? CachedTestRoom
+
+        XCTAssertEqual(createdSnapshots, 1)
+        XCTAssertEqual(secondRoom?.displayName, "Conversation 0")
+        XCTAssertFalse(firstRoom === secondRoom)
+    }
+
+    func testArraysContainCopies() {
+        storeRooms(count: 3)
+
+        let cache = NCReadModelCache()
+        let firstRooms = cache.snapshot(forKey: "rooms") { self.unmanagedRooms() } as? [CachedTestRoom] ?? []
+
+        firstRooms.first?.unreadMessages = 42
+
+        let secondRooms = cache.snapshot(forKey: "rooms") { self.unmanagedRooms() } as? [CachedTestRoom] ?? []
+
+        XCTAssertEqual(secondRooms.count, 3)
+        XCTAssertEqual(secondRooms.first?.unreadMessages, 0)
+        XCTAssertFalse(firstRooms.first === secondRooms.first)
+    }
+
+    func testMissingObjectsAreCached() {
+        let cache = NCReadModelCache()
+        var createdSnapshots = 0
+
+        for _ in 0..<2 {
+            XCTAssertNil(cache.snapshot(forKey: "missing") {
+                createdSnapshots += 1
+                return nil
+            })
+        }
+
+        XCTAssertEqual(createdSnapshots, 1)
+    }
+
+    func testSnapshotsAreDroppedWhenTheDatabaseChanges() {
+        storeRooms(count: 1)
+
+        let cache = NCReadModelCache()
+        _ = cache.snapshot(forKey: "room0") { self.unmanagedRoom(token: "room0") }
+
+        // Commits on the main thread notify synchronously
+        let realm = RLMRealm.default()
+        realm.beginWriteTransaction()
+        (CachedTestRoom.objects(with: NSPredicate(format: "token = %@", "room0")).firstObject() as? CachedTestRoom)?.displayName = "Renamed"
+        try? realm.commitWriteTransaction()
+
+        let room = cache.snapshot(forKey: "room0") { self.unmanagedRoom(token: "room0") } as? CachedTestRoom
+
+        XCTAssertEqual(room?.displayName, "Renamed")
+    }
+
+    // MARK: - Benchmark
+
+    func testBenchmarkCachedRoomList() {
+        storeRooms(count: 500)
+
+        let cache = NCReadModelCache()
+
+        measure(metrics: [XCTClockMetric()]) {
+            for _ in 0..<20 {
+                let rooms = cache.snapshot(forKey: "rooms") { self.unmanagedRooms() } as? [CachedTestRoom]
+                XCTAssertEqual(rooms?.count, 500)
+            }
+        }
+    }
+
+    func testBenchmarkQueriedRoomList() {
+        storeRooms(count: 500)
+
+        measure(metrics: [XCTClockMetric()]) {
+            for _ in 0..<20 {
+                XCTAssertEqual(self.unmanagedRooms().count, 500)
+            }
+        }
+    }
+}
+#endif
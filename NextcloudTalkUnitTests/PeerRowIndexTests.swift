@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class PeerRowIndexTests: XCTestCase {
+
+    private func makeIndex(_ entries: [(peerId: String, peerIdentifier: String)]) -> PeerRowIndex {
+        var index = PeerRowIndex()
+
+        for entry in entries {
+            _ = index.append(peerId: entry.peerId, peerIdentifier: entry.peerIdentifier)
+        }
+
+        return index
+    }
+
+    // MARK: - Rows
+
+    func testAppendReturnsTheNewRow() {
+        var index = PeerRowIndex()
+
+        XCTAssertEqual(index.append(peerId: "a", peerIdentifier: "a-video"), 0)
+        XCTAssertEqual(index.append(peerId: "a", peerIdentifier: "a-screen"), 1)
+        XCTAssertEqual(index.append(peerId: "b", peerIdentifier: "b-video"), 2)
+
+        // Every peerIdentifier is only contained once
+        XCTAssertNil(index.append(peerId: "c", peerIdentifier: "a-video"))
+        XCTAssertEqual(index.count, 3)
+
+        XCTAssertEqual(index.row(forPeerIdentifier: "a-screen"), 1)
+        XCTAssertEqual(index.row(forPeerId: "a"), 1)
+        XCTAssertEqual(index.row(forPeerId: "b"), 2)
+        XCTAssertNil(index.row(forPeerId: "c"))
+    }
+
+    func testRowsForPeerIdentifiersAreUnique() {
+        let index = makeIndex([("a", "1"), ("b", "2"), ("c", "3")])
+
+        XCTAssertEqual(index.rows(forPeerIdentifiers: ["3", "1", "3", "unknown"]), IndexSet([0, 2]))
+    }
+
+    func testRemovingRowsUpdatesTheFollowingRows() {
+        var index = makeIndex([("a", "1"), ("b", "2"), ("c", "3"), ("d", "4")])
+
+        index.remove(rows: IndexSet([1, 2, 10]))
+
+        XCTAssertEqual(index.peerIds, ["a", "d"])
+        XCTAssertEqual(index.peerIdentifiers, ["1", "4"])
+        XCTAssertEqual(index.row(forPeerId: "d"), 1)
+        XCTAssertEqual(index.row(forPeerIdentifier: "4"), 1)
+        XCTAssertNil(index.row(forPeerId: "b"))
+        XCTAssertNil(index.row(forPeerIdentifier: "3"))
+    }
+
+    func testRemovedPeerIdMapsToTheLastEarlierRow() {
+        var index = makeIndex([("a", "1"), ("a", "2"), ("b", "3"), ("a", "4")])
+
+        index.remove(rows: IndexSet([3]))
+
+        XCTAssertEqual(index.row(forPeerId: "a"), 1)
+
+        index.remove(rows: IndexSet([1]))
+
+        XCTAssertEqual(index.row(forPeerId: "a"), 0)
+        XCTAssertEqual(index.row(forPeerId: "b"), 1)
+    }
+
+    func testRemoveAll() {
+        var index = makeIndex([("a", "1"), ("b", "2")])
+
+        index.removeAll()
+
+        XCTAssertEqual(index.count, 0)
+        XCTAssertNil(index.row(forPeerId: "a"))
+        XCTAssertNil(index.row(forPeerIdentifier: "2"))
+        XCTAssertEqual(index.append(peerId: "a", peerIdentifier: "1"), 0)
+    }
+
+    // MARK: - Invariants
+
+    // Same lookups as the linear scans the index replaced, which returned the last matching row
+    private func assertMatchesLinearScan(_ index: PeerRowIndex, entries: [(peerId: String, peerIdentifier: String)],
+                                         peerIds: [String], peerIdentifiers: [String], file: StaticString = #filePath, line: UInt = #line) {
+
+        XCTAssertEqual(index.count, entries.count, file: file, line: line)
+        XCTAssertEqual(index.peerIds, entries.map { $0.peerId }, file: file, line: line)
+        XCTAssertEqual(index.peerIdentifiers, entries.map { $0.peerIdentifier }, file: file, line: line)
+
+        for peerId in peerIds {
+            XCTAssertEqual(index.row(forPeerId: peerId), entries.lastIndex { $0.peerId == peerId }, "peerId \(peerId)", file: file, line: line)
+        }
+
+        for peerIdentifier in peerIdentifiers {
+            XCTAssertEqual(index.row(forPeerIdentifier: peerIdentifier), entries.lastIndex { $0.peerIdentifier == peerIdentifier },
+                           "peerIdentifier \(peerIdentifier)", file: file, line: line)
+        }
+    }
+
+    func testRandomOperationsKeepTheInvariants() {
+        var generator = SystemRandomNumberGenerator()
+        // Few peerIds, so the same peerId is contained in several rows (e.g. video and screen share)
+        let peerIds = (0..<6).map { "peer-\($0)" }
+        let peerIdentifiers = (0..<24).map { "identifier-\($0)" }
+
+        for _ in 0..<50 {
+            var index = PeerRowIndex()
+            var entries: [(peerId: String, peerIdentifier: String)] = []
+
+            for _ in 0..<200 {
+                switch Int.random(in: 0..<10, using: &generator) {
+                case 0..<6:
+                    let peerId = peerIds.randomElement(using: &generator)!
+                    let peerIdentifier = peerIdentifiers.randomElement(using: &generator)!
+                    let isContained = entries.contains { $0.peerIdentifier == peerIdentifier }
+
+                    XCTAssertEqual(index.append(peerId: peerId, peerIdentifier: peerIdentifier), isContained ? nil : entries.count)
+
+                    if !isContained {
+                        entries.append((peerId, peerIdentifier))
+                    }
+                case 6..<9:
+                    let identifiersToRemove = (0..<Int.random(in: 1...3, using: &generator)).map { _ in peerIdentifiers.randomElement(using: &generator)! }
+                    let rows = index.rows(forPeerIdentifiers: identifiersToRemove)
+
+                    XCTAssertEqual(Array(rows), entries.indices.filter { identifiersToRemove.contains(entries[$0].peerIdentifier) })
+
+                    index.remove(rows: rows)
+                    entries = entries.filter { !identifiersToRemove.contains($0.peerIdentifier) }
+                default:
+                    if Int.random(in: 0..<20, using: &generator) == 0 {
+                        index.removeAll()
+                        entries.removeAll()
+                    }
+                }
+
+                assertMatchesLinearScan(index, entries: entries, peerIds: peerIds, peerIdentifiers: peerIdentifiers)
+            }
+        }
+    }
+}
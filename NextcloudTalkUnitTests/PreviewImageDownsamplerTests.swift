@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+#if canImport(ImageIO)
+
+import CoreGraphics
+import ImageIO
+
+final class PreviewImageDownsamplerTests: XCTestCase {
+
+    // Size of a media preview in a chat cell at 3x scale
+    let maxPixelSize = 690
+    let numberOfPreviews = 500
+
+    // Photo-sized JPEG with some structure, so the encoder can't reduce it to nothing
+    func makeJPEGData(width: Int, height: Int) throws -> Data {
+        let colorSpace = CGColorSpaceCreateDeviceRGB()
+        let context = try XCTUnwrap(CGContext(data: nil, width: width, height: height, bitsPerComponent: 8, bytesPerRow: 0,
+                                              space: colorSpace, bitmapInfo: CGImageAlphaInfo.premultipliedLast.rawValue))
+
+        for row in 0..<16 {
+            for column in 0..<16 {
+                context.setFillColor(red: CGFloat(row) / 16, green: CGFloat(column) / 16, blue: CGFloat((row + column) % 16) / 16, alpha: 1)
+                context.fill(CGRect(x: column * width / 16, y: row * height / 16, width: width / 16, height: height / 16))
+            }
+        }
+
+        let image = try XCTUnwrap(context.makeImage())
+        let data = NSMutableData()
+        let destination = try XCTUnwrap(CGImageDestinationCreateWithData(data as CFMutableData, "public.jpeg" as CFString, 1, nil))
+
+        CGImageDestinationAddImage(destination, image, [kCGImageDestinationLossyCompressionQuality: 0.8] as CFDictionary)
+        XCTAssertTrue(CGImageDestinationFinalize(destination))
+
+        return data as Data
+    }
+
+    func testDownsampledImageFitsMaxPixelSize() throws {
+        let data = try makeJPEGData(width: 4032, height: 3024)
+        let image = try XCTUnwrap(PreviewImageDownsampler.downsampledImage(from: data, maxPixelSize: maxPixelSize))
+
+        XCTAssertEqual(max(image.width, image.height), maxPixelSize)
+        XCTAssertEqual(image.width, maxPixelSize)
+    }
+
+    // MARK: - Performance
+
+    // Decode time and peak memory (RSS) of decoding 500 previews at display size
+    func testDownsampledDecodingPerformance() throws {
+        let data = try makeJPEGData(width: 2048, height: 1536)
+        let options = XCTMeasureOptions()
+        options.iterationCount = 3
+
+        measure(metrics: [XCTClockMetric(), XCTMemoryMetric()], options: options) {
+            for _ in 0..<numberOfPreviews {
+                autoreleasepool {
+                    _ = PreviewImageDownsampler.downsampledImage(from: data, maxPixelSize: maxPixelSize)
+                }
+            }
+        }
+    }
+
+    // Reference: decoding the same previews at full resolution, as done before
+    func testFullDecodingPerformance() throws {
+        let data = try makeJPEGData(width: 2048, height: 1536)
+        let options = XCTMeasureOptions()
+        options.iterationCount = 3
+
+        measure(metrics: [XCTClockMetric(), XCTMemoryMetric()], options: options) {
+            for _ in 0..<numberOfPreviews {
+                autoreleasepool {
+                    guard let imageSource = CGImageSourceCreateWithData(data as CFData, nil) else { return }
+
+                    _ = CGImageSourceCreateImageAtIndex(imageSource, 0, [kCGImageSourceShouldCacheImmediately: true] as CFDictionary)
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class ReferenceDataStoreTests: XCTestCase {
+
+    let urlString = "https://cloud.example.com/s/abc"
+    let references: [String: Any] = ["https://cloud.example.com/s/abc": ["richObjectType": "file"]]
+
+    // Counts the fetches, the fetch blocks return the references immediately
+    class Fetcher {
+        var fetchCount = 0
+
+        func fetchBlock(references: [String: Any]?, timestamp: TimeInterval) -> ReferenceDataStore.FetchBlock {
+            return { completionBlock in
+                self.fetchCount += 1
+                completionBlock(references.map { ReferenceDataStore.CachedReferences(timestamp: timestamp, references: $0) })
+            }
+        }
+    }
+
+    func testConcurrentLookupsShareOneFetch() {
+        let store = ReferenceDataStore()
+        let key = ReferenceDataStore.cacheKey(forUrlString: urlString, accountId: "account")
+
+        var fetchCount = 0
+        var pendingFetch: ((ReferenceDataStore.CachedReferences?) -> Void)?
+        var results: [[String: Any]?] = []
+
+        for _ in 0..<3 {
+            store.references(forKey: key, now: 0, fetchBlock: { completionBlock in
+                fetchCount += 1
+                pendingFetch = completionBlock
+            }, completionBlock: { references in
+                results.append(references)
+            })
+        }
+
+        XCTAssertEqual(fetchCount, 1)
+        XCTAssertTrue(results.isEmpty)
+
+        pendingFetch?(ReferenceDataStore.CachedReferences(timestamp: 0, references: references))
+
+        XCTAssertEqual(results.count, 3)
+        XCTAssertTrue(results.allSatisfy { $0?.keys.first == urlString })
+
+        // Served from memory afterwards
+        let cachedFetcher = Fetcher()
+        var cachedResult: [String: Any]?
+
+        store.references(forKey: key, now: 1, fetchBlock: cachedFetcher.fetchBlock(references: nil, timestamp: 1)) { references in
+            cachedResult = references
+        }
+
+        XCTAssertEqual(cachedFetcher.fetchCount, 0)
+        XCTAssertEqual(cachedResult?.keys.first, urlString)
+    }
+
+    func testFailedFetchIsNotCached() {
+        let store = ReferenceDataStore()
+        let fetcher = Fetcher()
+        var results: [[String: Any]?] = []
+
+        store.references(forKey: "key", now: 0, fetchBlock: fetcher.fetchBlock(references: nil, timestamp: 0)) { results.append($0) }
+        store.references(forKey: "key", now: 0, fetchBlock: fetcher.fetchBlock(references: nil, timestamp: 0)) { results.append($0) }
+
+        XCTAssertEqual(fetcher.fetchCount, 2)
+        XCTAssertEqual(results.count, 2)
+        XCTAssertTrue(results.allSatisfy { $0 == nil })
+        XCTAssertEqual(store.count, 0)
+    }
+
+    func testReferencesExpireAfterTheirLifetime() {
+        let store = ReferenceDataStore()
+        store.referenceLifetime = 100
+        store.missingReferenceLifetime = 10
+
+        let fetcher = Fetcher()
+
+        store.references(forKey: "found", now: 0, fetchBlock: fetcher.fetchBlock(references: references, timestamp: 0)) { _ in }
+        store.references(forKey: "found", now: 99, fetchBlock: fetcher.fetchBlock(references: references, timestamp: 99)) { _ in }
+        XCTAssertEqual(fetcher.fetchCount, 1)
+
+        store.references(forKey: "found", now: 100, fetchBlock: fetcher.fetchBlock(references: references, timestamp: 100)) { _ in }
+        XCTAssertEqual(fetcher.fetchCount, 2)
+
+        // URLs without a reference use the shorter lifetime
+        let missingFetcher = Fetcher()
+        var missingResult: [String: Any]?
+
+        store.references(forKey: "missing", now: 0, fetchBlock: missingFetcher.fetchBlock(references: [:], timestamp: 0)) { missingResult = $0 }
+        XCTAssertEqual(missingResult?.isEmpty, true)
+
+        store.references(forKey: "missing", now: 9, fetchBlock: missingFetcher.fetchBlock(references: [:], timestamp: 9)) { _ in }
+        XCTAssertEqual(missingFetcher.fetchCount, 1)
+
+        store.references(forKey: "missing", now: 10, fetchBlock: missingFetcher.fetchBlock(references: [:], timestamp: 10)) { _ in }
+        XCTAssertEqual(missingFetcher.fetchCount, 2)
+    }
+
+    func testLeastRecentlyUsedReferencesAreEvicted() {
+        let store = ReferenceDataStore(capacity: 2)
+        let fetcher = Fetcher()
+
+        for key in ["first", "second"] {
+            store.references(forKey: key, now: 0, fetchBlock: fetcher.fetchBlock(references: references, timestamp: 0)) { _ in }
+        }
+
+        // Use "first" again, so "second" is the least recently used one
+        store.references(forKey: "first", now: 0, fetchBlock: fetcher.fetchBlock(references: references, timestamp: 0)) { _ in }
+        store.references(forKey: "third", now: 0, fetchBlock: fetcher.fetchBlock(references: references, timestamp: 0)) { _ in }
+
+        XCTAssertEqual(fetcher.fetchCount, 3)
+        XCTAssertEqual(store.count, 2)
+
+        store.references(forKey: "first", now: 0, fetchBlock: fetcher.fetchBlock(references: references, timestamp: 0)) { _ in }
+        XCTAssertEqual(fetcher.fetchCount, 3)
+
+        store.references(forKey: "second", now: 0, fetchBlock: fetcher.fetchBlock(references: references, timestamp: 0)) { _ in }
+        XCTAssertEqual(fetcher.fetchCount, 4)
+    }
+
+    func testCacheKeys() {
+        let key = ReferenceDataStore.cacheKey(forUrlString: urlString, accountId: "account")
+
+        XCTAssertEqual(ReferenceDataStore.cacheKey(forUrlString: " HTTPS://Cloud.Example.com:443/s/abc\n", accountId: "account"), key)
+        XCTAssertNotEqual(ReferenceDataStore.cacheKey(forUrlString: urlString, accountId: "other account"), key)
+        XCTAssertNotEqual(ReferenceDataStore.cacheKey(forUrlString: "https://cloud.example.com/s/ABC", accountId: "account"), key)
+        XCTAssertNotEqual(ReferenceDataStore.cacheKey(forUrlString: "https://cloud.example.com:8443/s/abc", accountId: "account"), key)
+    }
+}
@@ -0,0 +1,183 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class RoomListDiffTests: XCTestCase {
+
+    private func item(_ internalId: String, lastActivity: Int = 0, lastMessageContent: String = "") -> RoomListItem {
+        return RoomListItem(internalId: internalId, token: internalId, displayName: "Room \(internalId)", lastActivity: lastActivity,
+                            lastMessageId: "\(internalId)@1", lastMessageContent: lastMessageContent)
+    }
+
+    /// Applies the diff like a table view batch update does and returns the resulting order
+    private func apply(_ diff: RoomListDiff, to oldItems: [RoomListItem], newItems: [RoomListItem]) -> [String] {
+        var rows: [String?] = Array(repeating: nil, count: newItems.count)
+        let deletedRows = Set(diff.deletedRows)
+        let movedFromRows = Set(diff.movedFromRows)
+        let occupiedRows = Set(diff.insertedRows).union(diff.movedToRows)
+
+        for (oldRow, newRow) in zip(diff.movedFromRows, diff.movedToRows) {
+            rows[newRow] = oldItems[oldRow].internalId
+        }
+
+        for newRow in diff.insertedRows {
+            rows[newRow] = newItems[newRow].internalId
+        }
+
+        // Rows that are not deleted, inserted or moved keep their relative order
+        var remainingRows = oldItems.enumerated().filter { !deletedRows.contains($0.offset) && !movedFromRows.contains($0.offset) }.map { $0.element.internalId }.makeIterator()
+
+        for newRow in 0..<newItems.count where !occupiedRows.contains(newRow) {
+            rows[newRow] = remainingRows.next()
+        }
+
+        return rows.map { $0 ?? "" }
+    }
+
+    // MARK: - Structure
+
+    func testInsertedDeletedAndMovedRooms() {
+        let oldItems = ["a", "b", "c", "d"].map { item($0) }
+        let newItems = ["d", "a", "c", "e"].map { item($0) }
+
+        let diff = RoomListDiff.diff(from: oldItems, to: newItems)
+
+        XCTAssertEqual(diff.deletedRows, [1])
+        XCTAssertEqual(diff.insertedRows, [3])
+        XCTAssertEqual(diff.movedFromRows, [3])
+        XCTAssertEqual(diff.movedToRows, [0])
+        XCTAssertTrue(diff.updatedRows.isEmpty)
+        XCTAssertEqual(apply(diff, to: oldItems, newItems: newItems), ["d", "a", "c", "e"])
+    }
+
+    func testRandomListsAreTransformed() {
+        var generator = SystemRandomNumberGenerator()
+
+        for _ in 0..<200 {
+            let oldItems = (0..<20).filter { _ in Bool.random(using: &generator) }.map { item("\($0)") }.shuffled(using: &generator)
+            let newItems = (0..<20).filter { _ in Bool.random(using: &generator) }.map { item("\($0)") }.shuffled(using: &generator)
+
+            let diff = RoomListDiff.diff(from: oldItems, to: newItems)
+
+            XCTAssertFalse(diff.requiresReload)
+            XCTAssertEqual(apply(diff, to: oldItems, newItems: newItems), newItems.map { $0.internalId })
+        }
+    }
+
+    func testDuplicatedRoomsRequireAReload() {
+        XCTAssertTrue(RoomListDiff.diff(from: [item("a"), item("a")], to: [item("a")]).requiresReload)
+        XCTAssertTrue(RoomListDiff.diff(from: [item("a")], to: [item("b"), item("b")]).requiresReload)
+    }
+
+    func testUnchangedListHasNoChanges() {
+        let items = ["a", "b", "c"].map { item($0) }
+
+        XCTAssertFalse(RoomListDiff.diff(from: items, to: items).hasChanges)
+    }
+
+    // MARK: - Content
+
+    func testEditedLastMessageUpdatesTheRoom() {
+        // An edited or deleted message keeps its id
+        let oldItems = [item("a", lastMessageContent: "Hello"), item("b", lastMessageContent: "Hi")]
+        let newItems = [item("a", lastMessageContent: "Hello everyone"), item("b", lastMessageContent: "Hi")]
+
+        let diff = RoomListDiff.diff(from: oldItems, to: newItems)
+
+        XCTAssertEqual(diff.updatedRows, [0])
+        XCTAssertFalse(diff.hasStructuralChanges)
+    }
+
+    func testChangedPropertiesUpdateTheRoom() {
+        let oldItem = item("a")
+        var changedItems: [RoomListItem] = []
+
+        var unread = oldItem
+        unread.unreadMessages = 3
+        changedItems.append(unread)
+
+        var renamed = oldItem
+        renamed.displayName = "Renamed"
+        changedItems.append(renamed)
+
+        var call = oldItem
+        call.hasCall = true
+        changedItems.append(call)
+
+        var status = oldItem
+        status.statusIcon = "🌴"
+        changedItems.append(status)
+
+        var avatar = oldItem
+        avatar.avatarVersion = "2"
+        changedItems.append(avatar)
+
+        for changedItem in changedItems {
+            XCTAssertEqual(RoomListDiff.diff(from: [oldItem], to: [changedItem]).updatedRows, [0])
+        }
+    }
+
+    func testUpdatedRowsReferToTheNewList() {
+        let oldItems = [item("a"), item("b", lastActivity: 1)]
+        let newItems = [item("b", lastActivity: 2), item("a")]
+
+        let diff = RoomListDiff.diff(from: oldItems, to: newItems)
+
+        XCTAssertEqual(diff.updatedRows, [0])
+        XCTAssertEqual(apply(diff, to: oldItems, newItems: newItems), ["b", "a"])
+    }
+
+    // MARK: - Benchmark
+
+    func testBenchmarkDiffingTwoThousandRooms() {
+        let oldItems = (0..<2_000).map { item("room\($0)", lastActivity: 2_000 - $0, lastMessageContent: "Message \($0)") }
+
+        // A few rooms got new messages and moved to the top, one was edited, one left and one joined
+        var newItems = oldItems
+        let movedItems = [1_500, 700, 20].map { index -> RoomListItem in
+            var movedItem = newItems[index]
+            movedItem.lastActivity = 3_000 + index
+            movedItem.lastMessageContent = "New message"
+            return movedItem
+        }
+
+        newItems.remove(at: 1_500)
+        newItems.remove(at: 700)
+        newItems.remove(at: 20)
+        newItems.insert(contentsOf: movedItems, at: 0)
+        newItems[100].lastMessageContent = "Edited"
+        newItems.remove(at: 1_000)
+        newItems.insert(item("new", lastActivity: 2_500), at: 3)
+
+        let diff = RoomListDiff.diff(from: oldItems, to: newItems)
+        XCTAssertEqual(diff.movedFromRows.count, 3)
+        XCTAssertEqual(apply(diff, to: oldItems, newItems: newItems), newItems.map { $0.internalId })
+
+        measure(metrics: [XCTClockMetric()]) {
+            for _ in 0..<10 {
+                _ = RoomListDiff.diff(from: oldItems, to: newItems)
+            }
+        }
+    }
+}
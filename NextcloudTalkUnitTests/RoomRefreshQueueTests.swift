@@ -0,0 +1,279 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class RoomRefreshQueueTests: XCTestCase {
+
+    /// Stands in for the chat controllers, refreshes only complete when the test completes them
+    private final class StubFetcher {
+        var startedRooms: [String] = []
+        var cancelledRooms: [String] = []
+        private var completionBlocks: [String: () -> Void] = [:]
+
+        var runningRooms: Set<String> {
+            return Set(completionBlocks.keys)
+        }
+
+        lazy var refreshBlock: RoomRefreshQueue.RefreshBlock = { [unowned self] room, completionBlock in
+            self.startedRooms.append(room.token)
+            self.completionBlocks[room.token] = completionBlock
+
+            // A cancelled request might still complete later
+            return {
+                self.cancelledRooms.append(room.token)
+            }
+        }
+
+        func complete(_ token: String) {
+            completionBlocks.removeValue(forKey: token)?()
+        }
+    }
+
+    private final class SimulatedClock {
+        var now = Date(timeIntervalSinceReferenceDate: 0)
+
+        func advance(by timeInterval: TimeInterval) {
+            now = now.addingTimeInterval(timeInterval)
+        }
+    }
+
+    private let accountId = "user@cloud.example.com"
+    private var userDefaultsSuiteName = ""
+    private var userDefaults: UserDefaults!
+    private var clock = SimulatedClock()
+    private var fetcher = StubFetcher()
+    private var storedRooms: [String: RoomRefreshCandidate] = [:]
+
+    override func setUp() {
+        super.setUp()
+
+        userDefaultsSuiteName = "RoomRefreshQueueTests-\(UUID().uuidString)"
+        userDefaults = UserDefaults(suiteName: userDefaultsSuiteName)
+        clock = SimulatedClock()
+        fetcher = StubFetcher()
+        storedRooms = [:]
+    }
+
+    override func tearDown() {
+        userDefaults.removePersistentDomain(forName: userDefaultsSuiteName)
+        super.tearDown()
+    }
+
+    private func makeQueue(maxConcurrentRefreshes: Int = 3, timeBudget: TimeInterval = 20) -> RoomRefreshQueue {
+        let queue = RoomRefreshQueue(userDefaults: userDefaults, now: { [unowned self] in self.clock.now }, scheduleOnMain: { $0() },
+                                     roomForToken: { [unowned self] token, _ in self.storedRooms[token] })
+        queue.maxConcurrentRefreshes = maxConcurrentRefreshes
+        queue.timeBudget = timeBudget
+
+        return queue
+    }
+
+    private func room(_ token: String, mention: Bool = false, oneToOne: Bool = false, favorite: Bool = false, lastActivity: Int = 0) -> RoomRefreshCandidate {
+        let room = RoomRefreshCandidate(internalId: "\(accountId)@\(token)", token: token, hasUnreadMention: mention,
+                                        isOneToOne: oneToOne, isFavorite: favorite, lastActivity: lastActivity)
+        storedRooms[token] = room
+
+        return room
+    }
+
+    // MARK: - Priority
+
+    func testRoomsAreRefreshedByImportance() {
+        let rooms = [
+            room("group-old", lastActivity: 1),
+            room("favorite", favorite: true, lastActivity: 2),
+            room("group-new", lastActivity: 9),
+            room("one-to-one", oneToOne: true, lastActivity: 3),
+            room("mention-old", mention: true, lastActivity: 4),
+            room("mention-new", mention: true, lastActivity: 8)
+        ]
+
+        let queue = makeQueue(maxConcurrentRefreshes: 1)
+        queue.refresh(rooms: rooms, forAccountId: accountId, using: fetcher.refreshBlock, completionBlock: nil)
+
+        while let running = fetcher.runningRooms.first {
+            fetcher.complete(running)
+        }
+
+        XCTAssertEqual(fetcher.startedRooms, ["mention-new", "mention-old", "one-to-one", "favorite", "group-new", "group-old"])
+        XCTAssertFalse(queue.isRunning)
+    }
+
+    func testParallelRefreshesAreLimited() {
+        let rooms = (0..<10).map { room("room\($0)", lastActivity: 10 - $0) }
+
+        let queue = makeQueue(maxConcurrentRefreshes: 3)
+        queue.refresh(rooms: rooms, forAccountId: accountId, using: fetcher.refreshBlock, completionBlock: nil)
+
+        XCTAssertEqual(fetcher.runningRooms, ["room0", "room1", "room2"])
+
+        fetcher.complete("room1")
+
+        XCTAssertEqual(fetcher.runningRooms, ["room0", "room2", "room3"])
+    }
+
+    func testRoomsAddedToARunningRunAreRanked() {
+        let queue = makeQueue(maxConcurrentRefreshes: 1)
+        queue.refresh(rooms: [room("first", lastActivity: 1), room("second", lastActivity: 0)], forAccountId: accountId, using: fetcher.refreshBlock, completionBlock: nil)
+        queue.refresh(rooms: [room("mention", mention: true), room("first", lastActivity: 1)], forAccountId: accountId, using: fetcher.refreshBlock, completionBlock: nil)
+
+        while let running = fetcher.runningRooms.first {
+            fetcher.complete(running)
+        }
+
+        // A room that is already queued is not refreshed twice
+        XCTAssertEqual(fetcher.startedRooms, ["first", "mention", "second"])
+    }
+
+    // MARK: - Time budget
+
+    func testNoRefreshesAreStartedAfterTheTimeBudget() {
+        let rooms = (0..<6).map { room("room\($0)", lastActivity: 10 - $0) }
+        var completedRuns = 0
+
+        let queue = makeQueue(maxConcurrentRefreshes: 1, timeBudget: 20)
+        queue.refresh(rooms: rooms, forAccountId: accountId, using: fetcher.refreshBlock) {
+            completedRuns += 1
+        }
+
+        // Every refresh takes 8s, so the third one completes after the budget ran out
+        for token in ["room0", "room1", "room2"] {
+            clock.advance(by: 8)
+            fetcher.complete(token)
+        }
+
+        XCTAssertEqual(fetcher.startedRooms, ["room0", "room1", "room2"])
+        XCTAssertEqual(completedRuns, 1)
+        XCTAssertFalse(queue.isRunning)
+    }
+
+    func testRunningRefreshesFinishAfterTheTimeBudget() {
+        let rooms = (0..<4).map { room("room\($0)", lastActivity: 10 - $0) }
+        var completedRuns = 0
+
+        let queue = makeQueue(maxConcurrentRefreshes: 2, timeBudget: 20)
+        queue.refresh(rooms: rooms, forAccountId: accountId, using: fetcher.refreshBlock) {
+            completedRuns += 1
+        }
+
+        clock.advance(by: 25)
+        fetcher.complete("room0")
+
+        // The run ends once the refresh that is still running completed
+        XCTAssertEqual(completedRuns, 0)
+        XCTAssertEqual(fetcher.runningRooms, ["room1"])
+
+        fetcher.complete("room1")
+
+        XCTAssertEqual(completedRuns, 1)
+        XCTAssertTrue(fetcher.cancelledRooms.isEmpty)
+    }
+
+    // MARK: - Carry-over
+
+    func testRemainingRoomsAreCarriedOverToTheNextRun() {
+        let rooms = (0..<4).map { room("room\($0)", lastActivity: 10 - $0) }
+
+        let firstRun = makeQueue(maxConcurrentRefreshes: 1, timeBudget: 20)
+        firstRun.refresh(rooms: rooms, forAccountId: accountId, using: fetcher.refreshBlock, completionBlock: nil)
+
+        clock.advance(by: 30)
+        fetcher.complete("room0")
+
+        XCTAssertFalse(firstRun.isRunning)
+
+        // A new queue, like after the app was started again
+        fetcher = StubFetcher()
+
+        let secondRun = makeQueue(maxConcurrentRefreshes: 1, timeBudget: 20)
+        secondRun.refresh(rooms: [room("new", lastActivity: 0)], forAccountId: accountId, using: fetcher.refreshBlock, completionBlock: nil)
+
+        while let running = fetcher.runningRooms.first {
+            fetcher.complete(running)
+        }
+
+        XCTAssertEqual(fetcher.startedRooms, ["room1", "room2", "room3", "new"])
+
+        // Nothing is left for the run after
+        fetcher = StubFetcher()
+        makeQueue().refresh(rooms: [], forAccountId: accountId, using: fetcher.refreshBlock, completionBlock: nil)
+        XCTAssertTrue(fetcher.startedRooms.isEmpty)
+    }
+
+    func testCancelledRefreshesAreCarriedOver() {
+        let rooms = (0..<3).map { room("room\($0)", lastActivity: 10 - $0) }
+        var completedRuns = 0
+
+        let queue = makeQueue(maxConcurrentRefreshes: 2)
+        queue.refresh(rooms: rooms, forAccountId: accountId, using: fetcher.refreshBlock) {
+            completedRuns += 1
+        }
+
+        // e.g. the background time expired
+        queue.cancel()
+
+        XCTAssertEqual(Set(fetcher.cancelledRooms), ["room0", "room1"])
+        XCTAssertEqual(completedRuns, 1)
+
+        fetcher = StubFetcher()
+        queue.refresh(rooms: [], forAccountId: accountId, using: fetcher.refreshBlock, completionBlock: nil)
+
+        XCTAssertEqual(fetcher.startedRooms, ["room0", "room1"])
+    }
+
+    func testLateCompletionsOfACancelledRunAreIgnored() {
+        let queue = makeQueue(maxConcurrentRefreshes: 1)
+        queue.refresh(rooms: [room("room0", lastActivity: 1), room("room1")], forAccountId: accountId, using: fetcher.refreshBlock, completionBlock: nil)
+
+        let firstFetcher = fetcher
+        fetcher = StubFetcher()
+
+        // Another account ends the run of the first one
+        queue.refresh(rooms: [room("other0", lastActivity: 1), room("other1")], forAccountId: "other@cloud.example.com", using: fetcher.refreshBlock, completionBlock: nil)
+
+        XCTAssertEqual(firstFetcher.cancelledRooms, ["room0"])
+        XCTAssertEqual(fetcher.startedRooms, ["other0"])
+
+        firstFetcher.complete("room0")
+
+        XCTAssertEqual(fetcher.startedRooms, ["other0"])
+        XCTAssertTrue(queue.isRunning)
+    }
+
+    func testStoppedRunKeepsTheQueuedRooms() {
+        let queue = makeQueue(maxConcurrentRefreshes: 1)
+        queue.refresh(rooms: [room("room0", lastActivity: 1), room("room1")], forAccountId: accountId, using: fetcher.refreshBlock, completionBlock: nil)
+
+        queue.stop()
+        fetcher.complete("room0")
+
+        XCTAssertFalse(queue.isRunning)
+        XCTAssertEqual(fetcher.startedRooms, ["room0"])
+
+        fetcher = StubFetcher()
+        queue.refresh(rooms: [], forAccountId: accountId, using: fetcher.refreshBlock, completionBlock: nil)
+
+        XCTAssertEqual(fetcher.startedRooms, ["room1"])
+    }
+}
@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class RoomSearchIndexTests: XCTestCase {
+
+    private func makeIndex(_ entries: [RoomSearchEntry]) -> RoomSearchIndex {
+        let index = RoomSearchIndex()
+        index.update(entries: entries)
+
+        return index
+    }
+
+    // MARK: - Matching
+
+    func testRoomsAreRankedByWhereTheTermMatched() {
+        let entries = [
+            RoomSearchEntry(internalId: "participant", displayName: "Weekly sync", participants: ["anna"]),
+            RoomSearchEntry(internalId: "substring", displayName: "Hannah"),
+            RoomSearchEntry(internalId: "word", displayName: "Team Anna"),
+            RoomSearchEntry(internalId: "prefix", displayName: "Anna Smith"),
+            RoomSearchEntry(internalId: "none", displayName: "Bob")
+        ]
+        let index = makeIndex(entries)
+
+        XCTAssertEqual(index.internalIds(matching: "anna", in: entries.map { $0.internalId }), ["prefix", "word", "substring", "participant"])
+    }
+
+    func testRoomsWithTheSameRankKeepTheirOrder() {
+        let entries = ["c", "a", "b"].map { RoomSearchEntry(internalId: $0, displayName: "Project \($0)") }
+        let index = makeIndex(entries)
+
+        XCTAssertEqual(index.internalIds(matching: "proj", in: ["c", "a", "b"]), ["c", "a", "b"])
+        XCTAssertEqual(index.internalIds(matching: "proj", in: ["b", "c"]), ["b", "c"])
+    }
+
+    func testCaseAndDiacriticsAreIgnored() {
+        let index = makeIndex([RoomSearchEntry(internalId: "room", displayName: "Ümlaut Café")])
+
+        XCTAssertEqual(index.internalIds(matching: "umlaut", in: ["room"]), ["room"])
+        XCTAssertEqual(index.internalIds(matching: "CAFE", in: ["room"]), ["room"])
+        XCTAssertEqual(index.internalIds(matching: "é", in: ["room"]), ["room"])
+    }
+
+    func testShortAndLongTerms() {
+        let index = makeIndex([RoomSearchEntry(internalId: "room", displayName: "Release planning", name: "release-planning")])
+
+        XCTAssertEqual(index.internalIds(matching: "r", in: ["room"]), ["room"])
+        XCTAssertEqual(index.internalIds(matching: "pla", in: ["room"]), ["room"])
+        XCTAssertEqual(index.internalIds(matching: "planning", in: ["room"]), ["room"])
+        XCTAssertEqual(index.internalIds(matching: "  release ", in: ["room"]), ["room"])
+        XCTAssertTrue(index.internalIds(matching: "plans", in: ["room"]).isEmpty)
+        XCTAssertTrue(index.internalIds(matching: "x", in: ["room"]).isEmpty)
+    }
+
+    func testRoomsContainingAllTrigramsButNotTheTermDontMatch() {
+        // Contains "abc", "bcb" and "cbc", but not "abcbc"
+        let index = makeIndex([RoomSearchEntry(internalId: "room", displayName: "abcb xcbc")])
+
+        XCTAssertTrue(index.internalIds(matching: "abcbc", in: ["room"]).isEmpty)
+    }
+
+    func testEmptyTermReturnsAllRooms() {
+        let index = makeIndex([RoomSearchEntry(internalId: "a", displayName: "A")])
+
+        XCTAssertEqual(index.internalIds(matching: " ", in: ["a", "unknown"]), ["a", "unknown"])
+    }
+
+    // MARK: - Updates
+
+    func testUpdatesReplaceChangedAndRemovedRooms() {
+        let index = makeIndex([
+            RoomSearchEntry(internalId: "renamed", displayName: "Old name"),
+            RoomSearchEntry(internalId: "removed", displayName: "Old room")
+        ])
+
+        index.update(entries: [RoomSearchEntry(internalId: "renamed", displayName: "New name")])
+
+        XCTAssertTrue(index.internalIds(matching: "old", in: ["renamed", "removed"]).isEmpty)
+        XCTAssertEqual(index.internalIds(matching: "new", in: ["renamed", "removed"]), ["renamed"])
+    }
+
+    func testParticipantChangesAreIndexed() {
+        let index = makeIndex([RoomSearchEntry(internalId: "room", displayName: "Team", participants: ["alice"])])
+
+        index.update(entries: [RoomSearchEntry(internalId: "room", displayName: "Team", participants: ["alice", "bob"])])
+
+        XCTAssertEqual(index.internalIds(matching: "bob", in: ["room"]), ["room"])
+    }
+
+    func testRemoveAllEntries() {
+        let index = makeIndex([RoomSearchEntry(internalId: "room", displayName: "Team")])
+
+        index.removeAllEntries()
+
+        XCTAssertTrue(index.internalIds(matching: "team", in: ["room"]).isEmpty)
+    }
+
+    // MARK: - Benchmark
+
+    private let words = ["Team", "Project", "Marketing", "Release", "Design", "Support", "Weekly", "Café", "Planning", "Öffentlich"]
+    private let names = ["anna", "bob", "carla", "dimitri", "emma", "farid", "greta", "hiro", "ines", "jonas"]
+
+    private func benchmarkEntries() -> [RoomSearchEntry] {
+        return (0..<2_000).map { index in
+            let displayName = "\(words[index % words.count]) \(words[(index / 10) % words.count]) \(index)"
+            let participants = (0..<8).map { "\(names[($0 + index) % names.count])\(index % 50)" }
+
+            return RoomSearchEntry(internalId: "room\(index)", displayName: displayName, name: "room-\(index)", participants: participants)
+        }
+    }
+
+    // 1,000 searches per iteration, so the target of <1 ms per search means <1 s per iteration
+    func testBenchmarkSearch() {
+        let entries = benchmarkEntries()
+        let internalIds = entries.map { $0.internalId }
+        let index = makeIndex(entries)
+        let terms = ["t", "pr", "caf", "plann", "anna1", "market 12", "xyz"]
+
+        measure(metrics: [XCTClockMetric()]) {
+            var matches = 0
+
+            for search in 0..<1_000 {
+                matches += index.internalIds(matching: terms[search % terms.count], in: internalIds).count
+            }
+
+            XCTAssertGreaterThan(matches, 0)
+        }
+    }
+
+    func testBenchmarkTypingATerm() {
+        let entries = benchmarkEntries()
+        let internalIds = entries.map { $0.internalId }
+        let index = makeIndex(entries)
+        let term = Array("marketing design")
+
+        // Every keystroke searches again, like the search controller does
+        measure(metrics: [XCTClockMetric()]) {
+            for _ in 0..<50 {
+                for length in 1...term.count {
+                    _ = index.internalIds(matching: String(term[0..<length]), in: internalIds)
+                }
+            }
+        }
+    }
+
+    func testBenchmarkUpdatingUnchangedRooms() {
+        let entries = benchmarkEntries()
+        let index = makeIndex(entries)
+
+        // The room list is updated often, but only a few rooms change
+        measure(metrics: [XCTClockMetric()]) {
+            index.update(entries: entries)
+        }
+    }
+}
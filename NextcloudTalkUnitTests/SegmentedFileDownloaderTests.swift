@@ -0,0 +1,368 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+#if canImport(FoundationNetworking)
+import FoundationNetworking
+#endif
+@testable import NextcloudTalkCore
+
+/// Serves a file with range requests like the WebDAV endpoint of the server
+final class RangeServerStandIn: URLProtocol {
+
+    static let host = "range-server.test"
+
+    private static let lock = NSLock()
+    private static var content = Data()
+    private static var etag = ""
+    private static var ignoresRanges = false
+    private static var failingRequests = 0
+    private static var interruptAfterBytes: Int?
+    private static var requestedRanges: [String] = []
+
+    static func reset(content: Data, etag: String, ignoresRanges: Bool = false, failingRequests: Int = 0, interruptAfterBytes: Int? = nil) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        self.content = content
+        self.etag = etag
+        self.ignoresRanges = ignoresRanges
+        self.failingRequests = failingRequests
+        self.interruptAfterBytes = interruptAfterBytes
+        self.requestedRanges = []
+    }
+
+    static var ranges: [String] {
+        lock.lock()
+        defer { lock.unlock() }
+
+        return requestedRanges
+    }
+
+    override class func canInit(with request: URLRequest) -> Bool {
+        return request.url?.host == host
+    }
+
+    override class func canonicalRequest(for request: URLRequest) -> URLRequest {
+        return request
+    }
+
+    override func startLoading() {
+        let rangeHeader = request.value(forHTTPHeaderField: "Range") ?? ""
+        let ifRangeHeader = request.value(forHTTPHeaderField: "If-Range")
+
+        RangeServerStandIn.lock.lock()
+        let content = RangeServerStandIn.content
+        let etag = RangeServerStandIn.etag
+        let ignoresRanges = RangeServerStandIn.ignoresRanges
+        let shouldFail = RangeServerStandIn.failingRequests > 0
+        let interruptAfterBytes = RangeServerStandIn.interruptAfterBytes
+        RangeServerStandIn.failingRequests -= shouldFail ? 1 : 0
+        RangeServerStandIn.interruptAfterBytes = nil
+        RangeServerStandIn.requestedRanges.append(rangeHeader)
+        RangeServerStandIn.lock.unlock()
+
+        if shouldFail {
+            self.respond(statusCode: 503, headers: [:], body: Data())
+            return
+        }
+
+        var range = 0..<content.count
+        var statusCode = 200
+
+        let bounds = rangeHeader.replacingOccurrences(of: "bytes=", with: "").split(separator: "-").compactMap { Int($0) }
+
+        if !ignoresRanges, bounds.count == 2, ifRangeHeader == nil || ifRangeHeader == "\"\(etag)\"" {
+            range = bounds[0]..<min(bounds[1] + 1, content.count)
+            statusCode = 206
+        }
+
+        var headers = ["Content-Length": "\(range.count)", "ETag": "\"\(etag)\""]
+
+        if statusCode == 206 {
+            headers["Content-Range"] = "bytes \(range.lowerBound)-\(range.upperBound - 1)/\(content.count)"
+        }
+
+        let body = content.subdata(in: range)
+
+        if let interruptAfterBytes {
+            self.respond(statusCode: statusCode, headers: headers, body: body.prefix(interruptAfterBytes), error: URLError(.networkConnectionLost))
+        } else {
+            self.respond(statusCode: statusCode, headers: headers, body: body)
+        }
+    }
+
+    override func stopLoading() {
+    }
+
+    private func respond(statusCode: Int, headers: [String: String], body: Data, error: Error? = nil) {
+        guard let url = request.url, let response = HTTPURLResponse(url: url, statusCode: statusCode, httpVersion: "HTTP/1.1", headerFields: headers) else { return }
+
+        client?.urlProtocol(self, didReceive: response, cacheStoragePolicy: .notAllowed)
+
+        // Deliver the body in small chunks like a real connection
+        var offset = 0
+
+        while offset < body.count {
+            let chunkEnd = min(offset + 8192, body.count)
+            client?.urlProtocol(self, didLoad: body.subdata(in: (body.startIndex + offset)..<(body.startIndex + chunkEnd)))
+            offset = chunkEnd
+        }
+
+        if let error {
+            client?.urlProtocol(self, didFailWithError: error)
+        } else {
+            client?.urlProtocolDidFinishLoading(self)
+        }
+    }
+}
+
+final class SegmentedFileDownloaderTests: XCTestCase {
+
+    private struct Result {
+        var errorDescription: String?
+        var progress: [(fractionCompleted: Double, playableFraction: Double)] = []
+    }
+
+    private let fileSize = 256 * 1024
+    private var content = Data()
+    private var directory: URL!
+
+    override func setUp() {
+        super.setUp()
+
+        var generator = SystemRandomNumberGenerator()
+        content = Data((0..<fileSize).map { _ in UInt8.random(in: 0...255, using: &generator) })
+        directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: directory)
+        super.tearDown()
+    }
+
+    private var localPath: String {
+        return directory.appendingPathComponent("video.mp4").path
+    }
+
+    private func makeDownloader() -> SegmentedFileDownloader {
+        let configuration = URLSessionConfiguration.ephemeral
+        configuration.protocolClasses = [RangeServerStandIn.self]
+
+        let downloader = SegmentedFileDownloader(configuration: configuration, requestHeaders: ["Authorization": "Basic dGVzdA=="])
+        downloader.callbackQueue = DispatchQueue(label: "SegmentedFileDownloaderTests")
+        downloader.parallelDownloadThreshold = 64 * 1024
+        downloader.retryBaseDelay = 0.01
+
+        return downloader
+    }
+
+    private func download(with downloader: SegmentedFileDownloader, etag: String = "etag1") -> Result {
+        let expectation = self.expectation(description: "Download finished")
+        var result = Result()
+
+        downloader.downloadFile(fromURL: URL(string: "https://\(RangeServerStandIn.host)/remote.php/dav/files/user/video.mp4")!,
+                                toPath: localPath, fileSize: Int64(fileSize), etag: etag) { fractionCompleted, playableFraction in
+            result.progress.append((fractionCompleted, playableFraction))
+        } completionBlock: { errorDescription in
+            result.errorDescription = errorDescription
+            expectation.fulfill()
+        }
+
+        wait(for: [expectation], timeout: 10)
+
+        return result
+    }
+
+    private func assertDownloadedFileIsComplete(file: StaticString = #filePath, line: UInt = #line) {
+        XCTAssertEqual(FileManager.default.contents(atPath: localPath), content, file: file, line: line)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: SegmentedFileDownloader.partialFilePath(forLocalPath: localPath)), file: file, line: line)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: localPath + ".partinfo"), file: file, line: line)
+    }
+
+    // MARK: - Download
+
+    func testLargeFilesAreDownloadedInParallelSegments() {
+        RangeServerStandIn.reset(content: content, etag: "etag1")
+
+        let result = download(with: makeDownloader())
+
+        XCTAssertNil(result.errorDescription)
+        XCTAssertEqual(Set(RangeServerStandIn.ranges), ["bytes=0-65535", "bytes=65536-131071", "bytes=131072-196607", "bytes=196608-262143"])
+        assertDownloadedFileIsComplete()
+    }
+
+    func testStreamedFilesAreDownloadedTailFirst() {
+        RangeServerStandIn.reset(content: content, etag: "etag1")
+
+        let tailLength = 16 * 1024
+        let downloader = makeDownloader()
+        downloader.allowsParallelSegments = false
+        downloader.tailLength = Int64(tailLength)
+
+        let result = download(with: downloader)
+
+        XCTAssertNil(result.errorDescription)
+        XCTAssertEqual(RangeServerStandIn.ranges, ["bytes=\(fileSize - tailLength)-\(fileSize - 1)", "bytes=0-\(fileSize - tailLength - 1)"])
+        assertDownloadedFileIsComplete()
+
+        // Nothing is playable before the index at the end of the file is available, then the file is filled from the start
+        let tailFraction = Double(tailLength) / Double(fileSize)
+
+        XCTAssertFalse(result.progress.isEmpty)
+
+        for progress in result.progress {
+            XCTAssertLessThanOrEqual(progress.playableFraction, progress.fractionCompleted)
+
+            if progress.fractionCompleted < tailFraction {
+                XCTAssertEqual(progress.playableFraction, 0)
+            } else if progress.fractionCompleted < 1 {
+                XCTAssertEqual(progress.playableFraction, progress.fractionCompleted - tailFraction, accuracy: 0.0001)
+            }
+        }
+
+        XCTAssertEqual(result.progress.last?.fractionCompleted, 1)
+        XCTAssertEqual(result.progress.last?.playableFraction, 1)
+    }
+
+    func testServerIgnoringRangesRestartsWithASingleRequest() {
+        RangeServerStandIn.reset(content: content, etag: "etag1", ignoresRanges: true)
+
+        let downloader = makeDownloader()
+        downloader.allowsParallelSegments = false
+        downloader.tailLength = 16 * 1024
+
+        let result = download(with: downloader)
+
+        XCTAssertNil(result.errorDescription)
+        XCTAssertEqual(RangeServerStandIn.ranges.count, 2)
+        assertDownloadedFileIsComplete()
+
+        // Without the tail, the file can only be played once it's complete
+        for progress in result.progress where progress.fractionCompleted < 1 {
+            XCTAssertEqual(progress.playableFraction, 0)
+        }
+    }
+
+    func testChangedFileOnServerIsDownloadedCompletely() {
+        RangeServerStandIn.reset(content: content, etag: "etag2")
+
+        // Our etag is outdated, so If-Range makes the server return the whole file
+        let result = download(with: makeDownloader(), etag: "etag1")
+
+        XCTAssertNil(result.errorDescription)
+        assertDownloadedFileIsComplete()
+    }
+
+    func testServerErrorsAreRetried() {
+        RangeServerStandIn.reset(content: content, etag: "etag1", failingRequests: 2)
+
+        let downloader = makeDownloader()
+        downloader.allowsParallelSegments = false
+
+        let result = download(with: downloader)
+
+        XCTAssertNil(result.errorDescription)
+        XCTAssertEqual(RangeServerStandIn.ranges, Array(repeating: "bytes=0-\(fileSize - 1)", count: 3))
+        assertDownloadedFileIsComplete()
+    }
+
+    func testDownloadFailsAfterMaxRetries() {
+        RangeServerStandIn.reset(content: content, etag: "etag1", failingRequests: 10)
+
+        let downloader = makeDownloader()
+        downloader.allowsParallelSegments = false
+        downloader.maxRetries = 1
+
+        let result = download(with: downloader)
+
+        XCTAssertNotNil(result.errorDescription)
+        XCTAssertEqual(RangeServerStandIn.ranges.count, 2)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: localPath))
+    }
+
+    func testInterruptedDownloadIsResumed() {
+        RangeServerStandIn.reset(content: content, etag: "etag1", interruptAfterBytes: 100 * 1024)
+
+        let firstDownloader = makeDownloader()
+        firstDownloader.allowsParallelSegments = false
+        firstDownloader.maxRetries = 0
+
+        XCTAssertNotNil(download(with: firstDownloader).errorDescription)
+
+        let secondDownloader = makeDownloader()
+        secondDownloader.allowsParallelSegments = false
+
+        XCTAssertNil(download(with: secondDownloader).errorDescription)
+
+        // The second request continues where the first one stopped
+        let ranges = RangeServerStandIn.ranges
+        XCTAssertEqual(ranges.count, 2)
+        XCTAssertNotEqual(ranges.last, ranges.first)
+        XCTAssertTrue(ranges.last?.hasSuffix("-\(fileSize - 1)") ?? false)
+        assertDownloadedFileIsComplete()
+    }
+
+    // MARK: - Partial state
+
+    func testPlayableBytesNeedTheTail() {
+        var state = PartialDownloadState(etag: "etag", fileSize: 1000, numberOfSegments: 1, tailLength: 100)
+
+        XCTAssertEqual(state.segments, [DownloadSegment(start: 900, end: 999, receivedBytes: 0), DownloadSegment(start: 0, end: 899, receivedBytes: 0)])
+
+        state.segments[1].receivedBytes = 500
+        XCTAssertEqual(state.playableBytes, 0)
+
+        state.segments[0].receivedBytes = 100
+        XCTAssertEqual(state.playableBytes, 500)
+
+        state.segments[1].receivedBytes = 900
+        XCTAssertEqual(state.playableBytes, 1000)
+    }
+
+    func testPlayableBytesWithoutTail() {
+        var state = PartialDownloadState(etag: "etag", fileSize: 1000, numberOfSegments: 2, tailLength: 0)
+
+        XCTAssertEqual(state.segments.count, 2)
+
+        // The second half is not contiguous to the beginning of the file
+        state.segments[1].receivedBytes = 500
+        XCTAssertEqual(state.playableBytes, 0)
+
+        state.segments[0].receivedBytes = 200
+        XCTAssertEqual(state.playableBytes, 200)
+
+        state.segments[0].receivedBytes = 500
+        XCTAssertEqual(state.playableBytes, 1000)
+    }
+
+    func testStreamingTailLengthDependsOnTheContainer() {
+        let megabyte: Int64 = 1024 * 1024
+
+        XCTAssertEqual(SegmentedFileDownloader.streamingTailLength(forFileName: "video.MP4", fileSize: 10 * megabyte), megabyte)
+        XCTAssertEqual(SegmentedFileDownloader.streamingTailLength(forFileName: "video.webm", fileSize: 128 * megabyte), 4 * megabyte)
+        XCTAssertEqual(SegmentedFileDownloader.streamingTailLength(forFileName: "video.mkv", fileSize: 4096 * megabyte), 16 * megabyte)
+        XCTAssertEqual(SegmentedFileDownloader.streamingTailLength(forFileName: "recording.ts", fileSize: 128 * megabyte), 0)
+        XCTAssertNil(SegmentedFileDownloader.streamingTailLength(forFileName: "document.pdf", fileSize: 128 * megabyte))
+    }
+}
@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class UsernamePaletteIndexesTests: XCTestCase {
+
+    // Size of the palette of the ColorGenerator (3 * 6 steps)
+    let paletteSize = 18
+
+    // Calculated with the algorithm of the web client (sum of the hex digits of the MD5 hash of the lowercased username)
+    let goldenVectors: [(username: String, hexDigitSum: Int)] = [
+        ("admin", 202),
+        ("alice", 250),
+        ("Bob", 242),
+        ("user1", 265),
+        ("guest", 211),
+        ("Max.Mustermann@example.com", 220),
+        ("Jürgen", 245),
+        ("ÄÖÜ", 218),
+        ("", 246)
+    ]
+
+    let usernames = (0..<1000).map { "user\($0)@cloud.example.com" }
+
+    func testPaletteIndexMatchesWebClient() {
+        for (username, hexDigitSum) in goldenVectors {
+            XCTAssertEqual(UsernamePaletteIndexes.paletteIndex(for: username, paletteSize: paletteSize), hexDigitSum % paletteSize, username)
+            XCTAssertEqual(UsernamePaletteIndexes.paletteIndex(for: username, paletteSize: 1000), hexDigitSum, username)
+        }
+    }
+
+    func testPaletteIndexIsCaseInsensitive() {
+        XCTAssertEqual(UsernamePaletteIndexes.paletteIndex(for: "ADMIN", paletteSize: paletteSize),
+                       UsernamePaletteIndexes.paletteIndex(for: "admin", paletteSize: paletteSize))
+    }
+
+    func testCachedPaletteIndexesMatchUncachedOnes() {
+        // Less capacity than usernames, so the lookups are a mix of cached and evicted entries
+        let paletteIndexes = UsernamePaletteIndexes(paletteSize: paletteSize, capacity: 100)
+
+        for _ in 0..<2 {
+            for username in usernames {
+                XCTAssertEqual(paletteIndexes.paletteIndex(for: username), UsernamePaletteIndexes.paletteIndex(for: username, paletteSize: paletteSize))
+            }
+        }
+    }
+
+    // MARK: - Performance
+
+    func testUncachedLookupPerformance() {
+        measure {
+            for username in usernames {
+                _ = UsernamePaletteIndexes.paletteIndex(for: username, paletteSize: paletteSize)
+            }
+        }
+    }
+
+    func testCachedLookupPerformance() {
+        let paletteIndexes = UsernamePaletteIndexes(paletteSize: paletteSize, capacity: usernames.count)
+
+        for username in usernames {
+            _ = paletteIndexes.paletteIndex(for: username)
+        }
+
+        measure {
+            for username in usernames {
+                _ = paletteIndexes.paletteIndex(for: username)
+            }
+        }
+    }
+}
@@ -0,0 +1,210 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class VideoTileVisibilityControllerTests: XCTestCase {
+
+    // Applies the actions like the call view does and fails on actions that can't be applied
+    private struct RendererModel {
+        var attachedRenderers: [String: Int] = [:]
+        var idleRenderers = Set<Int>()
+        var discardedRenderers = Set<Int>()
+        var pausedPeers = Set<String>()
+
+        mutating func apply(_ actions: [VideoTileAction], file: StaticString = #filePath, line: UInt = #line) {
+            for action in actions {
+                switch action {
+                case .attach(let peerIdentifier, let renderer):
+                    XCTAssertNil(attachedRenderers[peerIdentifier], "\(peerIdentifier) already has a renderer", file: file, line: line)
+                    XCTAssertFalse(attachedRenderers.values.contains(renderer), "Renderer \(renderer) is already attached", file: file, line: line)
+                    XCTAssertFalse(discardedRenderers.contains(renderer), "Renderer \(renderer) was discarded", file: file, line: line)
+
+                    idleRenderers.remove(renderer)
+                    attachedRenderers[peerIdentifier] = renderer
+                case .detach(let peerIdentifier, let renderer):
+                    XCTAssertEqual(attachedRenderers.removeValue(forKey: peerIdentifier), renderer, file: file, line: line)
+                    idleRenderers.insert(renderer)
+                case .discard(let renderer):
+                    XCTAssertNotNil(idleRenderers.remove(renderer), "Renderer \(renderer) is not idle", file: file, line: line)
+                    discardedRenderers.insert(renderer)
+                case .pauseVideo(let peerIdentifier):
+                    XCTAssertTrue(pausedPeers.insert(peerIdentifier).inserted, "\(peerIdentifier) is already paused", file: file, line: line)
+                case .resumeVideo(let peerIdentifier):
+                    XCTAssertNotNil(pausedPeers.remove(peerIdentifier), "\(peerIdentifier) is not paused", file: file, line: line)
+                }
+            }
+        }
+
+        // Peers that are gone are not resumed
+        mutating func forget(_ peerIdentifier: String) {
+            pausedPeers.remove(peerIdentifier)
+        }
+    }
+
+    // MARK: - Renderers
+
+    func testVisibleVideoPeersGetARenderer() {
+        let controller = VideoTileVisibilityController()
+
+        XCTAssertEqual(controller.addVideoPeer("a"), [])
+        XCTAssertEqual(controller.updateVisiblePeers(["a", "b"]), [.attach(peerIdentifier: "a", renderer: 1)])
+        XCTAssertEqual(controller.addVideoPeer("b"), [.attach(peerIdentifier: "b", renderer: 2)])
+
+        XCTAssertEqual(controller.updateVisiblePeers(["b"]), [.detach(peerIdentifier: "a", renderer: 1)])
+        XCTAssertEqual(controller.idleRenderers, [1])
+
+        // Idle renderers are reused
+        XCTAssertEqual(controller.updateVisiblePeers(["a", "b"]), [.attach(peerIdentifier: "a", renderer: 1)])
+        XCTAssertEqual(controller.numberOfRenderers, 2)
+    }
+
+    func testIdleRenderersAreBounded() {
+        let controller = VideoTileVisibilityController(maxIdleRenderers: 2)
+        let peers = (0..<6).map { "peer-\($0)" }
+        var model = RendererModel()
+
+        for peer in peers {
+            model.apply(controller.addVideoPeer(peer))
+        }
+
+        model.apply(controller.updateVisiblePeers(Set(peers)))
+        XCTAssertEqual(controller.numberOfRenderers, 6)
+
+        let actions = controller.updateVisiblePeers(["peer-0"])
+        model.apply(actions)
+
+        XCTAssertEqual(actions.filter { if case .discard = $0 { return true } else { return false } }.count, 3)
+        XCTAssertEqual(controller.numberOfRenderers, 3)
+        XCTAssertEqual(model.idleRenderers.count, 2)
+    }
+
+    func testReplacingAVisiblePeerAttachesTheSameRendererAgain() {
+        let controller = VideoTileVisibilityController()
+
+        _ = controller.addVideoPeer("a")
+        _ = controller.updateVisiblePeers(["a"])
+
+        // The renderer is detached from the previous stream before it's attached to the new one
+        XCTAssertEqual(controller.replaceVideoPeer("a"), [.detach(peerIdentifier: "a", renderer: 1), .attach(peerIdentifier: "a", renderer: 1)])
+        XCTAssertEqual(controller.numberOfRenderers, 1)
+    }
+
+    func testReplacingAHiddenPeerKeepsItPaused() {
+        let controller = VideoTileVisibilityController()
+        controller.pausesHiddenPeers = true
+
+        XCTAssertEqual(controller.addVideoPeer("a"), [.pauseVideo(peerIdentifier: "a")])
+        XCTAssertEqual(controller.replaceVideoPeer("a"), [])
+        XCTAssertEqual(controller.pausedPeers, ["a"])
+
+        // A peer that didn't send video before is handled like a new video peer
+        XCTAssertEqual(controller.replaceVideoPeer("b"), [.pauseVideo(peerIdentifier: "b")])
+    }
+
+    // MARK: - Pausing
+
+    func testHiddenPeersArePausedAndResumedWhenVisible() {
+        let controller = VideoTileVisibilityController()
+        controller.pausesHiddenPeers = true
+
+        XCTAssertEqual(controller.addVideoPeer("a"), [.pauseVideo(peerIdentifier: "a")])
+        XCTAssertEqual(controller.updateVisiblePeers(["a"]), [.resumeVideo(peerIdentifier: "a"), .attach(peerIdentifier: "a", renderer: 1)])
+        XCTAssertEqual(controller.updateVisiblePeers([]), [.detach(peerIdentifier: "a", renderer: 1), .pauseVideo(peerIdentifier: "a")])
+
+        // Peers that left are not resumed
+        XCTAssertEqual(controller.removeVideoPeer("a"), [])
+        XCTAssertTrue(controller.pausedPeers.isEmpty)
+    }
+
+    func testPeersAreNotPausedWithoutMCU() {
+        let controller = VideoTileVisibilityController()
+
+        XCTAssertEqual(controller.addVideoPeer("a"), [])
+        XCTAssertEqual(controller.updateVisiblePeers(["b"]), [])
+        XCTAssertTrue(controller.pausedPeers.isEmpty)
+    }
+
+    func testRemoveAllDiscardsAllRenderers() {
+        let controller = VideoTileVisibilityController()
+        var model = RendererModel()
+
+        model.apply(controller.addVideoPeer("a"))
+        model.apply(controller.addVideoPeer("b"))
+        model.apply(controller.updateVisiblePeers(["a", "b"]))
+        model.apply(controller.removeAll())
+
+        XCTAssertEqual(controller.numberOfRenderers, 0)
+        XCTAssertTrue(model.attachedRenderers.isEmpty)
+        XCTAssertTrue(model.idleRenderers.isEmpty)
+        XCTAssertEqual(model.discardedRenderers, [1, 2])
+    }
+
+    // MARK: - Invariants
+
+    func testRandomUpdatesKeepTheRendererBound() {
+        var generator = SystemRandomNumberGenerator()
+        let peers = (0..<12).map { "peer-\($0)" }
+
+        for _ in 0..<50 {
+            let controller = VideoTileVisibilityController()
+            controller.pausesHiddenPeers = Bool.random(using: &generator)
+
+            var model = RendererModel()
+            var videoPeers = Set<String>()
+            var visiblePeers = Set<String>()
+
+            for _ in 0..<200 {
+                let peer = peers.randomElement(using: &generator)!
+
+                switch Int.random(in: 0..<10, using: &generator) {
+                case 0..<3:
+                    videoPeers.insert(peer)
+                    model.apply(controller.addVideoPeer(peer))
+                case 3..<5:
+                    videoPeers.remove(peer)
+                    visiblePeers.remove(peer)
+                    model.forget(peer)
+                    model.apply(controller.removeVideoPeer(peer))
+                case 5:
+                    videoPeers.insert(peer)
+                    model.apply(controller.replaceVideoPeer(peer))
+                default:
+                    visiblePeers = Set(peers.filter { _ in Int.random(in: 0..<3, using: &generator) == 0 })
+                    model.apply(controller.updateVisiblePeers(visiblePeers))
+                }
+
+                let visibleVideoPeers = videoPeers.intersection(visiblePeers)
+
+                // One renderer per visible peer with video, plus at most 2 idle renderers
+                XCTAssertEqual(Set(model.attachedRenderers.keys), visibleVideoPeers)
+                XCTAssertLessThanOrEqual(controller.numberOfRenderers, visibleVideoPeers.count + 2)
+                XCTAssertEqual(controller.numberOfRenderers, model.attachedRenderers.count + model.idleRenderers.count)
+
+                // Every pause is followed by a resume before the next pause, only hidden peers are paused
+                XCTAssertEqual(model.pausedPeers, controller.pausesHiddenPeers ? videoPeers.subtracting(visiblePeers) : [])
+                XCTAssertEqual(model.pausedPeers, controller.pausedPeers)
+            }
+        }
+    }
+}
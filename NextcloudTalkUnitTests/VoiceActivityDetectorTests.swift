@@ -0,0 +1,245 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+import XCTest
+@testable import NextcloudTalkCore
+
+final class VoiceActivityDetectorTests: XCTestCase {
+
+    // Part of an energy trace with a constant level, as the features of 10ms frames would report it
+    private struct TraceSegment {
+        let duration: Int
+        let level: Float
+        var zeroCrossingRate: Float = 0.08
+        var isSpeech = false
+
+        static func silence(_ duration: Int, level: Float = -60) -> TraceSegment {
+            return TraceSegment(duration: duration, level: level, zeroCrossingRate: 0.05)
+        }
+
+        static func speech(_ duration: Int, level: Float = -30) -> TraceSegment {
+            return TraceSegment(duration: duration, level: level, isSpeech: true)
+        }
+    }
+
+    private struct Transition: Equatable {
+        let transition: VoiceActivityTransition
+        // Milliseconds since the start of the trace
+        let time: Int
+    }
+
+    private let frameDuration = 10
+
+    // Replays the trace in 10ms frames, with a deterministic jitter of ±0.5 dB on the levels
+    private func replay(_ trace: [TraceSegment], detector: VoiceActivityDetector = VoiceActivityDetector()) -> [Transition] {
+        var generator = SeededGenerator(seed: 1)
+        var transitions: [Transition] = []
+        var time = 0
+
+        for segment in trace {
+            for _ in 0..<(segment.duration / frameDuration) {
+                let level = segment.level + Float.random(in: -0.5...0.5, using: &generator)
+                let rms = powf(10, level / 20)
+
+                if let transition = detector.process(rms: rms, zeroCrossingRate: segment.zeroCrossingRate, duration: Float(frameDuration) / 1000) {
+                    transitions.append(Transition(transition: transition, time: time))
+                }
+
+                time += frameDuration
+            }
+        }
+
+        return transitions
+    }
+
+    private func assertTransition(_ transition: Transition?, is expected: VoiceActivityTransition, within range: ClosedRange<Int>,
+                                  file: StaticString = #filePath, line: UInt = #line) {
+        guard let transition else {
+            XCTFail("Missing transition \(expected)", file: file, line: line)
+            return
+        }
+
+        XCTAssertEqual(transition.transition, expected, file: file, line: line)
+        XCTAssertTrue(range.contains(transition.time), "\(expected) at \(transition.time)ms, expected within \(range)", file: file, line: line)
+    }
+
+    // MARK: - Traces
+
+    func testSpeechIsDetectedAfterTheAttackTime() {
+        let transitions = replay([.silence(1000), .speech(1500), .silence(1500)])
+
+        XCTAssertEqual(transitions.count, 2)
+        // 30ms attack
+        assertTransition(transitions.first, is: .startedSpeaking, within: 1020...1040)
+        // 600ms release
+        assertTransition(transitions.last, is: .stoppedSpeaking, within: 3080...3110)
+    }
+
+    func testPausesShorterThanTheHangoverDontStopSpeaking() {
+        let transitions = replay([.silence(1000), .speech(1500), .silence(300), .speech(1200), .silence(1500)])
+
+        XCTAssertEqual(transitions.count, 2)
+        assertTransition(transitions.first, is: .startedSpeaking, within: 1020...1040)
+        assertTransition(transitions.last, is: .stoppedSpeaking, within: 4580...4610)
+    }
+
+    func testPausesLongerThanTheHangoverStopSpeaking() {
+        let transitions = replay([.silence(1000), .speech(500), .silence(1000), .speech(500), .silence(1000)])
+
+        XCTAssertEqual(transitions.map { $0.transition }, [.startedSpeaking, .stoppedSpeaking, .startedSpeaking, .stoppedSpeaking])
+        assertTransition(transitions[1], is: .stoppedSpeaking, within: 2080...2110)
+        assertTransition(transitions[2], is: .startedSpeaking, within: 2520...2540)
+    }
+
+    func testQuietSpeechContinuesButDoesNotStartSpeaking() {
+        // -52 dBFS is below the minimum speech level of -50 dBFS, but above the lowered threshold while speaking
+        let continued = replay([.silence(1000), .speech(300), .speech(1000, level: -52), .silence(1500)])
+
+        XCTAssertEqual(continued.count, 2)
+        assertTransition(continued.first, is: .startedSpeaking, within: 1020...1040)
+        assertTransition(continued.last, is: .stoppedSpeaking, within: 2880...2910)
+
+        XCTAssertTrue(replay([.silence(1000), .speech(1000, level: -52), .silence(1500)]).isEmpty)
+    }
+
+    func testQuietSpeechStopsWithoutThresholdHysteresis() {
+        let detector = VoiceActivityDetector()
+        detector.speakingThresholdFactor = 1
+
+        let transitions = replay([.silence(1000), .speech(300), .speech(1000, level: -52), .silence(1500)], detector: detector)
+
+        XCTAssertEqual(transitions.count, 2)
+        assertTransition(transitions.last, is: .stoppedSpeaking, within: 1880...1910)
+    }
+
+    func testSilenceAndNoiseAreNotSpeech() {
+        XCTAssertTrue(replay([.silence(5000)]).isEmpty)
+        XCTAssertTrue(replay([.silence(5000, level: -90)]).isEmpty)
+
+        // Loud, but with a noise-like zero-crossing rate
+        let noise = TraceSegment(duration: 2000, level: -30, zeroCrossingRate: 0.5)
+        XCTAssertTrue(replay([.silence(1000), noise, .silence(1000)]).isEmpty)
+    }
+
+    func testSpeakingFromTheStartIsDetected() {
+        let transitions = replay([.speech(1000), .silence(1000)])
+
+        XCTAssertEqual(transitions.count, 2)
+        assertTransition(transitions.first, is: .startedSpeaking, within: 20...40)
+    }
+
+    func testResetForgetsTheSpeakingState() {
+        let detector = VoiceActivityDetector()
+
+        XCTAssertEqual(replay([.silence(500), .speech(500)], detector: detector).count, 1)
+        XCTAssertTrue(detector.isSpeaking)
+
+        detector.reset()
+
+        XCTAssertFalse(detector.isSpeaking)
+        XCTAssertEqual(detector.noiseFloor, 0)
+    }
+
+    // MARK: - PCM frames
+
+    private func pcmFrame(sampleCount: Int, channels: Int = 1, sample: (Int) -> Float) -> [Int16] {
+        var samples = [Int16](repeating: 0, count: sampleCount * channels)
+
+        for index in 0..<sampleCount {
+            for channel in 0..<channels {
+                samples[index * channels + channel] = Int16(sample(index) * Float(Int16.max))
+            }
+        }
+
+        return samples
+    }
+
+    private func process(_ frames: [[Int16]], detector: VoiceActivityDetector, channels: Int = 1) -> [VoiceActivityTransition] {
+        return frames.compactMap { frame in
+            frame.withUnsafeBufferPointer { detector.process(samples: $0, sampleRate: 48000, channels: channels) }
+        }
+    }
+
+    func testToneIsSpeechAndWhiteNoiseIsNot() {
+        var generator = SeededGenerator(seed: 2)
+        let silence = pcmFrame(sampleCount: 480) { _ in 0.001 }
+        // 200 Hz at -23 dBFS, 4 zero crossings per 10ms
+        let tone = pcmFrame(sampleCount: 480) { sinf(2 * .pi * 200 * Float($0) / 48000) * 0.1 }
+        let noise = pcmFrame(sampleCount: 480) { _ in Float.random(in: -0.1...0.1, using: &generator) }
+
+        let toneDetector = VoiceActivityDetector()
+        XCTAssertEqual(process(Array(repeating: silence, count: 50) + Array(repeating: tone, count: 50), detector: toneDetector), [.startedSpeaking])
+
+        let noiseDetector = VoiceActivityDetector()
+        XCTAssertTrue(process(Array(repeating: silence, count: 50) + Array(repeating: noise, count: 50), detector: noiseDetector).isEmpty)
+    }
+
+    func testInterleavedChannelsAreProcessedSeparately() {
+        // A low tone on both channels, interleaving must not turn it into zero crossings between the channels
+        let tone = pcmFrame(sampleCount: 480, channels: 2) { sinf(2 * .pi * 200 * Float($0) / 48000) * 0.1 }
+        var inverted = tone
+
+        for index in stride(from: 1, to: inverted.count, by: 2) {
+            inverted[index] = -inverted[index]
+        }
+
+        XCTAssertEqual(process(Array(repeating: inverted, count: 10), detector: VoiceActivityDetector(), channels: 2), [.startedSpeaking])
+    }
+
+    // MARK: - Performance
+
+    func testFramePerformance() {
+        var generator = SeededGenerator(seed: 3)
+        // 10 seconds of 10ms frames at 48 kHz
+        let frames = (0..<1000).map { _ in
+            pcmFrame(sampleCount: 480) { index in
+                sinf(2 * .pi * 200 * Float(index) / 48000) * 0.1 + Float.random(in: -0.01...0.01, using: &generator)
+            }
+        }
+
+        measure(metrics: [XCTClockMetric()]) {
+            let detector = VoiceActivityDetector()
+
+            for frame in frames {
+                _ = frame.withUnsafeBufferPointer { detector.process(samples: $0, sampleRate: 48000) }
+            }
+        }
+    }
+}
+
+// Deterministic random numbers, so the traces are the same in every run
+private struct SeededGenerator: RandomNumberGenerator {
+    private var state: UInt64
+
+    init(seed: UInt64) {
+        state = seed
+    }
+
+    mutating func next() -> UInt64 {
+        // SplitMix64
+        state &+= 0x9E3779B97F4A7C15
+        var value = state
+        value = (value ^ (value >> 30)) &* 0xBF58476D1CE4E5B9
+        value = (value ^ (value >> 27)) &* 0x94D049BB133111EB
+        return value ^ (value >> 31)
+    }
+}
@@ -0,0 +1,106 @@
+// swift-tools-version:5.7
+
+import Foundation
+import PackageDescription
+
+// The app is built with the Xcode project. This package only contains the parts of the app that don't depend on
+// UIKit or Objective-C, so their unit tests can be run with `swift test`, also on Linux.
+let coreSources = [
+    "BlurMaskScheduler.swift",
+    "CallStatsHistory.swift",
+    "CaptureFormatGovernor.swift",
+    "ChatFileCachePolicy.swift",
+    "ChatMessageFullTextIndex.swift",
+    "LRUCache.swift",
+    "MarkdownParseCache.swift",
+    "MentionSuggestionEngine.swift",
+    "PeerRowIndex.swift",
+    "PreviewImageDownsampler.swift",
+    "ReferenceDataStore.swift",
+    "RoomListDiff.swift",
+    "RoomRefreshQueue.swift",
+    "RoomSearchIndex.swift",
+    "SegmentedFileDownloader.swift",
+    "UsernamePaletteIndexes.swift",
+    "VideoTileVisibilityController.swift",
+    "VoiceActivityDetector.swift"
+]
+
+// Everything else in the app directory (sources, resources, localizations) is not part of the package
+let appDirectory = URL(fileURLWithPath: #filePath).deletingLastPathComponent().appendingPathComponent("NextcloudTalk")
+let appFiles = (try? FileManager.default.contentsOfDirectory(atPath: appDirectory.path)) ?? []
+
+let package = Package(
+    name: "NextcloudTalkCore",
+    platforms: [
+        .macOS(.v10_15),
+        .iOS(.v15)
+    ],
+    dependencies: [
+        // CryptoKit is not available on Linux
+        .package(url: "https://github.com/apple/swift-crypto.git", "2.0.0" ..< "4.0.0")
+    ],
+    targets: [
+        .target(
+            name: "NextcloudTalkCore",
+            dependencies: [
+                .product(name: "Crypto", package: "swift-crypto", condition: .when(platforms: [.linux]))
+            ],
+            path: "NextcloudTalk",
+            exclude: appFiles.filter { !coreSources.contains($0) },
+            sources: coreSources
+        ),
+        .testTarget(
+            name: "NextcloudTalkUnitTests",
+            dependencies: ["NextcloudTalkCore"],
+            path: "NextcloudTalkUnitTests"
+        )
+    ]
+)
+
+#if os(Linux)
+// SQLite is part of the SDK on Apple platforms
+package.targets.append(
+    .systemLibrary(
+        name: "CSQLite",
+        path: "NextcloudTalk/CSQLite",
+        pkgConfig: "sqlite3",
+        providers: [.apt(["libsqlite3-dev"])]
+    )
+)
+
+package.targets.first { $0.name == "NextcloudTalkCore" }?.dependencies.append("CSQLite")
+#endif
+
+#if !os(Linux)
+// Objective-C parts are only part of the package (and tested) on Apple platforms
+let objCCoreSources = [
+    "NCAddressBookDiff.m",
+    "NCChatOutboxRetryPolicy.m",
+    "NCChatOutboxSendQueue.m",
+    "NCCompiledServerCapabilities.m",
+    "NCLogger.m",
+    "NCReadModelCache.m"
+]
+
+// Same version as in the Xcode project
+package.dependencies.append(.package(url: "https://github.com/realm/realm-swift.git", exact: "10.41.1"))
+
+package.targets.append(
+    .target(
+        name: "NextcloudTalkObjCCore",
+        dependencies: [
+            .product(name: "Realm", package: "realm-swift")
+        ],
+        path: "NextcloudTalk",
+        exclude: appFiles.filter { !objCCoreSources.contains($0) && $0 != "ObjCCore" },
+        sources: objCCoreSources,
+        publicHeadersPath: "ObjCCore"
+    )
+)
+
+package.targets.first { $0.name == "NextcloudTalkUnitTests" }?.dependencies += [
+    "NextcloudTalkObjCCore",
+    .product(name: "Realm", package: "realm-swift")
+]
+#endif
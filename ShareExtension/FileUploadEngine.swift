@@ -0,0 +1,481 @@
+//
+// Copyright (c) 2026 agent <agent@local>
+//
+// Author agent <agent@local>
+//
+// GNU GPL version 3 or any later version
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+import Foundation
+import CryptoKit
+
+private struct ChunkedUploadState: Codable {
+    var uploadId: String
+    var destinationURL: String
+    var fileSize: Int64
+    var chunkSize: Int64
+    var uploadedChunks: Set<Int>
+
+    var numberOfChunks: Int {
+        return Int((fileSize + chunkSize - 1) / chunkSize)
+    }
+}
+
+private class FileUploadJob {
+    let localPath: String
+    let fileName: String
+    let progressBlock: ((_ fractionCompleted: Double) -> Void)?
+    let completionBlock: (_ fileServerPath: String?, _ errorDescription: String?) -> Void
+
+    var fileServerURL: String?
+    var fileServerPath: String?
+    var fileSize: Int64 = 0
+    var attempt = 0
+    var attachmentFolderChecked = false
+    var progressObservation: NSKeyValueObservation?
+
+    init(localPath: String, fileName: String, progressBlock: ((_ fractionCompleted: Double) -> Void)?, completionBlock: @escaping (_ fileServerPath: String?, _ errorDescription: String?) -> Void) {
+        self.localPath = localPath
+        self.fileName = fileName
+        self.progressBlock = progressBlock
+        self.completionBlock = completionBlock
+    }
+}
+
+/// Uploads files to the attachment folder of an account with a limited number of parallel uploads.
+/// Large files are uploaded with the chunked upload v2 API, the upload state is stored on disk so that an
+/// interrupted upload can be resumed from the last uploaded chunk. Transient failures are retried with an exponential backoff.
+@objcMembers class FileUploadEngine: NSObject, URLSessionTaskDelegate {
+
+    public let account: TalkAccount
+    public var maxConcurrentUploads = 3
+    public var maxRetries = 4
+    public var chunkSize: Int64 = 10 * 1024 * 1024
+
+    private let userAgent = "Mozilla/5.0 (iOS) Nextcloud-Talk v\(Bundle.main.infoDictionary?["CFBundleShortVersionString"] as? String ?? "")"
+    private let engineQueue = DispatchQueue(label: "com.nextcloud.Talk.FileUploadEngine")
+    private var pendingJobs: [FileUploadJob] = []
+    private var activeJobs = 0
+
+    // The session retains its delegate, so it's only kept around while there are uploads running
+    private var urlSession: URLSession?
+
+    private var session: URLSession {
+        if let urlSession {
+            return urlSession
+        }
+
+        let configuration = URLSessionConfiguration.default
+        configuration.httpCookieStorage = HTTPCookieStorage.sharedCookieStorage(forGroupContainerIdentifier: account.accountId)
+        configuration.timeoutIntervalForRequest = 60
+
+        let session = URLSession(configuration: configuration, delegate: self, delegateQueue: nil)
+        urlSession = session
+
+        return session
+    }
+
+    private lazy var uploadStateDirectory: URL? = {
+        guard let groupURL = FileManager.default.containerURL(forSecurityApplicationGroupIdentifier: groupIdentifier) else { return nil }
+
+        let directoryURL = groupURL.appendingPathComponent("UploadState", isDirectory: true)
+        try? FileManager.default.createDirectory(at: directoryURL, withIntermediateDirectories: true)
+
+        return directoryURL
+    }()
+
+    public init(account: TalkAccount) {
+        self.account = account
+        super.init()
+    }
+
+    // MARK: - Public
+
+    public func uploadFile(atPath localPath: String, withName fileName: String,
+                           progressBlock: ((_ fractionCompleted: Double) -> Void)?,
+                           completionBlock: @escaping (_ fileServerPath: String?, _ errorDescription: String?) -> Void) {
+
+        let job = FileUploadJob(localPath: localPath, fileName: fileName, progressBlock: progressBlock, completionBlock: completionBlock)
+
+        engineQueue.async {
+            self.pendingJobs.append(job)
+            self.startPendingJobs()
+        }
+    }
+
+    // MARK: - Scheduling
+
+    private func startPendingJobs() {
+        dispatchPrecondition(condition: .onQueue(engineQueue))
+
+        while activeJobs < max(maxConcurrentUploads, 1), !pendingJobs.isEmpty {
+            let job = pendingJobs.removeFirst()
+            activeJobs += 1
+
+            DispatchQueue.main.async {
+                self.start(job)
+            }
+        }
+    }
+
+    private func start(_ job: FileUploadJob) {
+        let attributes = try? FileManager.default.attributesOfItem(atPath: job.localPath)
+        job.fileSize = (attributes?[.size] as? NSNumber)?.int64Value ?? 0
+
+        NCAPIController.sharedInstance().uniqueNameForFileUpload(withName: job.fileName, originalName: true, for: account) { fileServerURL, fileServerPath, errorCode, errorDescription in
+            guard let fileServerURL, let fileServerPath else {
+                if self.shouldRetry(job, errorCode: errorCode) {
+                    self.retry(job) { self.start(job) }
+                } else {
+                    self.finish(job, fileServerPath: nil, errorDescription: errorDescription)
+                }
+
+                return
+            }
+
+            job.fileServerURL = fileServerURL
+            job.fileServerPath = fileServerPath
+
+            self.upload(job)
+        }
+    }
+
+    private func upload(_ job: FileUploadJob) {
+        if job.fileSize > chunkSize, self.serverSupportsChunkingV2() {
+            self.uploadChunked(job)
+        } else {
+            self.uploadSingleRequest(job)
+        }
+    }
+
+    private func finish(_ job: FileUploadJob, fileServerPath: String?, errorDescription: String?) {
+        job.progressObservation = nil
+
+        var errorDescription = errorDescription
+
+        if fileServerPath == nil, errorDescription == nil {
+            errorDescription = NSLocalizedString("Upload failed", comment: "")
+        }
+
+        DispatchQueue.main.async {
+            job.completionBlock(fileServerPath, errorDescription)
+        }
+
+        engineQueue.async {
+            self.activeJobs -= 1
+            self.startPendingJobs()
+
+            if self.activeJobs == 0 {
+                DispatchQueue.main.async {
+                    self.invalidateSessionIfIdle()
+                }
+            }
+        }
+    }
+
+    private func invalidateSessionIfIdle() {
+        let isIdle = engineQueue.sync { activeJobs == 0 && pendingJobs.isEmpty }
+
+        if isIdle {
+            urlSession?.finishTasksAndInvalidate()
+            urlSession = nil
+        }
+    }
+
+    // MARK: - Error handling
+
+    private func handleUploadError(_ job: FileUploadJob, errorCode: Int, errorDescription: String?) {
+        if (errorCode == 404 || errorCode == 409), !job.attachmentFolderChecked {
+            // The attachment folder might not exist yet
+            job.attachmentFolderChecked = true
+
+            NCAPIController.sharedInstance().checkOrCreateAttachmentFolder(for: account) { created, _ in
+                if created {
+                    self.upload(job)
+                } else {
+                    self.finish(job, fileServerPath: nil, errorDescription: errorDescription)
+                }
+            }
+        } else if self.shouldRetry(job, errorCode: errorCode) {
+            self.retry(job) { self.upload(job) }
+        } else {
+            self.finish(job, fileServerPath: nil, errorDescription: errorDescription)
+        }
+    }
+
+    private func shouldRetry(_ job: FileUploadJob, errorCode: Int) -> Bool {
+        guard job.attempt < maxRetries else { return false }
+
+        // Network errors (NSURLError codes are negative) except cancellations
+        if errorCode < 0 {
+            return errorCode != NSURLErrorCancelled
+        }
+
+        // Request timeout, locked, too many requests and server errors (except insufficient storage)
+        return errorCode == 408 || errorCode == 423 || errorCode == 429 || (errorCode >= 500 && errorCode != 507)
+    }
+
+    private func retry(_ job: FileUploadJob, block: @escaping () -> Void) {
+        // Exponential backoff with jitter: ~1s, 2s, 4s, 8s...
+        let delay = pow(2.0, Double(job.attempt)) + Double.random(in: 0...0.5)
+        job.attempt += 1
+
+        NSLog("Retrying upload of %@ in %.1fs (attempt %ld)", job.fileName, delay, job.attempt)
+
+        DispatchQueue.main.asyncAfter(deadline: .now() + delay, execute: block)
+    }
+
+    // MARK: - Single request upload
+
+    private func uploadSingleRequest(_ job: FileUploadJob) {
+        guard let fileServerURL = job.fileServerURL,
+              let encodedURLString = fileServerURL.addingPercentEncoding(withAllowedCharacters: .urlPathAllowed),
+              let url = URL(string: encodedURLString)
+        else {
+            self.finish(job, fileServerPath: nil, errorDescription: NSLocalizedString("Invalid upload URL", comment: ""))
+            return
+        }
+
+        var request = URLRequest(url: url)
+        request.httpMethod = "PUT"
+        request.setValue(NCAPIController.sharedInstance().authHeader(for: account), forHTTPHeaderField: "Authorization")
+        request.setValue(userAgent, forHTTPHeaderField: "User-Agent")
+
+        // Upload directly from the file, so we never load the whole file into memory
+        let task = session.uploadTask(with: request, fromFile: URL(fileURLWithPath: job.localPath)) { _, response, error in
+            let statusCode = self.statusCode(for: response, error: error)
+
+            DispatchQueue.main.async {
+                if (200..<300).contains(statusCode) {
+                    self.finish(job, fileServerPath: job.fileServerPath, errorDescription: nil)
+                } else {
+                    self.handleUploadError(job, errorCode: statusCode, errorDescription: error?.localizedDescription)
+                }
+            }
+        }
+
+        self.observeProgress(of: task, for: job, alreadyUploadedBytes: 0)
+        task.resume()
+    }
+
+    private func observeProgress(of task: URLSessionTask, for job: FileUploadJob, alreadyUploadedBytes: Int64) {
+        let fileSize = Double(max(job.fileSize, 1))
+
+        job.progressObservation = task.progress.observe(\.completedUnitCount) { progress, _ in
+            let fractionCompleted = min(Double(alreadyUploadedBytes + progress.completedUnitCount) / fileSize, 1.0)
+
+            DispatchQueue.main.async {
+                job.progressBlock?(fractionCompleted)
+            }
+        }
+    }
+
+    // MARK: - Chunked upload
+
+    private func serverSupportsChunkingV2() -> Bool {
+        // Chunked upload v2 (with a destination header) is available since Nextcloud 26
+        let serverCapabilities = NCDatabaseManager.sharedInstance().serverCapabilities(forAccountId: account.accountId)
+        return (serverCapabilities?.versionMajor ?? 0) >= 26
+    }
+
+    private func uploadChunked(_ job: FileUploadJob) {
+        guard let fileServerURL = job.fileServerURL,
+              let destinationURL = fileServerURL.addingPercentEncoding(withAllowedCharacters: .urlPathAllowed)
+        else {
+            self.finish(job, fileServerPath: nil, errorDescription: NSLocalizedString("Invalid upload URL", comment: ""))
+            return
+        }
+
+        let state = self.loadUploadState(forDestination: destinationURL, fileSize: job.fileSize)
+            ?? ChunkedUploadState(uploadId: "talk-upload-\(UUID().uuidString)", destinationURL: destinationURL, fileSize: job.fileSize, chunkSize: chunkSize, uploadedChunks: [])
+
+        self.saveUploadState(state)
+
+        let folderURL = self.uploadFolderURL(forUploadId: state.uploadId)
+        let request = self.request(withURL: folderURL, method: "MKCOL", state: state)
+
+        session.dataTask(with: request) { _, response, error in
+            let statusCode = self.statusCode(for: response, error: error)
+
+            DispatchQueue.main.async {
+                if statusCode == 405 {
+                    // The upload folder already exists, we are resuming a previous upload
+                    self.uploadNextChunk(job, state: state)
+                } else if (200..<300).contains(statusCode) {
+                    // A new upload folder was created, previously uploaded chunks (if any) are gone
+                    var newState = state
+                    newState.uploadedChunks.removeAll()
+                    self.saveUploadState(newState)
+                    self.uploadNextChunk(job, state: newState)
+                } else {
+                    self.handleUploadError(job, errorCode: statusCode, errorDescription: error?.localizedDescription)
+                }
+            }
+        }.resume()
+    }
+
+    private func uploadNextChunk(_ job: FileUploadJob, state: ChunkedUploadState) {
+        guard let chunkNumber = (1...state.numberOfChunks).first(where: { !state.uploadedChunks.contains($0) }) else {
+            self.assembleChunks(job, state: state)
+            return
+        }
+
+        let offset = Int64(chunkNumber - 1) * state.chunkSize
+        let length = min(state.chunkSize, state.fileSize - offset)
+
+        guard let chunkData = self.readChunk(fromFileAtPath: job.localPath, offset: offset, length: length) else {
+            self.removeUploadState(state)
+            self.finish(job, fileServerPath: nil, errorDescription: NSLocalizedString("Unable to read file", comment: ""))
+            return
+        }
+
+        // Chunk names need to be numbers between 1 and 10000 for chunked upload v2
+        let chunkURL = self.uploadFolderURL(forUploadId: state.uploadId).appendingPathComponent(String(format: "%05ld", chunkNumber))
+        let request = self.request(withURL: chunkURL, method: "PUT", state: state)
+        let uploadedBytes = Int64(state.uploadedChunks.count) * state.chunkSize
+        var currentState = state
+
+        let task = session.uploadTask(with: request, from: chunkData) { _, response, error in
+            let statusCode = self.statusCode(for: response, error: error)
+
+            DispatchQueue.main.async {
+                if (200..<300).contains(statusCode) {
+                    // Retries are counted per chunk, a few transient failures spread over a large upload should not fail it
+                    job.attempt = 0
+                    currentState.uploadedChunks.insert(chunkNumber)
+                    self.saveUploadState(currentState)
+                    self.uploadNextChunk(job, state: currentState)
+                } else {
+                    if statusCode == 404 {
+                        // The upload folder was removed on the server (e.g. expired), start again from the beginning
+                        self.removeUploadState(currentState)
+                    }
+
+                    self.handleUploadError(job, errorCode: statusCode, errorDescription: error?.localizedDescription)
+                }
+            }
+        }
+
+        self.observeProgress(of: task, for: job, alreadyUploadedBytes: uploadedBytes)
+        task.resume()
+    }
+
+    private func assembleChunks(_ job: FileUploadJob, state: ChunkedUploadState) {
+        let assembleURL = self.uploadFolderURL(forUploadId: state.uploadId).appendingPathComponent(".file")
+        let request = self.request(withURL: assembleURL, method: "MOVE", state: state)
+
+        session.dataTask(with: request) { _, response, error in
+            let statusCode = self.statusCode(for: response, error: error)
+
+            DispatchQueue.main.async {
+                if (200..<300).contains(statusCode) {
+                    self.removeUploadState(state)
+                    self.finish(job, fileServerPath: job.fileServerPath, errorDescription: nil)
+                } else {
+                    if statusCode == 404 {
+                        self.removeUploadState(state)
+                    }
+
+                    self.handleUploadError(job, errorCode: statusCode, errorDescription: error?.localizedDescription)
+                }
+            }
+        }.resume()
+    }
+
+    private func readChunk(fromFileAtPath path: String, offset: Int64, length: Int64) -> Data? {
+        guard let fileHandle = FileHandle(forReadingAtPath: path) else { return nil }
+
+        defer {
+            fileHandle.closeFile()
+        }
+
+        return autoreleasepool {
+            fileHandle.seek(toFileOffset: UInt64(offset))
+            return fileHandle.readData(ofLength: Int(length))
+        }
+    }
+
+    // MARK: - Requests
+
+    private func uploadFolderURL(forUploadId uploadId: String) -> URL {
+        let uploadsPath = NCAPIController.sharedInstance().uploadsPath(for: account)
+        return URL(string: "\(account.server)\(uploadsPath)")!.appendingPathComponent(uploadId)
+    }
+
+    private func request(withURL url: URL, method: String, state: ChunkedUploadState) -> URLRequest {
+        var request = URLRequest(url: url)
+        request.httpMethod = method
+        request.setValue(NCAPIController.sharedInstance().authHeader(for: account), forHTTPHeaderField: "Authorization")
+        request.setValue(userAgent, forHTTPHeaderField: "User-Agent")
+        request.setValue(state.destinationURL, forHTTPHeaderField: "Destination")
+        request.setValue(String(state.fileSize), forHTTPHeaderField: "OC-Total-Length")
+
+        return request
+    }
+
+    private func statusCode(for response: URLResponse?, error: Error?) -> Int {
+        if let error = error as NSError? {
+            return error.code
+        }
+
+        return (response as? HTTPURLResponse)?.statusCode ?? 0
+    }
+
+    // MARK: - Upload state
+
+    private func uploadStateURL(forDestination destinationURL: String, fileSize: Int64) -> URL? {
+        let stateIdentifier = "\(account.accountId)-\(destinationURL)-\(fileSize)"
+        let stateFileName = SHA256.hash(data: Data(stateIdentifier.utf8)).map { String(format: "%02x", $0) }.joined()
+
+        return uploadStateDirectory?.appendingPathComponent(stateFileName).appendingPathExtension("json")
+    }
+
+    private func loadUploadState(forDestination destinationURL: String, fileSize: Int64) -> ChunkedUploadState? {
+        guard let stateURL = self.uploadStateURL(forDestination: destinationURL, fileSize: fileSize),
+              let data = try? Data(contentsOf: stateURL),
+              let state = try? JSONDecoder().decode(ChunkedUploadState.self, from: data),
+              state.chunkSize > 0
+        else { return nil }
+
+        return state
+    }
+
+    private func saveUploadState(_ state: ChunkedUploadState) {
+        guard let stateURL = self.uploadStateURL(forDestination: state.destinationURL, fileSize: state.fileSize),
+              let data = try? JSONEncoder().encode(state)
+        else { return }
+
+        try? data.write(to: stateURL, options: .atomic)
+    }
+
+    private func removeUploadState(_ state: ChunkedUploadState) {
+        guard let stateURL = self.uploadStateURL(forDestination: state.destinationURL, fileSize: state.fileSize) else { return }
+
+        try? FileManager.default.removeItem(at: stateURL)
+    }
+
+    // MARK: - URLSessionTaskDelegate
+
+    func urlSession(_ session: URLSession, task: URLSessionTask, didReceive challenge: URLAuthenticationChallenge,
+                    completionHandler: @escaping (URLSession.AuthChallengeDisposition, URLCredential?) -> Void) {
+
+        if CCCertificate.sharedManager().checkTrustedChallenge(challenge), let serverTrust = challenge.protectionSpace.serverTrust {
+            completionHandler(.useCredential, URLCredential(trust: serverTrust))
+        } else {
+            completionHandler(.performDefaultHandling, nil)
+        }
+    }
+}
@@ -33,6 +33,8 @@ extern NSString *const kShareConfirmationTableCellNibName;
 @property (strong, nonatomic) IBOutlet UIImageView *previewView;
 @property (strong, nonatomic) IBOutlet UIImageView *placeholderImageView;
 @property (strong, nonatomic) IBOutlet UITextView *placeholderTextView;
+// File the cell currently shows, used to discard previews that finish decoding after the cell was reused
+@property (strong, nonatomic, nullable) NSURL *fileURL;
 
 - (void)setPlaceHolderImage:(UIImage *)image;
 - (void)setPlaceHolderText:(NSString *)text;
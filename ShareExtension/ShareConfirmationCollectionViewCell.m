@@ -36,6 +36,7 @@ NSString *const kShareConfirmationTableCellNibName = @"ShareConfirmationCollecti
 {
     [super prepareForReuse];
 
+    self.fileURL = nil;
     self.previewView.image = nil;
     self.placeholderImageView.image = nil;
     self.placeholderTextView.text = @"";
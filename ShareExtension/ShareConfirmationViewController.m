@@ -431,13 +431,19 @@
     _uploadFailed = NO;
     _uploadErrors = [[NSMutableArray alloc] init];
     
+    // Uploads are queued and run with limited parallelism, each file is shared as soon as its upload finished
+    FileUploadEngine *uploadEngine = [[FileUploadEngine alloc] initWithAccount:_account];
+
     for (ShareItem *item in self.shareItemController.shareItems) {
         NSLog(@"Uploading %@", item.fileURL);
         
         dispatch_group_enter(_uploadGroup);
-        [[NCAPIController sharedInstance] uniqueNameForFileUploadWithName:item.fileName originalName:YES forAccount:_account withCompletionBlock:^(NSString *fileServerURL, NSString *fileServerPath, NSInteger errorCode, NSString *errorDescription) {
-            if (fileServerURL && fileServerPath) {
-                [self uploadFileToServerURL:fileServerURL withFilePath:fileServerPath withItem:item];
+        [uploadEngine uploadFileAtPath:item.filePath withName:item.fileName progressBlock:^(double fractionCompleted) {
+            item.uploadProgress = fractionCompleted;
+            [self updateHudProgress];
+        } completionBlock:^(NSString *fileServerPath, NSString *errorDescription) {
+            if (fileServerPath) {
+                [self shareFileWithServerPath:fileServerPath];
             } else {
                 self->_uploadFailed = YES;
                 [self->_uploadErrors addObject:errorDescription];
@@ -476,40 +482,17 @@
     });
 }
 
-- (void)uploadFileToServerURL:(NSString *)fileServerURL withFilePath:(NSString *)filePath withItem:(ShareItem *)item
+- (void)shareFileWithServerPath:(NSString *)filePath
 {
-    [[NextcloudKit shared] uploadWithServerUrlFileName:fileServerURL fileNameLocalPath:item.filePath dateCreationFile:nil dateModificationFile:nil customUserAgent:nil addCustomHeaders:nil queue:dispatch_get_main_queue() taskHandler:^(NSURLSessionTask *task) {
-        NSLog(@"Upload task");
-    } progressHandler:^(NSProgress *progress) {
-        item.uploadProgress = progress.fractionCompleted;
-        [self updateHudProgress];
-    } completionHandler:^(NSString *accountId, NSString *ocId, NSString *etag, NSDate *date, int64_t size, NSDictionary *allHeaderFields, NKError *error) {
-        if (error.errorCode == 0) {
-            [[NCAPIController sharedInstance] shareFileOrFolderForAccount:self->_account atPath:filePath toRoom:self->_room.token talkMetaData:nil withCompletionBlock:^(NSError *error) {
-                if (error) {
-                    NSLog(@"Failed to send shared file");
-
-                    self->_uploadFailed = YES;
-                    [self->_uploadErrors addObject:error.description];
-                }
+    [[NCAPIController sharedInstance] shareFileOrFolderForAccount:_account atPath:filePath toRoom:_room.token talkMetaData:nil withCompletionBlock:^(NSError *error) {
+        if (error) {
+            NSLog(@"Failed to send shared file");
 
-                dispatch_group_leave(self->_uploadGroup);
-            }];
-        } else if (error.errorCode == 404 || error.errorCode == 409) {
-            [[NCAPIController sharedInstance] checkOrCreateAttachmentFolderForAccount:self->_account withCompletionBlock:^(BOOL created, NSInteger errorCode) {
-                if (created) {
-                    [self uploadFileToServerURL:fileServerURL withFilePath:filePath withItem:item];
-                } else {
-                    self->_uploadFailed = YES;
-                    [self->_uploadErrors addObject:error.errorDescription];
-                    dispatch_group_leave(self->_uploadGroup);
-                }
-            }];
-        } else {
             self->_uploadFailed = YES;
-            [self->_uploadErrors addObject:error.errorDescription];
-            dispatch_group_leave(self->_uploadGroup);
+            [self->_uploadErrors addObject:error.description];
         }
+
+        dispatch_group_leave(self->_uploadGroup);
     }];
 }
 
@@ -640,17 +623,30 @@
     // Setting placeholder here in case we can't generate any other preview
     [cell setPlaceHolderImage:item.placeholderImage];
     [cell setPlaceHolderText:item.fileName];
+    cell.fileURL = item.fileURL;
 
-    // Check if we got an image
-    UIImage *image = [self.shareItemController getImageFromItem:item];
-    
-    if (image) {
-        // We're able to get an image directly from the fileURL -> use it
-        [cell setPreviewImage:image];
-    } else {
-        // We need to generate our own preview/thumbnail here
-        [self generatePreviewForCell:cell withCollectionView:collectionView withItem:item];
-    }
+    // Check if we got an image, decoding happens in the background to keep scrolling smooth
+    CGFloat maxPointSize = MAX(collectionView.bounds.size.width, collectionView.bounds.size.height);
+    CGFloat scale = [UIScreen mainScreen].scale;
+    NSInteger maxPixelSize = ceil(maxPointSize * scale);
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        UIImage *image = [self.shareItemController getThumbnailFromItem:item withMaxPixelSize:maxPixelSize scale:scale];
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (![cell.fileURL isEqual:item.fileURL]) {
+                return;
+            }
+
+            if (image) {
+                // We're able to get an image directly from the fileURL -> use it
+                [cell setPreviewImage:image];
+            } else {
+                // We need to generate our own preview/thumbnail here
+                [self generatePreviewForCell:cell withCollectionView:collectionView withItem:item];
+            }
+        });
+    });
     
     return cell;
 }
@@ -668,7 +664,9 @@
         }
 
         dispatch_async(dispatch_get_main_queue(), ^{
-            [cell setPreviewImage:thumbnail.UIImage];
+            if ([cell.fileURL isEqual:item.fileURL]) {
+                [cell setPreviewImage:thumbnail.UIImage];
+            }
         });
     }];
 }
@@ -50,6 +50,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)removeItem:(ShareItem *)item;
 - (void)removeAllItems;
 - (UIImage *)getImageFromItem:(ShareItem *)item;
+- (UIImage *)getThumbnailFromItem:(ShareItem *)item withMaxPixelSize:(NSInteger)maxPixelSize scale:(CGFloat)scale;
 
 @end
 
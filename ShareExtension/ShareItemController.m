@@ -20,6 +20,7 @@
  *
  */
 
+#import <ImageIO/ImageIO.h>
 #import <MobileCoreServices/MobileCoreServices.h>
 
 #import "ShareItemController.h"
@@ -108,8 +109,7 @@ CGFloat const kShareItemControllerImageQuality = 0.7f;
     
     // Try to determine if the item is an image file
     // This can happen when sharing an image from the native ios files app
-    UIImage *image = [self getImageFromFileURL:fileLocalURL];
-    BOOL fileIsImage = (image != nil);
+    BOOL fileIsImage = [self isImageFileURL:fileLocalURL];
     
     ShareItem* item = [ShareItem initWithURL:fileLocalURL withName:fileName withPlaceholderImage:[self getPlaceholderImageForFileURL:fileLocalURL] isImage:fileIsImage];
     [self.shareItems addObject:item];
@@ -154,6 +154,52 @@ CGFloat const kShareItemControllerImageQuality = 0.7f;
     return image;
 }
 
+- (UIImage *)getThumbnailFromItem:(ShareItem *)item withMaxPixelSize:(NSInteger)maxPixelSize scale:(CGFloat)scale
+{
+    if (!item || !item.fileURL) {
+        return nil;
+    }
+
+    // Decode the image directly at the requested size instead of loading the full image into memory
+    NSDictionary *sourceOptions = @{(id)kCGImageSourceShouldCache: @NO};
+    CGImageSourceRef imageSource = CGImageSourceCreateWithURL((__bridge CFURLRef)item.fileURL, (__bridge CFDictionaryRef)sourceOptions);
+
+    if (!imageSource) {
+        return nil;
+    }
+
+    NSDictionary *thumbnailOptions = @{(id)kCGImageSourceCreateThumbnailFromImageAlways: @YES,
+                                       (id)kCGImageSourceShouldCacheImmediately: @YES,
+                                       (id)kCGImageSourceCreateThumbnailWithTransform: @YES,
+                                       (id)kCGImageSourceThumbnailMaxPixelSize: @(maxPixelSize)};
+    CGImageRef thumbnailImage = CGImageSourceCreateThumbnailAtIndex(imageSource, 0, (__bridge CFDictionaryRef)thumbnailOptions);
+    CFRelease(imageSource);
+
+    if (!thumbnailImage) {
+        return nil;
+    }
+
+    UIImage *image = [UIImage imageWithCGImage:thumbnailImage scale:scale orientation:UIImageOrientationUp];
+    CGImageRelease(thumbnailImage);
+
+    return image;
+}
+
+- (BOOL)isImageFileURL:(NSURL *)fileURL
+{
+    // Only read the file header to determine the type, without decoding the image
+    CGImageSourceRef imageSource = CGImageSourceCreateWithURL((__bridge CFURLRef)fileURL, NULL);
+
+    if (!imageSource) {
+        return NO;
+    }
+
+    BOOL isImage = (CGImageSourceGetType(imageSource) != NULL && CGImageSourceGetCount(imageSource) > 0);
+    CFRelease(imageSource);
+
+    return isImage;
+}
+
 - (void)addItemWithContactData:(NSData *)data
 {
     NSString *vCardFileName = [NSString stringWithFormat:@"Contact_%.f.vcf", [[NSDate date] timeIntervalSince1970] * 1000];